@@ -0,0 +1,87 @@
+#ifndef ADMISSIONCONTROL_H
+#define ADMISSIONCONTROL_H
+
+#include <Arduino.h>
+#include "Metrics.h"
+
+// Clients tracked at once; the least recently seen one is evicted
+#define ADMISSION_MAX_CLIENTS 16
+
+// What a route costs the single-threaded server. Control routes are
+// never shed for global load, only for a client exceeding its own rate.
+enum RouteClass : uint8_t
+{
+    ROUTE_CONTROL = 0,  // Tune/volume/seek/preset/power, config changes
+    ROUTE_STATUS = 1,   // Polled status (I2C reads, JSON building)
+    ROUTE_HEAVY = 2,    // Wi-Fi scan, benchmarks, config import, reset
+    ROUTE_STATIC = 3,   // UI files from SD
+    ROUTE_CLASS_COUNT = 4
+};
+
+enum Admission : uint8_t
+{
+    ADMIT_OK = 0,
+    ADMIT_RATE_LIMITED = 1, // This client is over its budget -> 429
+    ADMIT_OVERLOADED = 2    // All clients together are over budget -> 503
+};
+
+// =========================================================
+// Token-bucket admission control for AppWebServer
+// =========================================================
+// Every client IP has one bucket per route class, and every class also
+// has a bucket shared by all clients. Buckets store credit in
+// milliseconds: each token costs `intervalMs` and at most `burst`
+// tokens accumulate, so refill is one subtraction, no floats.
+// The last `reserve` tokens of a shared bucket go only to clients that
+// still hold half their own burst, so a few clients using up their rate
+// cannot drain it for one polling within its rate. A 503 refunds the
+// client's own token, except to such a client for a class with a reserve.
+class AdmissionControl
+{
+public:
+    AdmissionControl();
+
+    // Register the shed counters
+    void begin();
+
+    Admission admit(uint32_t clientIp, RouteClass cls);
+
+    static const char *className(RouteClass cls);
+
+private:
+    struct Bucket
+    {
+        uint32_t creditMs;
+        uint32_t lastMs;
+    };
+
+    struct Client
+    {
+        uint32_t ip;          // 0 = free slot
+        uint32_t lastSeenMs;
+        Bucket buckets[ROUTE_CLASS_COUNT];
+    };
+
+    struct Spec
+    {
+        uint16_t intervalMs;  // 1000 / rate; 0 = unlimited
+        uint16_t burst;
+        uint16_t reserve;     // Shared bucket: tokens kept for light clients
+    };
+
+    static const Spec clientSpecs[ROUTE_CLASS_COUNT];
+    static const Spec globalSpecs[ROUTE_CLASS_COUNT];
+
+    Client clients[ADMISSION_MAX_CLIENTS];
+    Bucket global[ROUTE_CLASS_COUNT];
+
+    MetricCounter *rateLimited[ROUTE_CLASS_COUNT];
+    MetricCounter *overloaded[ROUTE_CLASS_COUNT];
+
+    static bool take(Bucket &bucket, const Spec &spec, uint32_t now, uint16_t keep = 0);
+    static void fill(Bucket &bucket, const Spec &spec, uint32_t now);
+    static void refund(Bucket &bucket, const Spec &spec);
+    Client *findClient(uint32_t ip, uint32_t now);
+};
+
+#endif // ADMISSIONCONTROL_H
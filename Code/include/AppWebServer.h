@@ -8,12 +8,40 @@
 #include "FileManager.h"  // Cần để phục vụ file tĩnh và lưu config
 #include "Constants.h"    // Nơi chứa các hằng số
 #include "ConnectivityManager.h"
+#include "ConfigStore.h"
+#include "OtaManager.h"
+#include "RadioController.h"
+#include "GroupSync.h"
+#include "AdmissionControl.h"
+#include "UiFlash.h"
+#include "ScheduleEngine.h"
+#include "SpectrumStream.h"
+#include "InputSourceManager.h"
+#include "ListeningLog.h"
+#include "HttpRange.h"
+
+// JSON /api/fm/status đã serialize sẵn (đủ cho freq, rssi, ps, version...)
+#define STATUS_JSON_MAX 256
+
+// Module mà route cần, do một bước boot khởi động (có thể chưa xong khi
+// server đã nhận request)
+enum RouteNeeds : uint8_t
+{
+    NEEDS_NOTHING,
+    NEEDS_TUNER,
+    NEEDS_SCHEDULE,
+    NEEDS_INPUT,
+    NEEDS_LISTENING,
+    NEEDS_GROUP,
+};
 
 class AppWebServer
 {
 public:
     // Constructor nhận con trỏ của các module khác
-    AppWebServer(FMRadio *radio, PowerManager *power, FileManager *fileMgr, ConnectivityManager *connectivity);
+    // Lệnh điều khiển FM đi qua RadioController để nhóm đa phòng nhận được
+    // UI đóng gói trong flash (uiFlash) là lớp mặc định, /ui trên SD ghi đè lên nó
+    AppWebServer(RadioController *controller, PowerManager *power, FileManager *fileMgr, ConnectivityManager *connectivity, ConfigStore *config, OtaManager *ota, GroupSync *group, UiFlash *uiFlash, ScheduleEngine *schedule, SpectrumStream *spectrum, InputSourceManager *inputs, ListeningLog *listening);
 
     bool begin();
 
@@ -26,16 +54,60 @@ private:
 
     // Con trỏ tới các module khác
     ConnectivityManager *connectivity;
+    RadioController *radioController;
     FMRadio *fmRadio;
     PowerManager *powerManager;
     FileManager *fileManager;
+    ConfigStore *configStore;
+    OtaManager *otaManager;
+    GroupSync *groupSync;
+    UiFlash *uiFlash;
+    ScheduleEngine *scheduleEngine;
+    SpectrumStream *spectrumStream;
+    InputSourceManager *inputSources;
+    ListeningLog *listeningLog;
+
+    // Giới hạn tốc độ theo IP client và loại route
+    AdmissionControl admission;
+
+    // Đã trả lời request đầu tiên (đo time-to-first-HTTP lúc boot)
+    bool firstResponseSent;
+    // Cache JSON trạng thái FM theo version của snapshot: poll lặp lại ở
+    // cùng version chỉ tốn một lần gửi bộ đệm, không JSON, không I2C
+    char statusJson[STATUS_JSON_MAX];
+    size_t statusJsonLen;
+    uint32_t statusJsonVersion;
+    MetricCounter *statusCacheHits;
+
+    // Số request đã qua admit() (để biết handleClient() có xử lý gì không)
+    uint32_t requestsSeen;
 
     // Hàm đăng ký tất cả các API endpoints
     void registerAPIs();
+    // server.on() kèm đo latency theo route và kiểm soát tải (dùng thay cho std::bind)
+    void on(const char *uri, HTTPMethod method, void (AppWebServer::*handler)(), RouteClass cls, RouteNeeds needs = NEEDS_NOTHING);
+    // False (đã trả 429/503) nếu request bị từ chối
+    bool admit(RouteClass cls);
+    // False (đã trả 503) nếu module route cần vẫn đang khởi động
+    bool moduleReady(RouteNeeds needs);
+    void noteRequest();
+    // Ghi request vừa xử lý vào Capture (nếu đang ghi)
+    void captureRequest(uint32_t start, uint32_t heapBefore);
 
     // Các hàm xử lý request cụ thể
     void handleRoot();
-    void handleStaticFile();
+    void handleSdBench();
+    void handleUiBench();
+
+    // Stream file từ SD với bộ đệm lớn, hỗ trợ Range/206. False nếu không có file.
+    // `entry` (từ manifest /ui) cho phép gửi bản .gz nếu có.
+    bool streamFile(const char *fsPath, const char *contentType, const UiManifest::Entry *entry = nullptr);
+    // Gửi file từ partition UI: ghi thẳng từ vùng flash đã map ra socket, không bộ đệm
+    void sendFlashFile(const UiFlash::Entry *entry, const char *contentType);
+    // SD (nếu có file) rồi tới flash. False nếu cả hai đều không có.
+    bool serveUiFile(const String &path, const char *fsPath);
+    // Header chung (CORS, Range, gzip) + status line. False nếu không cần gửi thân (416/HEAD).
+    bool beginFileResponse(size_t size, const char *contentType, bool gzip, bool vary, HttpRange &range);
     void handleSystemVolume();
 
     // API FM module
@@ -48,8 +120,12 @@ private:
     void handleFmSetFreq();
     void handleFmVolume();
     void handleFmDeleteChannel();
+    void handleFmRds();
+    void handleFmStations();
+    void handleFmHistory();
     // CORS helper
     void sendCORSHeaders();
+    void sendChannelResponse(Channel channel, const char* extra = "");
     const char* getContentType(const String& path);
     // API Cấu hình Wi-Fi
     void handleGetWifiStatus();    // Trạng thái (AP/STA/Operational)
@@ -58,6 +134,29 @@ private:
     void handleResetWifiConfig();  // Buộc về Provisioning Mode
     // API Hệ thống
     void handleSystemReset();      // Kích hoạt reset thủ công
+    void handleConfigImport();     // Nạp lại các file JSON vào snapshot
+    void handleSystemBoot();       // Thời gian các pha khởi động
+    void handleSystemMetrics();    // Counter/gauge/histogram dạng text
+    void handleSystemTrace();      // Đọc TraceLog (và ?bench)
+    void handleSystemHangs();      // Breadcrumb lần reset trước + SLO từng bước
+    // API Capture
+    void handleCaptureStatus();    // Đang ghi/phát lại, số sự kiện, byte bị mất
+    void handleCaptureControl();   // Bắt đầu ghi, phát lại hoặc dừng
+    void handleCaptureFile();      // Tải file trace
+    // API Hẹn giờ (báo thức, hẹn giờ tắt)
+    void handleScheduleStatus();   // Báo thức, hẹn giờ tắt, ước tính dòng tiêu thụ
+    void handleScheduleSettings(); // Múi giờ
+    void handleScheduleAlarm();    // Thêm/sửa/tắt một báo thức
+    void handleScheduleSleep();    // Hẹn giờ tắt (0 = hủy)
+    void handleOtaStatus();        // Tiến độ cập nhật OTA (firmware/UI)
+    void handleSpectrumStatus();   // Dải tần các band, cổng WebSocket, CPU so với ngân sách
+    // API Nguồn vào (FM / Bluetooth)
+    void handleInputStatus();      // Nguồn đang phát, pha chuyển, độ trễ, dòng tiết kiệm
+    void handleInputSelect();      // Chuyển nguồn (fade ra -> đổi nguồn -> fade vào)
+    void handleListeningStats();   // Đài nghe nhiều nhất, thời gian nghe theo ngày
+    // API Nhóm đa phòng
+    void handleGroupStatus();      // Vai trò, leader, danh sách peer
+    void handleGroupMode();        // Bật/tắt chế độ nhóm
     // ... Thêm các hàm xử lý API khác
 };
 
@@ -0,0 +1,74 @@
+#ifndef AUDIORINGBUFFER_H
+#define AUDIORINGBUFFER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// =========================================================
+// Single-producer / single-consumer PCM ring buffer
+// =========================================================
+// Stores interleaved 16-bit stereo frames (L, R). One task writes
+// (Bluetooth/source callback), one task reads (I2S feeder). No locks:
+// the producer only moves `head`, the consumer only moves `tail`.
+class AudioRingBuffer
+{
+public:
+    enum Watermark
+    {
+        WATERMARK_LOW,  // Fill dropped to/below the low mark (consumer side)
+        WATERMARK_HIGH  // Fill rose to/above the high mark (producer side)
+    };
+
+    // Called from the producer (HIGH) or consumer (LOW) context, keep it short
+    typedef void (*WatermarkCallback)(Watermark mark, size_t fillFrames, void *ctx);
+
+    AudioRingBuffer();
+    ~AudioRingBuffer();
+
+    // Allocate storage, capacity is rounded up to a power of two (frames)
+    bool begin(size_t capacityFrames);
+    void end();
+
+    // Producer: copy up to `frames` frames in, returns frames accepted.
+    // Frames that do not fit are dropped and counted as an overrun.
+    size_t write(const int16_t *pcm, size_t frames);
+
+    // Consumer: copy up to `frames` frames out, returns frames read.
+    // Reading fewer frames than requested is counted as an underrun.
+    size_t read(int16_t *pcm, size_t frames);
+
+    // Consumer: drop everything currently buffered
+    void flush();
+
+    void setWatermarks(size_t lowFrames, size_t highFrames, WatermarkCallback cb, void *ctx);
+
+    size_t available() const;  // Frames ready to read
+    size_t freeSpace() const;  // Frames that can be written
+    size_t capacity() const { return capacityFrames; }
+
+    uint32_t getUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+    uint32_t getOverruns() const { return overruns.load(std::memory_order_relaxed); }
+    uint32_t getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+
+private:
+    int16_t *buffer;       // capacityFrames * 2 samples
+    size_t capacityFrames; // Power of two
+    size_t mask;           // capacityFrames - 1
+
+    // Free-running frame counters, fill = head - tail
+    std::atomic<uint32_t> head; // Written by producer only
+    std::atomic<uint32_t> tail; // Written by consumer only
+
+    std::atomic<uint32_t> underruns;
+    std::atomic<uint32_t> overruns;
+    std::atomic<uint32_t> droppedFrames;
+
+    size_t lowMark;
+    size_t highMark;
+    WatermarkCallback watermarkCb;
+    void *watermarkCtx;
+    bool highSignaled; // Owned by producer
+    bool lowSignaled;  // Owned by consumer
+};
+
+#endif // AUDIORINGBUFFER_H
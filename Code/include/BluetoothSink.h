@@ -0,0 +1,70 @@
+#ifndef BLUETOOTHSINK_H
+#define BLUETOOTHSINK_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <esp_a2dp_api.h>
+#include "AudioRingBuffer.h"
+#include "I2SAudioOutput.h"
+#include "Constants.h"
+
+// Bring-up/teardown run here, not on the loop task (Bluedroid takes
+// hundreds of ms either way)
+#define BT_TASK_CORE 0
+#define BT_TASK_PRIORITY 2
+
+// =========================================================
+// Bluetooth A2DP sink -> AudioRingBuffer -> I2SAudioOutput
+// =========================================================
+// enable()/disable() only record what is wanted and wake a worker task,
+// which starts or stops the whole chain: BR/EDR controller, Bluedroid,
+// the A2DP sink profile and the I2S output. Stopped, the radio is off and
+// its power is saved. Decoded PCM arrives on the Bluedroid task and goes
+// straight into the ring.
+class BluetoothSink
+{
+public:
+    BluetoothSink(AudioRingBuffer *ring, I2SAudioOutput *output);
+
+    // Allocate the ring and start the worker; the stack stays off
+    bool begin();
+
+    // Asynchronous; isReady() turns true once discoverable
+    void enable();
+    void disable();
+
+    bool isReady() const { return ready.load(); }
+    bool isConnected() const { return connected.load(); }
+    bool isStreaming() const { return streaming.load(); }
+
+    // Call from loop(): applies a sample rate change from the source
+    void poll();
+
+    void getStatus(JsonDocument *doc);
+
+private:
+    AudioRingBuffer *ring;
+    I2SAudioOutput *output;
+    TaskHandle_t task;
+
+    std::atomic<bool> wanted;
+    std::atomic<bool> ready;
+    std::atomic<bool> connected;
+    std::atomic<bool> streaming;
+    std::atomic<uint32_t> pendingRate; // From the codec config event, 0 = none
+    uint32_t lastEnableMs;             // Time of the last bring-up
+    uint32_t lastDisableMs;
+
+    // Bluedroid callbacks are plain functions
+    static BluetoothSink *instance;
+    static void taskEntry(void *arg);
+    static void onA2dpEvent(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param);
+    static void onAudioData(const uint8_t *data, uint32_t len);
+
+    void run();
+    bool startStack();
+    void stopStack();
+};
+
+#endif // BLUETOOTHSINK_H
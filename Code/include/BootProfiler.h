@@ -0,0 +1,49 @@
+#ifndef BOOTPROFILER_H
+#define BOOTPROFILER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "BootSequencer.h"
+
+// One phase per boot step, plus "serial" (before the sequencer starts)
+// and the "first_http" mark
+#define BOOT_MAX_PHASES (BOOT_MAX_STEPS + 2)
+
+// =========================================================
+// Boot-phase timer
+// =========================================================
+// Records start/end timestamps (us since reset) of named boot phases.
+// Phases may overlap and may be started from several tasks at once;
+// names must be string literals.
+class BootProfiler
+{
+public:
+    // Returns a phase id for end(), -1 if the table is full
+    static int start(const char *name);
+    static void end(int id);
+
+    // Zero-length phase marking a point in time (e.g. first HTTP response)
+    static void mark(const char *name);
+
+    // Print every phase to Serial
+    static void report();
+
+    // Phases as JSON (for /api/system/boot)
+    static void toJson(JsonDocument *doc);
+
+private:
+    struct Phase
+    {
+        const char *name; // nullptr until the slot is filled in
+        uint32_t startUs;
+        uint32_t endUs;   // 0 = still running
+    };
+
+    static Phase phases[BOOT_MAX_PHASES];
+    static std::atomic<uint8_t> count;
+
+    static uint8_t recorded();
+};
+
+#endif // BOOTPROFILER_H
@@ -0,0 +1,56 @@
+#ifndef BOOTSEQUENCER_H
+#define BOOTSEQUENCER_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Event groups carry 24 usable bits
+#define BOOT_MAX_STEPS 24
+#define BOOT_STEP_STACK 8192
+
+// =========================================================
+// Dependency-graph boot
+// =========================================================
+// Each step names the steps it depends on (bitmask returned by add()).
+// A coordinator task starts every step whose dependencies are done in its
+// own task, so independent steps (SD mount, tuner bring-up, Wi-Fi
+// association, ...) overlap. Every step is timed with BootProfiler.
+class BootSequencer
+{
+public:
+    typedef std::function<void()> StepFn;
+
+    BootSequencer();
+
+    // Register a step. `deps` may only reference steps added earlier,
+    // which keeps the graph acyclic. Returns the step's bit.
+    uint32_t add(const char *name, StepFn fn, uint32_t deps = 0);
+
+    // Launch the coordinator; returns immediately
+    void start();
+
+    // Block the calling task until all steps in `bits` are done.
+    // Safe to call from inside a step for a step it does not depend on.
+    void waitFor(uint32_t bits);
+    bool isDone(uint32_t bits) const;
+
+private:
+    struct Step
+    {
+        const char *name;
+        StepFn fn;
+        uint32_t deps;
+        uint32_t bit;
+        BootSequencer *owner;
+    };
+
+    Step steps[BOOT_MAX_STEPS];
+    uint8_t count;
+    EventGroupHandle_t done;
+
+    static void coordinatorTask(void *arg);
+    static void stepTask(void *arg);
+    void coordinate();
+};
+
+#endif // BOOTSEQUENCER_H
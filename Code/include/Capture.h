@@ -0,0 +1,199 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "FileManager.h"
+
+// Traces live in /capture/<name>.bin (relative to PROJECT_ROOT_DIR)
+#define CAPTURE_DIR "/capture"
+#define CAPTURE_NAME_MAX 24
+// Recording stops by itself at this size
+#define CAPTURE_MAX_BYTES (1024UL * 1024UL)
+// Producers copy events into this ring; poll() writes it to SD
+#define CAPTURE_RING_BYTES 16384
+#define CAPTURE_DRAIN_BYTES 2048       // Write once this much is pending...
+#define CAPTURE_DRAIN_INTERVAL_MS 500  // ...or this long after the last write
+// Request line kept per HTTP event ("uri?name=value&...", truncated)
+#define CAPTURE_TEXT_MAX 160
+// Replay feeds recorded tuner reads up to this far ahead of their time
+#define CAPTURE_REPLAY_LEAD_MS 2000
+
+// =========================================================
+// Trace format (little-endian)
+// =========================================================
+// A CaptureHeader, then events: type (1 byte), payload length (1 byte),
+// time (4 bytes, micros() at the start of the operation), payload.
+// Unknown types can be skipped by their length; tools/capture_trace.py
+// reads the same layout.
+enum CaptureEvent : uint8_t
+{
+    CAP_HTTP = 1,        // method, duration, heap before/after, largest block, request line
+    CAP_TUNER_BLOCK = 2, // ok, registers 0x0A-0x0F (FMRadio status/RDS burst)
+    CAP_TUNER_REG = 3,   // register, ok, value (FastTuner single register read)
+    CAP_TUNER_STC = 4,   // ok, 0x0A, 0x0B (FastTuner STC/RSSI poll)
+    CAP_FILE = 5,        // op, ok, duration, bytes, free heap, path
+    CAP_DROPPED = 6      // Bytes of events lost to a full ring before this point
+};
+
+// FileManager operations in CAP_FILE
+enum CaptureFileOp : uint8_t
+{
+    CAP_FILE_OPEN_READ = 1,
+    CAP_FILE_OPEN_WRITE = 2,
+    CAP_FILE_OPEN_APPEND = 3,
+    CAP_FILE_LOAD_JSON = 4,
+    CAP_FILE_SAVE_JSON = 5,
+    CAP_FILE_REMOVE = 6,
+    CAP_FILE_MKDIR = 7,
+    CAP_FILE_RENAME = 8,
+    CAP_FILE_EXISTS = 9
+};
+
+struct CaptureHeader
+{
+    char magic[4];       // "FMCP"
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t startUs;    // micros() when recording started; event times count from here
+    uint32_t startMs;    // millis() at the same moment
+    uint32_t freeHeap;
+    uint32_t reserved;
+    char build[24];      // __DATE__ " " __TIME__ of the firmware that recorded it
+};
+
+// =========================================================
+// Record / replay of requests and hardware results
+// =========================================================
+// Recording: the HTTP wrapper, the tuner register reads and FileManager
+// append compact events to a RAM ring under a spinlock; poll() (loop
+// task) streams the ring to SD. Hooks are a single flag test when idle.
+//
+// Replay: poll() reads a trace back and queues its tuner events by their
+// recorded time; FMRadio and FastTuner take the next queued result instead
+// of reading the RDA5807, so the station/RDS/signal logic runs on what the
+// field unit received. tools/capture_trace.py re-sends the recorded
+// requests with their original spacing and compares the new recording
+// with the old one; test/test_replay does the same on the host (native).
+// SD results are recorded but not substituted (File objects leave
+// FileManager). Replay consumers run on the loop task only.
+class Capture
+{
+public:
+    static void begin(FileManager *fm);
+
+    // Start/stop. Recording and replay may run together (record the replay).
+    static bool startRecording(const char *name);
+    static bool startReplay(const char *name);
+    static void stop();
+    static bool isRecording() { return recording.load(std::memory_order_relaxed); }
+    static bool isReplaying() { return replaying; }
+
+    // Call from loop(): drain to SD, feed the replay queues
+    static void poll();
+
+    // Recording hooks
+    static void request(uint8_t method, const char *text, uint32_t startUs, uint32_t heapBefore);
+    static void tunerBlock(const uint16_t regs[6], bool ok);
+    static void tunerRegister(uint8_t reg, uint16_t value, bool ok);
+    static void tunerStatus(uint16_t reg0a, uint16_t reg0b, bool ok);
+    static void file(CaptureFileOp op, const char *path, bool ok, uint32_t startUs, uint32_t bytes);
+
+    // Replay hooks: true if the result came from the trace (`ok` = recorded outcome)
+    static bool replayTunerBlock(uint16_t regs[6], bool &ok);
+    static bool replayTunerRegister(uint8_t reg, uint16_t &value, bool &ok);
+    static bool replayTunerStatus(uint16_t &reg0a, uint16_t &reg0b, bool &ok);
+
+    static bool validName(const char *name);
+    static void pathFor(const char *name, char *out, size_t size);
+
+    static void getStatus(JsonDocument *doc);
+
+private:
+    struct TunerResult
+    {
+        uint8_t ok;
+        uint8_t reg;
+        uint16_t v[6];
+    };
+
+    template <uint8_t N>
+    struct TunerQueue
+    {
+        TunerResult items[N];
+        uint8_t head;
+        uint8_t count;
+        uint32_t fed;
+        uint32_t underflows;
+        bool push(const TunerResult &r);
+        bool pop(TunerResult &r);
+    };
+
+    static FileManager *fileManager;
+    static std::atomic<bool> recording;
+    static bool replaying;
+    static bool internalIo; // Capture's own SD access is not recorded
+
+    // Event ring (bytes), producers under ringLock
+    static portMUX_TYPE ringLock;
+    static uint8_t ring[CAPTURE_RING_BYTES];
+    static uint32_t ringHead; // Write position (free-running)
+    static uint32_t ringTail; // Drain position
+    static uint32_t ringHighWater;
+    static uint32_t droppedBytes;
+    static uint32_t droppedReported;
+
+    static File out;
+    static char recordName[CAPTURE_NAME_MAX + 1];
+    static uint32_t startUs;
+    static uint32_t bytesWritten;
+    static uint32_t lastDrainMs;
+    static uint32_t eventCounts[CAP_DROPPED + 1];
+
+    static File in;
+    static char replayName[CAPTURE_NAME_MAX + 1];
+    static uint32_t replayStartUs;      // micros() when replay began
+    static bool replayPending;          // `pending` holds an event not queued yet
+    static bool replayEof;
+    static uint8_t pendingType;
+    static uint32_t pendingUs;
+    static TunerResult pending;
+    static TunerQueue<64> blocks;
+    static TunerQueue<16> registers;
+    static TunerQueue<64> stcPolls;
+
+    static void append(uint8_t type, uint32_t timeUs, const void *payload, uint8_t len,
+                       const char *text = nullptr, uint8_t textLen = 0);
+    static void drain(bool all);
+    static void feedReplay();
+    static bool readEvent();
+};
+
+// Times one FileManager operation and records it when the scope ends,
+// as failed unless succeed() was called. Nothing is measured while not recording.
+class CaptureFileScope
+{
+public:
+    CaptureFileScope(CaptureFileOp op, const char *path)
+        : op(op), path(path), ok(false), bytes(0), startUs(Capture::isRecording() ? micros() : 0) {}
+    ~CaptureFileScope()
+    {
+        if (startUs)
+            Capture::file(op, path, ok, startUs, bytes);
+    }
+    void succeed(uint32_t size = 0)
+    {
+        ok = true;
+        bytes = size;
+    }
+
+private:
+    CaptureFileOp op;
+    const char *path;
+    bool ok;
+    uint32_t bytes;
+    uint32_t startUs;
+};
+
+#endif // CAPTURE_H
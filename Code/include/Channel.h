@@ -0,0 +1,60 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <Arduino.h>
+
+// Longest formatted frequency: "108.00" + NUL
+#define CHANNEL_STR_LEN 8
+
+// =========================================================
+// FM channel as a fixed-point frequency (10 kHz units)
+// =========================================================
+// 99.5 MHz is stored as 9950, the same unit the RDA5807 library uses, so
+// no float ever sits between the HTTP layer, the config files and the chip.
+// Band/space arguments use the RDA5807 register encoding (see FMRadio.h).
+class Channel
+{
+public:
+    Channel() : value(0) {}
+    explicit Channel(uint16_t code) : value(code) {}
+
+    // Parse decimal MHz text ("99.5", "99.95", "101") without floats.
+    // More than two decimals are rounded to the nearest 10 kHz.
+    static bool parse(const char *text, Channel &out);
+
+    // Legacy float MHz (old JSON files), rounded to the nearest 10 kHz
+    static Channel fromMHz(float mhz);
+
+    uint16_t code() const { return value; }
+    bool isNull() const { return value == 0; }
+
+    // Inside the band and on the channel raster for `space`
+    bool isValid(uint8_t band, uint8_t space) const;
+    bool inBand(uint8_t band) const;
+
+    // Nearest raster point inside the band
+    Channel snapped(uint8_t band, uint8_t space) const;
+
+    // "99.5", "99.55", "108.0": one decimal unless the second is needed.
+    // Returns the length written; `buf` must hold CHANNEL_STR_LEN bytes.
+    size_t format(char *buf) const;
+
+    static uint16_t bandStart(uint8_t band);
+    static uint16_t bandEnd(uint8_t band);
+    static uint16_t spacingKHz(uint8_t space);
+    static uint16_t rasterStep(uint8_t space); // Raster in 10 kHz units
+
+    // Channel number as the chip counts it (0x03 CHAN, 0x0A READCHAN): in
+    // chip channels of spacingKHz(space), 25 kHz at space=3, not in raster
+    // steps. The raster is a multiple of it, so both ways are exact.
+    uint16_t chipChannel(uint8_t band, uint8_t space) const;
+    static Channel fromChipChannel(uint16_t chan, uint8_t band, uint8_t space);
+
+    bool operator==(const Channel &other) const { return value == other.value; }
+    bool operator!=(const Channel &other) const { return value != other.value; }
+
+private:
+    uint16_t value;
+};
+
+#endif // CHANNEL_H
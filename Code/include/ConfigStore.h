@@ -0,0 +1,101 @@
+#ifndef CONFIGSTORE_H
+#define CONFIGSTORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include "FileManager.h"
+#include "Constants.h"
+#include "Schedule.h"
+
+// NVS location of the binary snapshot
+#define CONFIG_NVS_NAMESPACE "famio"
+#define CONFIG_NVS_KEY "snapshot"
+// Bump whenever RuntimeConfig changes layout
+#define CONFIG_SNAPSHOT_VERSION 5
+
+// =========================================================
+// All runtime configuration in one flat struct
+// =========================================================
+// Mirrors /config/common.json, /config/wifi.json, /config/fm.json and
+// /config/schedule.json.
+struct RuntimeConfig
+{
+    // common.json
+    uint8_t commonVolume;     // 0-100
+    uint16_t commonFreqCode;  // 10 kHz units
+    uint8_t groupEnabled;     // Multi-room group mode (GroupSync)
+    uint32_t controlToken;    // UDP control auth token, 0 = open
+    uint8_t inputSource;      // InputSource: 0 = FM, 1 = Bluetooth
+
+    // wifi.json
+    char staSsid[33];
+    char staPass[65];
+    char apSsid[33];
+    char apPass[65];
+
+    // fm.json
+    uint8_t fmVolume;         // 0-15
+    uint16_t fmChannelCode;   // 10 kHz units
+
+    // schedule.json
+    ScheduleAlarm alarms[SCHEDULE_MAX_ALARMS];
+    int16_t tzOffsetMin;      // Local time = UTC + offset
+};
+
+// =========================================================
+// Config store: NVS snapshot in front of the JSON files
+// =========================================================
+// Boot reads one CRC-checked blob from NVS instead of opening and
+// parsing three JSON files over SPI. The JSON files stay the editable
+// import/export format: modules keep writing them, and importJson()
+// pulls hand-edited files back into the snapshot.
+class ConfigStore
+{
+public:
+    ConfigStore(FileManager *fm);
+
+    // Load the snapshot, falling back to importing the JSON files. If that
+    // import fails too (no card), the defaults stay in RAM and nothing is
+    // written on its own, so the next boot retries the import.
+    void begin();
+
+    // Snapshot only, no SD access. Lets boot start Wi-Fi/tuner while the
+    // card is still mounting; call importJson() if this returns false.
+    bool loadSnapshot();
+
+    RuntimeConfig &get() { return config; }
+
+    // Persist the current values to the NVS snapshot. Only for changes the
+    // user made (credentials, tune, volume, ...): these are written even
+    // while an import is pending, which ends the retry.
+    bool commit();
+
+    // True while begin() found neither a snapshot nor readable JSON files
+    bool isImportPending() const { return importPending; }
+
+    // Write the runtime-changed common.json keys ("group", "input") back to
+    // the file, keeping the hand-edited ones, so importJson() sees them.
+    // False, with the file untouched, if it exists but cannot be parsed.
+    bool saveCommonJson();
+
+    // Re-read all JSON files into the snapshot (e.g. after editing on SD).
+    // False, with the config unchanged, if the card is not mounted or
+    // neither common.json nor wifi.json could be read.
+    bool importJson();
+
+    // Where the last begin() got its data from
+    bool loadedFromSnapshot() const { return fromSnapshot; }
+
+private:
+    FileManager *fileManager;
+    RuntimeConfig config;
+    bool fromSnapshot;
+    bool importPending; // Boot found no snapshot and could not import either
+
+    void setDefaults();
+
+    static uint32_t crc32(const uint8_t *data, size_t len);
+};
+
+#endif // CONFIGSTORE_H
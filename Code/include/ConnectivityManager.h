@@ -5,6 +5,7 @@
 #include <Preferences.h>
 #include <ArduinoJson.h>
 #include "FileManager.h"
+#include "ConfigStore.h"
 #include "Constants.h" // Cần để truy cập FileManager
 
 
@@ -16,13 +17,20 @@ public:
         int rssi;
     };
     
-    // Constructor nhận FileManager
-    ConnectivityManager(FileManager* fileManager);
+    // Constructor nhận FileManager và ConfigStore (snapshot cấu hình)
+    ConnectivityManager(FileManager* fileManager, ConfigStore* configStore);
 
     // Hàm chính khởi tạo và thiết lập chế độ Wi-Fi
     // Trả về TRUE nếu ở chế độ Operational (STA), FALSE nếu ở chế độ Provisioning (AP+STA)
     bool begin();
 
+    // Các bước của begin() tách riêng để BootSequencer chạy song song:
+    // startAssociation() không chặn, waitForAssociation() chờ STA kết nối
+    // (thất bại -> xóa cấu hình và restart), startMdns() sau khi có IP.
+    void startAssociation();
+    bool waitForAssociation();
+    void startMdns();
+
     // Lấy trạng thái hoạt động hiện tại
     bool isOperational() const { return operational_mode; }
 
@@ -48,15 +56,55 @@ public:
     // Thực hiện khởi động lại thiết bị.
     void manualReset();
 
+    // Cập nhật gauge Wi-Fi (RSSI, chế độ) trước mỗi lần xuất metrics
+    void sampleMetrics();
+
+    // Giám sát liên kết STA, gọi trong loop() (không chặn): mất kết nối thì
+    // kết nối lại với backoff có jitter, RSSI yếu thì roam sang BSSID mạnh hơn
+    // cùng SSID. Web server/UDP vẫn giữ socket qua các lần kết nối lại.
+    void poll();
+
+    // Trạng thái giám sát cho /api/wifi/status
+    void getLinkStatus(JsonDocument* doc);
+
 private:
     FileManager* fm;
+    ConfigStore* config;
     bool operational_mode = false;
+    bool sta_pending = false; // Đã gọi WiFi.begin(), chưa có kết quả
     int scan_state = -2; // -2: chưa quét, -1: đang quét, >=0: số mạng tìm thấy
 
-    // Hàm nội bộ: Tải Credentials từ SD Card
+    // --- Giám sát liên kết (chỉ ở chế độ Operational) ---
+    enum LinkState : uint8_t
+    {
+        LINK_UP,         // Đã kết nối
+        LINK_BACKOFF,    // Chờ tới lần thử tiếp theo
+        LINK_CONNECTING, // Đã gọi WiFi.begin(), chờ kết quả
+        LINK_ROAM_SCAN   // Đang quét tìm BSSID mạnh hơn (vẫn kết nối)
+    };
+    LinkState link_state = LINK_UP;
+    uint32_t last_supervise_ms = 0;
+    uint32_t down_since_ms = 0;      // 0: đang kết nối bình thường
+    uint32_t next_attempt_ms = 0;
+    uint32_t attempt_started_ms = 0;
+    uint32_t backoff_ms = WIFI_BACKOFF_MIN_MS;
+    uint32_t last_roam_check_ms = 0;
+    uint32_t last_roam_scan_ms = 0;
+    bool roaming = false;            // Lần kết nối hiện tại là roaming chủ động
+    uint32_t disconnects = 0;
+    uint32_t attempts = 0;
+    uint32_t roams = 0;
+    uint32_t downtime_ms = 0;        // Tổng thời gian mất kết nối
+    uint32_t last_reconnect_ms = 0;  // Độ trễ kết nối lại gần nhất
+
+    void startAttempt(const uint8_t* bssid = nullptr, int32_t channel = 0);
+    void onLinkUp(uint32_t now);
+    void finishRoamScan(uint32_t now);
+
+    // Hàm nội bộ: Tải Credentials từ snapshot cấu hình
     bool loadCredentials(String& ssid, String& pass, String& ap_ssid, String& ap_pass);
 
-    // Hàm nội bộ: Lưu Credentials vào SD Card
+    // Hàm nội bộ: Lưu Credentials vào snapshot + wifi.json trên SD Card
     bool saveCredentials(const String& ssid, const String& pass);
 
     // Hàm nội bộ: Xóa Credentials
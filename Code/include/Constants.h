@@ -9,6 +9,19 @@
 #define SPI_MOSI_PIN 23 // Master Out Slave In (MOSI)
 #define SD_CS_PIN 5     // Chip Select (CS)
 
+// Xung SPI cho SD: mặc định của thư viện là 4 MHz, thẻ thường chạy được 20-25 MHz.
+// Nếu khởi tạo thất bại ở tốc độ cao, FileManager thử lại ở 4 MHz.
+#define SD_SPI_FREQ_HZ 20000000
+#define SD_SPI_FREQ_SAFE_HZ 4000000
+// Bộ đệm đọc khi stream file: bội số 512 byte để thư viện đọc nhiều sector liền
+#define FILE_STREAM_BUF_SIZE 8192
+// Độ dài tối đa của đường dẫn đầy đủ (/famio/...)
+#define FILE_PATH_MAX 128
+// Mỗi vòng loop() xử lý tối đa chừng này request liên tiếp (trong giới hạn
+// thời gian), để request bị từ chối (429/503) rời hàng đợi accept thật nhanh
+#define HTTP_ACCEPT_BURST 4
+#define HTTP_ACCEPT_BUDGET_US 20000
+
 // =========================================================
 // 2. Quản lý Nguồn (PowerManager)
 // =========================================================
@@ -36,11 +49,55 @@
 
 #define CONNECTION_TIMEOUT_S 30
 
+// Giám sát liên kết Wi-Fi khi đang chạy (ConnectivityManager::poll)
+#define WIFI_SUPERVISE_INTERVAL_MS 250
+#define WIFI_BACKOFF_MIN_MS 500       // Lần thử lại đầu tiên
+#define WIFI_BACKOFF_MAX_MS 15000     // Trần backoff (nhân đôi mỗi lần, jitter 50-100%)
+#define WIFI_ATTEMPT_TIMEOUT_MS 10000 // Một lần WiFi.begin() chưa xong thì tính là thất bại
+#define WIFI_ROAM_RSSI_DBM -75        // Dưới ngưỡng này thì quét tìm BSSID mạnh hơn
+#define WIFI_ROAM_HYSTERESIS_DB 8     // BSSID mới phải mạnh hơn ít nhất chừng này
+#define WIFI_ROAM_CHECK_MS 10000
+#define WIFI_ROAM_COOLDOWN_MS 60000   // Giữa hai lần quét roaming
+
 // Thư mục gốc chứa tất cả dữ liệu dự án trên SD Card
 #define PROJECT_ROOT_DIR "/famio"
 #define CONFIG_FILE_PATH "/config" // Đường dẫn file config Wi-Fi trên SD Card
 #define UI_PATH "/ui"
 #define WIFI_CONFIG_FILE "/wifi.json"
 #define COMMON_CONFIG_FILE "/common.json"
+#define FM_CONFIG_FILE "/fm.json"
+#define SCHEDULE_CONFIG_FILE "/schedule.json"
+
+// Đồng bộ giờ (báo thức cần giờ thật; RTC giữ giờ khi deep sleep)
+#define NTP_SERVER "pool.ntp.org"
+
+// =========================================================
+// 4. Audio Output (I2S -> Amplifier)
+// =========================================================
+// I2S0 được dành cho ADC nội (phân tích phổ), ngõ ra dùng I2S1
+#define I2S_OUT_PORT 1
+#define I2S_BCK_PIN 26
+#define I2S_WS_PIN 27
+#define I2S_DATA_OUT_PIN 32
+
+#define AUDIO_SAMPLE_RATE 44100
+// Double-buffering: 2 DMA buffers x 512 frames (~11.6 ms mỗi buffer @ 44.1 kHz)
+#define I2S_DMA_BUF_COUNT 2
+#define I2S_DMA_BUF_LEN 512
+
+// Tên hiển thị khi điện thoại dò Bluetooth (A2DP sink)
+#define BT_DEVICE_NAME "Famio Speaker"
+
+// Ring buffer PCM giữa nguồn (Bluetooth) và I2S, tính theo frame stereo
+#define AUDIO_RING_FRAMES 8192
+// Jitter buffer thích ứng: mức đệm trước khi phát (frame)
+#define AUDIO_JITTER_MIN_FRAMES 1024
+#define AUDIO_JITTER_MAX_FRAMES 6144
+#define AUDIO_TASK_PRIORITY 5
+#define AUDIO_TASK_CORE 1
+
+// Phân tích phổ: ngõ ra audio của tuner (qua tụ + cầu chia về 1.65 V) vào GPIO36
+#define SPECTRUM_I2S_PORT 0
+#define SPECTRUM_ADC_CHANNEL ADC1_CHANNEL_0
 
 #endif // CONSTANTS_H
\ No newline at end of file
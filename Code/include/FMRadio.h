@@ -2,13 +2,18 @@
 #define FMRADIO_H
 
 #include <Arduino.h>
+#include <atomic>
 #include <Wire.h>          // I2C library
 #include <ArduinoJson.h>   // JSON support
 #include <RDA5807.h>       // PU2CLR RDA5807 library
 #include "FileManager.h"
-
-#define FM_CONFIG_FILE "/config/fm.json" 
-#define MAX_CHANNELS 10    // Maximum number of saved channels
+#include "RDSDecoder.h"
+#include "StationStore.h"
+#include "Channel.h"
+#include "ConfigStore.h"
+#include "Metrics.h"
+#include "FastTuner.h"
+#include "SignalMonitor.h"
 
 // RDA5807 library configuration
 // Band options: 0=FM World (87-108MHz), 1=Japan wide (76-91MHz), 2=World wide (76-108MHz), 3=Special (65-76MHz or 50-65MHz)
@@ -16,62 +21,156 @@
 // Space options: 0=100kHz, 1=200kHz, 2=50kHz, 3=25kHz
 #define RDA5807_SPACE 0      // 100 kHz channel spacing
 
+// RDS groups arrive every ~88 ms; poll faster so none are missed. The same
+// burst read samples RSSI/stereo for the status snapshot.
+#define RDS_POLL_INTERVAL_MS 40
+
+// RSSI/stereo changes reach the status snapshot at most this often; tune,
+// volume, power and RDS changes are published on the next poll()
+#define STATUS_SAMPLE_INTERVAL_MS 250
+
+// Tune/volume changes are written to NVS/fm.json after this much quiet,
+// so preset switching never waits on flash or SD
+#define CONFIG_SAVE_DELAY_MS 2000
+
+// Station metadata (play count, RSSI, name) is written back at most this often
+#define STATION_FLUSH_INTERVAL_MS 60000
+
+// Receiver state as last sampled by poll(). Copied out under a sequence
+// counter, so readers never touch the I2C bus or block the loop task.
+struct FMStatusSnapshot
+{
+    uint16_t channelCode;
+    uint8_t volume;
+    uint8_t rssi;
+    bool stereo;
+    bool powered;
+    bool hasPs;
+    char ps[9];
+    uint32_t rdsVersion;
+    uint32_t sampledMs;
+};
+
 class FMRadio {
 public:
     // Constructor
-    FMRadio(FileManager* fm);
+    FMRadio(FileManager* fm, ConfigStore* config);
 
     // Initialize I2C and RDA5807 chip
     void begin();
+
+    // Load config and station database without touching the chip.
+    // Run as a boot step so power-on later only has to set up the RDA5807.
+    void prepare();
     
-    // Set frequency in MHz (e.g., 99.5 for 99.5 MHz)
-    void setFrequency(float freq_mhz);
+    // Tune to a channel (snapped onto the band/space raster). Muted while
+    // the chip retunes; config is saved later from poll().
+    void setFrequency(Channel channel);
     
-    // Auto seek - returns new frequency
-    float autoSeekNext();
+    // Auto seek - returns new channel
+    Channel autoSeekNext();
 
     // Hardware seek up/down
     void seekUp();
     void seekDown();
 
-    // Stereo/Mono control
+    // Stereo/Mono control. Mono here is forced; with stereo allowed the
+    // SignalMonitor still blends to mono on weak signal.
     void setStereo(bool enable);
 
     // Power management
     void powerOff();
-    void powerOn();
+    void powerOn();  // Warm start after powerOff(), full begin() the first time
     
     // Volume control (0-15)
     void setVolume(uint8_t volume);
     uint8_t getVolume() const { return currentVolume; }
+    bool isPoweredOn() const { return isPowered; }
+    // prepare() or begin() has finished: config and stations are loaded.
+    // Set by the "tuner" boot step while loop() and HTTP already run.
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+    int getRssi() const { return rssi; }   // Last sampled value (0-63)
 
-    // Save configuration to SD card
+    // Save configuration to SD card (now; see also scheduleSave)
     void saveConfig();
     // Channel management
-    void saveChannel(float freq_mhz);                
+    void saveChannel(Channel channel);                
     void selectSavedChannel(uint8_t index);         
     void getSavedChannels(JsonDocument* doc);       
     void deleteChannel(uint8_t index);
 
-    // Get receiver status (for WebServer)
+    // Full station database (presets and every station tuned so far)
+    void getStations(JsonDocument* doc);
+    void benchmarkStations(JsonDocument* doc);
+
+    // Get receiver status (for WebServer); served from the snapshot, no I2C
     void getStatus(JsonDocument* doc);
 
-    // Get current frequency
-    float getCurrentFrequency() const { return currentFreq; }
+    // Lock-free copy of the snapshot; returns its version
+    uint32_t readStatus(FMStatusSnapshot& out) const;
+    // Changes whenever the snapshot changes (cache key for serialized status)
+    uint32_t getStatusVersion() const { return statusSeq.load(std::memory_order_acquire) >> 1; }
+
+    // Periodic work (RDS decoding), call from loop()
+    void poll();
+
+    // RDS data (for WebServer). Version changes whenever any field changes.
+    void getRdsStatus(JsonDocument* doc);
+    uint32_t getRdsVersion() const { return rds.getVersion(); }
+
+    // RSSI/stereo history (for WebServer)
+    const SignalMonitor& getSignalMonitor() const { return signal; }
+
+    // Get current channel
+    Channel getCurrentChannel() const { return currentChannel; }
+
+    // Band-aware validation for input coming from the HTTP layer
+    static bool isValidChannel(Channel channel) { return channel.inBand(RDA5807_BAND); }
 
 private:
     RDA5807 rx;                         // RDA5807 receiver from library
+    FastTuner tuner;                    // Register-level tune path
     FileManager* fileManager;           // Reference to FileManager
-    float currentFreq;                  // Current frequency in MHz
+    ConfigStore* configStore;           // Volume/channel snapshot (NVS)
+    Channel currentChannel;             // Current frequency (10 kHz units)
     bool isPowered;                     // Power state
+    bool chipInitialized;               // begin() has run once; powerOn() can warm start
+    std::atomic<bool> ready;            // See isReady()
     int rssi;                           // Signal strength (RSSI)
     uint8_t currentVolume;              // Current volume (0-15)
-    float savedChannels[MAX_CHANNELS];  // Saved channel frequencies
-    uint8_t numSavedChannels;           // Number of saved channels
+    StationStore stations;              // Presets + station metadata on SD
+    bool stationsLoaded;                // stations.begin() done
+    uint32_t lastStationFlushMs;        // Last deferred metadata write
+    RDSDecoder rds;                     // Incremental RDS group decoder
+    uint32_t lastRdsPollMs;             // Last RDS poll timestamp
+    bool stereo;                        // ST bit from the last sample
+    bool forcedMono;                    // setStereo(false)
+    SignalMonitor signal;               // History + auto mono blend
+
+    // Status snapshot (seqlock: odd while being written)
+    std::atomic<uint32_t> statusSeq;
+    FMStatusSnapshot status;
+    uint32_t lastStatusPublishMs;
+
+    // Deferred persistence
+    bool configDirty;
+    uint32_t configDirtyMs;
+    MetricCounter* i2cTransactions;
+
+    // I2C latency per operation (see /api/system/metrics)
+    MetricHistogram* tuneLatency;       // Mute -> unmute, whole retune
+    MetricCounter* tuneTimeouts;
+    MetricHistogram* i2cSeek;
+    MetricHistogram* i2cVolume;
+    MetricHistogram* i2cSample;       // Status/RDS burst read
+    MetricHistogram* i2cPower;
 
     // Helper functions
     void loadConfig();       // Load volume and channels from SD card
-    void updateStatus();     // Update RSSI from chip
+    void scheduleSave();     // Save after CONFIG_SAVE_DELAY_MS of quiet
+    void sampleChip();       // One burst read: RDS group, RSSI, stereo
+    void publishStatus();    // Refresh the snapshot if something changed
+    bool readStatusRegisters(uint16_t regs[6]);
 };
 
 #endif // FMRADIO_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef FASTTUNER_H
+#define FASTTUNER_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// RDA5807 I2C addresses: sequential access reads from 0x0A, random
+// access reads/writes any single register
+#define RDA5807_I2C_SEQ_ADDR 0x10
+#define RDA5807_I2C_REG_ADDR 0x11
+
+// Give up waiting for STC (seek/tune complete) after this long
+#define FAST_TUNE_TIMEOUT_MS 60
+// Poll interval while waiting for STC / RSSI
+#define FAST_TUNE_POLL_US 2000
+// RSSI counts as settled once two samples differ by at most this much...
+#define FAST_TUNE_RSSI_EPS 2
+// ...or after this long past STC
+#define FAST_TUNE_SETTLE_MAX_MS 20
+
+// =========================================================
+// Register-level tune path for the RDA5807
+// =========================================================
+// The library's setFrequency() writes 0x03 and then sleeps a fixed
+// worst-case delay. This writes only 0x03 (channel + TUNE bit), polls
+// STC with a short timeout and waits for RSSI to settle, with the
+// output muted through DMUTE in 0x02 so the retune is not audible.
+class FastTuner
+{
+public:
+    struct Result
+    {
+        bool completed;     // STC seen before the timeout
+        uint16_t channelCode;
+        uint8_t rssi;
+        uint32_t stcUs;     // Register write -> STC
+        uint32_t totalUs;   // Mute -> unmute
+    };
+
+    FastTuner(TwoWire *bus);
+
+    // Tune to `code` (10 kHz units, already on the raster). `band`/`space`
+    // use the register encoding (see FMRadio.h).
+    Result tune(uint16_t code, uint8_t band, uint8_t space);
+
+    // Direct register access (random-access address)
+    bool readRegister(uint8_t reg, uint16_t &value);
+    bool writeRegister(uint8_t reg, uint16_t value);
+
+private:
+    TwoWire *wire;
+
+    // 0x0A (status) and 0x0B (RSSI) in one sequential read
+    bool readStatus(uint16_t &reg0a, uint16_t &reg0b);
+};
+
+#endif // FASTTUNER_H
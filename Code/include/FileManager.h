@@ -4,6 +4,7 @@
 #include "FS.h"
 #include "SD.h"
 #include <ArduinoJson.h>
+#include "UiManifest.h"
 
 // Định nghĩa Pin CS cho SD Card (Điều chỉnh theo mạch của bạn)
 #define SD_CS_PIN 5 
@@ -19,12 +20,51 @@ public:
     // Hàm lưu JSON (cần thiết để lưu cấu hình Wi-Fi, Preset)
     bool saveJsonFile(const char* path, const JsonDocument& doc);
 
-    // Hàm phục vụ file tĩnh (cho Web Server)
-    File openFile(const char* path);
+    // Hàm phục vụ file tĩnh (cho Web Server), mode: FILE_READ / FILE_WRITE / "r+"
+    File openFile(const char* path, const char* mode = FILE_READ);
+
+    // Xóa file (đường dẫn tương đối với PROJECT_ROOT_DIR)
+    bool removeFile(const char* path);
+
+    // Thao tác thư mục (đường dẫn tương đối với PROJECT_ROOT_DIR)
+    bool makeDir(const char* path);
+    bool renamePath(const char* from, const char* to);
+    bool exists(const char* path);
+    // Xóa đệ quy một thư mục (hoặc một file)
+    bool removeTree(const char* path);
+
+    // Đo tốc độ đọc tuần tự (MB/s) với các kích thước bộ đệm khác nhau
+    void benchmarkRead(const char* path, JsonDocument* doc);
+
+    // --- Manifest thư mục /ui (tra cứu không cần I/O) ---
+
+    // Quét lại /famio/ui vào RAM (gọi lúc mount và khi file marker thay đổi)
+    bool refreshUiManifest();
+
+    // Tra cứu đường dẫn tương đối với /ui ("/app.js"). nullptr nếu không có
+    // hoặc manifest chưa sẵn sàng (xem isUiManifestReady()).
+    const UiManifest::Entry* findUiFile(const char* relPath);
+    bool isUiManifestReady() const { return uiManifest.isReady(); }
+
+    // Thẻ SD đã mount thành công (false: chạy không SD, UI lấy từ flash)
+    bool isMounted() const { return sd_initialized; }
+
+    // Số thao tác SD (open/remove/duyệt thư mục) từ lúc boot
+    uint32_t getSdOps() const { return sdOps; }
+
+    // So sánh số thao tác SD và thời gian: manifest vs. dò từng file
+    void benchmarkUiLookups(JsonDocument* doc);
 
 private:
     // Biến lưu trữ trạng thái khởi tạo
     bool sd_initialized = false;
+
+    UiManifest uiManifest;
+    uint32_t sdOps = 0;
+    uint32_t lastMarkerCheckMs = 0;
+
+    void noteSdOps(uint32_t n = 1);
+    bool readUiMarker(uint32_t& size, uint32_t& mtime);
 };
 
 #endif // FILEMANAGER_H
\ No newline at end of file
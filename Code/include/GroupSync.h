@@ -0,0 +1,146 @@
+#ifndef GROUPSYNC_H
+#define GROUPSYNC_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <ArduinoJson.h>
+#include "RadioController.h"
+#include "ConfigStore.h"
+#include "Metrics.h"
+
+#define GROUP_PORT 5010
+#define GROUP_MDNS_SERVICE "famio-group"
+#define GROUP_MAX_PEERS 8
+#define GROUP_HEARTBEAT_MS 1000
+// A peer missing this long leaves the membership view
+#define GROUP_PEER_TIMEOUT_MS 3500
+#define GROUP_DISCOVERY_MS 15000
+// Resend state / forwarded commands that were not acknowledged
+#define GROUP_RETRY_MS 100
+
+// =========================================================
+// Multi-room group mode
+// =========================================================
+// Units find each other through the "_famio-group._udp" mDNS service and
+// through heartbeats they receive. The leader is the live member with
+// the lowest node id, so every unit with the same membership view picks
+// the same one without extra voting rounds.
+//
+// Local changes (HTTP, UDP control) reach the leader (directly or as a
+// FORWARD), which stamps them with the next sequence number and sends
+// CMD to every member. Followers apply CMD with seq greater than their
+// last one and ACK it; the ACK round trip is the propagation latency.
+// Heartbeats carry the full radio state: the leader resends one every
+// GROUP_RETRY_MS to followers that have not ACKed its latest seq, and a
+// leader that rejoins with an older seq adopts the group's state instead
+// of overwriting it.
+class GroupSync
+{
+public:
+    GroupSync(RadioController *controller, ConfigStore *config);
+
+    // Open the UDP socket and start mDNS discovery (needs the network stack).
+    // Units always use GROUP_PORT; another port lets several instances
+    // share one host.
+    void begin(uint16_t listenPort = GROUP_PORT);
+    // begin() runs in its boot step's task while loop() already polls
+    bool isStarted() const { return started.load(std::memory_order_acquire); }
+
+    // Handle packets and timers; call from loop()
+    void poll();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    bool isLeader() const { return enabled && leaderId == nodeId; }
+
+    void getStatus(JsonDocument *doc);
+
+    // Static peer (networks without mDNS)
+    void addPeer(IPAddress ip, uint16_t peerPort);
+
+    uint32_t getNodeId() const { return nodeId; }
+    uint32_t getLeaderId() const { return leaderId; }
+
+private:
+    enum PacketType : uint8_t
+    {
+        PKT_HEARTBEAT = 1,
+        PKT_CMD = 2,
+        PKT_FORWARD = 3,
+        PKT_ACK = 4
+    };
+
+    struct __attribute__((packed)) Packet
+    {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t type;
+        uint8_t cmdType;
+        uint8_t flags;     // bit0: group mode on, bit1: powered
+        uint32_t nodeId;
+        uint32_t leaderId; // Sender's view of the leader
+        uint32_t seq;
+        int32_t value;
+        uint16_t channelCode;
+        uint8_t volume;
+        uint8_t reserved;
+        uint32_t sentUs;   // Echoed back in ACK for RTT
+    };
+
+    struct Peer
+    {
+        uint32_t id;       // 0 = free slot / id not known yet
+        IPAddress ip;
+        uint16_t port;
+        uint32_t lastSeenMs;
+        uint32_t ackedSeq; // Leader only: last seq this peer confirmed
+        uint32_t retryMs;
+        bool enabled;
+    };
+
+    RadioController *controller;
+    ConfigStore *configStore;
+    WiFiUDP udp;
+    uint16_t port;
+
+    bool enabled;
+    uint32_t nodeId;
+    uint32_t leaderId;
+    uint32_t seq;             // Leader: last issued; follower: last applied
+    uint32_t lastHeartbeatMs;
+    uint32_t holdUntilMs;     // Ignore heartbeat state until a forwarded command comes back
+    RadioCommand pendingForward;
+    uint32_t forwardSentMs;
+    uint32_t lastPropagationUs;
+    std::atomic<bool> started;
+    Peer peers[GROUP_MAX_PEERS];
+
+    // Filled by the discovery task, drained by poll()
+    portMUX_TYPE discoveredLock;
+    IPAddress discovered[GROUP_MAX_PEERS];
+    uint8_t discoveredCount;
+
+    MetricHistogram *propagation;
+    MetricCounter *applied;
+    MetricCounter *stale;
+
+    static void onLocalCommand(const RadioCommand &effect, RadioCommandSource source, void *ctx);
+    static void discoveryTask(void *arg);
+
+    void handlePacket(const Packet &pkt, IPAddress from, uint16_t fromPort);
+    void sendPacket(Packet &pkt, IPAddress ip, uint16_t toPort);
+    void broadcast(Packet &pkt);
+    void fillHeader(Packet &pkt, PacketType type);
+    void issue(const RadioCommand &cmd);
+    void applyRemote(RadioCommandType type, int32_t value);
+    void convergeTo(const Packet &heartbeat);
+    void adoptState(const Packet &pkt);
+    void sendForward();
+    Peer *leaderPeer();
+    void electLeader(uint32_t now);
+    Peer *findPeer(IPAddress ip, uint16_t port, bool create);
+};
+
+#endif // GROUPSYNC_H
@@ -0,0 +1,148 @@
+#ifndef HANGDETECTOR_H
+#define HANGDETECTOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "Metrics.h"
+
+// Task watchdog for the loop task (seconds; panics and resets on expiry).
+// Long bounded work on the loop task (credential check, file streaming,
+// SD benchmark) calls feed().
+#define HANG_TWDT_TIMEOUT_S 8
+// Monitor task period: scans open sites for stalls
+#define HANG_MONITOR_INTERVAL_MS 250
+// A site still open after this long is treated as wedged: restart so the
+// trail is reported on the next boot (covers tasks the TWDT does not watch)
+#define HANG_FATAL_MS 60000
+// Breadcrumbs kept in RTC memory (power of two)
+#define HANG_TRAIL_SIZE 64
+// Labels (HTTP routes, boot steps) that can be attached to a breadcrumb
+#define HANG_MAX_LABELS 64
+
+// Breadcrumb flags per site
+#define HANG_TRAIL 0x01 // Enter/exit go to the trail (off for per-loop sites)
+
+// =========================================================
+// Site table
+// =========================================================
+// One entry per instrumented spot: id, name, budget (ms), flags. Leaving a
+// site after its budget counts as an SLO miss; still being inside it when
+// the monitor looks counts as a stall.
+#define HANG_SITES(X)                               \
+    X(LOOP, "loop", 250, 0)                         \
+    X(HTTP, "http", 300, HANG_TRAIL)                \
+    X(FM_POLL, "fm_poll", 50, 0)                    \
+    X(FM_TUNE, "fm_tune", 100, HANG_TRAIL)          \
+    X(FM_SEEK, "fm_seek", 3000, HANG_TRAIL)         \
+    X(FM_SAVE, "fm_save", 500, HANG_TRAIL)          \
+    X(GROUP_POLL, "group_poll", 20, 0)              \
+    X(UDP_POLL, "udp_poll", 20, 0)                  \
+    X(WIFI_ASSOC, "wifi_assoc", 35000, HANG_TRAIL)  \
+    X(WIFI_CHECK, "wifi_check", 35000, HANG_TRAIL)  \
+    X(WIFI_SOFTAP, "wifi_softap", 2000, HANG_TRAIL) \
+    X(SPECTRUM_POLL, "spectrum_poll", 1200, 0)
+
+enum HangSite : uint8_t
+{
+#define HANG_ENUM(id, name, budget, flags) HANG_##id,
+    HANG_SITES(HANG_ENUM)
+#undef HANG_ENUM
+        HANG_SITE_COUNT
+};
+
+// =========================================================
+// Hang detector
+// =========================================================
+// enter()/leave() stamp the site's open slot and (for HANG_TRAIL sites)
+// append an 8-byte breadcrumb to a ring, all in RTC_NOINIT memory that
+// survives panics, watchdog and software resets. A monitor task reports
+// sites open past their budget. After a non-power-on reset, begin() copies
+// what was open and the last breadcrumbs out before clearing them, and
+// report() serves that with per-site SLO stats.
+class HangDetector
+{
+public:
+    // Check for a previous wedge, arm the TWDT on the loop task, start the monitor
+    static void begin();
+
+    static void enter(HangSite site, uint16_t label = 0);
+    static void leave(HangSite site);
+
+    // Keep the loop task's watchdog alive inside a bounded wait
+    static void feed();
+
+    // Stable id for a string literal (route URI, ...); 0 if the table is full
+    static uint16_t label(const char *name);
+
+    // Restart on purpose, recording `site` as the cause (replaces `while (1);`)
+    static void restart(HangSite site);
+
+    // Last reset cause and trail, open sites, per-site budgets and misses
+    static void report(JsonDocument *doc);
+
+private:
+    struct Breadcrumb
+    {
+        uint32_t ms;
+        uint8_t site;
+        uint8_t kind; // KIND_*
+        uint16_t label;
+    };
+
+    struct OpenSlot
+    {
+        uint32_t startMs; // 0 when closed
+        uint16_t label;
+        uint8_t stalled;  // Stall already reported for this entry
+        uint8_t reserved;
+    };
+
+    // Lives in RTC slow memory, not cleared across resets
+    struct State
+    {
+        uint32_t magic;
+        uint32_t head;
+        uint32_t lastBeatMs;  // Monitor heartbeat: "now" at the time of the reset
+        uint8_t cause;        // Site passed to restart(), or HANG_SITE_COUNT
+        uint8_t reserved[3];
+        OpenSlot open[HANG_SITE_COUNT];
+        Breadcrumb trail[HANG_TRAIL_SIZE];
+    };
+
+    struct SiteStats
+    {
+        uint32_t runs;
+        uint32_t overBudget;
+        uint32_t stalls;
+        uint32_t maxMs;
+    };
+
+    static State state;
+    static State previous;      // Copy taken at boot (valid if hasPrevious)
+    static bool hasPrevious;
+    static int resetReason;
+    static std::atomic<uint32_t> trailHead;
+    static SiteStats stats[HANG_SITE_COUNT];
+    static MetricCounter *overBudgetTotal;
+    static MetricCounter *stallTotal;
+    static const char *labels[HANG_MAX_LABELS];
+    static std::atomic<uint16_t> labelCount;
+
+    static void crumb(HangSite site, uint8_t kind, uint16_t label);
+    static void monitorTask(void *arg);
+    static void reportState(const State &s, uint32_t nowMs, JsonObject out);
+};
+
+// Scoped enter/exit
+class HangGuard
+{
+public:
+    explicit HangGuard(HangSite site, uint16_t label = 0) : site(site) { HangDetector::enter(site, label); }
+    ~HangGuard() { HangDetector::leave(site); }
+
+private:
+    HangSite site;
+};
+
+#endif // HANGDETECTOR_H
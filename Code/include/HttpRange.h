@@ -0,0 +1,31 @@
+#ifndef HTTPRANGE_H
+#define HTTPRANGE_H
+
+#include <Arduino.h>
+#include "FS.h"
+
+// =========================================================
+// Range request against a file body (RFC 7233, one range)
+// =========================================================
+// resolve() turns the Range header into what to answer: 200 with the whole
+// body, 206 with one span, or 416. A range that starts past the end (or any
+// range on an empty body) is unsatisfiable. Headers we do not serve - other
+// units, several ranges, bad syntax - are ignored and the whole body goes
+// out with 200, as the RFC allows. The HTTP layer sends the headers; copy()
+// writes the span from an open file.
+struct HttpRange
+{
+    int code;              // 200, 206 or 416
+    size_t first;
+    size_t length;         // Bytes of body to send (0 for 416)
+    char contentRange[48]; // Content-Range value, "" for 200
+
+    // `header` is the Range value, nullptr when the request had none
+    static HttpRange resolve(const char *header, size_t size);
+
+    // Seek to `first` and write `length` bytes to `out` through `buf`;
+    // returns the bytes written (short if the file ends or the client goes)
+    size_t copy(File &file, Print &out, uint8_t *buf, size_t bufSize) const;
+};
+
+#endif // HTTPRANGE_H
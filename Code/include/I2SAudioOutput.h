@@ -0,0 +1,54 @@
+#ifndef I2SAUDIOOUTPUT_H
+#define I2SAUDIOOUTPUT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "AudioRingBuffer.h"
+#include "Constants.h"
+
+// =========================================================
+// I2S output fed from an AudioRingBuffer
+// =========================================================
+// A dedicated task drains the ring into a DMA double-buffer. The task runs
+// above loop() priority so a busy web server cannot starve the amplifier.
+// Playback only (re)starts once the ring holds `jitterTarget` frames; every
+// underrun grows that target, long clean stretches shrink it again.
+class I2SAudioOutput
+{
+public:
+    I2SAudioOutput(AudioRingBuffer *ring);
+
+    // Install the I2S driver and start the feeder task
+    bool begin(uint32_t sampleRate = AUDIO_SAMPLE_RATE);
+    void end();
+
+    bool setSampleRate(uint32_t sampleRate);
+    uint32_t getSampleRate() const { return sampleRate; }
+
+    // Stats (safe to read from any task)
+    uint32_t getUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+    uint32_t getFramesPlayed() const { return framesPlayed.load(std::memory_order_relaxed); }
+    size_t getJitterTarget() const { return jitterTarget.load(std::memory_order_relaxed); }
+    bool isRunning() const { return running; }
+
+private:
+    AudioRingBuffer *ring;
+    TaskHandle_t task;
+    volatile bool running;
+    uint32_t sampleRate;
+
+    int16_t chunk[I2S_DMA_BUF_LEN * 2]; // One DMA buffer worth of stereo frames
+    bool priming;                       // Waiting for the jitter buffer to fill
+    uint32_t cleanChunks;               // Chunks played since the last underrun
+
+    std::atomic<uint32_t> underruns;
+    std::atomic<uint32_t> framesPlayed;
+    std::atomic<size_t> jitterTarget;
+
+    static void taskEntry(void *arg);
+    void run();
+    void onUnderrun();
+    void onCleanChunk();
+};
+
+#endif // I2SAUDIOOUTPUT_H
@@ -0,0 +1,70 @@
+#ifndef INPUTSOURCEMANAGER_H
+#define INPUTSOURCEMANAGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <ArduinoJson.h>
+#include "InputSwitch.h"
+#include "RadioController.h"
+#include "PowerManager.h"
+#include "ConfigStore.h"
+#include "BluetoothSink.h"
+#include "Metrics.h"
+
+// =========================================================
+// Owner of the audio input: FM tuner or Bluetooth
+// =========================================================
+// Only the selected source is powered: Bluetooth active means the
+// RDA5807 is powered down, FM active means the BR/EDR stack is off.
+// Switches run through InputSwitch as a mute ramp on the amp. The tuner
+// is switched directly, not through RadioController commands, so a local
+// source change is not replicated to the rest of the group.
+//
+// Turning the tuner on from elsewhere (HTTP, alarm, group) while
+// Bluetooth is active counts as selecting FM.
+class InputSourceManager
+{
+public:
+    InputSourceManager(RadioController *controller, PowerManager *power, ConfigStore *config, BluetoothSink *bluetooth);
+
+    // After config/tuner/power: restore the saved source
+    void begin();
+    bool isStarted() const { return started.load(std::memory_order_acquire); }
+
+    // Call from loop()
+    void poll();
+
+    // Start a switch; false if `source` is already selected
+    bool select(InputSource source);
+    InputSource getActive() const { return inputSwitch.getActive(); }
+    InputSource getSelected() const { return inputSwitch.getTarget(); }
+
+    // Switch phase/latency, per-source power time and the current saved
+    void getStatus(JsonDocument *doc);
+
+private:
+    RadioController *controller;
+    FMRadio *fmRadio;
+    PowerManager *powerManager;
+    ConfigStore *configStore;
+    BluetoothSink *bluetooth;
+    InputSwitch inputSwitch;
+    std::atomic<bool> started;
+
+    // Time each source was powered, and powered down while the other one
+    // played (what gating saves, at INPUT_MA_*)
+    uint32_t lastAccountMs;
+    uint64_t poweredMs[INPUT_SOURCE_COUNT];
+    uint64_t gatedMs[INPUT_SOURCE_COUNT];
+
+    MetricCounter *switchCount[INPUT_SOURCE_COUNT];
+    MetricHistogram *switchLatency;
+
+    bool isPowered(InputSource source) const;
+    bool isReady(InputSource source) const;
+    void powerUp(InputSource source);
+    void powerDown(InputSource source);
+    void account(uint32_t nowMs);
+};
+
+#endif // INPUTSOURCEMANAGER_H
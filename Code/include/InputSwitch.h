@@ -0,0 +1,98 @@
+#ifndef INPUTSWITCH_H
+#define INPUTSWITCH_H
+
+#include <Arduino.h>
+
+enum InputSource : uint8_t
+{
+    INPUT_FM = 0,
+    INPUT_BLUETOOTH = 1,
+    INPUT_SOURCE_COUNT
+};
+
+// Amp fade on each side of a switch (full scale; partial fades are shorter)
+#define INPUT_RAMP_MS 150
+// Fade back in even if the new source never reports ready
+#define INPUT_READY_TIMEOUT_MS 3000
+
+// Battery-side draw of a powered source on top of the rest (3S pack, mA)
+#define INPUT_MA_FM 20.0f        // RDA5807 receiving; power-down is a few uA
+#define INPUT_MA_BLUETOOTH 35.0f // BR/EDR controller + Bluedroid, page scan, I2S out
+
+// What the caller has to do after update()
+struct InputSwitchOutput
+{
+    int8_t ampPercent; // Amp level as % of the listening level, -1 no change
+    int8_t powerDown;  // Source to power down now, -1 none
+    int8_t powerUp;    // Source to power up now, -1 none
+    bool finished;     // Switch complete; see getStats()
+};
+
+// =========================================================
+// Source switch sequencing, independent of the hardware
+// =========================================================
+// FM is analog into the amp and Bluetooth is PCM through I2S, so there is
+// no point where the two could be mixed: a switch is a mute ramp on the
+// amp. Fade out, power the old source down and the new one up while
+// muted, wait until the new one reports ready, fade in. Only one source
+// is ever powered outside the muted window.
+//
+// Times are millis() passed in by the caller, so the host can run the
+// same code against stand-in sources and a virtual clock.
+class InputSwitch
+{
+public:
+    enum Phase : uint8_t
+    {
+        PHASE_IDLE,
+        PHASE_FADE_OUT,
+        PHASE_WAIT_READY,
+        PHASE_FADE_IN
+    };
+
+    struct Stats
+    {
+        uint32_t switches;
+        uint32_t lastLatencyMs; // request() -> fade-in complete
+        uint32_t lastMutedMs;   // Amp at 0
+        uint32_t maxLatencyMs;
+        uint32_t readyTimeouts;
+    };
+
+    explicit InputSwitch(InputSource initial);
+
+    // Start switching to `target`. Asking for the source that is being
+    // faded out reverses the fade. False if already there.
+    bool request(InputSource target, uint32_t nowMs);
+
+    // Advance to `nowMs`. `activeReady`: the source getActive() returns is
+    // powered and producing audio (only looked at while waiting for it).
+    InputSwitchOutput update(uint32_t nowMs, bool activeReady);
+
+    // The source that is powered (the new one once the old is shut down)
+    InputSource getActive() const { return active; }
+    InputSource getTarget() const { return target; }
+    Phase getPhase() const { return phase; }
+    bool isSwitching() const { return phase != PHASE_IDLE; }
+    const Stats &getStats() const { return stats; }
+
+    static const char *name(InputSource source);
+    static const char *phaseName(Phase phase);
+
+private:
+    InputSource active;
+    InputSource target;
+    Phase phase;
+
+    uint8_t percent;       // Amp level the ramp last produced
+    uint8_t fromPercent;   // Where the current fade started
+    uint32_t phaseStartMs;
+    uint32_t requestMs;
+    uint32_t mutedAtMs;
+    Stats stats;
+
+    void startFade(Phase fade, uint32_t nowMs);
+    bool ramp(uint32_t nowMs, uint8_t to);
+};
+
+#endif // INPUTSWITCH_H
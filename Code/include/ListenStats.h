@@ -0,0 +1,109 @@
+#ifndef LISTENSTATS_H
+#define LISTENSTATS_H
+
+#include <Arduino.h>
+
+// Stations and days kept in the aggregate (RAM and listen_agg.bin)
+#define LISTEN_MAX_STATIONS 64
+#define LISTEN_DAYS 32 // Power of two; the day ring is indexed by day number
+
+#define LISTEN_CODE_BLUETOOTH 0 // Channel code recorded while Bluetooth plays
+
+// Why a session record was closed
+enum ListenEnd : uint8_t
+{
+    LISTEN_END_TUNE = 0,  // Retuned (preset, seek, group)
+    LISTEN_END_POWER = 1, // Tuner off, volume 0 or Bluetooth source idle
+    LISTEN_END_INPUT = 2, // Input source switched
+    LISTEN_END_SPLIT = 3, // LISTEN_MAX_SESSION_S reached, next record continues
+    LISTEN_END_SHUTDOWN = 4
+};
+
+// =========================================================
+// On-disk record (fixed 16 bytes)
+// =========================================================
+// One listening session on one channel. Slot 0 of each log file is a
+// header; records follow back to back, so 32 of them fill a sector.
+struct ListenRecord
+{
+    uint32_t start;     // UTC epoch seconds, 0 = clock was never set
+    uint16_t code;      // Channel code in 10 kHz units, 0 = Bluetooth
+    uint16_t durationS;
+    uint8_t rssiAvg;    // 0-63 (FM only)
+    uint8_t rssiMin;
+    uint8_t endReason;  // ListenEnd
+    uint8_t reserved;
+    uint16_t seq;       // Low bits of the sequence number (detects stale slots)
+    uint16_t crc;       // CRC-16 of the record with this field zeroed
+};
+
+// =========================================================
+// Aggregates, updated one record at a time
+// =========================================================
+// Persisted as-is next to the log. `seq` is the sequence number of the
+// next record to apply: on boot, records in the log from `seq` on are
+// replayed instead of scanning the whole log again.
+struct ListenAggregate
+{
+    struct Station
+    {
+        uint16_t code;
+        uint16_t sessions;
+        uint32_t seconds;
+    };
+    struct Day
+    {
+        uint32_t day;     // Local days since the epoch, 0 = unused
+        uint32_t seconds;
+    };
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t crc;
+    uint32_t seq;
+    uint32_t sessions;
+    uint32_t totalSeconds;
+    uint32_t bluetoothSeconds;
+    uint32_t untimedSeconds; // Sessions without a wall clock (no day)
+    uint32_t evicted;        // Stations dropped to make room
+    Station stations[LISTEN_MAX_STATIONS];
+    Day days[LISTEN_DAYS];
+};
+
+class ListenStats
+{
+public:
+    ListenStats();
+
+    void clear();
+
+    // Fold the record with sequence number nextSeq() in; `tzOffsetMin`
+    // places its start on a local day
+    void apply(const ListenRecord &rec, int16_t tzOffsetMin);
+    // Replay skips records (bad CRC) and lines up with the log's numbering
+    void setNextSeq(uint32_t seq) { agg.seq = seq; }
+
+    // Up to `max` FM stations by listening time, longest first
+    size_t top(const ListenAggregate::Station **out, size_t max) const;
+
+    // Listening seconds on a local day (days since the epoch)
+    uint32_t secondsOn(uint32_t day) const;
+
+    const ListenAggregate &get() const { return agg; }
+    uint32_t nextSeq() const { return agg.seq; }
+
+    // Image for listen_agg.bin; load() rejects a bad magic/version/CRC
+    const ListenAggregate &image();
+    bool load(const ListenAggregate &stored);
+
+    static uint16_t crc16(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
+    static uint16_t recordCrc(const ListenRecord &rec);
+
+private:
+    ListenAggregate agg;
+    uint8_t used; // Stations in use
+
+    ListenAggregate::Station *station(uint16_t code);
+};
+
+#endif // LISTENSTATS_H
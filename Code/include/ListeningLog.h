@@ -0,0 +1,123 @@
+#ifndef LISTENINGLOG_H
+#define LISTENINGLOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <ArduinoJson.h>
+#include "ListenStats.h"
+#include "FMRadio.h"
+#include "InputSourceManager.h"
+#include "BluetoothSink.h"
+#include "ConfigStore.h"
+#include "FileManager.h"
+#include "Metrics.h"
+
+#define LISTEN_LOG_DIR "/log"
+#define LISTEN_LOG_FILE "/log/listen.bin"
+#define LISTEN_LOG_PREVIOUS "/log/listen.1.bin" // Rotated out; one generation kept
+#define LISTEN_AGG_FILE "/log/listen_agg.bin"
+
+// 64 KB per file = 4095 records, around a year of typical use
+#define LISTEN_LOG_MAX_BYTES 65536
+// One SD sector of records (header slot included in the alignment)
+#define LISTEN_BUFFER_RECORDS 32
+// A partly filled sector is written anyway once its oldest record is this old
+#define LISTEN_FLUSH_INTERVAL_MS (6 * 3600 * 1000UL)
+// listen_agg.bin is rewritten every this many flushes (and on rotation or
+// shutdown); boot replays at most this many sectors of log
+#define LISTEN_AGG_SAVE_FLUSHES 8
+
+#define LISTEN_SAMPLE_MS 1000
+// Shorter sessions (seeking, flipping through presets) are not logged
+#define LISTEN_MIN_SESSION_S 10
+// Long sessions are cut so each record's day is about right
+#define LISTEN_MAX_SESSION_S 3600
+
+// =========================================================
+// Listening history: append-only log on SD + running aggregates
+// =========================================================
+// poll() samples what is playing once a second: the tuner snapshot
+// (channel, volume, RSSI) or a streaming Bluetooth source. A session
+// ends on retune, power-off or input switch and becomes one 16-byte
+// ListenRecord, folded into the aggregates right away and buffered in
+// RAM. The buffer goes to SD when it completes a sector, when its oldest
+// record has waited LISTEN_FLUSH_INTERVAL_MS, or before deep sleep, so a
+// typical day costs a handful of sector writes. The aggregates are
+// saved every few flushes; at boot only log records newer than the
+// stored aggregate are replayed, never the whole log.
+class ListeningLog
+{
+public:
+    ListeningLog(FMRadio *radio, InputSourceManager *inputs, BluetoothSink *bluetooth, ConfigStore *config,
+                 FileManager *fm);
+
+    // After sd/config/input: load the aggregates and catch up from the log
+    void begin();
+    // Until then the stats are half loaded: HTTP answers 503
+    bool isStarted() const { return started.load(std::memory_order_acquire); }
+
+    // Call from loop()
+    void poll();
+
+    // Close the open session and write everything (before deep sleep)
+    void shutdown();
+
+    // Top `topN` stations, the last `days` local days, the open session
+    // and the log's write statistics
+    void getStatus(JsonDocument *doc, size_t topN, size_t days);
+
+private:
+    FMRadio *fmRadio;
+    InputSourceManager *inputSources;
+    BluetoothSink *bluetooth;
+    ConfigStore *configStore;
+    FileManager *fileManager;
+    ListenStats stats;
+    std::atomic<bool> started;
+
+    // Open session
+    bool sessionOpen;
+    bool sessionContinued; // Follows a LISTEN_END_SPLIT record
+    uint16_t sessionCode;
+    uint32_t sessionStartMs;
+    uint32_t rssiSum;
+    uint16_t rssiSamples;
+    uint8_t rssiMin;
+    InputSource sessionSource;
+    uint32_t lastSampleMs;
+
+    // Closed records not yet on SD (also the read buffer for replay)
+    ListenRecord buffer[LISTEN_BUFFER_RECORDS];
+    uint8_t buffered;
+    uint32_t bufferedSinceMs;
+
+    // Current log file
+    uint32_t fileBaseSeq;  // Sequence number of its first record
+    uint32_t fileRecords;
+    bool rotatePending;    // Torn tail: start a new file on the next flush
+
+    uint32_t flushes;
+    uint32_t bytesWritten;
+    uint32_t rotations;
+    uint8_t flushesSinceSave;
+    uint32_t writeErrors;
+    uint32_t skippedShort;
+    uint32_t replayed;
+    uint32_t corrupt;
+    MetricHistogram *flushLatency;
+
+    static bool wallClock(uint32_t &epoch);
+
+    void openSession(uint16_t code, InputSource source, uint32_t nowMs);
+    void closeSession(ListenEnd reason, uint32_t nowMs);
+    uint32_t slotAfterFlush() const;
+    bool flush();
+    bool rotate();
+    bool writeHeader(uint32_t baseSeq);
+    bool openLog();
+    size_t replay(const char *path, uint32_t fromSeq);
+    bool loadAggregate();
+    void saveAggregate();
+};
+
+#endif // LISTENINGLOG_H
@@ -0,0 +1,120 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Registry capacity (static storage, nothing is allocated at runtime).
+// Registered today: 36 counters, 10 gauges, 54 histograms (one
+// http_request_us per route). Running out asserts, so raise these when
+// adding routes or labeled metrics.
+#define METRICS_MAX_COUNTERS 48
+#define METRICS_MAX_GAUGES 16
+#define METRICS_MAX_HISTOGRAMS 64
+// Bucket i counts values < 2^i us; the last bucket is open-ended (~8.4 s)
+#define METRICS_HIST_BUCKETS 24
+
+// =========================================================
+// Metric types
+// =========================================================
+// Name and label strings must outlive the registry (string literals or
+// route URIs passed to WebServer::on()). Recording is a few relaxed
+// atomic operations and is safe from any task.
+struct MetricCounter
+{
+    const char *name;
+    const char *labelKey;
+    const char *labelValue;
+    std::atomic<uint32_t> value;
+
+    void inc(uint32_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+};
+
+struct MetricGauge
+{
+    const char *name;
+    const char *labelKey;
+    const char *labelValue;
+    std::atomic<int32_t> value;
+
+    void set(int32_t v) { value.store(v, std::memory_order_relaxed); }
+};
+
+struct MetricHistogram
+{
+    const char *name;
+    const char *labelKey;
+    const char *labelValue;
+    std::atomic<uint32_t> buckets[METRICS_HIST_BUCKETS];
+    std::atomic<uint32_t> count;
+    std::atomic<uint64_t> sum;
+
+    void record(uint32_t us);
+};
+
+// Records the lifetime of a scope into a histogram (nullptr = no-op)
+class MetricTimer
+{
+public:
+    explicit MetricTimer(MetricHistogram *h) : hist(h), start(micros()) {}
+    ~MetricTimer()
+    {
+        if (hist)
+            hist->record(micros() - start);
+    }
+
+private:
+    MetricHistogram *hist;
+    uint32_t start;
+};
+
+// =========================================================
+// Registry
+// =========================================================
+// Register once at init and keep the pointer; registering the same
+// name+label again returns the existing metric. A full pool is a sizing
+// bug: it asserts, and with NDEBUG returns nullptr, which every record
+// helper accepts.
+class Metrics
+{
+public:
+    static MetricCounter *counter(const char *name, const char *labelKey = nullptr, const char *labelValue = nullptr);
+    static MetricGauge *gauge(const char *name, const char *labelKey = nullptr, const char *labelValue = nullptr);
+    static MetricHistogram *histogram(const char *name, const char *labelKey = nullptr, const char *labelValue = nullptr);
+
+    static void inc(MetricCounter *c, uint32_t n = 1)
+    {
+        if (c)
+            c->inc(n);
+    }
+    static void set(MetricGauge *g, int32_t v)
+    {
+        if (g)
+            g->set(v);
+    }
+    static void record(MetricHistogram *h, uint32_t us)
+    {
+        if (h)
+            h->record(us);
+    }
+
+    // Refresh heap/uptime gauges (called before each scrape)
+    static void sampleSystem();
+
+    // Prometheus-style text exposition. Output is produced in chunks of at
+    // most `bufSize` bytes so it can be streamed without building the
+    // whole page in RAM. Series are grouped by family under one TYPE line;
+    // histograms that were never hit are skipped.
+    typedef void (*EmitFn)(const char *data, size_t len, void *ctx);
+    static void render(char *buf, size_t bufSize, EmitFn emit, void *ctx);
+
+private:
+    static MetricCounter counters[METRICS_MAX_COUNTERS];
+    static MetricGauge gauges[METRICS_MAX_GAUGES];
+    static MetricHistogram histograms[METRICS_MAX_HISTOGRAMS];
+    static uint8_t counterCount;
+    static uint8_t gaugeCount;
+    static uint8_t histogramCount;
+};
+
+#endif // METRICS_H
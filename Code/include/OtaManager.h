@@ -0,0 +1,90 @@
+#ifndef OTAMANAGER_H
+#define OTAMANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "FileManager.h"
+#include "ConfigStore.h"
+#include "Constants.h"
+
+// Uploads go to a separate port so the main server keeps answering
+#define OTA_PORT 8080
+// Bytes read/written per slice; one flash sector
+#define OTA_CHUNK_SIZE 4096
+#define OTA_IO_TIMEOUT_MS 5000
+// Core 0: the loop task (radio control, HTTP) runs on core 1
+#define OTA_TASK_CORE 0
+#define OTA_TASK_PRIORITY 1
+
+// UI bundle layout (little endian), produced by tools/ui_bundle.py:
+//   "FUI1" | u32 fileCount | { u16 pathLen | u32 size | path | data } ...
+#define UI_BUNDLE_MAGIC 0x31495546UL // "FUI1"
+#define UI_STAGING_PATH "/ui.new"
+#define UI_PREVIOUS_PATH "/ui.old"
+
+// =========================================================
+// Over-the-air firmware and UI updates
+// =========================================================
+// A low-priority task on core 0 accepts raw POST bodies on OTA_PORT:
+//   POST /firmware?md5=<hex>   -> inactive OTA app partition (Update)
+//   POST /ui?md5=<hex>         -> UI bundle unpacked to /famio/ui.new,
+//                                 then swapped with /famio/ui
+// The body is consumed OTA_CHUNK_SIZE bytes at a time with a yield in
+// between. Nothing is buffered beyond one chunk, and the MD5 must match
+// before anything is activated.
+// Uploads need the control token (udp_token in common.json), sent as an
+// "X-Famio-Token: <n>" header or a token=<n> query parameter; with no
+// token configured OTA stays closed.
+class OtaManager
+{
+public:
+    OtaManager(FileManager *fm, ConfigStore *cs);
+
+    // Start the upload listener (needs the network stack)
+    void begin();
+
+    // Progress and stats of the current/last update
+    void getStatus(JsonDocument *doc);
+
+    bool isBusy() const { return busy.load(); }
+
+private:
+    enum Kind : uint8_t
+    {
+        KIND_NONE,
+        KIND_FIRMWARE,
+        KIND_UI
+    };
+
+    FileManager *fileManager;
+    ConfigStore *configStore;
+    WiFiServer server;
+    uint8_t *chunk;
+
+    std::atomic<bool> busy;
+    Kind kind;
+    const char *state;       // Literal: idle / receiving / verifying / done / error
+    char message[64];
+    uint32_t totalBytes;
+    uint32_t receivedBytes;
+    uint32_t startMs;
+    uint32_t durationMs;
+    uint32_t maxSliceUs;     // Longest single read+write slice
+    uint32_t heapAtStart;
+    uint32_t heapLowest;
+
+    static void taskEntry(void *arg);
+    void serve(WiFiClient &client);
+    bool receiveFirmware(WiFiClient &client, const String &md5);
+    bool receiveUiBundle(WiFiClient &client, const String &md5);
+
+    bool readExact(WiFiClient &client, uint8_t *buf, size_t len);
+    void beginTransfer(Kind k, uint32_t length);
+    void noteSlice(uint32_t startUs, size_t bytes);
+    void fail(const char *why);
+    void respond(WiFiClient &client, int code, const char *body);
+};
+
+#endif // OTAMANAGER_H
@@ -26,10 +26,16 @@ public:
     int readPotentiometer(); // Đọc ADC từ biến trở và trả về 0-100
 
     // 4. Quản lý Nguồn
-    void shutdown();
+    // Tắt amp và Wi-Fi rồi deep sleep; thức dậy sau wakeAfterS giây (0: chỉ khi reset).
+    // Tuner phải được tắt trước (qua RadioController). Không trả về.
+    void shutdown(uint32_t wakeAfterS = 0);
+    // Gọi ngay đầu shutdown() (ghi nốt dữ liệu còn trong RAM xuống SD)
+    typedef void (*ShutdownHook)();
+    void setShutdownHook(ShutdownHook hook) { shutdownHook = hook; }
 
 private:
     int currentVolume; // Lưu trữ mức âm lượng hiện tại (0-100)
+    ShutdownHook shutdownHook;
 
     float mapAdcToVoltage(int raw_adc);
 };
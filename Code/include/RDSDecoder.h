@@ -0,0 +1,105 @@
+#ifndef RDSDECODER_H
+#define RDSDECODER_H
+
+#include <Arduino.h>
+
+#define RDS_PS_LENGTH 8
+#define RDS_RT_LENGTH 64
+
+// Block error level as reported by the tuner (BLER):
+// 0 = no errors, 1 = 1-2 bits corrected, 2 = 3-5 bits corrected, 3 = uncorrectable
+#define RDS_BLER_UNCORRECTABLE 3
+
+// =========================================================
+// Incremental RDS group decoder
+// =========================================================
+// Fed one group (blocks A-D) at a time. Each character position keeps a
+// current value and a challenger, both with a confidence score weighted by
+// the block error level, so a clean reception wins quickly while corrected
+// blocks need confirmation. Text is only published once every position
+// reaches RDS_STABLE_SCORE.
+class RDSDecoder
+{
+public:
+    struct ClockTime
+    {
+        uint32_t mjd;      // Modified Julian Day
+        uint8_t hour;      // UTC
+        uint8_t minute;    // UTC
+        int8_t offsetHalfHours; // Local offset from UTC
+    };
+
+    RDSDecoder();
+
+    // Forget everything, call on every retune. `nowMs` starts the
+    // time-to-stable-name clock.
+    void reset(uint32_t nowMs);
+
+    // Decode one group. `errors` holds the BLER level of each block.
+    void processGroup(const uint16_t blocks[4], const uint8_t errors[4], uint32_t nowMs);
+
+    // Published (stable) data
+    bool hasPsName() const { return psName[0] != '\0'; }
+    const char *getPsName() const { return psName; }
+    bool hasRadioText() const { return radioText[0] != '\0'; }
+    const char *getRadioText() const { return radioText; }
+    bool hasPi() const { return piValid; }
+    uint16_t getPi() const { return pi; }
+    bool hasPty() const { return ptyValid; }
+    uint8_t getPty() const { return pty; }
+    bool hasClock() const { return clockValid; }
+    const ClockTime &getClock() const { return clock; }
+
+    // Bumped whenever a published field changes
+    uint32_t getVersion() const { return version; }
+
+    // Milliseconds from reset() until the PS name first became stable, 0 = not yet
+    uint32_t getTimeToStablePsMs() const { return psStableMs; }
+
+    uint32_t getGroupsDecoded() const { return groupsDecoded; }
+    uint32_t getBlocksRejected() const { return blocksRejected; }
+
+private:
+    struct CharSlot
+    {
+        char value;
+        uint8_t score;
+        char challenger;
+        uint8_t challengerScore;
+    };
+
+    CharSlot psSlots[RDS_PS_LENGTH];
+    CharSlot rtSlots[RDS_RT_LENGTH];
+    char psName[RDS_PS_LENGTH + 1];
+    char radioText[RDS_RT_LENGTH + 1];
+    uint8_t rtLength;  // Known length (terminator seen), else RDS_RT_LENGTH
+    int8_t rtAbFlag;   // -1 = unknown
+
+    uint16_t pi;
+    uint8_t pty;
+    bool piValid;
+    bool ptyValid;
+    uint8_t piScore;
+    uint8_t ptyScore;
+    ClockTime clock;
+    bool clockValid;
+
+    uint32_t version;
+    uint32_t resetMs;
+    uint32_t psStableMs;
+    uint32_t groupsDecoded;
+    uint32_t blocksRejected;
+
+    static uint8_t weightFor(uint8_t bler);
+    static bool feedSlot(CharSlot &slot, char ch, uint8_t weight);
+    static void clearSlots(CharSlot *slots, size_t count);
+
+    void decodePs(uint16_t blockB, uint16_t blockD, uint8_t errD);
+    void decodeRadioText(uint16_t blockB, uint16_t blockC, uint16_t blockD, uint8_t errC, uint8_t errD, bool versionB);
+    void decodeClock(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void putRtChar(uint8_t pos, char ch, uint8_t weight);
+    void publishPs(uint32_t nowMs);
+    void publishRadioText();
+};
+
+#endif // RDSDECODER_H
@@ -0,0 +1,73 @@
+#ifndef RADIOCONTROLLER_H
+#define RADIOCONTROLLER_H
+
+#include <Arduino.h>
+#include "FMRadio.h"
+
+enum RadioCommandType : uint8_t
+{
+    RADIO_CMD_NONE = 0,
+    RADIO_CMD_TUNE = 1,      // value: channel code (10 kHz units)
+    RADIO_CMD_VOLUME = 2,    // value: 0-15
+    RADIO_CMD_PRESET = 3,    // value: preset index
+    RADIO_CMD_SEEK_UP = 4,
+    RADIO_CMD_SEEK_DOWN = 5,
+    RADIO_CMD_POWER = 6,     // value: 1 = on, 0 = off
+    RADIO_CMD_SEEK_NEXT = 7  // Software scan to the next station
+};
+
+// Where a command came from. Only commands that did not arrive through
+// group replication are handed to the listener.
+enum RadioCommandSource : uint8_t
+{
+    RADIO_SRC_HTTP = 0,
+    RADIO_SRC_GROUP = 1,
+    RADIO_SRC_UDP = 2,
+    RADIO_SRC_SCHEDULE = 3 // Alarms / sleep timer (ScheduleEngine)
+};
+
+struct RadioCommand
+{
+    RadioCommandType type;
+    int32_t value;
+};
+
+// Replicable snapshot of what the listener hears
+struct RadioState
+{
+    uint16_t channelCode;
+    uint8_t volume;
+    bool powered;
+};
+
+// =========================================================
+// Single entry point for radio control
+// =========================================================
+// HTTP, the UDP control port and group sync all go through apply(), so
+// every change is validated once and can be observed/replicated. Must be
+// called from the loop task (FMRadio is not thread-safe).
+class RadioController
+{
+public:
+    // `effect` is the command in replicable form: seek and preset
+    // selection are reported as the TUNE they resulted in, because
+    // presets and seek results differ between units.
+    typedef void (*Listener)(const RadioCommand &effect, RadioCommandSource source, void *ctx);
+
+    RadioController(FMRadio *radio);
+
+    // Returns false if the command is invalid (bad channel, index...)
+    bool apply(const RadioCommand &cmd, RadioCommandSource source);
+
+    RadioState getState() const;
+    FMRadio *getRadio() const { return fmRadio; }
+
+    void setListener(Listener fn, void *ctx);
+
+private:
+    FMRadio *fmRadio;
+    Listener listener;
+    void *listenerCtx;
+};
+
+#endif // RADIOCONTROLLER_H
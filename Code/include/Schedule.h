@@ -0,0 +1,112 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <Arduino.h>
+
+#define SCHEDULE_MAX_ALARMS 8
+#define SCHEDULE_MAGIC 0x53434844UL // "SCHD"
+// Deep sleep ends this much before an alarm so boot is done when it fires
+#define SCHEDULE_WAKE_LEAD_S 8
+// An alarm missed by more than this (clock jump, long boot) is skipped
+#define SCHEDULE_GRACE_S 120
+// Listening time assumed for alarms without an auto-off duration
+#define SCHEDULE_DEFAULT_LISTEN_MIN 60
+// Earliest epoch accepted as a real wall clock (NTP synced or kept by the RTC)
+#define SCHEDULE_MIN_VALID_EPOCH 1700000000UL
+
+// Battery-side current draw used for the estimate (3S pack, mA)
+#define SCHEDULE_MA_PLAYING 140.0f    // Wi-Fi STA + tuner + amp at listening level
+#define SCHEDULE_MA_BOOT 90.0f        // Boot until the alarm fires
+#define SCHEDULE_MA_DEEP_SLEEP 0.25f  // ESP32 deep sleep + regulator, amp/tuner off
+
+// One alarm: wake, tune a preset, fade the amp in. `days` bit 0 = Sunday;
+// 0 means one-shot (disabled again after it fires).
+struct ScheduleAlarm
+{
+    uint8_t enabled;
+    uint8_t days;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t preset;       // Preset index (StationStore)
+    uint8_t volume;       // Tuner volume 0-15
+    uint16_t fadeSec;     // Amp fade-in
+    uint16_t durationMin; // Fade out and sleep after this long, 0 = keep playing
+};
+
+// Kept in RTC memory on the device, so it survives deep sleep
+struct ScheduleState
+{
+    uint32_t magic;
+    ScheduleAlarm alarms[SCHEDULE_MAX_ALARMS];
+    int16_t tzOffsetMin;  // Local time = UTC + offset (no DST)
+    uint32_t lastFiredMin; // Epoch minute of the last fired alarm
+};
+
+// What the caller has to do after update()
+struct ScheduleOutput
+{
+    int8_t fireAlarm;   // Alarm index to start (power on, preset, volume), -1 none
+    int8_t ampPercent;  // Amp level as % of the listening level, -1 no change
+    bool sleep;         // Fade done: power down and deep sleep
+    uint32_t wakeInS;   // With sleep: seconds until the timer wake, 0 = none
+};
+
+// =========================================================
+// Alarm / sleep-timer logic, independent of the hardware
+// =========================================================
+// Times are UTC epoch milliseconds passed in by the caller, so the same
+// code runs on the device (gettimeofday) and on the host against a
+// virtual clock. Without a valid wall clock only the sleep timer runs:
+// it is relative, so the time since boot is enough.
+class Schedule
+{
+public:
+    explicit Schedule(ScheduleState &state);
+
+    // Fresh state (power-on): copy alarms/timezone in from the config
+    void reset(const ScheduleAlarm *alarms, int16_t tzOffsetMin);
+
+    // Advance to `nowMs`; call at least once per second
+    ScheduleOutput update(uint64_t nowMs, bool clockValid);
+
+    // Fade out over fadeSec ending `minutes` from now; 0 minutes cancels
+    void startSleepTimer(uint64_t nowMs, uint32_t minutes, uint16_t fadeSec);
+    // Manual power-on/off or volume change: stop fades and auto-off
+    void cancelTimers();
+
+    // Next enabled alarm at or after nowMs (epoch ms, 0 if none)
+    uint64_t nextAlarmMs(uint64_t nowMs, int8_t *index = nullptr) const;
+
+    bool hasSleepTimer() const { return sleepAtMs != 0; }
+    uint64_t getSleepAtMs() const { return sleepAtMs; }
+
+    // RTC copy survived (deep sleep wake) rather than power-on garbage
+    bool isValid() const { return state.magic == SCHEDULE_MAGIC; }
+    ScheduleState &getState() { return state; }
+
+    // Average battery current over a week of this schedule: deep sleep
+    // between alarms, boot + listening (duration or the default) after each
+    struct Estimate
+    {
+        float avgMa;
+        float awakeMinPerDay;
+        float wakesPerDay;
+        float batteryDays;     // For `capacityMah`
+    };
+    Estimate estimate(float capacityMah) const;
+
+private:
+    ScheduleState &state;
+
+    // Fades run in ms; the ramp maps elapsed time to 0-100 %
+    uint64_t fadeStartMs;
+    uint32_t fadeMs;
+    bool fadingIn;
+    uint64_t sleepAtMs;    // Sleep timer or alarm auto-off, 0 = none
+    uint32_t sleepFadeMs;
+    int8_t lastPercent;
+
+    static uint64_t localDayStart(uint64_t nowMs, int16_t tzOffsetMin, uint8_t &weekday);
+};
+
+#endif // SCHEDULE_H
@@ -0,0 +1,68 @@
+#ifndef SCHEDULEENGINE_H
+#define SCHEDULEENGINE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <ArduinoJson.h>
+#include "Schedule.h"
+#include "RadioController.h"
+#include "PowerManager.h"
+#include "ConfigStore.h"
+#include "FileManager.h"
+#include "Metrics.h"
+
+#define SCHEDULE_POLL_INTERVAL_MS 250
+// Pack capacity used for the battery-life figure in the estimate
+#define SCHEDULE_BATTERY_MAH 3000.0f
+
+// =========================================================
+// Wake-to-radio alarms and sleep timer
+// =========================================================
+// Drives Schedule from the wall clock (NTP, kept across deep sleep by the
+// RTC). An alarm powers the tuner, selects its preset and fades the amp
+// in; the sleep timer (or an alarm's duration) fades it out, powers the
+// tuner off and puts the unit into deep sleep until the next alarm.
+// Schedule state lives in RTC memory, so a timer wake picks up where the
+// previous run left off; the alarm table itself is part of the config
+// snapshot (and /config/schedule.json).
+class ScheduleEngine
+{
+public:
+    ScheduleEngine(RadioController *controller, PowerManager *power, ConfigStore *config, FileManager *fm);
+
+    // After the config is loaded: resume the RTC state or start fresh
+    void begin();
+    bool isStarted() const { return started.load(std::memory_order_acquire); }
+
+    // Call from loop()
+    void poll();
+
+    // --- API ---
+    void getStatus(JsonDocument *doc);
+    // False if index or a field is out of range
+    bool setAlarm(uint8_t index, const ScheduleAlarm &alarm);
+    void setTimezone(int16_t offsetMin);
+    // 0 minutes cancels
+    void setSleepTimer(uint32_t minutes, uint16_t fadeSec);
+
+private:
+    RadioController *controller;
+    PowerManager *powerManager;
+    ConfigStore *configStore;
+    FileManager *fileManager;
+    Schedule schedule;
+    std::atomic<bool> started;
+    bool resumed;          // Woke from deep sleep with valid RTC state
+    uint32_t lastPollMs;
+    Schedule::Estimate estimateCache; // Recomputed when the alarm table changes
+    bool estimateDirty;
+    MetricCounter *alarmsFired;
+    MetricCounter *sleeps;
+
+    static uint64_t nowMs(bool &clockValid);
+    void fire(uint8_t index);
+    void sleepNow(uint32_t wakeInS);
+    void persist();
+};
+
+#endif // SCHEDULEENGINE_H
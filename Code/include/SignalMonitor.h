@@ -0,0 +1,97 @@
+#ifndef SIGNALMONITOR_H
+#define SIGNALMONITOR_H
+
+#include <Arduino.h>
+#include "Metrics.h"
+
+// Ring sizes per tier: 2 minutes of seconds, 2 hours of minutes, 2 days of hours
+#define SIGNAL_SEC_SLOTS 120
+#define SIGNAL_MIN_SLOTS 120
+#define SIGNAL_HOUR_SLOTS 48
+
+// Auto mono blend (RSSI in chip units, 0-127): go mono when the 1 s average
+// stays below ON for MONO_BLEND_HOLD_S seconds, back to stereo above OFF
+#define MONO_BLEND_ON_RSSI 18
+#define MONO_BLEND_OFF_RSSI 24
+#define MONO_BLEND_HOLD_S 3
+
+enum SignalTier : uint8_t
+{
+    SIGNAL_TIER_SEC = 0,
+    SIGNAL_TIER_MIN = 1,
+    SIGNAL_TIER_HOUR = 2,
+    SIGNAL_TIER_COUNT = 3
+};
+
+// =========================================================
+// RSSI / stereo history with downsampling tiers
+// =========================================================
+// Every tier accumulates the raw samples itself (min, max, sum, count),
+// so the 1 h average is exact rather than an average of averages. Slots
+// are 4 bytes and the rings never grow: ~1.2 KB whatever the uptime.
+// Periods with no samples (radio off) are stored as empty slots so the
+// series stays aligned to wall time. Loop task only, no locking.
+class SignalMonitor
+{
+public:
+    SignalMonitor();
+
+    void addSample(uint8_t rssi, bool stereo, uint32_t nowMs);
+
+    // Current auto-blend decision (true = force mono)
+    bool wantMono() const { return mono; }
+
+    // Columnar JSON, oldest slot first; empty slots are -1
+    void renderHistory(SignalTier tier, char *buf, size_t bufSize, Metrics::EmitFn emit, void *ctx) const;
+
+    static bool parseTier(const char *name, SignalTier &out);
+
+private:
+    struct Slot
+    {
+        uint8_t min;      // 0xFF = no samples
+        uint8_t max;
+        uint8_t avg;
+        uint8_t stereoPct;
+    };
+
+    struct Accumulator
+    {
+        uint32_t startMs;
+        uint32_t sum;
+        uint32_t count;       // 25 Hz for an hour does not fit 16 bits
+        uint32_t stereoCount;
+        uint8_t min;
+        uint8_t max;
+    };
+
+    struct Ring
+    {
+        Slot *slots;
+        uint16_t size;
+        uint16_t head;    // Next slot to write
+        uint16_t filled;
+        uint32_t periodMs;
+        Accumulator acc;
+    };
+
+    Slot secSlots[SIGNAL_SEC_SLOTS];
+    Slot minSlots[SIGNAL_MIN_SLOTS];
+    Slot hourSlots[SIGNAL_HOUR_SLOTS];
+    Ring rings[SIGNAL_TIER_COUNT];
+    bool started;
+
+    bool mono;
+    uint8_t belowCount;   // Consecutive 1 s slots under ON
+    uint8_t aboveCount;   // Consecutive 1 s slots over OFF
+
+    MetricCounter *blendSwitches;
+
+    // Close every period that ended before `nowMs`; returns the number closed
+    uint16_t advance(Ring &ring, uint32_t nowMs);
+    void push(Ring &ring);
+    void updateBlend(const Slot &second);
+    static void resetAccumulator(Accumulator &acc, uint32_t startMs);
+};
+
+#endif // SIGNALMONITOR_H
@@ -0,0 +1,86 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <Arduino.h>
+
+// Real samples per FFT. The complex FFT runs on half of that and must be a
+// power of 4 (radix-4 only): 512 -> 256 = 4^4
+#define SPECTRUM_FFT_SIZE 512
+#define SPECTRUM_BANDS 16
+// Band edges, log spaced (upper edge below half the sample rate)
+#define SPECTRUM_MIN_HZ 60
+#define SPECTRUM_MAX_HZ 10000
+
+// Level bytes are 0.5 dB steps below full scale: 255 = 0 dB, 0 = -127.5 dB
+#define SPECTRUM_FRAME_TYPE 0x01
+
+// Wire format of one frame (little endian, 22 bytes). Bands hold the
+// power of the band relative to a full-scale sine inside it; peak/RMS are
+// over every sample since the previous frame, relative to full scale.
+struct __attribute__((packed)) SpectrumFrame
+{
+    uint8_t type;      // SPECTRUM_FRAME_TYPE
+    uint8_t bandCount; // SPECTRUM_BANDS
+    uint16_t seq;
+    uint8_t peak;
+    uint8_t rms;
+    uint8_t bands[SPECTRUM_BANDS];
+};
+
+// =========================================================
+// Fixed-point spectrum analysis, independent of the hardware
+// =========================================================
+// Q15 throughout: Hann window, radix-4 complex FFT of N/2 points on the
+// even/odd samples packed as re/im, then one split pass to the N-point
+// real spectrum. Every stage scales by 1/4, so nothing can overflow and
+// the output is the true DFT times 2/N. All tables (window, twiddles,
+// digit reversal, band bins) are built once in begin(); analyze() does
+// integer arithmetic only.
+class Spectrum
+{
+public:
+    Spectrum();
+
+    // Build the tables for this sample rate (uses floating point once)
+    void begin(uint32_t sampleRate);
+
+    // One frame from the `count` samples captured since the last one
+    // (Q15, DC removed). The FFT uses the newest SPECTRUM_FFT_SIZE of
+    // them; fewer are zero padded in front.
+    void analyze(const int16_t *samples, size_t count, SpectrumFrame &out);
+
+    uint32_t getSampleRate() const { return sampleRate; }
+    // Lower edge of each band in Hz (the last band ends at SPECTRUM_MAX_HZ)
+    uint16_t getBandHz(uint8_t band) const;
+
+    // 10*log10(v) in 0.5 dB units (integer log2, max error ~0.05 dB)
+    static int32_t halfDb(uint64_t v);
+
+private:
+    static const uint16_t FFT_POINTS = SPECTRUM_FFT_SIZE / 2;
+
+    struct Complex16
+    {
+        int16_t re;
+        int16_t im;
+    };
+
+    uint32_t sampleRate;
+    uint16_t seq;
+
+    int16_t window[SPECTRUM_FFT_SIZE];
+    // W_N^k = cos - j*sin for k < 3N/4: the split pass uses k < N/2, the
+    // N/2-point FFT uses every second entry (W_{N/2}^m = W_N^{2m})
+    Complex16 twiddle[SPECTRUM_FFT_SIZE * 3 / 4];
+    uint16_t digitReverse[FFT_POINTS];
+    uint16_t bandStart[SPECTRUM_BANDS + 1]; // First bin of each band, then the end
+    int32_t fullScaleBandDb;                // halfDb() of a full-scale sine's band power
+    int32_t fullScaleDb;                    // halfDb() of 32767^2
+
+    Complex16 buf[FFT_POINTS];
+
+    void fft();
+    static uint8_t level(int32_t db, int32_t reference);
+};
+
+#endif // SPECTRUM_H
@@ -0,0 +1,93 @@
+#ifndef SPECTRUMSTREAM_H
+#define SPECTRUMSTREAM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "Spectrum.h"
+#include "Constants.h"
+
+// Capture rate of the internal ADC; bands stop at SPECTRUM_MAX_HZ
+#define SPECTRUM_SAMPLE_RATE 22050
+#define SPECTRUM_FRAME_HZ 25
+#define SPECTRUM_HOP (SPECTRUM_SAMPLE_RATE / SPECTRUM_FRAME_HZ) // Samples per frame (882)
+// Analysis may use this share of one core (cycles per frame x frame rate)
+#define SPECTRUM_CPU_BUDGET_PERCENT 5
+
+// WebSocket push: browsers connect to ws://<host>:81/spectrum
+#define SPECTRUM_WS_PORT 81
+#define SPECTRUM_MAX_CLIENTS 4
+#define SPECTRUM_HANDSHAKE_TIMEOUT_S 1
+
+// Core 0 next to Wi-Fi: core 1 keeps loop() and the audio output task
+#define SPECTRUM_TASK_CORE 0
+#define SPECTRUM_TASK_PRIORITY 2
+
+// =========================================================
+// Audio spectrum / VU meter streamed to the web UI
+// =========================================================
+// A task on core 0 reads SPECTRUM_HOP samples at a time from I2S0 in ADC
+// mode, removes DC and hands them to Spectrum::analyze(). The newest frame
+// is kept under a spinlock; poll() (from loop()) pushes it as one binary
+// WebSocket message to every subscriber. Capture only runs while someone
+// is subscribed, since I2S owns ADC1 while it does.
+//
+// The WebSocket side is the minimum a browser needs: the upgrade handshake
+// and unmasked binary frames out. Clients are not expected to send
+// anything; a close frame or a dropped connection unsubscribes them.
+class SpectrumStream
+{
+public:
+    SpectrumStream();
+
+    // Build the tables, install the I2S ADC driver, start the task and the
+    // WebSocket listener (needs the network stack)
+    bool begin();
+
+    // Accept/handshake new subscribers and push the newest frame
+    void poll();
+
+    // Band edges, CPU use against the budget, subscribers
+    void getStatus(JsonDocument *doc);
+
+private:
+    Spectrum spectrum;
+    WiFiServer server;
+    WiFiClient clients[SPECTRUM_MAX_CLIENTS];
+    bool active[SPECTRUM_MAX_CLIENTS];
+    std::atomic<uint8_t> subscribers;
+    TaskHandle_t task;
+    std::atomic<bool> running; // Set by begin() in the boot step's task
+
+    // Newest frame, written by the task and read by poll()
+    portMUX_TYPE frameLock;
+    SpectrumFrame latest;
+    uint32_t latestCount; // Frames produced; poll() sends when it moves
+    uint32_t sentCount;
+
+    uint16_t raw[SPECTRUM_HOP];
+    int16_t samples[SPECTRUM_HOP];
+    int32_t dcQ4;       // ADC midpoint, 1/16 LSB (-1 = not measured yet)
+    bool adcEnabled;
+    uint8_t stride;     // Analyze every n-th hop (2 while over budget)
+    uint32_t hops;
+
+    // Cycles per frame (exponential average and worst) against the budget
+    uint32_t budgetCycles;
+    std::atomic<uint32_t> avgCycles;
+    std::atomic<uint32_t> maxCycles;
+    std::atomic<uint32_t> frames;
+    std::atomic<uint32_t> overBudget;
+
+    static void taskEntry(void *arg);
+    void run();
+    void setCapture(bool on);
+    void convert(size_t count);
+    void noteCycles(uint32_t cycles);
+
+    bool handshake(WiFiClient &client);
+    void dropClient(uint8_t i);
+};
+
+#endif // SPECTRUMSTREAM_H
@@ -0,0 +1,104 @@
+#ifndef STATIONSTORE_H
+#define STATIONSTORE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "FileManager.h"
+#include "Channel.h"
+
+#define STATION_STORE_FILE "/config/stations.bin"
+#define STATION_BENCH_FILE "/config/stations_bench.json"
+
+#define STATION_MAX 256        // Records kept on SD and in RAM
+#define STATION_INDEX_SIZE 512 // Hash index slots (power of two, 2x STATION_MAX)
+#define STATION_NAME_LEN 20    // Including NUL
+
+#define STATION_FLAG_FAVORITE 0x01
+
+// =========================================================
+// On-disk record (fixed 32 bytes)
+// =========================================================
+// File layout: 16-byte header, then STATION_MAX records at fixed offsets
+// so a single station can be rewritten in place.
+struct StationRecord
+{
+    uint16_t code;        // Channel code in 10 kHz units (9950 = 99.5 MHz), 0 = free slot
+    uint8_t flags;        // STATION_FLAG_*
+    int8_t lastRssi;      // Last measured RSSI (0-63), -1 = unknown
+    uint32_t playCount;   // Times this station was tuned
+    uint16_t presetOrder; // Sort key among favorites (preset list order)
+    uint16_t crc;         // CRC-16 of the record with this field zeroed
+    char name[STATION_NAME_LEN];
+};
+
+// =========================================================
+// Station database with O(1) lookup by channel code
+// =========================================================
+class StationStore
+{
+public:
+    StationStore(FileManager *fm);
+
+    // Load stations.bin, or create an empty one. Returns false only if
+    // the SD card is unusable.
+    bool begin();
+
+    // True when begin() had to create a new store (caller may migrate)
+    bool isFresh() const { return fresh; }
+
+    // Lookup (no I/O)
+    int find(Channel channel) const;
+    const StationRecord *get(Channel channel) const;
+    size_t count() const { return used; }
+    size_t capacity() const { return STATION_MAX; }
+    const StationRecord &at(size_t slot) const { return records[slot]; }
+
+    // Presets = favorite stations in the order they were added
+    size_t presetCount() const { return numPresets; }
+    const StationRecord *presetAt(size_t index) const;
+    bool addPreset(Channel channel);      // Persisted immediately
+    bool removePreset(size_t index);    // Persisted immediately
+
+    // Metadata updates are kept in RAM and written by flush()
+    void notePlay(Channel channel);
+    void noteRssi(Channel channel, int rssi);
+    void setName(Channel channel, const char *name);
+
+    // Write back records changed since the last flush
+    void flush();
+    bool isDirty() const;
+
+    // Time the binary store against the previous JSON path on this card
+    void benchmark(JsonDocument *doc);
+
+    uint32_t getLoadMicros() const { return loadMicros; }
+
+private:
+    FileManager *fileManager;
+    StationRecord records[STATION_MAX];
+    uint16_t index[STATION_INDEX_SIZE]; // Record slot + 1, 0 = empty
+    uint8_t presets[STATION_MAX];       // Record slots of favorites, ordered
+    uint32_t dirty[STATION_MAX / 32];   // One bit per record slot
+    size_t used;
+    size_t numPresets;
+    size_t tombstones;
+    uint16_t nextPresetOrder;
+    bool fresh;
+    uint32_t loadMicros;
+
+    bool load();
+    bool saveAll();
+    bool writeRecord(size_t slot);
+    int upsert(Channel channel);
+    int evictSlot();
+    void rebuildIndex();
+    void rebuildPresets();
+    void indexInsert(uint16_t code, size_t slot);
+    void indexRemove(uint16_t code, size_t slot);
+    void markDirty(size_t slot) { dirty[slot / 32] |= 1UL << (slot % 32); }
+
+    static uint16_t hashSlot(uint16_t code);
+    static uint16_t recordCrc(const StationRecord &rec);
+};
+
+#endif // STATIONSTORE_H
@@ -0,0 +1,133 @@
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "FileManager.h"
+
+// =========================================================
+// Levels (compile-time filter)
+// =========================================================
+#define TRACE_LEVEL_OFF 0
+#define TRACE_LEVEL_ERROR 1
+#define TRACE_LEVEL_WARN 2
+#define TRACE_LEVEL_INFO 3
+#define TRACE_LEVEL_DEBUG 4
+
+// Override with -DTRACE_LEVEL=... in platformio.ini build_flags
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_INFO
+#endif
+
+// Records kept in RAM (power of two)
+#define TRACE_RING_SIZE 256
+#define TRACE_DRAIN_INTERVAL_MS 50
+// Also append drained lines to SD (relative to PROJECT_ROOT_DIR)
+#ifndef TRACE_TO_SD
+#define TRACE_TO_SD 0
+#endif
+#define TRACE_SD_FILE "/trace.txt"
+
+// =========================================================
+// Event table
+// =========================================================
+// One entry per log site: id and printf format (up to 3 int args).
+// Formatting happens later in the drain task, never on the caller.
+#define TRACE_EVENTS(X)                                                             \
+    X(FM_TUNE, "FMRadio: Frequency set to %d.%02d MHz")                           \
+    X(FM_TUNE_TIMEOUT, "FMRadio: Tune to %d.%02d MHz timed out after %d us")      \
+    X(FM_SEEK_UP, "FMRadio: Seek up complete. New frequency: %d.%02d MHz")        \
+    X(FM_SEEK_DOWN, "FMRadio: Seek down complete. New frequency: %d.%02d MHz")    \
+    X(FM_VOLUME, "FMRadio: Volume set to %d")                                     \
+    X(FM_STEREO, "FMRadio: Stereo mode set to %d")                                \
+    X(FM_CONFIG_SAVED, "FMRadio: Config saved successfully.")                     \
+    X(FM_CONFIG_SAVE_FAILED, "FMRadio: Failed to save config.")                   \
+    X(FM_PRESET_SAVED, "FMRadio: Channel saved - %d.%02d MHz at index %d")        \
+    X(FM_PRESET_SELECT, "FMRadio: Selecting channel at index %d")                 \
+    X(FM_PRESET_DELETED, "FMRadio: Channel deleted. Remaining: %d")               \
+    X(HANG_STALL, "HangDetector: Site %d open for %d ms (budget %d ms)")          \
+    X(POWER_VOLUME, "PowerManager: Đặt âm lượng thành %d (PWM: %d)")              \
+    X(BENCH, "TraceLog: bench %d %d %d")
+
+enum TraceEvent : uint16_t
+{
+#define TRACE_ENUM(id, fmt) TRACE_##id,
+    TRACE_EVENTS(TRACE_ENUM)
+#undef TRACE_ENUM
+        TRACE_EVENT_COUNT
+};
+
+// =========================================================
+// Call-site macros
+// =========================================================
+// Disabled levels expand to nothing: the arguments are not evaluated.
+#if TRACE_LEVEL >= TRACE_LEVEL_ERROR
+#define TRACE_ERROR(id, ...) TraceLog::log(TRACE_LEVEL_ERROR, TRACE_##id, ##__VA_ARGS__)
+#else
+#define TRACE_ERROR(id, ...) ((void)0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LEVEL_WARN
+#define TRACE_WARN(id, ...) TraceLog::log(TRACE_LEVEL_WARN, TRACE_##id, ##__VA_ARGS__)
+#else
+#define TRACE_WARN(id, ...) ((void)0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LEVEL_INFO
+#define TRACE_INFO(id, ...) TraceLog::log(TRACE_LEVEL_INFO, TRACE_##id, ##__VA_ARGS__)
+#else
+#define TRACE_INFO(id, ...) ((void)0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(id, ...) TraceLog::log(TRACE_LEVEL_DEBUG, TRACE_##id, ##__VA_ARGS__)
+#else
+#define TRACE_DEBUG(id, ...) ((void)0)
+#endif
+
+// =========================================================
+// Deferred-formatting trace log
+// =========================================================
+// log() claims a slot with one atomic increment and copies 20 bytes; it
+// never blocks and never formats. The ring overwrites its oldest entries,
+// so each reader (Serial/SD drain task, HTTP) keeps its own cursor and
+// counts what it missed.
+class TraceLog
+{
+public:
+    static void log(uint8_t level, uint16_t event, int32_t a0 = 0, int32_t a1 = 0, int32_t a2 = 0);
+
+    // Start the drain task (SD copy only when built with TRACE_TO_SD)
+    static void begin(FileManager *fm);
+
+    // Records with sequence >= `since` as text lines, plus "next" cursor
+    static void toText(uint32_t since, String &out, uint32_t &next);
+
+    // Cost per event: log() vs. Serial.printf of the same line
+    static void benchmark(JsonDocument *doc);
+
+    static uint32_t getDropped() { return dropped.load(); }
+
+private:
+    struct Record
+    {
+        std::atomic<uint32_t> seq; // sequence + 1 once complete, 0 while written
+        uint32_t timestampUs;
+        uint16_t event;
+        uint8_t level;
+        int32_t args[3];
+    };
+
+    static Record ring[TRACE_RING_SIZE];
+    static std::atomic<uint32_t> head;
+    static std::atomic<uint32_t> dropped; // Overwritten before the drain task saw them
+    static FileManager *fileManager;
+
+    // 1 = copied, 0 = still being written, -1 = overwritten
+    static int read(uint32_t seq, Record &out);
+    static size_t format(const Record &r, uint32_t seq, char *buf, size_t size);
+    static void drainTask(void *arg);
+};
+
+#endif // TRACELOG_H
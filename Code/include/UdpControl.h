@@ -0,0 +1,113 @@
+#ifndef UDPCONTROL_H
+#define UDPCONTROL_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <WiFiUdp.h>
+#include "RadioController.h"
+#include "ConfigStore.h"
+#include "Metrics.h"
+
+#define UDP_CONTROL_PORT 5011
+// Remotes remembered for duplicate detection (least recently used is evicted)
+#define UDP_CONTROL_MAX_CLIENTS 8
+
+// =========================================================
+// Binary control protocol over UDP
+// =========================================================
+// One datagram per request, one per response, no connection setup. Meant
+// for hardware remotes and knobs; the web UI keeps using HTTP. Commands
+// go through RadioController like the HTTP routes, so validation and
+// group replication are the same.
+//
+// Every request carries a client-chosen sequence number. A request with
+// the same seq as the client's previous one is a retransmission: the
+// cached response is sent again and the command is not re-applied. Older
+// seqs are answered with UDP_STATUS_STALE. If common.json sets
+// "udp_token", requests must carry it.
+class UdpControl
+{
+public:
+    enum Op : uint8_t
+    {
+        // 1-7 match RadioCommandType
+        OP_TUNE = RADIO_CMD_TUNE,           // value: channel code (10 kHz units)
+        OP_VOLUME = RADIO_CMD_VOLUME,       // value: 0-15
+        OP_PRESET = RADIO_CMD_PRESET,       // value: preset index
+        OP_SEEK_UP = RADIO_CMD_SEEK_UP,
+        OP_SEEK_DOWN = RADIO_CMD_SEEK_DOWN,
+        OP_POWER = RADIO_CMD_POWER,         // value: 1 = on, 0 = off
+        OP_SEEK_NEXT = RADIO_CMD_SEEK_NEXT,
+        OP_STATUS = 0x10                    // No side effects, never cached
+    };
+
+    enum Status : uint8_t
+    {
+        UDP_STATUS_OK = 0,
+        UDP_STATUS_INVALID = 1,   // Unknown op or rejected value
+        UDP_STATUS_AUTH = 2,      // Missing/wrong token
+        UDP_STATUS_STALE = 3      // seq older than the client's last request
+    };
+
+    // 16 bytes, little-endian (native on ESP32)
+    struct __attribute__((packed)) Request
+    {
+        uint16_t magic;   // UDP_CONTROL_MAGIC
+        uint8_t version;
+        uint8_t op;
+        uint32_t seq;
+        int32_t value;
+        uint32_t token;
+    };
+
+    // 16 bytes; always carries the state after the request
+    struct __attribute__((packed)) Response
+    {
+        uint16_t magic;
+        uint8_t version;
+        uint8_t op;
+        uint32_t seq;
+        uint8_t status;
+        uint8_t flags;    // bit0: powered
+        uint16_t channelCode;
+        uint8_t volume;
+        uint8_t rssi;
+        uint16_t reserved;
+    };
+
+    UdpControl(RadioController *controller, ConfigStore *config);
+
+    // Open the socket (needs the network stack)
+    void begin(uint16_t port = UDP_CONTROL_PORT);
+    bool isStarted() const { return started.load(std::memory_order_acquire); }
+
+    // Answer pending requests; call from loop() (FMRadio is not thread-safe)
+    void poll();
+
+private:
+    struct Client
+    {
+        IPAddress ip;
+        uint16_t port;        // 0 = free slot
+        uint32_t lastUsedMs;
+        bool hasSeq;
+        uint32_t lastSeq;
+        Response lastResponse;
+    };
+
+    RadioController *controller;
+    ConfigStore *configStore;
+    WiFiUDP udp;
+    std::atomic<bool> started;
+    Client clients[UDP_CONTROL_MAX_CLIENTS];
+
+    MetricHistogram *latency;
+    MetricCounter *duplicates;
+    MetricCounter *rejected;
+
+    void handle(const Request &req, IPAddress ip, uint16_t port);
+    void fillState(Response &resp);
+    Client *findClient(IPAddress ip, uint16_t port);
+};
+
+#endif // UDPCONTROL_H
@@ -0,0 +1,59 @@
+#ifndef UIFLASH_H
+#define UIFLASH_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+// Data partition holding the packed UI (see partitions.csv, tools/pack_ui.py)
+#define UI_FLASH_PARTITION "uifs"
+#define UI_FLASH_SUBTYPE 0x40
+#define UI_FLASH_MAGIC 0x31465546UL // "FUF1"
+
+// =========================================================
+// Read-only UI image in a memory-mapped flash partition
+// =========================================================
+// Layout (little-endian, offsets from the partition start):
+//   header  "FUF1" | u32 count | u32 imageSize | u32 reserved
+//   index   count x Entry, sorted by hash
+//   data    file contents, 4-byte aligned
+// Paths are FNV-1a hashes of the path relative to /ui, the same hash
+// UiManifest uses. The whole image is mapped once at boot; find() is a
+// binary search over the mapped index and the HTTP layer writes file
+// data to the socket straight from the mapping, with no SD and no
+// staging buffer. Works without an SD card.
+class UiFlash
+{
+public:
+    enum Flags : uint8_t
+    {
+        GZIP = 0x01 // Stored gzip-compressed: send with Content-Encoding
+    };
+
+    struct __attribute__((packed)) Entry
+    {
+        uint32_t hash;
+        uint32_t offset;  // From the partition start
+        uint32_t size;    // Stored size (compressed if GZIP)
+        uint8_t flags;
+        uint8_t reserved[3];
+    };
+
+    UiFlash();
+
+    // Find and map the partition; false if missing or not a valid image
+    bool begin();
+
+    bool isReady() const { return index != nullptr; }
+    uint32_t fileCount() const { return count; }
+
+    const Entry *find(const char *relPath) const;
+    const uint8_t *data(const Entry *entry) const { return base + entry->offset; }
+
+private:
+    const uint8_t *base;
+    const Entry *index;
+    uint32_t count;
+    spi_flash_mmap_handle_t handle;
+};
+
+#endif // UIFLASH_H
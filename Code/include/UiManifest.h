@@ -0,0 +1,76 @@
+#ifndef UIMANIFEST_H
+#define UIMANIFEST_H
+
+#include <Arduino.h>
+#include "FS.h"
+
+// Hash table slots (power of two); at most 3/4 are filled
+#define UI_MANIFEST_SLOTS 256
+#define UI_MANIFEST_MAX_DEPTH 4
+// Deploys touch this file; its size/mtime changing triggers a rebuild
+#define UI_MANIFEST_MARKER "/.version"
+#define UI_MANIFEST_CHECK_MS 2000
+
+// =========================================================
+// In-RAM index of the /famio/ui tree
+// =========================================================
+// Built once at mount so the HTTP layer can answer "does this exist, how
+// big is it, what type is it, is there a .gz" without touching the card.
+// Paths are relative to the UI root ("/index.html") and stored only as
+// FNV-1a hashes. FATFS exposes no cluster numbers through the Arduino FS
+// API, so no cluster hint is kept.
+class UiManifest
+{
+public:
+    enum Flags : uint8_t
+    {
+        HAS_GZIP = 0x01, // "<path>.gz" exists
+        GZIP_ONLY = 0x02 // only the .gz exists
+    };
+
+    struct Entry
+    {
+        uint32_t hash;   // 0 = empty slot
+        uint32_t size;
+        uint32_t gzSize;
+        uint32_t mtime;
+        uint8_t mime;    // Index for mimeType()
+        uint8_t flags;
+    };
+
+    UiManifest();
+
+    // Walk `root` (an open directory). Returns the number of files indexed.
+    // SD operations used are added to `sdOps`.
+    size_t build(File root, const char *rootPath, uint32_t &sdOps);
+
+    // Forget everything; lookups fall back to probing the card
+    void clear();
+
+    const Entry *find(const char *relPath) const;
+    bool isReady() const { return ready; }
+    size_t size() const { return count; }
+    uint32_t getBuildUs() const { return buildUs; }
+
+    // Marker state captured at build time
+    void setMarker(uint32_t size, uint32_t mtime);
+    bool markerChanged(uint32_t size, uint32_t mtime) const;
+
+    static uint32_t hashPath(const char *relPath);
+    static uint8_t mimeIndex(const char *path);
+    static const char *mimeType(uint8_t index);
+
+private:
+    Entry table[UI_MANIFEST_SLOTS];
+    size_t count;
+    bool ready;
+    uint32_t buildUs;
+    uint32_t markerSize;
+    uint32_t markerMtime;
+
+    Entry *slotFor(uint32_t hash);
+    void walk(File dir, size_t rootLen, uint8_t depth, uint32_t &sdOps);
+    void add(const char *relPath, uint32_t size, uint32_t mtime);
+};
+
+#endif // UIMANIFEST_H
@@ -0,0 +1,140 @@
+#include "AdmissionControl.h"
+
+// Per client: the web UI polls status a few times per second and loads
+// ~20 files on page load; a tight polling loop is cut to the rate below.
+const AdmissionControl::Spec AdmissionControl::clientSpecs[ROUTE_CLASS_COUNT] = {
+    {50, 20, 0},   // control: 20/s
+    {100, 10, 0},  // status: 10/s
+    {1000, 3, 0},  // heavy: 1/s
+    {25, 40, 0},   // static: 40/s
+};
+
+// All clients together: what the loop task can serve while still
+// polling the radio. Control is not limited globally so it always wins.
+// Status keeps a quarter of its burst for clients polling within their
+// rate; four such clients at 10/s still fit in the 40/s.
+const AdmissionControl::Spec AdmissionControl::globalSpecs[ROUTE_CLASS_COUNT] = {
+    {0, 0, 0},     // control: unlimited
+    {25, 40, 10},  // status: 40/s
+    {500, 4, 0},   // heavy: 2/s
+    {20, 60, 0},   // static: 50/s
+};
+
+// =========================================================
+// Constructor / Setup
+// =========================================================
+AdmissionControl::AdmissionControl()
+{
+    memset(clients, 0, sizeof(clients));
+    for (uint8_t c = 0; c < ROUTE_CLASS_COUNT; c++)
+    {
+        fill(global[c], globalSpecs[c], 0);
+        rateLimited[c] = nullptr;
+        overloaded[c] = nullptr;
+    }
+}
+
+void AdmissionControl::begin()
+{
+    for (uint8_t c = 0; c < ROUTE_CLASS_COUNT; c++)
+    {
+        rateLimited[c] = Metrics::counter("http_rate_limited_total", "class", className((RouteClass)c));
+        overloaded[c] = Metrics::counter("http_overload_total", "class", className((RouteClass)c));
+    }
+}
+
+const char *AdmissionControl::className(RouteClass cls)
+{
+    switch (cls)
+    {
+    case ROUTE_CONTROL:
+        return "control";
+    case ROUTE_STATUS:
+        return "status";
+    case ROUTE_HEAVY:
+        return "heavy";
+    default:
+        return "static";
+    }
+}
+
+// =========================================================
+// Admission
+// =========================================================
+Admission AdmissionControl::admit(uint32_t clientIp, RouteClass cls)
+{
+    uint32_t now = millis();
+    Client *client = findClient(clientIp, now);
+
+    Bucket &own = client->buckets[cls];
+    if (!take(own, clientSpecs[cls], now))
+    {
+        Metrics::inc(rateLimited[cls]);
+        return ADMIT_RATE_LIMITED;
+    }
+    // Half its burst left: the client asks within its rate and may use
+    // the shared reserve; one spending every token as it accrues may not
+    bool light = own.creditMs * 2 >= (uint32_t)clientSpecs[cls].intervalMs * clientSpecs[cls].burst;
+    if (!take(global[cls], globalSpecs[cls], now, light ? 0 : globalSpecs[cls].reserve))
+    {
+        // Shed for everyone's load: the client keeps its own budget. Not
+        // where a reserve turned away a client using up its rate: refunds
+        // would keep its bucket full and let it pass for a light one.
+        if (light || !globalSpecs[cls].reserve)
+            refund(own, clientSpecs[cls]);
+        Metrics::inc(overloaded[cls]);
+        return ADMIT_OVERLOADED;
+    }
+    return ADMIT_OK;
+}
+
+void AdmissionControl::fill(Bucket &bucket, const Spec &spec, uint32_t now)
+{
+    bucket.creditMs = (uint32_t)spec.intervalMs * spec.burst;
+    bucket.lastMs = now;
+}
+
+bool AdmissionControl::take(Bucket &bucket, const Spec &spec, uint32_t now, uint16_t keep)
+{
+    if (spec.intervalMs == 0)
+        return true;
+
+    uint32_t cap = (uint32_t)spec.intervalMs * spec.burst;
+    uint32_t elapsed = now - bucket.lastMs;
+    bucket.lastMs = now;
+    bucket.creditMs = (elapsed >= cap - bucket.creditMs) ? cap : bucket.creditMs + elapsed;
+
+    if (bucket.creditMs < (uint32_t)spec.intervalMs * (1 + keep))
+        return false;
+    bucket.creditMs -= spec.intervalMs;
+    return true;
+}
+
+void AdmissionControl::refund(Bucket &bucket, const Spec &spec)
+{
+    uint32_t cap = (uint32_t)spec.intervalMs * spec.burst;
+    bucket.creditMs = (cap - bucket.creditMs < spec.intervalMs) ? cap : bucket.creditMs + spec.intervalMs;
+}
+
+AdmissionControl::Client *AdmissionControl::findClient(uint32_t ip, uint32_t now)
+{
+    Client *victim = &clients[0];
+    for (uint8_t i = 0; i < ADMISSION_MAX_CLIENTS; i++)
+    {
+        Client &c = clients[i];
+        if (c.ip == ip)
+        {
+            c.lastSeenMs = now;
+            return &c;
+        }
+        if (victim->ip && (!c.ip || c.lastSeenMs < victim->lastSeenMs))
+            victim = &c;
+    }
+
+    // New client starts with full buckets
+    victim->ip = ip;
+    victim->lastSeenMs = now;
+    for (uint8_t c = 0; c < ROUTE_CLASS_COUNT; c++)
+        fill(victim->buckets[c], clientSpecs[c], now);
+    return victim;
+}
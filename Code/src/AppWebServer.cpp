@@ -1,10 +1,17 @@
 #include "AppWebServer.h"
 #include <ArduinoJson.h>
 #include <ConnectivityManager.h>
+#include "BootProfiler.h"
+#include "Metrics.h"
+#include "TraceLog.h"
+#include "HangDetector.h"
+#include "Capture.h"
 
 // Constructor: Khởi tạo Web Server ở cổng 80 và lưu trữ con trỏ
-AppWebServer::AppWebServer(FMRadio *radio, PowerManager *power, FileManager *fileMgr, ConnectivityManager *connectivity)
-    : server(80), fmRadio(radio), powerManager(power), fileManager(fileMgr), connectivity(connectivity)
+AppWebServer::AppWebServer(RadioController *controller, PowerManager *power, FileManager *fileMgr, ConnectivityManager *connectivity, ConfigStore *config, OtaManager *ota, GroupSync *group, UiFlash *uiFlash, ScheduleEngine *schedule, SpectrumStream *spectrum, InputSourceManager *inputs, ListeningLog *listening)
+    : server(80), connectivity(connectivity), radioController(controller), fmRadio(controller->getRadio()), powerManager(power),
+      fileManager(fileMgr), configStore(config), otaManager(ota), groupSync(group), uiFlash(uiFlash), scheduleEngine(schedule), spectrumStream(spectrum), inputSources(inputs), listeningLog(listening), firstResponseSent(false), statusJsonLen(0), statusJsonVersion(0), statusCacheHits(nullptr),
+      requestsSeen(0)
 {
 
     // Kiểm tra tính hợp lệ của con trỏ (tùy chọn)
@@ -21,50 +28,193 @@ AppWebServer::AppWebServer(FMRadio *radio, PowerManager *power, FileManager *fil
 bool AppWebServer::begin()
 {
     // Đăng ký tất cả các API endpoints
+    admission.begin();
+    statusCacheHits = Metrics::counter("http_status_cache_hits_total");
     registerAPIs();
 
+    // WebServer chỉ giữ lại các header được khai báo trước
+    static const char *headerKeys[] = {"Range", "Accept-Encoding"};
+    server.collectHeaders(headerKeys, 2);
+
     // Bắt đầu Web Server
     server.begin();
     return true;
 }
 
 // =========================================================
-// Hàm Đăng ký API (Sử dụng std::bind)
+// Hàm Đăng ký API
 // =========================================================
 
+// Bọc mọi handler: kiểm soát tải, đo thời gian xử lý theo route và ghi nhận request đầu tiên
+void AppWebServer::on(const char *uri, HTTPMethod method, void (AppWebServer::*handler)(), RouteClass cls, RouteNeeds needs)
+{
+    MetricHistogram *latency = Metrics::histogram("http_request_us", "route", uri);
+    uint16_t label = HangDetector::label(uri);
+    server.on(uri, method, [this, handler, latency, cls, needs, label]()
+              {
+        uint32_t start = micros();
+        uint32_t heap = ESP.getFreeHeap();
+        if (!admit(cls) || !moduleReady(needs))
+            return;
+        HangGuard guard(HANG_HTTP, label);
+        MetricTimer timer(latency);
+        (this->*handler)();
+        captureRequest(start, heap);
+        noteRequest(); });
+}
+
+// Ghi request vào trace (nếu đang ghi): "uri?name=value&..." để phát lại được
+void AppWebServer::captureRequest(uint32_t start, uint32_t heapBefore)
+{
+    if (!Capture::isRecording())
+        return;
+    char text[CAPTURE_TEXT_MAX + 1];
+    size_t len = snprintf(text, sizeof(text), "%s", server.uri().c_str());
+    char sep = '?';
+    for (int i = 0; i < server.args() && len < CAPTURE_TEXT_MAX; i++)
+    {
+        // "plain" là thân request, không phải tham số
+        if (server.argName(i) == "plain")
+            continue;
+        len += snprintf(text + len, sizeof(text) - len, "%c%s=%s", sep, server.argName(i).c_str(), server.arg(i).c_str());
+        sep = '&';
+    }
+    Capture::request(server.method(), text, start, heapBefore);
+}
+
+// Từ chối sớm, trước khi handler chạm I2C/SD: 429 nếu client vượt hạn mức
+// riêng, 503 nếu cả server đang quá tải với loại route này
+bool AppWebServer::admit(RouteClass cls)
+{
+    requestsSeen++;
+    Admission result = admission.admit((uint32_t)server.client().remoteIP(), cls);
+    if (result == ADMIT_OK)
+        return true;
+
+    sendCORSHeaders();
+    server.sendHeader("Retry-After", "1");
+    if (result == ADMIT_RATE_LIMITED)
+        server.send(429, "application/json", "{\"status\":\"error\", \"message\":\"Quá nhiều request\"}");
+    else
+        server.send(503, "application/json", "{\"status\":\"error\", \"message\":\"Server đang quá tải\"}");
+    return false;
+}
+
+// Server nhận request từ bước "network"; tuner, lịch, nguồn vào... còn đang
+// chạy begin() ở các bước sau, chạm vào lúc đó là đọc dở trạng thái
+bool AppWebServer::moduleReady(RouteNeeds needs)
+{
+    bool ready = true;
+    switch (needs)
+    {
+    case NEEDS_TUNER:
+        ready = fmRadio->isReady();
+        break;
+    case NEEDS_SCHEDULE:
+        ready = scheduleEngine->isStarted();
+        break;
+    case NEEDS_INPUT:
+        ready = inputSources->isStarted();
+        break;
+    case NEEDS_LISTENING:
+        ready = listeningLog->isStarted();
+        break;
+    case NEEDS_GROUP:
+        ready = groupSync->isStarted();
+        break;
+    default:
+        break;
+    }
+    if (ready)
+        return true;
+
+    sendCORSHeaders();
+    server.sendHeader("Retry-After", "1");
+    server.send(503, "application/json", "{\"status\":\"error\", \"message\":\"Đang khởi động\"}");
+    return false;
+}
+
+void AppWebServer::noteRequest()
+{
+    if (firstResponseSent)
+        return;
+    firstResponseSent = true;
+    BootProfiler::mark("first_http");
+    Serial.printf("HTTP: First response %lu ms after reset\n", millis());
+}
+
 void AppWebServer::registerAPIs()
 {
 
     // API Lấy trạng thái FM
-    server.on("/api/fm/status", HTTP_GET, std::bind(&AppWebServer::handleFmStatus, this));
-    server.on("/api/fm/power", HTTP_POST, std::bind(&AppWebServer::handleFmPower, this));
-    server.on("/api/fm/setfreq", HTTP_POST, std::bind(&AppWebServer::handleFmSetFreq, this));
-    server.on("/api/fm/seek", HTTP_GET, std::bind(&AppWebServer::handleFmSeek, this));
-    server.on("/api/fm/volume", HTTP_POST, std::bind(&AppWebServer::handleFmVolume, this));
-    server.on("/api/fm/save", HTTP_POST, std::bind(&AppWebServer::handleFmSaveChannel, this));
-    server.on("/api/fm/select", HTTP_GET, std::bind(&AppWebServer::handleFmSelectChannel, this));
-    server.on("/api/fm/channels", HTTP_GET, std::bind(&AppWebServer::handleFmLoadChannels, this));
-    server.on("/api/fm/delete", HTTP_DELETE, std::bind(&AppWebServer::handleFmDeleteChannel, this));
+    on("/api/fm/status", HTTP_GET, &AppWebServer::handleFmStatus, ROUTE_STATUS);
+    on("/api/fm/power", HTTP_POST, &AppWebServer::handleFmPower, ROUTE_CONTROL, NEEDS_TUNER);
+    on("/api/fm/setfreq", HTTP_POST, &AppWebServer::handleFmSetFreq, ROUTE_CONTROL, NEEDS_TUNER);
+    on("/api/fm/seek", HTTP_GET, &AppWebServer::handleFmSeek, ROUTE_CONTROL, NEEDS_TUNER);
+    on("/api/fm/volume", HTTP_POST, &AppWebServer::handleFmVolume, ROUTE_CONTROL, NEEDS_TUNER);
+    on("/api/fm/save", HTTP_POST, &AppWebServer::handleFmSaveChannel, ROUTE_CONTROL, NEEDS_TUNER);
+    on("/api/fm/select", HTTP_GET, &AppWebServer::handleFmSelectChannel, ROUTE_CONTROL, NEEDS_TUNER);
+    on("/api/fm/channels", HTTP_GET, &AppWebServer::handleFmLoadChannels, ROUTE_STATUS, NEEDS_TUNER);
+    on("/api/fm/delete", HTTP_DELETE, &AppWebServer::handleFmDeleteChannel, ROUTE_CONTROL, NEEDS_TUNER);
+    on("/api/fm/rds", HTTP_GET, &AppWebServer::handleFmRds, ROUTE_STATUS, NEEDS_TUNER);
+    on("/api/fm/stations", HTTP_GET, &AppWebServer::handleFmStations, ROUTE_STATUS, NEEDS_TUNER);
+    on("/api/fm/history", HTTP_GET, &AppWebServer::handleFmHistory, ROUTE_STATUS, NEEDS_TUNER);
 
     // API Điều chỉnh âm lượng
-    server.on("/api/system/volume", HTTP_POST, std::bind(&AppWebServer::handleSystemVolume, this));
+    on("/api/system/volume", HTTP_POST, &AppWebServer::handleSystemVolume, ROUTE_CONTROL);
 
     // API Cấu hình Wi-Fi
-    server.on("/api/wifi/status", HTTP_GET, std::bind(&AppWebServer::handleGetWifiStatus, this));
-    server.on("/api/wifi/scan", HTTP_GET, std::bind(&AppWebServer::handleScanNetworks, this));
-    server.on("/api/wifi/config", HTTP_POST, std::bind(&AppWebServer::handleSubmitWifiConfig, this));
-    server.on("/api/wifi/reset", HTTP_POST, std::bind(&AppWebServer::handleResetWifiConfig, this));
+    on("/api/wifi/status", HTTP_GET, &AppWebServer::handleGetWifiStatus, ROUTE_STATUS);
+    on("/api/wifi/scan", HTTP_GET, &AppWebServer::handleScanNetworks, ROUTE_HEAVY);
+    on("/api/wifi/config", HTTP_POST, &AppWebServer::handleSubmitWifiConfig, ROUTE_HEAVY);
+    on("/api/wifi/reset", HTTP_POST, &AppWebServer::handleResetWifiConfig, ROUTE_HEAVY);
 
     // API Hệ thống
-    server.on("/api/system/reset", HTTP_POST, std::bind(&AppWebServer::handleSystemReset, this));
+    on("/api/system/reset", HTTP_POST, &AppWebServer::handleSystemReset, ROUTE_HEAVY);
+    on("/api/system/config/import", HTTP_POST, &AppWebServer::handleConfigImport, ROUTE_HEAVY);
+    on("/api/system/boot", HTTP_GET, &AppWebServer::handleSystemBoot, ROUTE_STATUS);
+    on("/api/system/metrics", HTTP_GET, &AppWebServer::handleSystemMetrics, ROUTE_STATUS);
+    on("/api/system/trace", HTTP_GET, &AppWebServer::handleSystemTrace, ROUTE_STATUS);
+    on("/api/system/hangs", HTTP_GET, &AppWebServer::handleSystemHangs, ROUTE_STATUS);
+    // Ghi/phát lại trace (request, I2C tuner, SD) để so sánh hồi quy ngoài hiện trường
+    on("/api/system/capture", HTTP_GET, &AppWebServer::handleCaptureStatus, ROUTE_STATUS);
+    on("/api/system/capture", HTTP_POST, &AppWebServer::handleCaptureControl, ROUTE_CONTROL);
+    on("/api/system/capture/file", HTTP_GET, &AppWebServer::handleCaptureFile, ROUTE_HEAVY);
+    // API Hẹn giờ
+    on("/api/system/schedule", HTTP_GET, &AppWebServer::handleScheduleStatus, ROUTE_STATUS, NEEDS_SCHEDULE);
+    on("/api/system/schedule", HTTP_POST, &AppWebServer::handleScheduleSettings, ROUTE_CONTROL, NEEDS_SCHEDULE);
+    on("/api/system/schedule/alarm", HTTP_POST, &AppWebServer::handleScheduleAlarm, ROUTE_CONTROL, NEEDS_SCHEDULE);
+    on("/api/system/schedule/sleep", HTTP_POST, &AppWebServer::handleScheduleSleep, ROUTE_CONTROL, NEEDS_SCHEDULE);
+    on("/api/system/ota", HTTP_GET, &AppWebServer::handleOtaStatus, ROUTE_STATUS);
+
+    // Phổ âm thanh: dữ liệu đẩy qua WebSocket (SPECTRUM_WS_PORT), ở đây chỉ mô tả luồng
+    on("/api/audio/spectrum", HTTP_GET, &AppWebServer::handleSpectrumStatus, ROUTE_STATUS);
+
+    // API Nguồn vào: chỉ nguồn đang chọn được cấp nguồn
+    on("/api/input", HTTP_GET, &AppWebServer::handleInputStatus, ROUTE_STATUS, NEEDS_INPUT);
+    on("/api/input", HTTP_POST, &AppWebServer::handleInputSelect, ROUTE_CONTROL, NEEDS_INPUT);
+
+    // API Thống kê nghe: tổng hợp cập nhật dần, không quét lại log trên SD
+    on("/api/stats/listening", HTTP_GET, &AppWebServer::handleListeningStats, ROUTE_STATUS, NEEDS_LISTENING);
+
+    // API Nhóm đa phòng
+    on("/api/group/status", HTTP_GET, &AppWebServer::handleGroupStatus, ROUTE_STATUS, NEEDS_GROUP);
+    on("/api/group/mode", HTTP_POST, &AppWebServer::handleGroupMode, ROUTE_CONTROL, NEEDS_GROUP);
 
     // 1. Root ("/") - Trang chính
-    server.on("/", HTTP_GET, std::bind(&AppWebServer::handleRoot, this));
-    AppWebServer::handleStaticFile();
+    on("/", HTTP_GET, &AppWebServer::handleRoot, ROUTE_STATIC);
+    on("/api/system/sdbench", HTTP_GET, &AppWebServer::handleSdBench, ROUTE_HEAVY);
+    on("/api/system/uibench", HTTP_GET, &AppWebServer::handleUiBench, ROUTE_HEAVY);
+    // File tĩnh khác được phục vụ trong onNotFound qua streamFile() (hỗ trợ Range)
 
     // Global handler: tất cả các OPTIONS (preflight) và các request không khớp
-    server.onNotFound([this]()
+    MetricHistogram *staticLatency = Metrics::histogram("http_request_us", "route", "static");
+    MetricHistogram *notFoundLatency = Metrics::histogram("http_request_us", "route", "not_found");
+    uint16_t staticLabel = HangDetector::label("static");
+    server.onNotFound([this, staticLatency, notFoundLatency, staticLabel]()
                       {
+        uint32_t start = micros();
+        uint32_t heap = ESP.getFreeHeap();
         // Trả lời preflight (OPTIONS) hoặc phục vụ file tĩnh từ SD
         if (server.method() == HTTP_OPTIONS) {
             sendCORSHeaders();
@@ -73,23 +223,28 @@ void AppWebServer::registerAPIs()
             server.send(204, "text/plain", "");
             return;
         }
+        if (!admit(ROUTE_STATIC))
+            return;
+        HangGuard guard(HANG_HTTP, staticLabel);
 
-        // Nếu không phải OPTIONS, thử phục vụ file từ /ui
+        // Nếu không phải OPTIONS, thử phục vụ file từ /ui (SD) hoặc partition UI (flash)
         String path = server.uri();
         if (path == "/") path = "/index.html";
-        String fsPath = String(UI_PATH) + path;
-        File f = fileManager->openFile(fsPath.c_str());
-        if (f) {
-            sendCORSHeaders();
-            const char* contentType = getContentType(path);
-            server.streamFile(f, contentType);
-            f.close();
+        char fsPath[FILE_PATH_MAX];
+        snprintf(fsPath, sizeof(fsPath), UI_PATH "%s", path.c_str());
+        if (serveUiFile(path, fsPath)) {
+            Metrics::record(staticLatency, micros() - start);
+            captureRequest(start, heap);
+            noteRequest();
             return;
         }
 
         // Không tìm thấy
         sendCORSHeaders();
-        server.send(404, "text/plain", "Not Found"); });
+        server.send(404, "text/plain", "Not Found");
+        Metrics::record(notFoundLatency, micros() - start);
+        captureRequest(start, heap);
+        noteRequest(); });
 }
 
 // =========================================================
@@ -98,53 +253,197 @@ void AppWebServer::registerAPIs()
 
 void AppWebServer::handleRoot()
 {
-    // Phục vụ file index.html từ thẻ SD
-    File file = fileManager->openFile(UI_PATH "/index.html");
-    if (file)
+    // Phục vụ index.html từ SD (nếu ghi đè) hoặc từ flash
+    if (!serveUiFile("/index.html", UI_PATH "/index.html"))
     {
         sendCORSHeaders();
-        server.streamFile(file, "text/html");
-        file.close();
+        server.send(404, "text/plain", "File /index.html not found on SD Card or UI partition!");
     }
-    else
+}
+
+// Thứ tự tra cứu: /ui trên SD ghi đè, partition UI trong flash là mặc định.
+// Không có thẻ SD (hoặc file không có trong manifest) thì không chạm SD.
+bool AppWebServer::serveUiFile(const String &path, const char *fsPath)
+{
+    if (fileManager->isMounted())
     {
-        sendCORSHeaders();
-        server.send(404, "text/plain", "File /index.html not found on SD Card!");
+        // Manifest trong RAM: URL không có trong /ui bỏ qua SD ngay
+        const UiManifest::Entry *entry = fileManager->findUiFile(path.c_str());
+        bool mayExist = entry || !fileManager->isUiManifestReady();
+        const char *contentType = entry ? UiManifest::mimeType(entry->mime) : getContentType(path);
+        if (mayExist && streamFile(fsPath, contentType, entry))
+            return true;
     }
+
+    const UiFlash::Entry *flashEntry = uiFlash ? uiFlash->find(path.c_str()) : nullptr;
+    if (!flashEntry)
+        return false;
+    sendFlashFile(flashEntry, getContentType(path));
+    return true;
 }
 
-void AppWebServer::handleStaticFile()
+// =========================================================
+// Stream file từ SD (hỗ trợ Range / 206)
+// =========================================================
+
+// Header chung cho SD và flash. `range`: đoạn thân cần gửi (200 cả file, 206 một đoạn).
+bool AppWebServer::beginFileResponse(size_t size, const char *contentType, bool gzip, bool vary, HttpRange &range)
 {
-    server.serveStatic("/", SD, PROJECT_ROOT_DIR "/ui/");
+    range = HttpRange::resolve(server.hasHeader("Range") ? server.header("Range").c_str() : nullptr, size);
+
+    sendCORSHeaders();
+    server.sendHeader("Accept-Ranges", "bytes");
+    if (gzip)
+        server.sendHeader("Content-Encoding", "gzip");
+    if (vary)
+        server.sendHeader("Vary", "Accept-Encoding");
+    if (range.contentRange[0])
+        server.sendHeader("Content-Range", range.contentRange);
+    if (range.code == 416)
+    {
+        server.send(416, "text/plain", "");
+        return false;
+    }
+
+    server.setContentLength(range.length);
+    server.send(range.code, contentType, "");
+    return server.method() != HTTP_HEAD;
 }
 
-void AppWebServer::handleFmStatus()
+bool AppWebServer::streamFile(const char *fsPath, const char *contentType, const UiManifest::Entry *entry)
 {
-    // Cấp phát bộ nhớ cho phản hồi JSON
-    JsonDocument statusDoc;
+    static MetricCounter *bytesSent = Metrics::counter("http_file_bytes_total");
+    static MetricGauge *lastKBps = Metrics::gauge("http_file_last_kbps");
+    // Bộ đệm cố định, căn 4 byte (chỉ task loop() dùng): không cấp phát mỗi request
+    static uint8_t buffer[FILE_STREAM_BUF_SIZE] __attribute__((aligned(4)));
 
-    // GỌI HÀM CỦA FMRADIO ĐỂ LẤY TRẠNG THÁI THẬT
-    if (fmRadio)
+    // Có bản .gz trong manifest và trình duyệt nhận gzip: gửi bản nén
+    char gzPath[FILE_PATH_MAX];
+    bool gzip = false;
+    if (entry && (entry->flags & UiManifest::HAS_GZIP) &&
+        ((entry->flags & UiManifest::GZIP_ONLY) || server.header("Accept-Encoding").indexOf("gzip") >= 0))
     {
-        fmRadio->getStatus(&statusDoc);
+        snprintf(gzPath, sizeof(gzPath), "%s.gz", fsPath);
+        fsPath = gzPath;
+        gzip = true;
     }
-    else
+
+    File file = fileManager->openFile(fsPath);
+    if (!file || file.isDirectory())
+        return false;
+
+    HttpRange range;
+    if (!beginFileResponse(file.size(), contentType, gzip, entry && (entry->flags & UiManifest::HAS_GZIP), range))
     {
-        // Giả lập dữ liệu (Xóa khi tích hợp FMRadio)
-        statusDoc["isPowered"] = false;
-        statusDoc["freq"] = 99.5;
-        statusDoc["volume"] = 75;
-        statusDoc["stereo"] = true;
-        statusDoc["rssi"] = 68;
+        file.close();
+        return true;
     }
 
+    WiFiClient client = server.client();
+    uint32_t start = micros();
+    size_t sent = range.copy(file, client, buffer, sizeof(buffer));
+    file.close();
+
+    uint32_t us = micros() - start;
+    Metrics::inc(bytesSent, sent);
+    if (us)
+        Metrics::set(lastKBps, (uint64_t)sent * 1000 / us);
+    return true;
+}
+
+// =========================================================
+// Gửi file từ partition UI (flash đã map, không sao chép)
+// =========================================================
+
+void AppWebServer::sendFlashFile(const UiFlash::Entry *entry, const char *contentType)
+{
+    static MetricCounter *bytesSent = Metrics::counter("http_file_bytes_total");
+    static MetricCounter *flashBytes = Metrics::counter("http_flash_bytes_total");
+    static MetricGauge *lastKBps = Metrics::gauge("http_file_last_kbps");
+
+    // pack_ui.py chỉ lưu bản nén cho loại file nén được (trình duyệt đều nhận gzip)
+    bool gzip = entry->flags & UiFlash::GZIP;
+    HttpRange range;
+    if (!beginFileResponse(entry->size, contentType, gzip, gzip, range))
+        return;
+
+    // Con trỏ vào cache flash: lwIP sao chép thẳng vào pbuf, không qua bộ đệm trung gian
+    const uint8_t *data = uiFlash->data(entry) + range.first;
+    size_t remaining = range.length;
+    WiFiClient client = server.client();
+    uint32_t start = micros();
+    size_t sent = 0;
+    while (remaining > 0)
+    {
+        size_t want = remaining < FILE_STREAM_BUF_SIZE ? remaining : FILE_STREAM_BUF_SIZE;
+        size_t n = client.write(data + sent, want);
+        if (n == 0)
+            break; // Client đã ngắt
+        sent += n;
+        remaining -= n;
+        HangDetector::feed();
+    }
+
+    uint32_t us = micros() - start;
+    Metrics::inc(bytesSent, sent);
+    Metrics::inc(flashBytes, sent);
+    if (us)
+        Metrics::set(lastKBps, (uint64_t)sent * 1000 / us);
+}
+
+void AppWebServer::handleUiBench()
+{
+    // Số thao tác SD cho một lần tải trang: dò file vs. manifest
+    JsonDocument doc;
+    fileManager->benchmarkUiLookups(&doc);
+    doc["sd_ops_total"] = fileManager->getSdOps();
+
     String response;
-    serializeJson(statusDoc, response);
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
 
+void AppWebServer::handleSdBench()
+{
+    // ?path=/ui/app.js (tương đối với PROJECT_ROOT_DIR)
+    JsonDocument doc;
+    String path = server.hasArg("path") ? server.arg("path") : String(UI_PATH "/index.html");
+    fileManager->benchmarkRead(path.c_str(), &doc);
+
+    String response;
+    serializeJson(doc, response);
     sendCORSHeaders();
     server.send(200, "application/json", response);
 }
 
+// Trạng thái FM: đọc snapshot (không I2C), serialize lại chỉ khi version đổi.
+// Client gửi lại version đã biết (since) thì trả 304 như /api/fm/rds
+void AppWebServer::handleFmStatus()
+{
+    sendCORSHeaders();
+    uint32_t version = fmRadio->getStatusVersion();
+    if (server.hasArg("since") && (uint32_t)server.arg("since").toInt() == version)
+    {
+        server.send(304, "application/json", "");
+        return;
+    }
+
+    if (statusJsonLen == 0 || statusJsonVersion != version)
+    {
+        JsonDocument statusDoc;
+        fmRadio->getStatus(&statusDoc);
+        statusJsonLen = serializeJson(statusDoc, statusJson, sizeof(statusJson));
+        // Version trong JSON mới là version thật (snapshot có thể vừa đổi)
+        statusJsonVersion = statusDoc["version"] | version;
+    }
+    else
+    {
+        Metrics::inc(statusCacheHits);
+    }
+    server.send_P(200, "application/json", statusJson, statusJsonLen);
+}
+
 void AppWebServer::handleSystemVolume()
 {
     // Kiểm tra xem tham số POST 'level' có được gửi không
@@ -170,8 +469,18 @@ void AppWebServer::handleSystemVolume()
 
 void AppWebServer::handleClient()
 {
-    // Hàm này phải được gọi liên tục trong main loop() để Web Server hoạt động
-    server.handleClient();
+    // Hàm này phải được gọi liên tục trong main loop() để Web Server hoạt động.
+    // Mỗi lần gọi server.handleClient() chỉ nhận một kết nối: xử lý tiếp khi
+    // vẫn còn request, nhưng không quá HTTP_ACCEPT_BURST/HTTP_ACCEPT_BUDGET_US
+    // để FM poll và UDP control vẫn được chạy đều
+    uint32_t start = micros();
+    for (uint8_t i = 0; i < HTTP_ACCEPT_BURST; i++)
+    {
+        uint32_t before = requestsSeen;
+        server.handleClient();
+        if (requestsSeen == before || micros() - start >= HTTP_ACCEPT_BUDGET_US)
+            break;
+    }
 }
 
 // --- XỬ LÝ API WIFI ---
@@ -181,6 +490,8 @@ void AppWebServer::handleGetWifiStatus()
     JsonDocument doc;
     doc["isOperational"] = connectivity->isOperational();
     doc["ip"] = connectivity->isOperational() ? WiFi.localIP().toString() : WiFi.softAPIP().toString();
+    if (connectivity->isOperational())
+        connectivity->getLinkStatus(&doc);
 
     String jsonResponse;
     serializeJson(doc, jsonResponse);
@@ -275,6 +586,308 @@ void AppWebServer::handleSystemReset()
     connectivity->manualReset(); // Thực hiện reset
 }
 
+void AppWebServer::handleConfigImport()
+{
+    // Đọc lại common/wifi/fm.json (sau khi sửa tay trên thẻ SD) vào snapshot NVS
+    sendCORSHeaders();
+    if (configStore->importJson())
+    {
+        server.send(200, "application/json", "{\"status\":\"success\", \"message\":\"Config imported. Restart to apply Wi-Fi changes.\"}");
+        return;
+    }
+    server.send(500, "application/json", "{\"status\":\"error\", \"message\":\"Không đọc được common.json/wifi.json hoặc không ghi được snapshot\"}");
+}
+
+void AppWebServer::handleSystemBoot()
+{
+    // Thời gian từng pha khởi động (BootProfiler), kể cả first_http
+    JsonDocument doc;
+    BootProfiler::toJson(&doc);
+    doc["uptime_ms"] = millis();
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+void AppWebServer::handleSystemMetrics()
+{
+    // Dạng text kiểu Prometheus, gửi theo từng khối (chunked) để không tốn RAM
+    Metrics::sampleSystem();
+    connectivity->sampleMetrics();
+
+    sendCORSHeaders();
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4", "");
+
+    char chunk[1024];
+    Metrics::render(chunk, sizeof(chunk), [](const char *data, size_t len, void *ctx)
+                    { static_cast<WebServer *>(ctx)->sendContent(data, len); }, &server);
+    server.sendContent("");
+}
+
+void AppWebServer::handleOtaStatus()
+{
+    // Upload thực hiện ở cổng OTA_PORT (task riêng); ở đây chỉ báo tiến độ
+    JsonDocument doc;
+    otaManager->getStatus(&doc);
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+// UI đọc dải tần các band ở đây rồi mở ws://<host>:81/spectrum; mỗi frame nhị
+// phân 22 byte (xem SpectrumFrame)
+void AppWebServer::handleSpectrumStatus()
+{
+    JsonDocument doc;
+    spectrumStream->getStatus(&doc);
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+void AppWebServer::handleInputStatus()
+{
+    JsonDocument doc;
+    inputSources->getStatus(&doc);
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+// ?source=fm|bluetooth. Trả về ngay, việc chuyển chạy tiếp trong loop()
+// (xem "phase" ở GET /api/input)
+void AppWebServer::handleInputSelect()
+{
+    sendCORSHeaders();
+    String source = server.arg("source");
+    InputSource target;
+    if (source == "fm")
+        target = INPUT_FM;
+    else if (source == "bluetooth")
+        target = INPUT_BLUETOOTH;
+    else
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"source phải là fm hoặc bluetooth\"}");
+        return;
+    }
+
+    bool changed = inputSources->select(target);
+    char body[96];
+    snprintf(body, sizeof(body), "{\"status\":\"success\", \"source\":\"%s\", \"changed\":%s}",
+             InputSwitch::name(target), changed ? "true" : "false");
+    server.send(200, "application/json", body);
+}
+
+// ?top=N (mặc định 10) &days=N (mặc định 7, tối đa LISTEN_DAYS)
+void AppWebServer::handleListeningStats()
+{
+    long top = server.hasArg("top") ? server.arg("top").toInt() : 10;
+    long days = server.hasArg("days") ? server.arg("days").toInt() : 7;
+    if (top < 0 || days < 0)
+    {
+        sendCORSHeaders();
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"top/days không hợp lệ\"}");
+        return;
+    }
+
+    JsonDocument doc;
+    listeningLog->getStatus(&doc, (size_t)top, (size_t)days);
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+void AppWebServer::handleSystemTrace()
+{
+    sendCORSHeaders();
+
+    // ?bench: đo chi phí mỗi sự kiện (TraceLog vs Serial.printf)
+    if (server.hasArg("bench"))
+    {
+        JsonDocument doc;
+        TraceLog::benchmark(&doc);
+        String response;
+        serializeJson(doc, response);
+        server.send(200, "application/json", response);
+        return;
+    }
+
+    // ?since=<seq>: chỉ trả các dòng mới; X-Trace-Next là con trỏ cho lần sau
+    uint32_t since = server.hasArg("since") ? strtoul(server.arg("since").c_str(), nullptr, 10) : 0;
+    String body;
+    uint32_t next;
+    TraceLog::toText(since, body, next);
+    server.sendHeader("X-Trace-Next", String(next));
+    server.sendHeader("X-Trace-Dropped", String(TraceLog::getDropped()));
+    server.send(200, "text/plain", body);
+}
+
+// Nơi bị treo ở lần reset trước (breadcrumb RTC) và ngân sách/SLO từng bước
+void AppWebServer::handleSystemHangs()
+{
+    JsonDocument doc;
+    HangDetector::report(&doc);
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+// =========================================================
+// API Capture (ghi / phát lại trace)
+// =========================================================
+
+void AppWebServer::handleCaptureStatus()
+{
+    JsonDocument doc;
+    Capture::getStatus(&doc);
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+// ?action=record|replay|stop &name=<tên trace> (chữ, số, '_' và '-')
+void AppWebServer::handleCaptureControl()
+{
+    sendCORSHeaders();
+    String action = server.arg("action");
+    String name = server.arg("name");
+
+    bool ok;
+    if (action == "stop")
+    {
+        Capture::stop();
+        ok = true;
+    }
+    else if (action != "record" && action != "replay")
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"action phải là record, replay hoặc stop\"}");
+        return;
+    }
+    else if (!Capture::validName(name.c_str()))
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Tên trace không hợp lệ\"}");
+        return;
+    }
+    else if (action == "record")
+        ok = Capture::startRecording(name.c_str());
+    else
+        ok = Capture::startReplay(name.c_str());
+
+    if (!ok)
+    {
+        server.send(409, "application/json", "{\"status\":\"error\", \"message\":\"Không thể bắt đầu (đang chạy, thiếu SD hoặc file hỏng)\"}");
+        return;
+    }
+    server.send(200, "application/json", "{\"status\":\"success\"}");
+}
+
+// Tải file trace về máy (tools/capture_trace.py)
+void AppWebServer::handleCaptureFile()
+{
+    String name = server.arg("name");
+    if (!Capture::validName(name.c_str()))
+    {
+        sendCORSHeaders();
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Tên trace không hợp lệ\"}");
+        return;
+    }
+
+    char path[FILE_PATH_MAX];
+    Capture::pathFor(name.c_str(), path, sizeof(path));
+    if (!streamFile(path, "application/octet-stream"))
+    {
+        sendCORSHeaders();
+        server.send(404, "application/json", "{\"status\":\"error\", \"message\":\"Không có trace này\"}");
+    }
+}
+
+// =========================================================
+// API Hẹn giờ
+// =========================================================
+
+void AppWebServer::handleScheduleStatus()
+{
+    JsonDocument doc;
+    scheduleEngine->getStatus(&doc);
+
+    String response;
+    serializeJson(doc, response);
+    sendCORSHeaders();
+    server.send(200, "application/json", response);
+}
+
+// ?tz_offset_min=420 (UTC+7)
+void AppWebServer::handleScheduleSettings()
+{
+    sendCORSHeaders();
+    int offset = server.arg("tz_offset_min").toInt();
+    if (!server.hasArg("tz_offset_min") || offset < -720 || offset > 840)
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"tz_offset_min không hợp lệ\"}");
+        return;
+    }
+    scheduleEngine->setTimezone((int16_t)offset);
+    server.send(200, "application/json", "{\"status\":\"success\"}");
+}
+
+// ?index=0&hour=6&minute=30&days=62&preset=2&volume=8&fade=60&duration=45&enabled=1
+// days: bit 0 = Chủ nhật; 0 = một lần
+void AppWebServer::handleScheduleAlarm()
+{
+    sendCORSHeaders();
+    if (!server.hasArg("index") || !server.hasArg("hour") || !server.hasArg("minute"))
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Thiếu index/hour/minute\"}");
+        return;
+    }
+
+    ScheduleAlarm alarm;
+    alarm.enabled = server.hasArg("enabled") ? server.arg("enabled").toInt() != 0 : 1;
+    alarm.days = (uint8_t)server.arg("days").toInt();
+    alarm.hour = (uint8_t)server.arg("hour").toInt();
+    alarm.minute = (uint8_t)server.arg("minute").toInt();
+    alarm.preset = (uint8_t)server.arg("preset").toInt();
+    alarm.volume = server.hasArg("volume") ? (uint8_t)server.arg("volume").toInt() : 8;
+    alarm.fadeSec = server.hasArg("fade") ? (uint16_t)server.arg("fade").toInt() : 60;
+    alarm.durationMin = (uint16_t)server.arg("duration").toInt();
+
+    if (!scheduleEngine->setAlarm((uint8_t)server.arg("index").toInt(), alarm))
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Báo thức không hợp lệ\"}");
+        return;
+    }
+    server.send(200, "application/json", "{\"status\":\"success\"}");
+}
+
+// ?minutes=30&fade=60 — hết giờ: giảm dần âm lượng, tắt tuner/amp/Wi-Fi và deep sleep
+void AppWebServer::handleScheduleSleep()
+{
+    sendCORSHeaders();
+    if (!server.hasArg("minutes"))
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Thiếu tham số minutes\"}");
+        return;
+    }
+    uint16_t fade = server.hasArg("fade") ? (uint16_t)server.arg("fade").toInt() : 60;
+    scheduleEngine->setSleepTimer((uint32_t)server.arg("minutes").toInt(), fade);
+    server.send(200, "application/json", "{\"status\":\"success\"}");
+}
+
 // ---------------------------------------------------------
 // CORS và MIME helpers
 // ---------------------------------------------------------
@@ -288,27 +901,8 @@ void AppWebServer::sendCORSHeaders()
 
 const char *AppWebServer::getContentType(const String &path)
 {
-    if (path.endsWith(".htm") || path.endsWith(".html"))
-        return "text/html";
-    if (path.endsWith(".css"))
-        return "text/css";
-    if (path.endsWith(".js"))
-        return "application/javascript";
-    if (path.endsWith(".png"))
-        return "image/png";
-    if (path.endsWith(".jpg") || path.endsWith(".jpeg"))
-        return "image/jpeg";
-    if (path.endsWith(".gif"))
-        return "image/gif";
-    if (path.endsWith(".svg"))
-        return "image/svg+xml";
-    if (path.endsWith(".ico"))
-        return "image/x-icon";
-    if (path.endsWith(".json"))
-        return "application/json";
-    if (path.endsWith(".txt"))
-        return "text/plain";
-    return "application/octet-stream";
+    // Bảng MIME dùng chung với manifest /ui
+    return UiManifest::mimeType(UiManifest::mimeIndex(path.c_str()));
 }
 
 void AppWebServer::handleFmPower()
@@ -320,13 +914,13 @@ void AppWebServer::handleFmPower()
         if (state == "on")
         {
             // Initialize and power on FM radio hardware
-            fmRadio->begin();
+            radioController->apply({RADIO_CMD_POWER, 1}, RADIO_SRC_HTTP);
             server.send(200, "application/json", "{\"status\":\"success\", \"powered\":true}");
             return;
         }
         else if (state == "off")
         {
-            fmRadio->powerOff();
+            radioController->apply({RADIO_CMD_POWER, 0}, RADIO_SRC_HTTP);
             server.send(200, "application/json", "{\"status\":\"success\", \"powered\":false}");
             return;
         }
@@ -342,33 +936,44 @@ void AppWebServer::handleFmSeek()
         String dir = server.arg("direction");
         if (dir == "up")
         {
-            fmRadio->seekUp();
+            radioController->apply({RADIO_CMD_SEEK_UP, 0}, RADIO_SRC_HTTP);
         }
         else if (dir == "down")
         {
-            fmRadio->seekDown();
+            radioController->apply({RADIO_CMD_SEEK_DOWN, 0}, RADIO_SRC_HTTP);
         }
         else if (dir == "next")
         {
-            fmRadio->autoSeekNext();
+            radioController->apply({RADIO_CMD_SEEK_NEXT, 0}, RADIO_SRC_HTTP);
         }
         else
         {
             server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Tham số direction không hợp lệ (up/down/next)\"}");
             return;
         }
-        server.send(200, "application/json", "{\"status\":\"success\", \"freq\":" + String(fmRadio->getCurrentFrequency(), 1) + "}");
+        sendChannelResponse(fmRadio->getCurrentChannel());
         return;
     }
     server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Thiếu tham số direction (up/down/next)\"}");
 }
 
+// Phản hồi {"status":"success", <extra>"freq":99.5} không qua float/String
+void AppWebServer::sendChannelResponse(Channel channel, const char *extra)
+{
+    char freq[CHANNEL_STR_LEN];
+    channel.format(freq);
+
+    char body[128];
+    snprintf(body, sizeof(body), "{\"status\":\"success\", %s\"freq\":%s}", extra, freq);
+    server.send(200, "application/json", body);
+}
+
 void AppWebServer::handleFmSaveChannel()
 {
     sendCORSHeaders();
-    float currentFreq = fmRadio->getCurrentFrequency();
-    fmRadio->saveChannel(currentFreq);
-    server.send(200, "application/json", "{\"status\":\"success\", \"message\":\"Đã lưu kênh\", \"freq\":" + String(currentFreq, 1) + "}");
+    Channel current = fmRadio->getCurrentChannel();
+    fmRadio->saveChannel(current);
+    sendChannelResponse(current, "\"message\":\"Đã lưu kênh\", ");
 }
 
 void AppWebServer::handleFmSelectChannel()
@@ -377,8 +982,8 @@ void AppWebServer::handleFmSelectChannel()
     if (server.hasArg("index"))
     {
         int index = server.arg("index").toInt();
-        fmRadio->selectSavedChannel(index);
-        server.send(200, "application/json", "{\"status\":\"success\", \"freq\":" + String(fmRadio->getCurrentFrequency(), 1) + "}");
+        radioController->apply({RADIO_CMD_PRESET, index}, RADIO_SRC_HTTP);
+        sendChannelResponse(fmRadio->getCurrentChannel());
         return;
     }
     server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Thiếu tham số index\"}");
@@ -398,15 +1003,12 @@ void AppWebServer::handleFmLoadChannels()
 void AppWebServer::handleFmSetFreq()
 {
     sendCORSHeaders();
-    if (server.hasArg("freq"))
+    Channel channel;
+    if (server.hasArg("freq") && Channel::parse(server.arg("freq").c_str(), channel) &&
+        radioController->apply({RADIO_CMD_TUNE, channel.code()}, RADIO_SRC_HTTP))
     {
-        float freq = server.arg("freq").toFloat();
-        if (freq >= 87.0 && freq <= 108.0)
-        {
-            fmRadio->setFrequency(freq);
-            server.send(200, "application/json", "{\"status\":\"success\", \"freq\":" + String(fmRadio->getCurrentFrequency(), 1) + "}");
-            return;
-        }
+        sendChannelResponse(fmRadio->getCurrentChannel());
+        return;
     }
     server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Tần số không hợp lệ (87.0-108.0)\"}");
 }
@@ -414,10 +1016,8 @@ void AppWebServer::handleFmSetFreq()
 void AppWebServer::handleFmVolume()
 {
     sendCORSHeaders();
-    if (server.hasArg("level"))
+    if (server.hasArg("level") && radioController->apply({RADIO_CMD_VOLUME, (int32_t)server.arg("level").toInt()}, RADIO_SRC_HTTP))
     {
-        int level = server.arg("level").toInt();
-        fmRadio->setVolume(level);
         server.send(200, "application/json", "{\"status\":\"success\", \"volume\":" + String(fmRadio->getVolume()) + "}");
         return;
     }
@@ -435,4 +1035,89 @@ void AppWebServer::handleFmDeleteChannel()
         return;
     }
     server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Thiếu tham số index\"}");
-}
\ No newline at end of file
+}
+
+// Lịch sử RSSI/stereo dạng cột: ?tier=sec|min|hour (mặc định sec)
+void AppWebServer::handleFmHistory()
+{
+    SignalTier tier = SIGNAL_TIER_SEC;
+    if (server.hasArg("tier") && !SignalMonitor::parseTier(server.arg("tier").c_str(), tier))
+    {
+        sendCORSHeaders();
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"tier phải là sec/min/hour\"}");
+        return;
+    }
+
+    sendCORSHeaders();
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+
+    char chunk[512];
+    fmRadio->getSignalMonitor().renderHistory(tier, chunk, sizeof(chunk), [](const char *data, size_t len, void *ctx)
+                                              { static_cast<WebServer *>(ctx)->sendContent(data, len); }, &server);
+    server.sendContent("");
+}
+
+// RDS: client gửi lại version đã biết (since), nếu chưa đổi trả 304 không có body
+void AppWebServer::handleFmRds()
+{
+    sendCORSHeaders();
+    if (server.hasArg("since") && (uint32_t)server.arg("since").toInt() == fmRadio->getRdsVersion())
+    {
+        server.send(304, "application/json", "");
+        return;
+    }
+
+    JsonDocument doc;
+    fmRadio->getRdsStatus(&doc);
+
+    String output;
+    serializeJson(doc, output);
+    server.send(200, "application/json", output);
+}
+
+// Danh sách toàn bộ đài đã lưu trong stations.bin, bench=1 để đo binary vs JSON
+void AppWebServer::handleFmStations()
+{
+    sendCORSHeaders();
+    JsonDocument doc;
+    if (server.hasArg("bench"))
+    {
+        fmRadio->benchmarkStations(&doc);
+    }
+    else
+    {
+        fmRadio->getStations(&doc);
+    }
+
+    String output;
+    serializeJson(doc, output);
+    server.send(200, "application/json", output);
+}
+
+// =========================================================
+// API Nhóm đa phòng (GroupSync)
+// =========================================================
+void AppWebServer::handleGroupStatus()
+{
+    sendCORSHeaders();
+    JsonDocument doc;
+    groupSync->getStatus(&doc);
+
+    String output;
+    serializeJson(doc, output);
+    server.send(200, "application/json", output);
+}
+
+void AppWebServer::handleGroupMode()
+{
+    sendCORSHeaders();
+    if (!server.hasArg("enabled"))
+    {
+        server.send(400, "application/json", "{\"status\":\"error\", \"message\":\"Thiếu tham số enabled (0/1)\"}");
+        return;
+    }
+    groupSync->setEnabled(server.arg("enabled").toInt() != 0);
+    server.send(200, "application/json", groupSync->isEnabled() ? "{\"status\":\"success\", \"enabled\":true}"
+                                                                 : "{\"status\":\"success\", \"enabled\":false}");
+}
@@ -0,0 +1,166 @@
+#include "AudioRingBuffer.h"
+
+// =========================================================
+// Constructor / Allocation
+// =========================================================
+AudioRingBuffer::AudioRingBuffer()
+    : buffer(nullptr), capacityFrames(0), mask(0), head(0), tail(0),
+      underruns(0), overruns(0), droppedFrames(0),
+      lowMark(0), highMark(0), watermarkCb(nullptr), watermarkCtx(nullptr),
+      highSignaled(false), lowSignaled(false)
+{
+}
+
+AudioRingBuffer::~AudioRingBuffer()
+{
+    end();
+}
+
+bool AudioRingBuffer::begin(size_t frames)
+{
+    end();
+
+    // Round up to a power of two so wrap-around is a mask instead of a modulo
+    size_t cap = 1;
+    while (cap < frames)
+        cap <<= 1;
+
+    buffer = (int16_t *)malloc(cap * 2 * sizeof(int16_t));
+    if (!buffer)
+    {
+        Serial.println("AudioRingBuffer: Allocation failed.");
+        return false;
+    }
+
+    capacityFrames = cap;
+    mask = cap - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void AudioRingBuffer::end()
+{
+    if (buffer)
+    {
+        free(buffer);
+        buffer = nullptr;
+    }
+    capacityFrames = 0;
+    mask = 0;
+}
+
+void AudioRingBuffer::setWatermarks(size_t lowFrames, size_t highFrames, WatermarkCallback cb, void *ctx)
+{
+    lowMark = lowFrames;
+    highMark = highFrames;
+    watermarkCtx = ctx;
+    watermarkCb = cb;
+}
+
+// =========================================================
+// Fill Level
+// =========================================================
+size_t AudioRingBuffer::available() const
+{
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+size_t AudioRingBuffer::freeSpace() const
+{
+    return capacityFrames - available();
+}
+
+// =========================================================
+// Producer
+// =========================================================
+size_t AudioRingBuffer::write(const int16_t *pcm, size_t frames)
+{
+    if (!buffer)
+        return 0;
+
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+    size_t space = capacityFrames - (h - t);
+
+    size_t n = frames;
+    if (n > space)
+    {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames.fetch_add(n - space, std::memory_order_relaxed);
+        n = space;
+    }
+
+    // Copy in at most two runs (before and after the wrap point)
+    size_t start = h & mask;
+    size_t first = capacityFrames - start;
+    if (first > n)
+        first = n;
+    memcpy(&buffer[start * 2], pcm, first * 2 * sizeof(int16_t));
+    if (n > first)
+        memcpy(&buffer[0], &pcm[first * 2], (n - first) * 2 * sizeof(int16_t));
+
+    head.store(h + n, std::memory_order_release);
+
+    size_t fill = (h + n) - t;
+    if (fill >= highMark && highMark > 0)
+    {
+        if (!highSignaled && watermarkCb)
+            watermarkCb(WATERMARK_HIGH, fill, watermarkCtx);
+        highSignaled = true;
+    }
+    else
+    {
+        highSignaled = false;
+    }
+    return n;
+}
+
+// =========================================================
+// Consumer
+// =========================================================
+size_t AudioRingBuffer::read(int16_t *pcm, size_t frames)
+{
+    if (!buffer)
+        return 0;
+
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+    size_t fill = h - t;
+
+    size_t n = frames;
+    if (n > fill)
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+        n = fill;
+    }
+
+    size_t start = t & mask;
+    size_t first = capacityFrames - start;
+    if (first > n)
+        first = n;
+    memcpy(pcm, &buffer[start * 2], first * 2 * sizeof(int16_t));
+    if (n > first)
+        memcpy(&pcm[first * 2], &buffer[0], (n - first) * 2 * sizeof(int16_t));
+
+    tail.store(t + n, std::memory_order_release);
+
+    fill -= n;
+    if (fill <= lowMark)
+    {
+        if (!lowSignaled && watermarkCb)
+            watermarkCb(WATERMARK_LOW, fill, watermarkCtx);
+        lowSignaled = true;
+    }
+    else
+    {
+        lowSignaled = false;
+    }
+    return n;
+}
+
+void AudioRingBuffer::flush()
+{
+    // Consumer-side: catch the tail up with whatever the producer has published
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
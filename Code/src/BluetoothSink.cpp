@@ -0,0 +1,192 @@
+#include "BluetoothSink.h"
+#include <esp_bt_main.h>
+#include <esp_bt_device.h>
+#include <esp_gap_bt_api.h>
+
+BluetoothSink *BluetoothSink::instance = nullptr;
+
+// =========================================================
+// Constructor / Initialization
+// =========================================================
+BluetoothSink::BluetoothSink(AudioRingBuffer *ring, I2SAudioOutput *output)
+    : ring(ring), output(output), task(nullptr), wanted(false), ready(false), connected(false), streaming(false),
+      pendingRate(0), lastEnableMs(0), lastDisableMs(0)
+{
+}
+
+bool BluetoothSink::begin()
+{
+    instance = this;
+    if (!ring->begin(AUDIO_RING_FRAMES))
+    {
+        Serial.println("Bluetooth: Failed to allocate the PCM ring.");
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(taskEntry, "bt_power", 4096, this, BT_TASK_PRIORITY, &task, BT_TASK_CORE) != pdPASS)
+    {
+        Serial.println("Bluetooth: Failed to start worker task.");
+        return false;
+    }
+    return true;
+}
+
+void BluetoothSink::enable()
+{
+    wanted.store(true);
+    if (task)
+        xTaskNotifyGive(task);
+}
+
+void BluetoothSink::disable()
+{
+    wanted.store(false);
+    if (task)
+        xTaskNotifyGive(task);
+}
+
+void BluetoothSink::poll()
+{
+    uint32_t rate = pendingRate.exchange(0);
+    if (rate && output->setSampleRate(rate))
+        Serial.printf("Bluetooth: Stream at %lu Hz\n", (unsigned long)rate);
+}
+
+// =========================================================
+// Worker: stack bring-up / teardown
+// =========================================================
+void BluetoothSink::taskEntry(void *arg)
+{
+    static_cast<BluetoothSink *>(arg)->run();
+}
+
+void BluetoothSink::run()
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Requests may flip while a bring-up is running; settle on the last one
+        while (wanted.load() != ready.load())
+        {
+            uint32_t start = millis();
+            if (wanted.load())
+            {
+                if (startStack())
+                {
+                    ready.store(true);
+                    lastEnableMs = millis() - start;
+                    Serial.printf("Bluetooth: Discoverable as \"%s\" (%lu ms)\n", BT_DEVICE_NAME,
+                                  (unsigned long)lastEnableMs);
+                }
+                else
+                {
+                    Serial.println("Bluetooth: Stack start failed.");
+                    stopStack();
+                    wanted.store(false);
+                }
+            }
+            else
+            {
+                ready.store(false);
+                stopStack();
+                lastDisableMs = millis() - start;
+                Serial.printf("Bluetooth: Off (%lu ms)\n", (unsigned long)lastDisableMs);
+            }
+        }
+    }
+}
+
+bool BluetoothSink::startStack()
+{
+    if (!btStartMode(BT_MODE_CLASSIC_BT))
+        return false;
+    if (esp_bluedroid_init() != ESP_OK || esp_bluedroid_enable() != ESP_OK)
+        return false;
+
+    esp_bt_dev_set_device_name(BT_DEVICE_NAME);
+    esp_a2d_register_callback(onA2dpEvent);
+    esp_a2d_sink_register_data_callback(onAudioData);
+    if (esp_a2d_sink_init() != ESP_OK)
+        return false;
+
+    // The output waits for its jitter buffer, so it can start before a phone connects
+    if (!output->begin(output->getSampleRate()))
+        return false;
+    esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
+    return true;
+}
+
+// Safe on a partly started stack: every step tolerates "not running"
+void BluetoothSink::stopStack()
+{
+    output->end();
+    esp_a2d_sink_deinit();
+    esp_bluedroid_disable();
+    esp_bluedroid_deinit();
+    btStop();
+
+    // The output task is gone, so this task may act as the consumer
+    ring->flush();
+    connected.store(false);
+    streaming.store(false);
+}
+
+// =========================================================
+// Bluedroid callbacks (BTC task)
+// =========================================================
+void BluetoothSink::onA2dpEvent(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param)
+{
+    if (!instance)
+        return;
+
+    switch (event)
+    {
+    case ESP_A2D_CONNECTION_STATE_EVT:
+        instance->connected.store(param->conn_stat.state == ESP_A2D_CONNECTION_STATE_CONNECTED);
+        break;
+
+    case ESP_A2D_AUDIO_STATE_EVT:
+        instance->streaming.store(param->audio_stat.state == ESP_A2D_AUDIO_STATE_STARTED);
+        break;
+
+    case ESP_A2D_AUDIO_CFG_EVT:
+        if (param->audio_cfg.mcc.type == ESP_A2D_MCT_SBC)
+        {
+            // SBC codec info, octet 0: sampling frequency bits
+            uint8_t oct0 = param->audio_cfg.mcc.cie.sbc[0];
+            uint32_t rate = (oct0 & 0x40) ? 32000 : (oct0 & 0x20) ? 44100 : (oct0 & 0x10) ? 48000 : 16000;
+            instance->pendingRate.store(rate);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// 16-bit stereo PCM, already decoded
+void BluetoothSink::onAudioData(const uint8_t *data, uint32_t len)
+{
+    if (instance)
+        instance->ring->write((const int16_t *)data, len / (2 * sizeof(int16_t)));
+}
+
+// =========================================================
+// Status
+// =========================================================
+void BluetoothSink::getStatus(JsonDocument *doc)
+{
+    JsonObject bt = (*doc)["bluetooth"].to<JsonObject>();
+    bt["name"] = BT_DEVICE_NAME;
+    bt["enabled"] = wanted.load();
+    bt["ready"] = ready.load();
+    bt["connected"] = connected.load();
+    bt["streaming"] = streaming.load();
+    bt["sample_rate"] = output->getSampleRate();
+    bt["enable_ms"] = lastEnableMs;
+    bt["disable_ms"] = lastDisableMs;
+    bt["buffered_frames"] = ring->available();
+    bt["jitter_target"] = output->getJitterTarget();
+    bt["underruns"] = output->getUnderruns();
+    bt["overruns"] = ring->getOverruns();
+}
@@ -0,0 +1,79 @@
+#include "BootProfiler.h"
+
+BootProfiler::Phase BootProfiler::phases[BOOT_MAX_PHASES];
+std::atomic<uint8_t> BootProfiler::count(0);
+
+// =========================================================
+// Phase Timing
+// =========================================================
+int BootProfiler::start(const char *name)
+{
+    // Boot steps run in parallel tasks: reserve the slot atomically
+    uint8_t id = count.fetch_add(1);
+    if (id >= BOOT_MAX_PHASES)
+        return -1;
+
+    Phase &p = phases[id];
+    p.startUs = micros();
+    p.endUs = 0;
+    p.name = name;
+    return id;
+}
+
+void BootProfiler::end(int id)
+{
+    if (id < 0 || id >= BOOT_MAX_PHASES)
+        return;
+    phases[id].endUs = micros();
+}
+
+void BootProfiler::mark(const char *name)
+{
+    int id = start(name);
+    if (id >= 0)
+        phases[id].endUs = phases[id].startUs;
+}
+
+uint8_t BootProfiler::recorded()
+{
+    uint8_t n = count.load();
+    return n > BOOT_MAX_PHASES ? BOOT_MAX_PHASES : n;
+}
+
+// =========================================================
+// Report
+// =========================================================
+void BootProfiler::report()
+{
+    Serial.println("BootProfiler: phase            start(ms)  took(ms)");
+    for (uint8_t i = 0; i < recorded(); i++)
+    {
+        const Phase &p = phases[i];
+        if (!p.name)
+            continue;
+        if (p.endUs == 0)
+        {
+            Serial.printf("BootProfiler: %-16s %9.1f   running\n", p.name, p.startUs / 1000.0f);
+            continue;
+        }
+        Serial.printf("BootProfiler: %-16s %9.1f %9.1f\n", p.name, p.startUs / 1000.0f,
+                      (p.endUs - p.startUs) / 1000.0f);
+    }
+}
+
+void BootProfiler::toJson(JsonDocument *doc)
+{
+    JsonArray list = (*doc)["phases"].to<JsonArray>();
+    for (uint8_t i = 0; i < recorded(); i++)
+    {
+        const Phase &p = phases[i];
+        if (!p.name)
+            continue;
+
+        JsonObject phase = list.add<JsonObject>();
+        phase["name"] = p.name;
+        phase["start_us"] = p.startUs;
+        if (p.endUs != 0)
+            phase["took_us"] = p.endUs - p.startUs;
+    }
+}
@@ -0,0 +1,104 @@
+#include "BootSequencer.h"
+#include "BootProfiler.h"
+
+// =========================================================
+// Constructor / Registration
+// =========================================================
+BootSequencer::BootSequencer() : count(0), done(nullptr)
+{
+}
+
+uint32_t BootSequencer::add(const char *name, StepFn fn, uint32_t deps)
+{
+    if (count >= BOOT_MAX_STEPS)
+    {
+        Serial.printf("BootSequencer: Too many steps, '%s' dropped.\n", name);
+        return 0;
+    }
+
+    uint32_t known = (1UL << count) - 1;
+    if (deps & ~known)
+    {
+        Serial.printf("BootSequencer: '%s' depends on an unknown step.\n", name);
+        deps &= known;
+    }
+
+    Step &s = steps[count];
+    s.name = name;
+    s.fn = fn;
+    s.deps = deps;
+    s.bit = 1UL << count;
+    s.owner = this;
+    count++;
+    return s.bit;
+}
+
+// =========================================================
+// Execution
+// =========================================================
+void BootSequencer::start()
+{
+    done = xEventGroupCreate();
+    xTaskCreate(coordinatorTask, "boot", 4096, this, 2, nullptr);
+}
+
+void BootSequencer::waitFor(uint32_t bits)
+{
+    // start() may not have created the group yet if called very early
+    while (!done)
+        delay(1);
+    xEventGroupWaitBits(done, bits, pdFALSE, pdTRUE, portMAX_DELAY);
+}
+
+bool BootSequencer::isDone(uint32_t bits) const
+{
+    return done && (xEventGroupGetBits(done) & bits) == bits;
+}
+
+void BootSequencer::coordinatorTask(void *arg)
+{
+    static_cast<BootSequencer *>(arg)->coordinate();
+    vTaskDelete(nullptr);
+}
+
+void BootSequencer::stepTask(void *arg)
+{
+    Step *step = static_cast<Step *>(arg);
+    int phase = BootProfiler::start(step->name);
+    step->fn();
+    BootProfiler::end(phase);
+    xEventGroupSetBits(step->owner->done, step->bit);
+    vTaskDelete(nullptr);
+}
+
+void BootSequencer::coordinate()
+{
+    uint32_t all = (1UL << count) - 1;
+    uint32_t started = 0;
+    uint32_t finished = 0;
+
+    while (finished != all)
+    {
+        // Launch everything whose dependencies are satisfied
+        for (uint8_t i = 0; i < count; i++)
+        {
+            Step &s = steps[i];
+            if ((started & s.bit) || (s.deps & ~finished))
+                continue;
+
+            started |= s.bit;
+            if (xTaskCreate(stepTask, s.name, BOOT_STEP_STACK, &s, 1, nullptr) != pdPASS)
+            {
+                // Out of memory for another task: run it here instead
+                Serial.printf("BootSequencer: Running '%s' inline.\n", s.name);
+                stepTask(&s);
+            }
+        }
+
+        // Sleep until any running step finishes
+        xEventGroupWaitBits(done, started & ~finished, pdFALSE, pdFALSE, portMAX_DELAY);
+        finished = xEventGroupGetBits(done) & all;
+    }
+
+    BootProfiler::report();
+}
@@ -0,0 +1,464 @@
+#include "Capture.h"
+#include "Constants.h"
+
+#define CAPTURE_MAGIC "FMCP"
+#define CAPTURE_VERSION 1
+#define EVENT_HEADER_BYTES 6 // type, length, time
+
+static_assert(sizeof(CaptureHeader) == 48, "CaptureHeader layout is shared with tools/capture_trace.py");
+static_assert((CAPTURE_RING_BYTES & (CAPTURE_RING_BYTES - 1)) == 0, "CAPTURE_RING_BYTES must be a power of two");
+
+FileManager *Capture::fileManager = nullptr;
+std::atomic<bool> Capture::recording(false);
+bool Capture::replaying = false;
+bool Capture::internalIo = false;
+
+portMUX_TYPE Capture::ringLock = portMUX_INITIALIZER_UNLOCKED;
+uint8_t Capture::ring[CAPTURE_RING_BYTES];
+uint32_t Capture::ringHead = 0;
+uint32_t Capture::ringTail = 0;
+uint32_t Capture::ringHighWater = 0;
+uint32_t Capture::droppedBytes = 0;
+uint32_t Capture::droppedReported = 0;
+
+File Capture::out;
+char Capture::recordName[CAPTURE_NAME_MAX + 1] = "";
+uint32_t Capture::startUs = 0;
+uint32_t Capture::bytesWritten = 0;
+uint32_t Capture::lastDrainMs = 0;
+uint32_t Capture::eventCounts[CAP_DROPPED + 1];
+
+File Capture::in;
+char Capture::replayName[CAPTURE_NAME_MAX + 1] = "";
+uint32_t Capture::replayStartUs = 0;
+bool Capture::replayPending = false;
+bool Capture::replayEof = false;
+uint8_t Capture::pendingType = 0;
+uint32_t Capture::pendingUs = 0;
+Capture::TunerResult Capture::pending;
+Capture::TunerQueue<64> Capture::blocks;
+Capture::TunerQueue<16> Capture::registers;
+Capture::TunerQueue<64> Capture::stcPolls;
+
+template <uint8_t N>
+bool Capture::TunerQueue<N>::push(const TunerResult &r)
+{
+    if (count == N)
+        return false;
+    items[(head + count) % N] = r;
+    count++;
+    return true;
+}
+
+template <uint8_t N>
+bool Capture::TunerQueue<N>::pop(TunerResult &r)
+{
+    if (!count)
+    {
+        underflows++;
+        return false;
+    }
+    r = items[head];
+    head = (head + 1) % N;
+    count--;
+    fed++;
+    return true;
+}
+
+void Capture::begin(FileManager *fm)
+{
+    fileManager = fm;
+}
+
+bool Capture::validName(const char *name)
+{
+    size_t len = strlen(name);
+    if (len == 0 || len > CAPTURE_NAME_MAX)
+        return false;
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = name[i];
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-')
+            return false;
+    }
+    return true;
+}
+
+void Capture::pathFor(const char *name, char *path, size_t size)
+{
+    snprintf(path, size, CAPTURE_DIR "/%s.bin", name);
+}
+
+// =========================================================
+// Recording
+// =========================================================
+bool Capture::startRecording(const char *name)
+{
+    if (!fileManager || !validName(name) || isRecording())
+        return false;
+
+    char path[FILE_PATH_MAX];
+    pathFor(name, path, sizeof(path));
+    internalIo = true;
+    fileManager->makeDir(CAPTURE_DIR);
+    out = fileManager->openFile(path, FILE_WRITE);
+    internalIo = false;
+    if (!out)
+        return false;
+
+    portENTER_CRITICAL(&ringLock);
+    ringHead = ringTail = 0;
+    portEXIT_CRITICAL(&ringLock);
+    ringHighWater = 0;
+    droppedBytes = droppedReported = 0;
+    memset(eventCounts, 0, sizeof(eventCounts));
+
+    CaptureHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAPTURE_MAGIC, 4);
+    header.version = CAPTURE_VERSION;
+    header.headerSize = sizeof(header);
+    startUs = micros();
+    header.startUs = startUs;
+    header.startMs = millis();
+    header.freeHeap = ESP.getFreeHeap();
+    snprintf(header.build, sizeof(header.build), "%s %s", __DATE__, __TIME__);
+    out.write((const uint8_t *)&header, sizeof(header));
+
+    bytesWritten = sizeof(header);
+    lastDrainMs = millis();
+    strncpy(recordName, name, CAPTURE_NAME_MAX);
+    recordName[CAPTURE_NAME_MAX] = '\0';
+    recording.store(true, std::memory_order_release);
+    Serial.printf("Capture: Recording to %s\n", path);
+    return true;
+}
+
+void Capture::stop()
+{
+    if (isRecording())
+    {
+        recording.store(false, std::memory_order_release);
+        drain(true);
+        out.close();
+        Serial.printf("Capture: Stopped, %lu bytes, %lu dropped\n", (unsigned long)bytesWritten,
+                      (unsigned long)droppedBytes);
+    }
+    if (replaying)
+    {
+        replaying = false;
+        in.close();
+        Serial.println("Capture: Replay stopped");
+    }
+}
+
+// One event into the ring; dropped (and counted) if it does not fit
+void Capture::append(uint8_t type, uint32_t timeUs, const void *payload, uint8_t len, const char *text, uint8_t textLen)
+{
+    uint8_t header[EVENT_HEADER_BYTES];
+    uint32_t rel = timeUs - startUs;
+    header[0] = type;
+    header[1] = len + textLen;
+    memcpy(header + 2, &rel, 4);
+
+    const uint8_t *parts[3] = {header, (const uint8_t *)payload, (const uint8_t *)text};
+    const uint32_t sizes[3] = {EVENT_HEADER_BYTES, len, textLen};
+    uint32_t total = EVENT_HEADER_BYTES + len + textLen;
+
+    portENTER_CRITICAL(&ringLock);
+    uint32_t used = ringHead - ringTail;
+    if (used + total > CAPTURE_RING_BYTES)
+    {
+        droppedBytes += total;
+        portEXIT_CRITICAL(&ringLock);
+        return;
+    }
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        for (uint32_t i = 0; i < sizes[p]; i++)
+            ring[(ringHead + i) & (CAPTURE_RING_BYTES - 1)] = parts[p][i];
+        ringHead += sizes[p];
+    }
+    if (used + total > ringHighWater)
+        ringHighWater = used + total;
+    eventCounts[type]++;
+    portEXIT_CRITICAL(&ringLock);
+}
+
+void Capture::request(uint8_t method, const char *text, uint32_t begin, uint32_t heapBefore)
+{
+    if (!isRecording())
+        return;
+    uint8_t payload[18];
+    uint32_t values[4] = {(uint32_t)(micros() - begin), heapBefore, ESP.getFreeHeap(), ESP.getMaxAllocHeap()};
+    payload[0] = method;
+    payload[1] = 0;
+    memcpy(payload + 2, values, sizeof(values));
+    size_t textLen = strnlen(text, CAPTURE_TEXT_MAX);
+    append(CAP_HTTP, begin, payload, sizeof(payload), text, (uint8_t)textLen);
+}
+
+void Capture::tunerBlock(const uint16_t regs[6], bool ok)
+{
+    if (!isRecording())
+        return;
+    uint8_t payload[14];
+    payload[0] = ok;
+    payload[1] = 0;
+    memcpy(payload + 2, regs, 12);
+    append(CAP_TUNER_BLOCK, micros(), payload, sizeof(payload));
+}
+
+void Capture::tunerRegister(uint8_t reg, uint16_t value, bool ok)
+{
+    if (!isRecording())
+        return;
+    uint8_t payload[4] = {reg, (uint8_t)ok};
+    memcpy(payload + 2, &value, 2);
+    append(CAP_TUNER_REG, micros(), payload, sizeof(payload));
+}
+
+void Capture::tunerStatus(uint16_t reg0a, uint16_t reg0b, bool ok)
+{
+    if (!isRecording())
+        return;
+    uint8_t payload[6] = {(uint8_t)ok, 0};
+    memcpy(payload + 2, &reg0a, 2);
+    memcpy(payload + 4, &reg0b, 2);
+    append(CAP_TUNER_STC, micros(), payload, sizeof(payload));
+}
+
+void Capture::file(CaptureFileOp op, const char *path, bool ok, uint32_t begin, uint32_t bytes)
+{
+    if (!isRecording() || internalIo)
+        return;
+    uint8_t payload[14];
+    uint32_t values[3] = {(uint32_t)(micros() - begin), bytes, ESP.getFreeHeap()};
+    payload[0] = op;
+    payload[1] = ok;
+    memcpy(payload + 2, values, sizeof(values));
+    size_t pathLen = strnlen(path, CAPTURE_TEXT_MAX);
+    append(CAP_FILE, begin, payload, sizeof(payload), path, (uint8_t)pathLen);
+}
+
+// =========================================================
+// Drain (loop task)
+// =========================================================
+void Capture::poll()
+{
+    if (isRecording())
+        drain(false);
+    if (replaying)
+        feedReplay();
+}
+
+void Capture::drain(bool all)
+{
+    if (droppedBytes != droppedReported)
+    {
+        // Tell the reader where the gap is
+        uint32_t lost = droppedBytes - droppedReported;
+        droppedReported = droppedBytes;
+        append(CAP_DROPPED, micros(), &lost, sizeof(lost));
+    }
+
+    portENTER_CRITICAL(&ringLock);
+    uint32_t head = ringHead;
+    portEXIT_CRITICAL(&ringLock);
+    uint32_t pendingBytes = head - ringTail;
+    if (!pendingBytes || (!all && pendingBytes < CAPTURE_DRAIN_BYTES && millis() - lastDrainMs < CAPTURE_DRAIN_INTERVAL_MS))
+        return;
+
+    // At most two writes: up to the end of the ring, then from its start
+    while (pendingBytes)
+    {
+        uint32_t offset = ringTail & (CAPTURE_RING_BYTES - 1);
+        uint32_t n = CAPTURE_RING_BYTES - offset < pendingBytes ? CAPTURE_RING_BYTES - offset : pendingBytes;
+        out.write(ring + offset, n);
+        portENTER_CRITICAL(&ringLock);
+        ringTail += n;
+        portEXIT_CRITICAL(&ringLock);
+        pendingBytes -= n;
+        bytesWritten += n;
+    }
+    out.flush();
+    lastDrainMs = millis();
+
+    if (isRecording() && bytesWritten >= CAPTURE_MAX_BYTES)
+    {
+        Serial.println("Capture: Size limit reached");
+        stop();
+    }
+}
+
+// =========================================================
+// Replay
+// =========================================================
+bool Capture::startReplay(const char *name)
+{
+    if (!fileManager || !validName(name) || replaying)
+        return false;
+
+    char path[FILE_PATH_MAX];
+    pathFor(name, path, sizeof(path));
+    internalIo = true;
+    in = fileManager->openFile(path);
+    internalIo = false;
+    if (!in)
+        return false;
+
+    CaptureHeader header;
+    if (in.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || memcmp(header.magic, CAPTURE_MAGIC, 4) != 0 ||
+        header.version != CAPTURE_VERSION)
+    {
+        in.close();
+        return false;
+    }
+    // Newer layouts may have a longer header
+    if (header.headerSize > sizeof(header))
+        in.seek(header.headerSize);
+
+    memset(&blocks, 0, sizeof(blocks));
+    memset(&registers, 0, sizeof(registers));
+    memset(&stcPolls, 0, sizeof(stcPolls));
+    replayStartUs = micros();
+    replayPending = false;
+    replayEof = false;
+    strncpy(replayName, name, CAPTURE_NAME_MAX);
+    replayName[CAPTURE_NAME_MAX] = '\0';
+    replaying = true;
+    Serial.printf("Capture: Replaying %s (recorded by %.24s)\n", path, header.build);
+    // loop() polls the radio before Capture: queue what is due now so the
+    // first sample does not fall through to the chip
+    feedReplay();
+    return true;
+}
+
+// Next tuner event from the trace into `pending`; other events are skipped
+bool Capture::readEvent()
+{
+    uint8_t header[EVENT_HEADER_BYTES];
+    uint8_t payload[255];
+    while (in.read(header, sizeof(header)) == sizeof(header))
+    {
+        uint8_t len = header[1];
+        if (in.read(payload, len) != len)
+            return false;
+        if (header[0] < CAP_TUNER_BLOCK || header[0] > CAP_TUNER_STC)
+            continue;
+
+        memset(&pending, 0, sizeof(pending));
+        pendingType = header[0];
+        memcpy(&pendingUs, header + 2, 4);
+        if (pendingType == CAP_TUNER_REG)
+        {
+            pending.reg = payload[0];
+            pending.ok = payload[1];
+            memcpy(pending.v, payload + 2, 2);
+        }
+        else
+        {
+            pending.ok = payload[0];
+            memcpy(pending.v, payload + 2, pendingType == CAP_TUNER_BLOCK ? 12 : 4);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Queue what is due within CAPTURE_REPLAY_LEAD_MS; a full queue waits
+void Capture::feedReplay()
+{
+    uint32_t horizonUs = micros() - replayStartUs + CAPTURE_REPLAY_LEAD_MS * 1000UL;
+    while (!replayEof)
+    {
+        if (!replayPending)
+        {
+            if (!readEvent())
+            {
+                replayEof = true;
+                break;
+            }
+            replayPending = true;
+        }
+        if (pendingUs > horizonUs)
+            break;
+        bool queued = pendingType == CAP_TUNER_BLOCK ? blocks.push(pending)
+                      : pendingType == CAP_TUNER_REG ? registers.push(pending)
+                                                     : stcPolls.push(pending);
+        if (!queued)
+            break;
+        replayPending = false;
+    }
+
+    if (replayEof && !blocks.count && !registers.count && !stcPolls.count)
+    {
+        replaying = false;
+        in.close();
+        Serial.printf("Capture: Replay of %s finished\n", replayName);
+    }
+}
+
+bool Capture::replayTunerBlock(uint16_t regs[6], bool &ok)
+{
+    TunerResult r;
+    if (!replaying || !blocks.pop(r))
+        return false;
+    memcpy(regs, r.v, 12);
+    ok = r.ok;
+    return true;
+}
+
+bool Capture::replayTunerRegister(uint8_t, uint16_t &value, bool &ok)
+{
+    TunerResult r;
+    if (!replaying || !registers.pop(r))
+        return false;
+    value = r.v[0];
+    ok = r.ok;
+    return true;
+}
+
+bool Capture::replayTunerStatus(uint16_t &reg0a, uint16_t &reg0b, bool &ok)
+{
+    TunerResult r;
+    if (!replaying || !stcPolls.pop(r))
+        return false;
+    reg0a = r.v[0];
+    reg0b = r.v[1];
+    ok = r.ok;
+    return true;
+}
+
+// =========================================================
+// Status
+// =========================================================
+void Capture::getStatus(JsonDocument *doc)
+{
+    JsonObject rec = (*doc)["recording"].to<JsonObject>();
+    rec["active"] = isRecording();
+    rec["name"] = recordName;
+    rec["bytes"] = bytesWritten;
+    rec["max_bytes"] = CAPTURE_MAX_BYTES;
+    rec["ring_high_water"] = ringHighWater;
+    rec["ring_bytes"] = CAPTURE_RING_BYTES;
+    rec["dropped_bytes"] = droppedBytes;
+    JsonObject events = rec["events"].to<JsonObject>();
+    events["http"] = eventCounts[CAP_HTTP];
+    events["tuner_block"] = eventCounts[CAP_TUNER_BLOCK];
+    events["tuner_reg"] = eventCounts[CAP_TUNER_REG];
+    events["tuner_stc"] = eventCounts[CAP_TUNER_STC];
+    events["file"] = eventCounts[CAP_FILE];
+
+    JsonObject rep = (*doc)["replay"].to<JsonObject>();
+    rep["active"] = replaying;
+    rep["name"] = replayName;
+    rep["elapsed_ms"] = replaying ? (micros() - replayStartUs) / 1000 : 0;
+    rep["eof"] = replayEof;
+    rep["blocks_fed"] = blocks.fed;
+    rep["block_underflows"] = blocks.underflows;
+    rep["registers_fed"] = registers.fed;
+    rep["register_underflows"] = registers.underflows;
+    rep["stc_fed"] = stcPolls.fed;
+    rep["stc_underflows"] = stcPolls.underflows;
+}
@@ -0,0 +1,153 @@
+#include "Channel.h"
+
+// =========================================================
+// Band Plan (RDA5807 BAND / SPACE register values)
+// =========================================================
+// Band: 0 = 87-108 MHz, 1 = 76-91 MHz, 2 = 76-108 MHz, 3 = 65-76 MHz
+static const uint16_t BAND_START[4] = {8700, 7600, 7600, 6500};
+static const uint16_t BAND_END[4] = {10800, 9100, 10800, 7600};
+// Space: 0 = 100 kHz, 1 = 200 kHz, 2 = 50 kHz, 3 = 25 kHz
+static const uint16_t SPACING_KHZ[4] = {100, 200, 50, 25};
+
+uint16_t Channel::bandStart(uint8_t band)
+{
+    return BAND_START[band & 0x03];
+}
+
+uint16_t Channel::bandEnd(uint8_t band)
+{
+    return BAND_END[band & 0x03];
+}
+
+uint16_t Channel::spacingKHz(uint8_t space)
+{
+    return SPACING_KHZ[space & 0x03];
+}
+
+// =========================================================
+// Conversion
+// =========================================================
+bool Channel::parse(const char *text, Channel &out)
+{
+    if (!text)
+        return false;
+
+    while (*text == ' ')
+        text++;
+
+    // Integer MHz part
+    uint32_t mhz = 0;
+    uint8_t intDigits = 0;
+    while (*text >= '0' && *text <= '9')
+    {
+        mhz = mhz * 10 + (*text++ - '0');
+        if (++intDigits > 3)
+            return false;
+    }
+
+    // Up to three fractional digits (kHz resolution), rounded to 10 kHz
+    uint32_t khz = 0;
+    uint8_t fracDigits = 0;
+    if (*text == '.')
+    {
+        text++;
+        while (*text >= '0' && *text <= '9')
+        {
+            if (fracDigits < 3)
+                khz = khz * 10 + (*text - '0');
+            fracDigits++;
+            text++;
+        }
+    }
+    while (*text == ' ')
+        text++;
+
+    if (*text != '\0' || (intDigits == 0 && fracDigits == 0))
+        return false;
+
+    for (uint8_t i = fracDigits; i < 3; i++)
+        khz *= 10;
+
+    uint32_t code = mhz * 100 + (khz + 5) / 10;
+    if (code == 0 || code > 0xFFFF)
+        return false;
+
+    out = Channel((uint16_t)code);
+    return true;
+}
+
+Channel Channel::fromMHz(float mhz)
+{
+    if (mhz <= 0.0f || mhz > 655.0f)
+        return Channel();
+    return Channel((uint16_t)(mhz * 100.0f + 0.5f));
+}
+
+// =========================================================
+// Validation
+// =========================================================
+bool Channel::inBand(uint8_t band) const
+{
+    return value >= bandStart(band) && value <= bandEnd(band);
+}
+
+bool Channel::isValid(uint8_t band, uint8_t space) const
+{
+    if (!inBand(band))
+        return false;
+    return (value - bandStart(band)) % rasterStep(space) == 0;
+}
+
+uint16_t Channel::rasterStep(uint8_t space)
+{
+    // 10 kHz units can't hold 87.025 MHz, so with space=3 (25 kHz) only
+    // the 50 kHz points are reachable.
+    uint16_t khz = spacingKHz(space);
+    return khz < 50 ? 5 : khz / 10;
+}
+
+uint16_t Channel::chipChannel(uint8_t band, uint8_t space) const
+{
+    return (uint16_t)((uint32_t)(value - bandStart(band)) * 10 / spacingKHz(space));
+}
+
+Channel Channel::fromChipChannel(uint16_t chan, uint8_t band, uint8_t space)
+{
+    return Channel(bandStart(band) + (uint16_t)((uint32_t)chan * spacingKHz(space) / 10));
+}
+
+Channel Channel::snapped(uint8_t band, uint8_t space) const
+{
+    uint16_t start = bandStart(band);
+    uint16_t end = bandEnd(band);
+    uint16_t step = rasterStep(space);
+    uint16_t v = value < start ? start : (value > end ? end : value);
+
+    uint16_t offset = (v - start + step / 2) / step * step;
+    if (start + offset > end)
+        offset -= step;
+    return Channel(start + offset);
+}
+
+// =========================================================
+// Formatting
+// =========================================================
+size_t Channel::format(char *buf) const
+{
+    // Plain digit arithmetic: no float, no printf
+    uint16_t mhz = value / 100;
+    uint8_t frac = value % 100;
+
+    char *p = buf;
+    if (mhz >= 100)
+        *p++ = '0' + mhz / 100;
+    if (mhz >= 10)
+        *p++ = '0' + (mhz / 10) % 10;
+    *p++ = '0' + mhz % 10;
+    *p++ = '.';
+    *p++ = '0' + frac / 10;
+    if (frac % 10 != 0)
+        *p++ = '0' + frac % 10;
+    *p = '\0';
+    return p - buf;
+}
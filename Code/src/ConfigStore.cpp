@@ -0,0 +1,212 @@
+#include "ConfigStore.h"
+#include "Channel.h"
+
+#define SNAPSHOT_MAGIC 0x47464346UL // "FCFG"
+
+struct SnapshotBlob
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t crc; // CRC-32 of `config`
+    RuntimeConfig config;
+};
+
+// =========================================================
+// Constructor
+// =========================================================
+ConfigStore::ConfigStore(FileManager *fm) : fileManager(fm), fromSnapshot(false), importPending(false)
+{
+    setDefaults();
+}
+
+void ConfigStore::setDefaults()
+{
+    memset(&config, 0, sizeof(config));
+    config.commonVolume = 50;
+    config.commonFreqCode = 9950;
+    strncpy(config.apSsid, "Famio_Setup_AP", sizeof(config.apSsid) - 1);
+    strncpy(config.apPass, "12345678", sizeof(config.apPass) - 1);
+    config.fmVolume = 10;
+    config.fmChannelCode = 9950;
+}
+
+// =========================================================
+// Boot Path
+// =========================================================
+void ConfigStore::begin()
+{
+    uint32_t start = micros();
+    if (!loadSnapshot())
+    {
+        // First boot or layout change: build the snapshot from the JSON files
+        Serial.println("ConfigStore: Snapshot missing/invalid, importing JSON.");
+        // No card or no readable file: run on defaults and try again next
+        // boot instead of saving a snapshot without the Wi-Fi credentials
+        importPending = !importJson();
+    }
+
+    Serial.printf("ConfigStore: Config ready from %s in %lu us\n",
+                  fromSnapshot ? "NVS snapshot" : "JSON", (unsigned long)(micros() - start));
+}
+
+bool ConfigStore::loadSnapshot()
+{
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, true))
+        return false;
+
+    SnapshotBlob blob;
+    size_t len = prefs.getBytesLength(CONFIG_NVS_KEY);
+    bool ok = len == sizeof(blob) && prefs.getBytes(CONFIG_NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    if (!ok || blob.magic != SNAPSHOT_MAGIC || blob.version != CONFIG_SNAPSHOT_VERSION ||
+        blob.size != sizeof(RuntimeConfig) ||
+        blob.crc != crc32((const uint8_t *)&blob.config, sizeof(RuntimeConfig)))
+    {
+        return false;
+    }
+
+    config = blob.config;
+    fromSnapshot = true;
+    return true;
+}
+
+bool ConfigStore::commit()
+{
+    if (importPending)
+    {
+        // No card on this unit: the user's own settings are the config now
+        Serial.println("ConfigStore: JSON import pending, writing snapshot from RAM.");
+        importPending = false;
+    }
+
+    SnapshotBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.magic = SNAPSHOT_MAGIC;
+    blob.version = CONFIG_SNAPSHOT_VERSION;
+    blob.size = sizeof(RuntimeConfig);
+    blob.config = config;
+    blob.crc = crc32((const uint8_t *)&blob.config, sizeof(RuntimeConfig));
+
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, false))
+    {
+        Serial.println("ConfigStore: Cannot open NVS.");
+        return false;
+    }
+    bool ok = prefs.putBytes(CONFIG_NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    return ok;
+}
+
+// =========================================================
+// JSON Export
+// =========================================================
+bool ConfigStore::saveCommonJson()
+{
+    // Start empty only if there is no file yet: one that cannot be read or
+    // parsed right now still holds volume, freq and udp_token
+    JsonDocument doc;
+    if (fileManager->exists(CONFIG_FILE_PATH COMMON_CONFIG_FILE) &&
+        !fileManager->loadJsonFile(CONFIG_FILE_PATH COMMON_CONFIG_FILE, &doc))
+    {
+        Serial.println("ConfigStore: common.json unreadable, not rewritten.");
+        return false;
+    }
+    doc["group"] = config.groupEnabled != 0;
+    doc["input"] = config.inputSource == 1 ? "bluetooth" : "fm";
+    return fileManager->saveJsonFile(CONFIG_FILE_PATH COMMON_CONFIG_FILE, doc);
+}
+
+// =========================================================
+// JSON Import
+// =========================================================
+bool ConfigStore::importJson()
+{
+    if (!fileManager->isMounted())
+    {
+        Serial.println("ConfigStore: SD not mounted, JSON import skipped.");
+        return false;
+    }
+
+    // Restored if neither common.json nor wifi.json can be read
+    RuntimeConfig previous = config;
+    setDefaults();
+    JsonDocument doc;
+
+    bool commonLoaded = fileManager->loadJsonFile(CONFIG_FILE_PATH COMMON_CONFIG_FILE, &doc);
+    if (commonLoaded)
+    {
+        config.commonVolume = doc["volume"] | 50;
+        config.commonFreqCode = Channel::fromMHz(doc["freq"] | 99.5f).code();
+        config.groupEnabled = (doc["group"] | false) ? 1 : 0;
+        config.controlToken = doc["udp_token"] | 0UL;
+        config.inputSource = strcmp(doc["input"] | "fm", "bluetooth") == 0 ? 1 : 0;
+    }
+
+    doc.clear();
+    bool wifiLoaded = fileManager->loadJsonFile(CONFIG_FILE_PATH WIFI_CONFIG_FILE, &doc);
+    if (wifiLoaded)
+    {
+        strncpy(config.staSsid, doc[STA_SSID_CONFIG_KEY] | "", sizeof(config.staSsid) - 1);
+        strncpy(config.staPass, doc[STA_PWD_CONFIG_KEY] | "", sizeof(config.staPass) - 1);
+        strncpy(config.apSsid, doc[AP_SSID_CONFIG_KEY] | "Famio_Setup_AP", sizeof(config.apSsid) - 1);
+        strncpy(config.apPass, doc[AP_PWD_CONFIG_KEY] | "12345678", sizeof(config.apPass) - 1);
+    }
+
+    doc.clear();
+    if (fileManager->loadJsonFile(CONFIG_FILE_PATH FM_CONFIG_FILE, &doc))
+    {
+        config.fmVolume = doc["volume"] | 10;
+        config.fmChannelCode = Channel::fromMHz(doc["current_freq"] | 99.5f).code();
+    }
+
+    doc.clear();
+    if (fileManager->loadJsonFile(CONFIG_FILE_PATH SCHEDULE_CONFIG_FILE, &doc))
+    {
+        config.tzOffsetMin = doc["tz_offset_min"] | 0;
+        JsonArray alarms = doc["alarms"].as<JsonArray>();
+        uint8_t i = 0;
+        for (JsonObject o : alarms)
+        {
+            if (i >= SCHEDULE_MAX_ALARMS)
+                break;
+            ScheduleAlarm &a = config.alarms[i++];
+            a.enabled = o["enabled"] | 0;
+            a.days = o["days"] | 0;
+            a.hour = o["hour"] | 0;
+            a.minute = o["minute"] | 0;
+            a.preset = o["preset"] | 0;
+            a.volume = o["volume"] | 8;
+            a.fadeSec = o["fade"] | 60;
+            a.durationMin = o["duration"] | 0;
+        }
+    }
+
+    if (!commonLoaded && !wifiLoaded)
+    {
+        Serial.println("ConfigStore: common.json/wifi.json unreadable, import discarded.");
+        config = previous;
+        return false;
+    }
+
+    importPending = false;
+    return commit();
+}
+
+// =========================================================
+// CRC-32 (IEEE, reflected)
+// =========================================================
+uint32_t ConfigStore::crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+    }
+    return ~crc;
+}
@@ -1,29 +1,51 @@
 #include "ConnectivityManager.h"
 #include <ESPmDNS.h>
+#include "Metrics.h"
+#include "GroupSync.h"
+#include "HangDetector.h"
 
-ConnectivityManager::ConnectivityManager(FileManager *fileManager) : fm(fileManager)
+// Đếm số lần chuyển trạng thái Wi-Fi, theo trạng thái đích
+static void noteTransition(const char *state)
+{
+    static MetricCounter *sta = Metrics::counter("wifi_transitions_total", "to", "sta_connected");
+    static MetricCounter *failed = Metrics::counter("wifi_transitions_total", "to", "sta_failed");
+    static MetricCounter *provisioning = Metrics::counter("wifi_transitions_total", "to", "provisioning");
+
+    if (strcmp(state, "sta_connected") == 0)
+        Metrics::inc(sta);
+    else if (strcmp(state, "sta_failed") == 0)
+        Metrics::inc(failed);
+    else
+        Metrics::inc(provisioning);
+}
+
+ConnectivityManager::ConnectivityManager(FileManager *fileManager, ConfigStore *configStore)
+    : fm(fileManager), config(configStore)
 {
     // Khởi tạo
 }
 
-// Hàm nội bộ: Tải Credentials từ SD Card
+// Hàm nội bộ: Tải Credentials từ snapshot (không cần đọc wifi.json lúc boot)
 bool ConnectivityManager::loadCredentials(String &ssid, String &pass, String &ap_ssid, String &ap_pass)
 {
-    JsonDocument doc;
-    if (fm->loadJsonFile(CONFIG_FILE_PATH WIFI_CONFIG_FILE, &doc))
-    {
-        ssid = doc[STA_SSID_CONFIG_KEY] | "";
-        pass = doc[STA_PWD_CONFIG_KEY] | "";
-        ap_ssid = doc[AP_SSID_CONFIG_KEY] | "Famio_Setup_AP";
-        ap_pass = doc[AP_PWD_CONFIG_KEY] | "12345678";
-        return ssid.length() > 0;
-    }
-    return false;
+    const RuntimeConfig &cfg = config->get();
+    ssid = cfg.staSsid;
+    pass = cfg.staPass;
+    ap_ssid = cfg.apSsid;
+    ap_pass = cfg.apPass;
+    return ssid.length() > 0;
 }
 
-// Hàm nội bộ: Lưu Credentials vào SD Card
+// Hàm nội bộ: Lưu Credentials vào snapshot, wifi.json vẫn được ghi để sửa tay/xuất
 bool ConnectivityManager::saveCredentials(const String &ssid, const String &pass)
 {
+    RuntimeConfig &cfg = config->get();
+    strncpy(cfg.staSsid, ssid.c_str(), sizeof(cfg.staSsid) - 1);
+    cfg.staSsid[sizeof(cfg.staSsid) - 1] = '\0';
+    strncpy(cfg.staPass, pass.c_str(), sizeof(cfg.staPass) - 1);
+    cfg.staPass[sizeof(cfg.staPass) - 1] = '\0';
+    config->commit();
+
     JsonDocument doc;
     fm->loadJsonFile(CONFIG_FILE_PATH WIFI_CONFIG_FILE, &doc);
     doc[STA_SSID_CONFIG_KEY] = ssid;
@@ -37,8 +59,17 @@ void ConnectivityManager::clearCredentials()
     ConnectivityManager::saveCredentials("", "");
 }
 
-// Hàm chính khởi tạo
+// Hàm chính khởi tạo (tuần tự: bắt đầu kết nối, chờ, rồi mDNS)
 bool ConnectivityManager::begin()
+{
+    startAssociation();
+    waitForAssociation();
+    startMdns();
+    return true;
+}
+
+// Bước 1: Cấu hình Wi-Fi và bắt đầu kết nối, không chờ
+void ConnectivityManager::startAssociation()
 {
     String saved_ssid, saved_pass, ap_ssid, ap_pass;
 
@@ -47,60 +78,76 @@ bool ConnectivityManager::begin()
         // --- PHA HOẠT ĐỘNG (OPERATIONAL PHASE) ---
         WiFi.mode(WIFI_STA);
         WiFi.begin(saved_ssid.c_str(), saved_pass.c_str());
-
         Serial.printf("Connecting to STA: %s\n", saved_ssid.c_str());
+        sta_pending = true;
+        return;
+    }
 
-        long start_time = millis();
-        while (WiFi.status() != WL_CONNECTED && (millis() - start_time < CONNECTION_TIMEOUT_S * 1000))
-        {
-            delay(500);
-            Serial.print(".");
-        }
+    // --- PHA CẤU HÌNH (PROVISIONING PHASE) ---
+    Serial.println("Starting Provisioning Mode (AP+STA)...");
+    operational_mode = false;
+    noteTransition("provisioning");
+    WiFi.mode(WIFI_AP_STA);
+    HangGuard guard(HANG_WIFI_SOFTAP);
+    if (!WiFi.softAP(ap_ssid, ap_pass))
+    {
+        // Khởi động lại thay vì treo: lần boot sau sẽ báo nguyên nhân
+        log_e("Soft AP creation failed.");
+        HangDetector::restart(HANG_WIFI_SOFTAP);
+    }
+    Serial.printf("AP SSID: %s | IP: %s\n", ap_ssid.c_str(), WiFi.softAPIP().toString().c_str());
+}
 
-        if (WiFi.status() == WL_CONNECTED)
-        {
-            Serial.printf("\nSTA Connected. IP: %s\n", WiFi.localIP().toString().c_str());
-            operational_mode = true;
-        }
-        else
-        {
-            // Thất bại: Chuyển về chế độ cấu hình
-            Serial.println("\nSTA Connect FAILED/TIMEOUT. Entering Provisioning Mode.");
-            clearCredentials(); // Xóa cấu hình sai để bắt đầu lại
-            operational_mode = false;
-            ESP.restart();
-            // FALL-THROUGH để chạy Provisioning Mode
-        }
+// Bước 2: Chờ kết nối STA (chạy trong task riêng lúc boot)
+bool ConnectivityManager::waitForAssociation()
+{
+    if (!sta_pending)
+        return operational_mode;
+
+    HangGuard guard(HANG_WIFI_ASSOC);
+    long start_time = millis();
+    while (WiFi.status() != WL_CONNECTED && (millis() - start_time < CONNECTION_TIMEOUT_S * 1000))
+    {
+        delay(100);
     }
+    sta_pending = false;
 
-    if (!operational_mode)
+    if (WiFi.status() == WL_CONNECTED)
     {
-        // --- PHA CẤU HÌNH (PROVISIONING PHASE) ---
-        Serial.println("Starting Provisioning Mode (AP+STA)...");
-        WiFi.mode(WIFI_AP_STA);
-        if (!WiFi.softAP(ap_ssid, ap_pass))
-        {
-            log_e("Soft AP creation failed.");
-            while (1)
-                ;
-        }
-        Serial.printf("AP SSID: %s | IP: %s\n", ap_ssid.c_str(), WiFi.softAPIP().toString().c_str());
+        Serial.printf("STA Connected in %ld ms. IP: %s\n", millis() - start_time, WiFi.localIP().toString().c_str());
+        operational_mode = true;
+        noteTransition("sta_connected");
+        // Từ đây poll() lo việc kết nối lại (backoff + roaming), driver không tự thử
+        WiFi.setAutoReconnect(false);
+        return true;
     }
-    // =========================================================
-    // *** KHỞI TẠO MDNS (ÁP DỤNG CHO CẢ AP VÀ STA) ***
-    // =========================================================
+
+    // Thất bại: Xóa cấu hình sai và khởi động lại vào chế độ cấu hình
+    Serial.println("STA Connect FAILED/TIMEOUT. Entering Provisioning Mode.");
+    noteTransition("sta_failed");
+    clearCredentials();
+    operational_mode = false;
+    ESP.restart();
+    return false;
+}
+
+// =========================================================
+// *** KHỞI TẠO MDNS (ÁP DỤNG CHO CẢ AP VÀ STA) ***
+// =========================================================
+void ConnectivityManager::startMdns()
+{
     if (MDNS.begin(MDNS_HOSTNAME))
     {
         // Đăng ký dịch vụ HTTP (Web Server)
         MDNS.addService("http", "tcp", 80);
+        // Dịch vụ nhóm đa phòng (GroupSync tìm các thiết bị khác qua đây)
+        MDNS.addService(GROUP_MDNS_SERVICE, "udp", GROUP_PORT);
         Serial.printf("mDNS Ready. Access at: http://%s.local\n", MDNS_HOSTNAME);
     }
     else
     {
         Serial.println("mDNS failed to start.");
     }
-    // =========================================================
-    return true;
 }
 
 // API: Bắt đầu quét mạng (Non-blocking)
@@ -150,7 +197,8 @@ bool ConnectivityManager::checkAndSaveCredentials(const String &ssid, const Stri
     if (operational_mode)
         return false; // Chỉ thực hiện khi đang ở Provisioning
 
-    // 1. Cố gắng kết nối với Timeout 30s
+    // 1. Cố gắng kết nối với Timeout 30s (chạy trên task loop: phải nuôi watchdog)
+    HangGuard guard(HANG_WIFI_CHECK);
     WiFi.begin(ssid.c_str(), pass.c_str());
 
     long start_time = millis();
@@ -163,6 +211,7 @@ bool ConnectivityManager::checkAndSaveCredentials(const String &ssid, const Stri
             connected = true;
             break;
         }
+        HangDetector::feed();
         delay(500);
     }
 
@@ -172,6 +221,7 @@ bool ConnectivityManager::checkAndSaveCredentials(const String &ssid, const Stri
         // Thành công: Lưu config và reset
         saveCredentials(ssid, pass);
         operational_mode = true;
+        noteTransition("sta_connected");
         // Lưu ý: Chúng ta không gọi ESP.restart() trong hàm này mà để AppWebServer xử lý phản hồi API và reset
     }
     WiFi.mode(WIFI_AP_STA); // Đảm bảo AP+STA vẫn chạy
@@ -191,4 +241,202 @@ void ConnectivityManager::manualReset()
 {
     Serial.println("Manual reset triggered from API. Restarting device...");
     ESP.restart();
+}
+
+// =========================================================
+// GIÁM SÁT LIÊN KẾT WI-FI (gọi trong loop(), không chặn)
+// =========================================================
+
+// Backoff "equal jitter": 50-100% của mức hiện tại, tránh nhiều thiết bị
+// cùng thử lại một lúc khi AP vừa khởi động lại
+static uint32_t jittered(uint32_t backoffMs)
+{
+    return random(backoffMs / 2, backoffMs + 1);
+}
+
+void ConnectivityManager::poll()
+{
+    if (!operational_mode || sta_pending)
+        return;
+    uint32_t now = millis();
+    if (now - last_supervise_ms < WIFI_SUPERVISE_INTERVAL_MS)
+        return;
+    last_supervise_ms = now;
+
+    static MetricCounter *disconnectCount = Metrics::counter("wifi_disconnects_total");
+    static MetricCounter *attemptCount = Metrics::counter("wifi_reconnect_attempts_total");
+    bool connected = WiFi.status() == WL_CONNECTED;
+
+    switch (link_state)
+    {
+    case LINK_UP:
+        if (!connected)
+        {
+            // Mất kết nối: lần thử đầu rất sớm, sau đó giãn dần
+            Serial.println("Wi-Fi: Link lost, reconnecting...");
+            disconnects++;
+            Metrics::inc(disconnectCount);
+            down_since_ms = now;
+            backoff_ms = WIFI_BACKOFF_MIN_MS;
+            next_attempt_ms = now + jittered(backoff_ms);
+            link_state = LINK_BACKOFF;
+            break;
+        }
+        // Tín hiệu yếu: quét bất đồng bộ chỉ SSID hiện tại để tìm BSSID khác
+        if (now - last_roam_check_ms >= WIFI_ROAM_CHECK_MS)
+        {
+            last_roam_check_ms = now;
+            if (WiFi.RSSI() < WIFI_ROAM_RSSI_DBM && (!last_roam_scan_ms || now - last_roam_scan_ms >= WIFI_ROAM_COOLDOWN_MS))
+            {
+                last_roam_scan_ms = now;
+                if (WiFi.scanNetworks(true, false, false, 300, 0, config->get().staSsid) == WIFI_SCAN_RUNNING)
+                    link_state = LINK_ROAM_SCAN;
+            }
+        }
+        break;
+
+    case LINK_ROAM_SCAN:
+        if (WiFi.scanComplete() == WIFI_SCAN_RUNNING)
+            break;
+        finishRoamScan(now);
+        break;
+
+    case LINK_BACKOFF:
+        if (connected)
+            onLinkUp(now);
+        else if ((int32_t)(now - next_attempt_ms) >= 0)
+        {
+            attempts++;
+            Metrics::inc(attemptCount);
+            startAttempt();
+        }
+        break;
+
+    case LINK_CONNECTING:
+    {
+        if (connected)
+        {
+            onLinkUp(now);
+            break;
+        }
+        wl_status_t status = WiFi.status();
+        if (now - attempt_started_ms >= WIFI_ATTEMPT_TIMEOUT_MS || status == WL_CONNECT_FAILED || status == WL_NO_SSID_AVAIL)
+        {
+            // Thất bại (kể cả roaming): nhân đôi backoff, có trần
+            roaming = false;
+            backoff_ms = backoff_ms * 2 > WIFI_BACKOFF_MAX_MS ? WIFI_BACKOFF_MAX_MS : backoff_ms * 2;
+            next_attempt_ms = now + jittered(backoff_ms);
+            link_state = LINK_BACKOFF;
+        }
+        break;
+    }
+    }
+}
+
+// Bắt đầu một lần kết nối; bssid/channel dùng khi roaming sang AP cụ thể
+void ConnectivityManager::startAttempt(const uint8_t *bssid, int32_t channel)
+{
+    const RuntimeConfig &cfg = config->get();
+    WiFi.disconnect(false);
+    WiFi.begin(cfg.staSsid, cfg.staPass, channel, bssid);
+    attempt_started_ms = millis();
+    link_state = LINK_CONNECTING;
+}
+
+void ConnectivityManager::onLinkUp(uint32_t now)
+{
+    static MetricCounter *downtimeTotal = Metrics::counter("wifi_downtime_ms_total");
+    static MetricHistogram *reconnectLatency = Metrics::histogram("wifi_reconnect_us");
+    static MetricCounter *roamCount = Metrics::counter("wifi_roams_total");
+
+    uint32_t latency = now - down_since_ms;
+    downtime_ms += latency;
+    last_reconnect_ms = latency;
+    Metrics::inc(downtimeTotal, latency);
+    Metrics::record(reconnectLatency, latency < UINT32_MAX / 1000 ? latency * 1000 : UINT32_MAX);
+    if (roaming)
+    {
+        roams++;
+        Metrics::inc(roamCount);
+    }
+    Serial.printf("Wi-Fi: %s in %lu ms, BSSID %s, IP %s\n", roaming ? "Roamed" : "Reconnected", (unsigned long)latency,
+                  WiFi.BSSIDstr().c_str(), WiFi.localIP().toString().c_str());
+
+    roaming = false;
+    down_since_ms = 0;
+    backoff_ms = WIFI_BACKOFF_MIN_MS;
+    link_state = LINK_UP;
+    noteTransition("sta_connected");
+
+    // Web server/UDP lắng nghe trên mọi địa chỉ nên vẫn chạy; mDNS phải
+    // quảng bá lại (IP có thể đã đổi)
+    MDNS.end();
+    startMdns();
+}
+
+// Chọn BSSID cùng SSID mạnh hơn hiện tại ít nhất WIFI_ROAM_HYSTERESIS_DB
+void ConnectivityManager::finishRoamScan(uint32_t now)
+{
+    const char *ssid = config->get().staSsid;
+    uint8_t current[6];
+    memcpy(current, WiFi.BSSID(), sizeof(current));
+    int32_t threshold = WiFi.RSSI() + WIFI_ROAM_HYSTERESIS_DB;
+
+    uint8_t target[6];
+    int32_t channel = 0;
+    int best = -1;
+    int found = WiFi.scanComplete();
+    for (int i = 0; i < found; i++)
+    {
+        if (WiFi.SSID(i) != ssid || memcmp(WiFi.BSSID(i), current, sizeof(current)) == 0 || WiFi.RSSI(i) < threshold)
+            continue;
+        threshold = WiFi.RSSI(i);
+        memcpy(target, WiFi.BSSID(i), sizeof(target));
+        channel = WiFi.channel(i);
+        best = i;
+    }
+    WiFi.scanDelete();
+
+    link_state = LINK_UP;
+    if (best < 0)
+        return;
+
+    Serial.printf("Wi-Fi: Roaming to %02X:%02X:%02X:%02X:%02X:%02X (%ld dBm)\n", target[0], target[1], target[2],
+                  target[3], target[4], target[5], (long)threshold);
+    roaming = true;
+    down_since_ms = now;
+    startAttempt(target, channel);
+}
+
+void ConnectivityManager::getLinkStatus(JsonDocument *doc)
+{
+    static const char *const STATES[] = {"up", "backoff", "connecting", "roam_scan"};
+    uint32_t now = millis();
+    JsonObject link = (*doc)["link"].to<JsonObject>();
+    link["state"] = STATES[link_state];
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        link["rssi"] = WiFi.RSSI();
+        link["bssid"] = WiFi.BSSIDstr();
+        link["channel"] = WiFi.channel();
+    }
+    link["disconnects"] = disconnects;
+    link["attempts"] = attempts;
+    link["roams"] = roams;
+    link["downtime_ms"] = downtime_ms + (down_since_ms ? now - down_since_ms : 0);
+    link["last_reconnect_ms"] = last_reconnect_ms;
+    if (link_state == LINK_BACKOFF)
+        link["next_attempt_in_ms"] = (int32_t)(next_attempt_ms - now) > 0 ? next_attempt_ms - now : 0;
+}
+
+// Metrics: gauge trạng thái Wi-Fi hiện tại
+void ConnectivityManager::sampleMetrics()
+{
+    static MetricGauge *operational = Metrics::gauge("wifi_operational");
+    static MetricGauge *rssi = Metrics::gauge("wifi_rssi_dbm");
+    static MetricGauge *clients = Metrics::gauge("wifi_ap_clients");
+
+    Metrics::set(operational, operational_mode ? 1 : 0);
+    Metrics::set(rssi, WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0);
+    Metrics::set(clients, operational_mode ? 0 : WiFi.softAPgetStationNum());
 }
\ No newline at end of file
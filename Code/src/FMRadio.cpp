@@ -1,12 +1,27 @@
 #include "FMRadio.h"
+#include "TraceLog.h"
+#include "HangDetector.h"
+#include "Capture.h"
 
 // =========================================================
 // Constructor
 // =========================================================
-FMRadio::FMRadio(FileManager *fm)
-    : fileManager(fm), currentFreq(99.5f), isPowered(false), rssi(0), currentVolume(10), numSavedChannels(0)
+FMRadio::FMRadio(FileManager *fm, ConfigStore *config)
+    : tuner(&Wire), fileManager(fm), configStore(config), currentChannel(9950), isPowered(false), chipInitialized(false), ready(false), rssi(0), currentVolume(10),
+      stations(fm), stationsLoaded(false), lastStationFlushMs(0), lastRdsPollMs(0), stereo(false), forcedMono(false), statusSeq(0),
+      lastStatusPublishMs(0), configDirty(false), configDirtyMs(0)
 {
+    memset(&status, 0, sizeof(status));
+    status.channelCode = currentChannel.code();
+    status.volume = currentVolume;
     // Constructor body (rx object initialized by default)
+    tuneLatency = Metrics::histogram("fm_tune_us");
+    tuneTimeouts = Metrics::counter("fm_tune_timeouts_total");
+    i2cSeek = Metrics::histogram("fm_i2c_us", "op", "seek");
+    i2cVolume = Metrics::histogram("fm_i2c_us", "op", "volume");
+    i2cSample = Metrics::histogram("fm_i2c_us", "op", "sample");
+    i2cPower = Metrics::histogram("fm_i2c_us", "op", "power");
+    i2cTransactions = Metrics::counter("fm_i2c_transactions_total");
 }
 
 // =========================================================
@@ -19,41 +34,78 @@ void FMRadio::begin()
 
     // 2. Initialize RDA5807 chip using library
     // Note: Wire.begin() is already called in setup(), so I2C bus is ready
-    rx.setup();
-    delay(100);
-
-    // 4. Configure band and spacing
-    rx.setBand(RDA5807_BAND);
-    rx.setSpace(RDA5807_SPACE);
-
-    // 5. Set volume
-    rx.setVolume(currentVolume);
-    rx.setMono(false);
-    rx.setGpio(3,1);
+    {
+        MetricTimer timer(i2cPower);
+        rx.setup();
+        delay(100);
+
+        // 4. Configure band and spacing
+        rx.setBand(RDA5807_BAND);
+        rx.setSpace(RDA5807_SPACE);
+
+        // 5. Set volume
+        rx.setVolume(currentVolume);
+        rx.setMono(false);
+        rx.setGpio(3,1);
+        rx.setRDS(true);
+    }
 
 
     // 6. Wait for chip to stabilize
     delay(500);
 
-    // 7. Set loaded frequency
-    setFrequency(currentFreq);
+    // 7. Set loaded frequency (setFrequency() only talks to a powered chip)
     isPowered = true;
+    setFrequency(currentChannel);
+    chipInitialized = true;
+    ready.store(true, std::memory_order_release);
     Serial.println("FMRadio: RDA5807 chip initialized successfully.");
 }
 
+void FMRadio::prepare()
+{
+    loadConfig();
+    ready.store(true, std::memory_order_release);
+}
+
 // =========================================================
 // Frequency Control
 // =========================================================
-void FMRadio::setFrequency(float freq_mhz)
+void FMRadio::setFrequency(Channel channel)
 {
-    // Convert MHz to library format (frequency in 10 kHz units)
-    // Example: 99.5 MHz = 9950 in library format (99.5 * 100)
-    uint16_t freq_code = (uint16_t)(freq_mhz * 100);
-
-    rx.setFrequency(freq_code);
-    currentFreq = freq_mhz;
-    saveConfig();
-    Serial.printf("FMRadio: Frequency set to %.1f MHz\n", freq_mhz);
+    // Channel code is already the library format (10 kHz units):
+    // 99.5 MHz = 9950. Off-raster input is moved to the nearest channel.
+    channel = channel.snapped(RDA5807_BAND, RDA5807_SPACE);
+
+    // Powered down: the chip would not tune (and the STC wait would time
+    // out). Keep the channel; powerOn() tunes to it.
+    if (!isPowered)
+    {
+        currentChannel = channel;
+        scheduleSave();
+        return;
+    }
+
+    HangGuard guard(HANG_FM_TUNE);
+
+    FastTuner::Result result = tuner.tune(channel.code(), RDA5807_BAND, RDA5807_SPACE);
+    Metrics::record(tuneLatency, result.totalUs);
+    if (result.completed)
+    {
+        rssi = result.rssi;
+    }
+    else
+    {
+        Metrics::inc(tuneTimeouts);
+        TRACE_WARN(FM_TUNE_TIMEOUT, channel.code() / 100, channel.code() % 100, result.stcUs);
+    }
+
+    currentChannel = channel;
+    rds.reset(millis());
+    stations.notePlay(channel);
+    scheduleSave();
+
+    TRACE_INFO(FM_TUNE, channel.code() / 100, channel.code() % 100);
 }
 
 // =========================================================
@@ -61,31 +113,41 @@ void FMRadio::setFrequency(float freq_mhz)
 // =========================================================
 void FMRadio::seekUp()
 {
-    Serial.println("FMRadio: Seeking up...");
     // RDA5807 library seek function
     // RDA_SEEK_WRAP: wrap around at band edges
     // RDA_SEEK_UP: seek upward
-    rx.seek(RDA_SEEK_WRAP, RDA_SEEK_UP);
-    // Get the new frequency from chip (in 10 kHz units)
-    uint16_t freq_code = rx.getRealFrequency();
-    currentFreq = freq_code / 100.0f;
-    Serial.printf("FMRadio: Seek up complete. New frequency: %.1f MHz\n", currentFreq);
+    {
+        // rx.seek() polls the chip until it stops; no timeout of its own
+        HangGuard guard(HANG_FM_SEEK);
+        MetricTimer timer(i2cSeek);
+        rx.seek(RDA_SEEK_WRAP, RDA_SEEK_UP);
+        // Get the new frequency from chip (in 10 kHz units)
+        currentChannel = Channel(rx.getRealFrequency());
+    }
+    rds.reset(millis());
+    stations.notePlay(currentChannel);
+
+    TRACE_INFO(FM_SEEK_UP, currentChannel.code() / 100, currentChannel.code() % 100);
 }
 
 void FMRadio::seekDown()
 {
-    Serial.println("FMRadio: Seeking down...");
-    rx.seek(RDA_SEEK_WRAP, RDA_SEEK_DOWN);
-    uint16_t freq_code = rx.getRealFrequency();
-    currentFreq = freq_code / 100.0f;
-    Serial.printf("FMRadio: Seek down complete. New frequency: %.1f MHz\n", currentFreq);
+    {
+        HangGuard guard(HANG_FM_SEEK);
+        MetricTimer timer(i2cSeek);
+        rx.seek(RDA_SEEK_WRAP, RDA_SEEK_DOWN);
+        currentChannel = Channel(rx.getRealFrequency());
+    }
+    rds.reset(millis());
+    stations.notePlay(currentChannel);
+
+    TRACE_INFO(FM_SEEK_DOWN, currentChannel.code() / 100, currentChannel.code() % 100);
 }
 
-float FMRadio::autoSeekNext()
+Channel FMRadio::autoSeekNext()
 {
     seekUp();
-    Serial.printf("FMRadio: Auto seek completed. New frequency: %.1f MHz\n", currentFreq);
-    return currentFreq;
+    return currentChannel;
 }
 
 // =========================================================
@@ -93,8 +155,9 @@ float FMRadio::autoSeekNext()
 // =========================================================
 void FMRadio::setStereo(bool enable)
 {
-    rx.setMono(!enable); // setMono(true) = mono, setMono(false) = stereo
-    Serial.printf("FMRadio: Stereo mode set to %s\n", enable ? "ON" : "OFF");
+    forcedMono = !enable;
+    rx.setMono(forcedMono || signal.wantMono()); // setMono(true) = mono, setMono(false) = stereo
+    TRACE_INFO(FM_STEREO, enable);
 }
 
 // =========================================================
@@ -102,16 +165,38 @@ void FMRadio::setStereo(bool enable)
 // =========================================================
 void FMRadio::powerOn()
 {
-    // RDA5807 library handles power internally
-    // If needed, you can enable specific features
-    Serial.println("FMRadio: Power ON");
+    // After powerOff() the settings are still in RAM: skip begin()'s config
+    // reload and settle delays, just enable the chip and retune
+    if (!chipInitialized)
+    {
+        begin();
+        return;
+    }
+    {
+        MetricTimer timer(i2cPower);
+        // powerUp() rebuilds 0x02/0x04/0x05 from defaults: RDS, mono and
+        // GPIO have to be set again, as begin() does
+        rx.powerUp();
+        rx.setVolume(currentVolume);
+        rx.setMono(forcedMono || signal.wantMono());
+        rx.setGpio(3, 1);
+        rx.setRDS(true);
+    }
     isPowered = true;
+    setFrequency(currentChannel);
+    Serial.println("FMRadio: Power ON");
 }
 
 void FMRadio::powerOff()
 {
     // Disable receiver or put into low power mode
-    rx.powerDown();
+    {
+        MetricTimer timer(i2cPower);
+        rx.powerDown();
+    }
+    // Don't leave the last tune/volume change unsaved
+    if (configDirty)
+        saveConfig();
     Serial.println("FMRadio: Power OFF");
     isPowered = false;
 }
@@ -127,9 +212,12 @@ void FMRadio::setVolume(uint8_t volume)
         return;
 
     currentVolume = volume;
-    rx.setVolume(volume);
-    saveConfig(); // Save volume to SD card
-    Serial.printf("FMRadio: Volume set to %d\n", currentVolume);
+    {
+        MetricTimer timer(i2cVolume);
+        rx.setVolume(volume);
+    }
+    scheduleSave(); // Save volume to SD card
+    TRACE_INFO(FM_VOLUME, currentVolume);
 }
 
 // =========================================================
@@ -137,159 +225,341 @@ void FMRadio::setVolume(uint8_t volume)
 // =========================================================
 void FMRadio::loadConfig()
 {
-    JsonDocument doc;
-
-    // Try to load fm.json from SD Card
-    if (fileManager->loadJsonFile(FM_CONFIG_FILE, &doc))
+    // 1. Volume and current frequency come from the config snapshot
+    const RuntimeConfig &cfg = configStore->get();
+    currentVolume = cfg.fmVolume;
+    if (currentVolume > 15)
+        currentVolume = 15;
+
+    // 2. Load current frequency
+    Channel saved(cfg.fmChannelCode);
+    if (isValidChannel(saved))
+        currentChannel = saved;
+
+    // 3. Load station database (presets)
+    if (!stationsLoaded)
     {
-        // 1. Load volume
-        currentVolume = doc["volume"] | 10;
-        if (currentVolume > 15)
-            currentVolume = 15;
-
-        // 2. Load current frequency
-        currentFreq = doc["current_freq"] | 99.5f;
+        stationsLoaded = stations.begin();
 
-        // 3. Load saved channels
-        JsonArray channels = doc["channels"].as<JsonArray>();
-        numSavedChannels = 0;
-
-        for (JsonObject channel : channels)
+        // First boot with the binary store: migrate presets from fm.json
+        JsonDocument doc;
+        if (stationsLoaded && stations.isFresh() &&
+            fileManager->loadJsonFile(CONFIG_FILE_PATH FM_CONFIG_FILE, &doc))
         {
-            if (numSavedChannels < MAX_CHANNELS)
+            JsonArray channels = doc["channels"].as<JsonArray>();
+            for (JsonObject channel : channels)
             {
-                float freq = channel["freq"] | 0.0f;
-                if (freq >= 87.0f && freq <= 108.0f)
-                {
-                    savedChannels[numSavedChannels] = freq;
-                    numSavedChannels++;
-                }
+                Channel preset = Channel::fromMHz(channel["freq"] | 0.0f);
+                if (isValidChannel(preset))
+                    stations.addPreset(preset);
             }
         }
-        Serial.printf("FMRadio: Config loaded. Vol: %d, Channels: %d\n", currentVolume, numSavedChannels);
-    }
-    else
-    {
-        // Initialize defaults if load fails
-        Serial.println("FMRadio: Config not found. Using defaults.");
-        currentVolume = 10;
-        currentFreq = 99.5f;
-        numSavedChannels = 0;
-        saveConfig();
     }
+
+    Serial.printf("FMRadio: Config loaded. Vol: %d, Channels: %d\n", currentVolume, (int)stations.presetCount());
+}
+
+void FMRadio::scheduleSave()
+{
+    configDirty = true;
+    configDirtyMs = millis();
 }
 
 void FMRadio::saveConfig()
 {
-    JsonDocument doc;
+    HangGuard guard(HANG_FM_SAVE);
+    configDirty = false;
+    RuntimeConfig &cfg = configStore->get();
+    // Boot's tune to the loaded channel changes nothing: no snapshot is
+    // written until the user changes something (see ConfigStore::commit())
+    if (cfg.fmVolume == currentVolume && cfg.fmChannelCode == currentChannel.code())
+        return;
+    cfg.fmVolume = currentVolume;
+    cfg.fmChannelCode = currentChannel.code();
+    configStore->commit();
 
+    // fm.json is kept as the editable copy; presets live in stations.bin
+    JsonDocument doc;
+    char freq[CHANNEL_STR_LEN];
+    size_t len = currentChannel.format(freq);
     doc["volume"] = currentVolume;
-    doc["current_freq"] = currentFreq;
-
-    JsonArray channels = doc["channels"].as<JsonArray>();
-    for (int i = 0; i < numSavedChannels; i++)
-    {
-        JsonObject channel = channels.add<JsonObject>();
-        channel["freq"] = savedChannels[i];
-    }
+    doc["current_freq"] = serialized(freq, len);
 
-    if (fileManager->saveJsonFile(FM_CONFIG_FILE, doc))
+    if (fileManager->saveJsonFile(CONFIG_FILE_PATH FM_CONFIG_FILE, doc))
     {
-        Serial.println("FMRadio: Config saved successfully.");
+        TRACE_DEBUG(FM_CONFIG_SAVED);
     }
     else
     {
-        Serial.println("FMRadio: Failed to save config.");
+        TRACE_ERROR(FM_CONFIG_SAVE_FAILED);
     }
 }
 
 // =========================================================
 // Status & Information
 // =========================================================
-void FMRadio::updateStatus()
+void FMRadio::getStatus(JsonDocument *doc)
 {
-    if (!isPowered)
+    FMStatusSnapshot snap;
+    uint32_t version = readStatus(snap);
+    (*doc)["version"] = version;
+
+    if (!snap.powered)
+    {
+        (*doc)["error"] = "Chip is powered off.";
         return;
+    }
 
-    // Get RSSI (signal strength) from chip
-    rssi = rx.getRssi(); // 0-63 scale
+    char freq[CHANNEL_STR_LEN];
+    size_t len = Channel(snap.channelCode).format(freq);
+    (*doc)["freq"] = serialized(freq, len);
+    (*doc)["code"] = snap.channelCode;
+    (*doc)["rssi"] = snap.rssi;
+    (*doc)["stereo"] = snap.stereo;
+    (*doc)["isPowered"] = snap.powered;
+    (*doc)["volume"] = snap.volume;
+    if (snap.hasPs)
+        (*doc)["ps"] = snap.ps;
+    (*doc)["rds_version"] = snap.rdsVersion;
 }
 
-void FMRadio::getStatus(JsonDocument *doc)
+uint32_t FMRadio::readStatus(FMStatusSnapshot &out) const
 {
+    uint32_t before, after;
+    do
+    {
+        before = statusSeq.load(std::memory_order_acquire);
+        out = status;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = statusSeq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return before >> 1;
+}
+
+// Called from poll() only (single writer)
+void FMRadio::publishStatus()
+{
+    uint32_t now = millis();
+    bool controlChanged = status.powered != isPowered || status.channelCode != currentChannel.code() ||
+                          status.volume != currentVolume || status.rdsVersion != rds.getVersion();
+    bool signalChanged = status.rssi != (uint8_t)rssi || status.stereo != stereo;
+    if (!controlChanged && !(signalChanged && now - lastStatusPublishMs >= STATUS_SAMPLE_INTERVAL_MS))
+        return;
+
+    lastStatusPublishMs = now;
+    statusSeq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    status.channelCode = currentChannel.code();
+    status.volume = currentVolume;
+    status.rssi = (uint8_t)rssi;
+    status.stereo = isPowered && stereo;
+    status.powered = isPowered;
+    status.hasPs = rds.hasPsName();
+    strncpy(status.ps, status.hasPs ? rds.getPsName() : "", sizeof(status.ps) - 1);
+    status.ps[sizeof(status.ps) - 1] = '\0';
+    status.rdsVersion = rds.getVersion();
+    status.sampledMs = now;
+
+    statusSeq.fetch_add(1, std::memory_order_release);
+}
+
+// =========================================================
+// RDS / Sampling
+// =========================================================
+void FMRadio::poll()
+{
+    if (!isReady())
+        return;
+    uint32_t now = millis();
+    if (isPowered && now - lastRdsPollMs >= RDS_POLL_INTERVAL_MS)
+    {
+        lastRdsPollMs = now;
+        sampleChip();
+    }
+    publishStatus();
+
+    if (configDirty && now - configDirtyMs >= CONFIG_SAVE_DELAY_MS)
+        saveConfig();
+
     if (!isPowered)
+        return;
+
+    if (now - lastStationFlushMs >= STATION_FLUSH_INTERVAL_MS)
     {
-        (*doc)["error"] = "Chip is powered off.";
+        lastStationFlushMs = now;
+        stations.flush();
+    }
+}
+
+// 0x0A..0x0F in one I2C read, big-endian words. Replaces the separate
+// RDS-ready, RSSI, stereo, BLER and block reads (six transactions).
+bool FMRadio::readStatusRegisters(uint16_t regs[6])
+{
+    bool ok;
+    if (Capture::replayTunerBlock(regs, ok))
+        return ok;
+
+    Metrics::inc(i2cTransactions);
+    ok = Wire.requestFrom((uint8_t)RDA5807_I2C_SEQ_ADDR, (uint8_t)12) == 12;
+    for (uint8_t i = 0; ok && i < 6; i++)
+    {
+        uint16_t hi = Wire.read();
+        regs[i] = (hi << 8) | (uint8_t)Wire.read();
+    }
+    Capture::tunerBlock(regs, ok);
+    return ok;
+}
+
+void FMRadio::sampleChip()
+{
+    MetricTimer timer(i2cSample);
+    uint16_t regs[6];
+    if (!readStatusRegisters(regs))
         return;
+
+    // 0x0A: RDSR [15], ST [10]; 0x0B: RSSI [15:9], BLERA [3:2], BLERB [1:0]
+    uint16_t reg0a = regs[0];
+    uint16_t reg0b = regs[1];
+    stereo = (reg0a & 0x0400) != 0;
+    int sampled = reg0b >> 9;
+    if (sampled != rssi)
+    {
+        rssi = sampled;
+        stations.noteRssi(currentChannel, rssi);
     }
 
-    updateStatus();
-    (*doc)["freq"] = currentFreq;
-    (*doc)["rssi"] = rssi;
-    (*doc)["stereo"] = rx.isStereo(); // Use isStereo() instead of getStereoIndicator()
-    (*doc)["isPowered"] = isPowered;
-    (*doc)["volume"] = currentVolume;
+    bool wasMono = signal.wantMono();
+    signal.addSample((uint8_t)rssi, stereo, millis());
+    if (signal.wantMono() != wasMono && !forcedMono)
+        rx.setMono(signal.wantMono());
+
+    if (!(reg0a & 0x8000))
+        return;
+
+    // The chip reports no level for blocks C/D, so they inherit the worse of A/B.
+    uint8_t errors[4];
+    errors[0] = (reg0b >> 2) & 0x03;
+    errors[1] = reg0b & 0x03;
+    errors[2] = errors[0] > errors[1] ? errors[0] : errors[1];
+    errors[3] = errors[2];
+
+    uint32_t psVersion = rds.getVersion();
+    rds.processGroup(&regs[2], errors, millis());
+
+    // Remember the station name once it has settled
+    if (rds.getVersion() != psVersion && rds.hasPsName())
+        stations.setName(currentChannel, rds.getPsName());
+}
+
+void FMRadio::getRdsStatus(JsonDocument *doc)
+{
+    (*doc)["version"] = rds.getVersion();
+    (*doc)["ps"] = rds.getPsName();
+    (*doc)["rt"] = rds.getRadioText();
+    if (rds.hasPi())
+        (*doc)["pi"] = rds.getPi();
+    if (rds.hasPty())
+        (*doc)["pty"] = rds.getPty();
+    if (rds.hasClock())
+    {
+        const RDSDecoder::ClockTime &clock = rds.getClock();
+        JsonObject ct = (*doc)["clock"].to<JsonObject>();
+        ct["mjd"] = clock.mjd;
+        ct["hour"] = clock.hour;
+        ct["minute"] = clock.minute;
+        ct["offset"] = clock.offsetHalfHours;
+    }
+    // Time from tune until the station name settled (0 = not yet)
+    (*doc)["ps_stable_ms"] = rds.getTimeToStablePsMs();
+    (*doc)["groups"] = rds.getGroupsDecoded();
+    (*doc)["rejected"] = rds.getBlocksRejected();
 }
 
 // =========================================================
 // Channel Management
 // =========================================================
-void FMRadio::saveChannel(float freq_mhz)
+void FMRadio::saveChannel(Channel channel)
 {
-    if (numSavedChannels >= MAX_CHANNELS)
+    if (!stations.addPreset(channel))
     {
         Serial.println("FMRadio: Channel limit reached.");
         return;
     }
 
-    savedChannels[numSavedChannels] = freq_mhz;
-    numSavedChannels++;
+    // Name the preset right away if RDS already knows it
+    if (channel == currentChannel && rds.hasPsName())
+        stations.setName(channel, rds.getPsName());
 
-    Serial.printf("FMRadio: Channel saved - %.1f MHz at index %d\n", freq_mhz, numSavedChannels - 1);
-    saveConfig();
+    TRACE_INFO(FM_PRESET_SAVED, channel.code() / 100, channel.code() % 100, stations.presetCount() - 1);
 }
 
 void FMRadio::selectSavedChannel(uint8_t index)
 {
-    if (index >= numSavedChannels)
+    const StationRecord *preset = stations.presetAt(index);
+    if (!preset)
     {
         Serial.println("FMRadio: Invalid channel index.");
         return;
     }
 
-    float savedFreq = savedChannels[index];
-    Serial.printf("FMRadio: Selecting channel at index %d: %.1f MHz\n", index, savedFreq);
-    setFrequency(savedFreq);
-    saveConfig();
+    TRACE_INFO(FM_PRESET_SELECT, index);
+    setFrequency(Channel(preset->code));
 }
 
 void FMRadio::getSavedChannels(JsonDocument *doc)
 {
-    JsonArray channels = (*doc)["channels"].as<JsonArray>();
+    JsonArray channels = (*doc)["channels"].to<JsonArray>();
 
-    for (int i = 0; i < numSavedChannels; i++)
+    for (size_t i = 0; i < stations.presetCount(); i++)
     {
+        const StationRecord *preset = stations.presetAt(i);
+        char freq[CHANNEL_STR_LEN];
+        size_t len = Channel(preset->code).format(freq);
         JsonObject channel = channels.add<JsonObject>();
         channel["index"] = i;
-        channel["freq"] = savedChannels[i];
+        channel["freq"] = serialized(freq, len);
+        channel["name"] = preset->name;
+        channel["rssi"] = preset->lastRssi;
+        channel["plays"] = preset->playCount;
     }
 }
 
 void FMRadio::deleteChannel(uint8_t index)
 {
-    if (index >= numSavedChannels)
+    if (!stations.removePreset(index))
     {
         Serial.println("FMRadio: Invalid channel index to delete.");
         return;
     }
 
-    // Shift remaining channels
-    for (int i = index; i < numSavedChannels - 1; i++)
+    TRACE_INFO(FM_PRESET_DELETED, stations.presetCount());
+}
+
+void FMRadio::getStations(JsonDocument *doc)
+{
+    (*doc)["count"] = stations.count();
+    (*doc)["load_us"] = stations.getLoadMicros();
+    JsonArray list = (*doc)["stations"].to<JsonArray>();
+
+    for (size_t slot = 0; slot < stations.capacity(); slot++)
     {
-        savedChannels[i] = savedChannels[i + 1];
+        const StationRecord &rec = stations.at(slot);
+        if (rec.code == 0)
+            continue;
+
+        char freq[CHANNEL_STR_LEN];
+        size_t len = Channel(rec.code).format(freq);
+        JsonObject station = list.add<JsonObject>();
+        station["freq"] = serialized(freq, len);
+        station["name"] = rec.name;
+        station["rssi"] = rec.lastRssi;
+        station["favorite"] = (rec.flags & STATION_FLAG_FAVORITE) != 0;
+        station["plays"] = rec.playCount;
     }
+}
 
-    numSavedChannels--;
-    Serial.printf("FMRadio: Channel deleted. Remaining: %d\n", numSavedChannels);
-    saveConfig();
+void FMRadio::benchmarkStations(JsonDocument *doc)
+{
+    stations.benchmark(doc);
 }
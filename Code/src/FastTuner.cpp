@@ -0,0 +1,117 @@
+#include "FastTuner.h"
+#include "Channel.h"
+#include "Capture.h"
+
+#define REG02_DMUTE 0x4000 // 1 = normal output, 0 = muted
+#define REG03_TUNE 0x0010
+#define REG0A_STC 0x4000
+
+FastTuner::FastTuner(TwoWire *bus) : wire(bus)
+{
+}
+
+// =========================================================
+// Tune
+// =========================================================
+FastTuner::Result FastTuner::tune(uint16_t code, uint8_t band, uint8_t space)
+{
+    Result result = {false, code, 0, 0, 0};
+    uint32_t start = micros();
+
+    // 0x02 is re-read every time: the library changes it for mono/RDS/seek
+    uint16_t reg02 = 0;
+    bool canMute = readRegister(0x02, reg02);
+    if (canMute)
+        writeRegister(0x02, reg02 & ~REG02_DMUTE);
+
+    uint16_t chan = Channel(code).chipChannel(band, space);
+    writeRegister(0x03, (uint16_t)(chan << 6) | REG03_TUNE | ((band & 0x03) << 2) | (space & 0x03));
+    uint32_t written = micros();
+
+    uint16_t reg0a = 0, reg0b = 0;
+    while (micros() - written < FAST_TUNE_TIMEOUT_MS * 1000UL)
+    {
+        delayMicroseconds(FAST_TUNE_POLL_US);
+        if (readStatus(reg0a, reg0b) && (reg0a & REG0A_STC))
+        {
+            result.completed = true;
+            break;
+        }
+    }
+    result.stcUs = micros() - written;
+
+    if (result.completed)
+    {
+        // READCHAN [9:0] is what the chip actually locked to
+        result.channelCode = Channel::fromChipChannel(reg0a & 0x03FF, band, space).code();
+
+        // AGC settles over a few ms after STC; unmuting earlier is the chirp
+        uint8_t prev = reg0b >> 9;
+        uint32_t stc = micros();
+        while (micros() - stc < FAST_TUNE_SETTLE_MAX_MS * 1000UL)
+        {
+            delayMicroseconds(FAST_TUNE_POLL_US);
+            if (!readStatus(reg0a, reg0b))
+                break;
+            uint8_t now = reg0b >> 9;
+            uint8_t diff = now > prev ? now - prev : prev - now;
+            prev = now;
+            if (diff <= FAST_TUNE_RSSI_EPS)
+                break;
+        }
+        result.rssi = prev;
+    }
+
+    if (canMute)
+        writeRegister(0x02, reg02);
+    result.totalUs = micros() - start;
+    return result;
+}
+
+// =========================================================
+// Register Access
+// =========================================================
+bool FastTuner::readRegister(uint8_t reg, uint16_t &value)
+{
+    bool ok;
+    if (Capture::replayTunerRegister(reg, value, ok))
+        return ok;
+
+    wire->beginTransmission(RDA5807_I2C_REG_ADDR);
+    wire->write(reg);
+    ok = wire->endTransmission(false) == 0 && wire->requestFrom((uint8_t)RDA5807_I2C_REG_ADDR, (uint8_t)2) == 2;
+    if (ok)
+    {
+        uint16_t hi = wire->read();
+        value = (hi << 8) | (uint8_t)wire->read();
+    }
+    Capture::tunerRegister(reg, value, ok);
+    return ok;
+}
+
+bool FastTuner::writeRegister(uint8_t reg, uint16_t value)
+{
+    wire->beginTransmission(RDA5807_I2C_REG_ADDR);
+    wire->write(reg);
+    wire->write(value >> 8);
+    wire->write(value & 0xFF);
+    return wire->endTransmission() == 0;
+}
+
+bool FastTuner::readStatus(uint16_t &reg0a, uint16_t &reg0b)
+{
+    bool ok;
+    if (Capture::replayTunerStatus(reg0a, reg0b, ok))
+        return ok;
+
+    ok = wire->requestFrom((uint8_t)RDA5807_I2C_SEQ_ADDR, (uint8_t)4) == 4;
+    if (ok)
+    {
+        uint16_t hi = wire->read();
+        reg0a = (hi << 8) | (uint8_t)wire->read();
+        hi = wire->read();
+        reg0b = (hi << 8) | (uint8_t)wire->read();
+    }
+    Capture::tunerStatus(reg0a, reg0b, ok);
+    return ok;
+}
@@ -1,18 +1,34 @@
 #include "FileManager.h"
 #include "Constants.h"
+#include "Metrics.h"
+#include "Capture.h"
+#include "HangDetector.h"
 
 // =========================================================
 // Hàm Helper: Nối đường dẫn thư mục gốc
 // =========================================================
-// Hàm này đảm bảo mọi đường dẫn đều bắt đầu bằng /famio/
-String getFullPath(const char *path)
+// Ghi vào bộ đệm của nơi gọi (trên stack) thay vì cấp phát String mỗi lần mở file.
+// Đảm bảo mọi đường dẫn đều bắt đầu bằng /famio/
+static bool buildFullPath(const char *path, char *out, size_t size)
 {
     // Tránh nối đôi dấu '/', ví dụ: /famio//index.html
-    if (path[0] == '/')
-    {
-        return String(PROJECT_ROOT_DIR) + String(path);
-    }
-    return String(PROJECT_ROOT_DIR) + "/" + String(path);
+    int len = snprintf(out, size, path[0] == '/' ? "%s%s" : "%s/%s", PROJECT_ROOT_DIR, path);
+    return len > 0 && (size_t)len < size;
+}
+
+// Số lần mở/ghi file thất bại
+static MetricCounter *sdErrors()
+{
+    static MetricCounter *errors = Metrics::counter("sd_errors_total");
+    return errors;
+}
+
+// Đếm thao tác SD (cho metrics và benchmark manifest)
+void FileManager::noteSdOps(uint32_t n)
+{
+    static MetricCounter *ops = Metrics::counter("sd_ops_total");
+    sdOps += n;
+    Metrics::inc(ops, n);
 }
 
 // =========================================================
@@ -22,12 +38,17 @@ String getFullPath(const char *path)
 bool FileManager::begin()
 {
     Serial.print("Đang khởi tạo SD Card...");
-    // Khởi tạo với Pin CS được định nghĩa (SD_CS_PIN)
-    if (!SD.begin(SD_CS_PIN))
+    // Khởi tạo với Pin CS được định nghĩa (SD_CS_PIN), thử xung SPI cao trước
+    uint32_t freq = SD_SPI_FREQ_HZ;
+    if (!SD.begin(SD_CS_PIN, SPI, freq))
     {
-        Serial.println("Lỗi: Khởi tạo SD Card thất bại.");
-        sd_initialized = false;
-        return false;
+        freq = SD_SPI_FREQ_SAFE_HZ;
+        if (!SD.begin(SD_CS_PIN, SPI, freq))
+        {
+            Serial.println("Lỗi: Khởi tạo SD Card thất bại.");
+            sd_initialized = false;
+            return false;
+        }
     }
 
     // Kiểm tra loại thẻ
@@ -39,9 +60,11 @@ bool FileManager::begin()
         return false;
     }
 
-    Serial.printf("Thành công! Loại thẻ: %d\n", cardType);
+    Serial.printf("Thành công! Loại thẻ: %d, SPI %lu MHz\n", cardType, (unsigned long)(freq / 1000000));
     Serial.printf("Kích thước thẻ: %.2f GB\n", SD.cardSize() / (1024.0 * 1024.0 * 1024.0));
     sd_initialized = true;
+
+    refreshUiManifest();
     return true;
 }
 
@@ -51,6 +74,11 @@ bool FileManager::begin()
 
 bool FileManager::loadJsonFile(const char *path, JsonDocument *doc)
 {
+    static MetricHistogram *latency = Metrics::histogram("sd_op_us", "op", "load_json");
+    MetricTimer timer(latency);
+    CaptureFileScope capture(CAP_FILE_LOAD_JSON, path);
+    noteSdOps();
+
     if (!sd_initialized)
     {
         Serial.println("Lỗi: SD Card chưa được khởi tạo.");
@@ -58,26 +86,31 @@ bool FileManager::loadJsonFile(const char *path, JsonDocument *doc)
     }
 
     // SỬ DỤNG HÀM HELPER ĐỂ CÓ ĐƯỜNG DẪN ĐẦY ĐỦ: /famio/config.json
-    String fullPath = getFullPath(path);
+    char fullPath[FILE_PATH_MAX];
+    if (!buildFullPath(path, fullPath, sizeof(fullPath)))
+        return false;
 
-    File file = SD.open(fullPath.c_str());
+    File file = SD.open(fullPath);
     if (!file)
     {
-        Serial.printf("Lỗi: Không thể mở file JSON: %s\n", fullPath.c_str());
+        Serial.printf("Lỗi: Không thể mở file JSON: %s\n", fullPath);
+        Metrics::inc(sdErrors());
         return false;
     }
 
     // ... (Phần deserializeJson và xử lý lỗi giữ nguyên) ...
     DeserializationError error = deserializeJson(*doc, file);
+    size_t size = file.size();
     file.close();
 
     if (error)
     {
-        Serial.printf("Lỗi giải mã JSON (%s) trong file: %s\n", error.c_str(), fullPath.c_str());
+        Serial.printf("Lỗi giải mã JSON (%s) trong file: %s\n", error.c_str(), fullPath);
         doc->clear();
         return false;
     }
 
+    capture.succeed(size);
     return true;
 }
 
@@ -87,6 +120,11 @@ bool FileManager::loadJsonFile(const char *path, JsonDocument *doc)
 
 bool FileManager::saveJsonFile(const char *path, const JsonDocument &doc)
 {
+    static MetricHistogram *latency = Metrics::histogram("sd_op_us", "op", "save_json");
+    MetricTimer timer(latency);
+    CaptureFileScope capture(CAP_FILE_SAVE_JSON, path);
+    noteSdOps();
+
     if (!sd_initialized)
     {
         Serial.println("Lỗi: SD Card chưa được khởi tạo.");
@@ -94,25 +132,31 @@ bool FileManager::saveJsonFile(const char *path, const JsonDocument &doc)
     }
 
     // SỬ DỤNG HÀM HELPER ĐỂ CÓ ĐƯỜNG DẪN ĐẦY ĐỦ: /famio/ui/config
-    String fullPath = getFullPath(path);
+    char fullPath[FILE_PATH_MAX];
+    if (!buildFullPath(path, fullPath, sizeof(fullPath)))
+        return false;
 
-    File file = SD.open(fullPath.c_str(), FILE_WRITE);
+    File file = SD.open(fullPath, FILE_WRITE);
     if (!file)
     {
-        Serial.printf("Lỗi: Không thể mở file để ghi: %s\n", fullPath.c_str());
+        Serial.printf("Lỗi: Không thể mở file để ghi: %s\n", fullPath);
+        Metrics::inc(sdErrors());
         return false;
     }
 
     // ... (Phần serializeJson và xử lý lỗi giữ nguyên) ...
 
-    if (serializeJson(doc, file) == 0)
+    size_t written = serializeJson(doc, file);
+    if (written == 0)
     {
-        Serial.printf("Lỗi: Ghi file JSON thất bại: %s\n", fullPath.c_str());
+        Serial.printf("Lỗi: Ghi file JSON thất bại: %s\n", fullPath);
+        Metrics::inc(sdErrors());
         file.close();
         return false;
     }
 
     file.close();
+    capture.succeed(written);
     return true;
 }
 
@@ -120,15 +164,294 @@ bool FileManager::saveJsonFile(const char *path, const JsonDocument &doc)
 // Mở file tĩnh (Phục vụ Web Server)
 // =========================================================
 
-File FileManager::openFile(const char *path)
+File FileManager::openFile(const char *path, const char *mode)
 {
+    static MetricHistogram *latency = Metrics::histogram("sd_op_us", "op", "open");
+    MetricTimer timer(latency);
+    CaptureFileScope capture(mode[0] == 'w' ? CAP_FILE_OPEN_WRITE : mode[0] == 'a' ? CAP_FILE_OPEN_APPEND : CAP_FILE_OPEN_READ, path);
+    noteSdOps();
+
     if (!sd_initialized)
     {
         return File();
     }
 
     // SỬ DỤNG HÀM HELPER ĐỂ CÓ ĐƯỜNG DẪN ĐẦY ĐỦ: /famio/index.html
-    String fullPath = getFullPath(path);
+    char fullPath[FILE_PATH_MAX];
+    if (!buildFullPath(path, fullPath, sizeof(fullPath)))
+        return File();
+
+    File file = SD.open(fullPath, mode);
+    if (file)
+        capture.succeed(file.size());
+    return file;
+}
+
+// =========================================================
+// Xóa file
+// =========================================================
+
+bool FileManager::removeFile(const char *path)
+{
+    static MetricHistogram *latency = Metrics::histogram("sd_op_us", "op", "remove");
+    MetricTimer timer(latency);
+    CaptureFileScope capture(CAP_FILE_REMOVE, path);
+    noteSdOps();
+
+    if (!sd_initialized)
+    {
+        return false;
+    }
+
+    char fullPath[FILE_PATH_MAX];
+    if (!buildFullPath(path, fullPath, sizeof(fullPath)))
+        return false;
+    if (!SD.remove(fullPath))
+        return false;
+    capture.succeed();
+    return true;
+}
+
+// =========================================================
+// Thư mục
+// =========================================================
+
+bool FileManager::makeDir(const char *path)
+{
+    CaptureFileScope capture(CAP_FILE_MKDIR, path);
+    char fullPath[FILE_PATH_MAX];
+    if (!sd_initialized || !buildFullPath(path, fullPath, sizeof(fullPath)))
+        return false;
+    noteSdOps();
+    if (!SD.exists(fullPath) && !SD.mkdir(fullPath))
+        return false;
+    capture.succeed();
+    return true;
+}
+
+bool FileManager::renamePath(const char *from, const char *to)
+{
+    CaptureFileScope capture(CAP_FILE_RENAME, from);
+    char fullFrom[FILE_PATH_MAX];
+    char fullTo[FILE_PATH_MAX];
+    if (!sd_initialized || !buildFullPath(from, fullFrom, sizeof(fullFrom)) ||
+        !buildFullPath(to, fullTo, sizeof(fullTo)))
+        return false;
+    noteSdOps();
+    if (!SD.rename(fullFrom, fullTo))
+        return false;
+    capture.succeed();
+    return true;
+}
 
-    return SD.open(fullPath.c_str());
+bool FileManager::exists(const char *path)
+{
+    CaptureFileScope capture(CAP_FILE_EXISTS, path);
+    char fullPath[FILE_PATH_MAX];
+    if (!sd_initialized || !buildFullPath(path, fullPath, sizeof(fullPath)))
+        return false;
+    noteSdOps();
+    if (!SD.exists(fullPath))
+        return false;
+    capture.succeed();
+    return true;
+}
+
+// Xóa nội dung thư mục theo đường dẫn đầy đủ (đệ quy)
+static bool removeFullTree(const char *fullPath, uint8_t depth)
+{
+    File dir = SD.open(fullPath);
+    if (!dir)
+        return true; // Không tồn tại: coi như đã xóa
+    if (!dir.isDirectory())
+    {
+        dir.close();
+        return SD.remove(fullPath);
+    }
+
+    bool ok = true;
+    char child[FILE_PATH_MAX];
+    File entry = dir.openNextFile();
+    while (entry)
+    {
+        snprintf(child, sizeof(child), "%s", entry.path());
+        bool isDir = entry.isDirectory();
+        entry.close();
+        if (isDir)
+            ok = (depth < 8 && removeFullTree(child, depth + 1)) && ok;
+        else
+            ok = SD.remove(child) && ok;
+        entry = dir.openNextFile();
+    }
+    dir.close();
+    return SD.rmdir(fullPath) && ok;
+}
+
+bool FileManager::removeTree(const char *path)
+{
+    char fullPath[FILE_PATH_MAX];
+    if (!sd_initialized || !buildFullPath(path, fullPath, sizeof(fullPath)))
+        return false;
+    noteSdOps();
+    return removeFullTree(fullPath, 0);
+}
+
+// =========================================================
+// Benchmark tốc độ đọc (MB/s) theo kích thước bộ đệm
+// =========================================================
+
+void FileManager::benchmarkRead(const char *path, JsonDocument *doc)
+{
+    static const size_t sizes[] = {512, 4096, FILE_STREAM_BUF_SIZE};
+    uint8_t *buf = (uint8_t *)malloc(FILE_STREAM_BUF_SIZE);
+    if (!buf)
+    {
+        (*doc)["error"] = "out of memory";
+        return;
+    }
+
+    (*doc)["path"] = path;
+    JsonArray runs = (*doc)["runs"].to<JsonArray>();
+    for (size_t chunk : sizes)
+    {
+        File file = openFile(path);
+        if (!file)
+        {
+            (*doc)["error"] = "cannot open file";
+            break;
+        }
+
+        uint32_t start = micros();
+        size_t total = 0;
+        size_t n;
+        // Đọc cả file 3 lần trên task loop: nuôi watchdog mỗi chunk
+        while ((n = file.read(buf, chunk)) > 0)
+        {
+            total += n;
+            HangDetector::feed();
+        }
+        uint32_t us = micros() - start;
+        file.close();
+
+        JsonObject run = runs.add<JsonObject>();
+        run["buffer"] = chunk;
+        run["bytes"] = total;
+        run["us"] = us;
+        // bytes/us == MB/s
+        run["mbps"] = us ? (float)total / us : 0.0f;
+    }
+    free(buf);
+}
+
+// =========================================================
+// Manifest thư mục /ui
+// =========================================================
+
+bool FileManager::readUiMarker(uint32_t &size, uint32_t &mtime)
+{
+    File marker = openFile(UI_PATH UI_MANIFEST_MARKER);
+    if (!marker)
+    {
+        size = 0;
+        mtime = 0;
+        return false;
+    }
+    size = marker.size();
+    mtime = (uint32_t)marker.getLastWrite();
+    marker.close();
+    return true;
+}
+
+bool FileManager::refreshUiManifest()
+{
+    if (!sd_initialized)
+        return false;
+
+    uint32_t markerSize, markerMtime;
+    readUiMarker(markerSize, markerMtime);
+
+    File root = openFile(UI_PATH);
+    uint32_t ops = 0;
+    size_t files = uiManifest.build(root, PROJECT_ROOT_DIR UI_PATH, ops);
+    if (root)
+        root.close();
+    noteSdOps(ops);
+
+    uiManifest.setMarker(markerSize, markerMtime);
+    lastMarkerCheckMs = millis();
+    Serial.printf("FileManager: UI manifest %u files, %lu SD ops, %lu us\n", (unsigned)files,
+                  (unsigned long)ops, (unsigned long)uiManifest.getBuildUs());
+    return uiManifest.isReady();
+}
+
+const UiManifest::Entry *FileManager::findUiFile(const char *relPath)
+{
+    // Kiểm tra marker tối đa mỗi UI_MANIFEST_CHECK_MS (1 thao tác SD)
+    if (sd_initialized && millis() - lastMarkerCheckMs >= UI_MANIFEST_CHECK_MS)
+    {
+        lastMarkerCheckMs = millis();
+        uint32_t size, mtime;
+        readUiMarker(size, mtime);
+        if (uiManifest.markerChanged(size, mtime))
+            refreshUiManifest();
+    }
+    return uiManifest.find(relPath);
+}
+
+void FileManager::benchmarkUiLookups(JsonDocument *doc)
+{
+    // Một lần tải trang điển hình + các đường dẫn bot/favicon hay gặp
+    static const char *paths[] = {"/index.html", "/app.js", "/style.css", "/favicon.ico",
+                                  "/robots.txt", "/apple-touch-icon.png", "/wp-login.php", "/.env"};
+    const uint8_t n = sizeof(paths) / sizeof(paths[0]);
+
+    // 1. Dò SD như trước: mở file và thử thêm bản .gz
+    uint32_t opsBefore = sdOps;
+    uint32_t start = micros();
+    uint8_t found = 0;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        char fsPath[FILE_PATH_MAX];
+        snprintf(fsPath, sizeof(fsPath), UI_PATH "%s.gz", paths[i]);
+        File gz = openFile(fsPath);
+        if (gz)
+            gz.close();
+        fsPath[strlen(fsPath) - 3] = '\0';
+        File f = openFile(fsPath);
+        if (f)
+        {
+            found++;
+            f.close();
+        }
+    }
+    JsonObject probe = (*doc)["probe"].to<JsonObject>();
+    probe["sd_ops"] = sdOps - opsBefore;
+    probe["us"] = micros() - start;
+    probe["found"] = found;
+
+    // 2. Manifest: chỉ mở file thật sự tồn tại
+    opsBefore = sdOps;
+    start = micros();
+    found = 0;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        const UiManifest::Entry *e = findUiFile(paths[i]);
+        if (!e)
+            continue;
+        char fsPath[FILE_PATH_MAX];
+        snprintf(fsPath, sizeof(fsPath), UI_PATH "%s%s", paths[i], (e->flags & UiManifest::GZIP_ONLY) ? ".gz" : "");
+        File f = openFile(fsPath);
+        if (f)
+        {
+            found++;
+            f.close();
+        }
+    }
+    JsonObject manifest = (*doc)["manifest"].to<JsonObject>();
+    manifest["sd_ops"] = sdOps - opsBefore;
+    manifest["us"] = micros() - start;
+    manifest["found"] = found;
+    manifest["ready"] = uiManifest.isReady();
+    manifest["files"] = uiManifest.size();
+    manifest["build_us"] = uiManifest.getBuildUs();
 }
\ No newline at end of file
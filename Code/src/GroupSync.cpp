@@ -0,0 +1,456 @@
+#include "GroupSync.h"
+#include <ESPmDNS.h>
+
+#define GROUP_MAGIC 0x50524746UL // "FGRP"
+#define GROUP_VERSION 1
+#define FLAG_ENABLED 0x01
+#define FLAG_POWERED 0x02
+
+// =========================================================
+// Constructor / Setup
+// =========================================================
+GroupSync::GroupSync(RadioController *ctrl, ConfigStore *config)
+    : controller(ctrl), configStore(config), port(GROUP_PORT), enabled(false), nodeId(0), leaderId(0), seq(0),
+      lastHeartbeatMs(0), holdUntilMs(0), forwardSentMs(0), lastPropagationUs(0), started(false), discoveredCount(0),
+      propagation(nullptr), applied(nullptr), stale(nullptr)
+{
+    for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+        peers[i] = Peer();
+    pendingForward.type = RADIO_CMD_NONE;
+    pendingForward.value = 0;
+    discoveredLock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void GroupSync::begin(uint16_t listenPort)
+{
+    port = listenPort;
+
+    // Node id from the factory MAC (folded to 32 bits, never 0)
+    uint64_t mac = ESP.getEfuseMac();
+    nodeId = (uint32_t)(mac ^ (mac >> 32)) ^ port;
+    if (nodeId == 0)
+        nodeId = 1;
+
+    propagation = Metrics::histogram("group_propagation_us");
+    applied = Metrics::counter("group_commands_applied_total");
+    stale = Metrics::counter("group_commands_ignored_total");
+
+    enabled = configStore->get().groupEnabled != 0;
+    udp.begin(port);
+    controller->setListener(onLocalCommand, this);
+    started.store(true, std::memory_order_release);
+
+    if (port == GROUP_PORT)
+        xTaskCreate(discoveryTask, "group_mdns", 4096, this, 1, nullptr);
+    Serial.printf("GroupSync: Node %08lx on UDP %u, group mode %s\n", (unsigned long)nodeId, port,
+                  enabled ? "ON" : "OFF");
+}
+
+void GroupSync::setEnabled(bool on)
+{
+    if (on == enabled)
+        return;
+    enabled = on;
+    configStore->get().groupEnabled = on ? 1 : 0;
+    configStore->commit();
+    configStore->saveCommonJson();
+
+    // Announce right away instead of waiting for the next heartbeat
+    lastHeartbeatMs = millis() - GROUP_HEARTBEAT_MS;
+    Serial.printf("GroupSync: Group mode %s\n", on ? "ON" : "OFF");
+}
+
+void GroupSync::addPeer(IPAddress ip, uint16_t peerPort)
+{
+    findPeer(ip, peerPort, true);
+}
+
+// =========================================================
+// Main Loop
+// =========================================================
+void GroupSync::poll()
+{
+    if (!isStarted())
+        return;
+    uint32_t now = millis();
+
+    // Units found by the mDNS task
+    portENTER_CRITICAL(&discoveredLock);
+    uint8_t n = discoveredCount;
+    IPAddress found[GROUP_MAX_PEERS];
+    for (uint8_t i = 0; i < n; i++)
+        found[i] = discovered[i];
+    discoveredCount = 0;
+    portEXIT_CRITICAL(&discoveredLock);
+    for (uint8_t i = 0; i < n; i++)
+        findPeer(found[i], GROUP_PORT, true);
+
+    // Drain the socket
+    int len;
+    while ((len = udp.parsePacket()) > 0)
+    {
+        Packet pkt;
+        if (len != (int)sizeof(pkt) || udp.read((uint8_t *)&pkt, sizeof(pkt)) != (int)sizeof(pkt))
+            continue;
+        if (pkt.magic != GROUP_MAGIC || pkt.version != GROUP_VERSION || pkt.nodeId == nodeId)
+            continue;
+        handlePacket(pkt, udp.remoteIP(), udp.remotePort());
+    }
+
+    // Applying a command may have retuned (tens of ms): peers seen since
+    // then must not look older than the timeout
+    now = millis();
+    electLeader(now);
+
+    if (isLeader())
+    {
+        // Followers that missed the latest CMD get the full state again
+        for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+        {
+            Peer &p = peers[i];
+            if (p.port && p.enabled && p.ackedSeq < seq && now - p.lastSeenMs < GROUP_PEER_TIMEOUT_MS &&
+                now - p.retryMs >= GROUP_RETRY_MS)
+            {
+                Packet hb;
+                fillHeader(hb, PKT_HEARTBEAT);
+                sendPacket(hb, p.ip, p.port);
+                p.retryMs = now;
+            }
+        }
+    }
+    else if (pendingForward.type != RADIO_CMD_NONE)
+    {
+        if ((int32_t)(now - holdUntilMs) >= 0)
+            pendingForward.type = RADIO_CMD_NONE; // Leader never sequenced it; heartbeats win
+        else if (now - forwardSentMs >= GROUP_RETRY_MS)
+            sendForward();
+    }
+
+    if (now - lastHeartbeatMs >= GROUP_HEARTBEAT_MS)
+    {
+        lastHeartbeatMs = now;
+        Packet hb;
+        fillHeader(hb, PKT_HEARTBEAT);
+        // Everyone hears heartbeats, including units not in group mode,
+        // so turning group mode on later finds a ready membership view
+        for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+        {
+            if (peers[i].port)
+                sendPacket(hb, peers[i].ip, peers[i].port);
+        }
+    }
+}
+
+// =========================================================
+// Packets
+// =========================================================
+void GroupSync::fillHeader(Packet &pkt, PacketType type)
+{
+    RadioState state = controller->getState();
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.magic = GROUP_MAGIC;
+    pkt.version = GROUP_VERSION;
+    pkt.type = type;
+    pkt.flags = (enabled ? FLAG_ENABLED : 0) | (state.powered ? FLAG_POWERED : 0);
+    pkt.nodeId = nodeId;
+    pkt.leaderId = leaderId;
+    pkt.seq = seq;
+    pkt.channelCode = state.channelCode;
+    pkt.volume = state.volume;
+    pkt.sentUs = micros();
+}
+
+void GroupSync::sendPacket(Packet &pkt, IPAddress ip, uint16_t toPort)
+{
+    udp.beginPacket(ip, toPort);
+    udp.write((const uint8_t *)&pkt, sizeof(pkt));
+    udp.endPacket();
+}
+
+void GroupSync::broadcast(Packet &pkt)
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+    {
+        const Peer &p = peers[i];
+        if (p.port && p.enabled && now - p.lastSeenMs < GROUP_PEER_TIMEOUT_MS)
+            sendPacket(pkt, p.ip, p.port);
+    }
+}
+
+void GroupSync::handlePacket(const Packet &pkt, IPAddress from, uint16_t fromPort)
+{
+    uint32_t now = millis();
+    Peer *peer = findPeer(from, fromPort, true);
+    if (peer)
+    {
+        peer->id = pkt.nodeId;
+        peer->lastSeenMs = now;
+        peer->enabled = (pkt.flags & FLAG_ENABLED) != 0;
+    }
+    if (!enabled || !(pkt.flags & FLAG_ENABLED))
+        return;
+
+    // A new member may change the leader before we look at the payload
+    electLeader(now);
+
+    switch (pkt.type)
+    {
+    case PKT_HEARTBEAT:
+        if (pkt.nodeId == leaderId && !isLeader())
+        {
+            // A leader behind us (just rejoined) catches up from our heartbeat
+            if (pkt.seq < seq)
+                break;
+            convergeTo(pkt);
+            Packet ack;
+            fillHeader(ack, PKT_ACK);
+            ack.cmdType = PKT_HEARTBEAT;
+            ack.sentUs = pkt.sentUs;
+            sendPacket(ack, from, fromPort);
+        }
+        else if (isLeader() && pkt.seq > seq)
+        {
+            // The group moved on while we were away: continue its numbering
+            // and take over its state instead of imposing ours
+            seq = pkt.seq;
+            adoptState(pkt);
+        }
+        break;
+
+    case PKT_CMD:
+    {
+        if (pkt.nodeId != leaderId)
+        {
+            Metrics::inc(stale);
+            break;
+        }
+        if (pkt.seq > seq)
+        {
+            bool missed = pkt.seq > seq + 1;
+            seq = pkt.seq;
+            holdUntilMs = 0;
+            pendingForward.type = RADIO_CMD_NONE;
+            applyRemote((RadioCommandType)pkt.cmdType, pkt.value);
+            // A CMD before this one was lost: the leader's state in this one
+            // covers it (the ACK below tells the leader we are up to date)
+            if (missed)
+                adoptState(pkt);
+        }
+        // ACK duplicates too: the leader may have missed the first ACK
+        Packet ack;
+        fillHeader(ack, PKT_ACK);
+        ack.cmdType = PKT_CMD;
+        ack.seq = pkt.seq;
+        ack.sentUs = pkt.sentUs;
+        sendPacket(ack, from, fromPort);
+        break;
+    }
+
+    case PKT_FORWARD:
+        if (isLeader())
+        {
+            RadioCommand cmd = {(RadioCommandType)pkt.cmdType, pkt.value};
+            applyRemote(cmd.type, cmd.value);
+            issue(cmd);
+        }
+        break;
+
+    case PKT_ACK:
+        if (isLeader())
+        {
+            if (peer && pkt.seq > peer->ackedSeq)
+                peer->ackedSeq = pkt.seq;
+            if (pkt.cmdType == PKT_CMD)
+            {
+                lastPropagationUs = micros() - pkt.sentUs;
+                Metrics::record(propagation, lastPropagationUs);
+            }
+        }
+        break;
+    }
+}
+
+// =========================================================
+// Replication
+// =========================================================
+void GroupSync::onLocalCommand(const RadioCommand &effect, RadioCommandSource, void *ctx)
+{
+    GroupSync *self = static_cast<GroupSync *>(ctx);
+    if (!self->enabled || self->leaderId == 0)
+        return;
+
+    if (self->isLeader())
+    {
+        self->issue(effect);
+        return;
+    }
+
+    // Follower: already applied locally, hand it to the leader to sequence.
+    // Resent from poll() until a newer CMD arrives or the hold expires.
+    self->pendingForward = effect;
+    self->holdUntilMs = millis() + GROUP_HEARTBEAT_MS;
+    self->sendForward();
+}
+
+void GroupSync::sendForward()
+{
+    forwardSentMs = millis();
+    Peer *leader = leaderPeer();
+    if (!leader)
+        return;
+
+    Packet fwd;
+    fillHeader(fwd, PKT_FORWARD);
+    fwd.cmdType = pendingForward.type;
+    fwd.value = pendingForward.value;
+    sendPacket(fwd, leader->ip, leader->port);
+}
+
+void GroupSync::issue(const RadioCommand &cmd)
+{
+    Packet pkt;
+    seq++;
+    fillHeader(pkt, PKT_CMD);
+    pkt.cmdType = cmd.type;
+    pkt.value = cmd.value;
+    broadcast(pkt);
+}
+
+void GroupSync::applyRemote(RadioCommandType type, int32_t value)
+{
+    RadioCommand cmd = {type, value};
+    if (controller->apply(cmd, RADIO_SRC_GROUP))
+        Metrics::inc(applied);
+}
+
+void GroupSync::convergeTo(const Packet &hb)
+{
+    // A command we forwarded is still on its way back from the leader
+    if ((int32_t)(millis() - holdUntilMs) < 0)
+        return;
+    seq = hb.seq;
+    adoptState(hb);
+}
+
+void GroupSync::adoptState(const Packet &pkt)
+{
+    RadioState state = controller->getState();
+    bool powered = (pkt.flags & FLAG_POWERED) != 0;
+    if (powered != state.powered)
+        applyRemote(RADIO_CMD_POWER, powered ? 1 : 0);
+    if (!powered)
+        return;
+    if (pkt.channelCode != state.channelCode)
+        applyRemote(RADIO_CMD_TUNE, pkt.channelCode);
+    if (pkt.volume != state.volume)
+        applyRemote(RADIO_CMD_VOLUME, pkt.volume);
+}
+
+GroupSync::Peer *GroupSync::leaderPeer()
+{
+    for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+    {
+        if (peers[i].port && peers[i].id == leaderId)
+            return &peers[i];
+    }
+    return nullptr;
+}
+
+// =========================================================
+// Membership / Election
+// =========================================================
+void GroupSync::electLeader(uint32_t now)
+{
+    uint32_t best = enabled ? nodeId : 0;
+    for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+    {
+        const Peer &p = peers[i];
+        if (!best)
+            break;
+        if (p.id && p.enabled && now - p.lastSeenMs < GROUP_PEER_TIMEOUT_MS && p.id < best)
+            best = p.id;
+    }
+
+    if (best != leaderId)
+    {
+        leaderId = best;
+        if (best)
+            Serial.printf("GroupSync: Leader is now %08lx%s\n", (unsigned long)best, best == nodeId ? " (this unit)" : "");
+    }
+}
+
+GroupSync::Peer *GroupSync::findPeer(IPAddress ip, uint16_t peerPort, bool create)
+{
+    Peer *oldest = nullptr;
+    for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+    {
+        Peer &p = peers[i];
+        if (p.port == peerPort && p.ip == ip)
+            return &p;
+        if (!oldest || !p.port || (oldest->port && p.lastSeenMs < oldest->lastSeenMs))
+            oldest = &p;
+    }
+    if (!create)
+        return nullptr;
+
+    // Free slot, or the unit heard from least recently
+    *oldest = Peer();
+    oldest->ip = ip;
+    oldest->port = peerPort;
+    return oldest;
+}
+
+void GroupSync::discoveryTask(void *arg)
+{
+    GroupSync *self = static_cast<GroupSync *>(arg);
+    while (true)
+    {
+        if (WiFi.status() == WL_CONNECTED)
+        {
+            int n = MDNS.queryService(GROUP_MDNS_SERVICE, "udp");
+            IPAddress self_ip = WiFi.localIP();
+            portENTER_CRITICAL(&self->discoveredLock);
+            for (int i = 0; i < n && self->discoveredCount < GROUP_MAX_PEERS; i++)
+            {
+                if (MDNS.IP(i) != self_ip)
+                    self->discovered[self->discoveredCount++] = MDNS.IP(i);
+            }
+            portEXIT_CRITICAL(&self->discoveredLock);
+        }
+        vTaskDelay(pdMS_TO_TICKS(GROUP_DISCOVERY_MS));
+    }
+}
+
+// =========================================================
+// Status
+// =========================================================
+void GroupSync::getStatus(JsonDocument *doc)
+{
+    char id[9];
+    uint32_t now = millis();
+
+    (*doc)["enabled"] = enabled;
+    snprintf(id, sizeof(id), "%08lx", (unsigned long)nodeId);
+    (*doc)["node_id"] = id;
+    snprintf(id, sizeof(id), "%08lx", (unsigned long)leaderId);
+    (*doc)["leader_id"] = id;
+    (*doc)["role"] = !enabled ? "standalone" : (isLeader() ? "leader" : "follower");
+    (*doc)["seq"] = seq;
+    (*doc)["last_propagation_us"] = lastPropagationUs;
+
+    JsonArray list = (*doc)["peers"].to<JsonArray>();
+    for (uint8_t i = 0; i < GROUP_MAX_PEERS; i++)
+    {
+        const Peer &p = peers[i];
+        if (!p.port)
+            continue;
+        JsonObject peer = list.add<JsonObject>();
+        snprintf(id, sizeof(id), "%08lx", (unsigned long)p.id);
+        peer["id"] = id;
+        peer["ip"] = p.ip.toString();
+        peer["port"] = p.port;
+        peer["enabled"] = p.enabled;
+        peer["age_ms"] = p.lastSeenMs ? now - p.lastSeenMs : -1;
+    }
+}
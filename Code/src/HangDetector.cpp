@@ -0,0 +1,279 @@
+#include "HangDetector.h"
+#include <esp_task_wdt.h>
+#include <esp_system.h>
+#include "TraceLog.h"
+
+#define HANG_MAGIC 0x48414E47UL // "HANG"
+
+enum : uint8_t
+{
+    KIND_ENTER = 1,
+    KIND_EXIT,
+    KIND_OVER,  // Exit after the budget
+    KIND_STALL, // Seen open past the budget by the monitor
+    KIND_RESTART
+};
+
+static const char *const KIND_NAMES[] = {"?", "enter", "exit", "over", "stall", "restart"};
+
+struct SiteInfo
+{
+    const char *name;
+    uint32_t budgetMs;
+    uint8_t flags;
+};
+
+static const SiteInfo SITES[HANG_SITE_COUNT] = {
+#define HANG_INFO(id, name, budget, flags) {name, budget, flags},
+    HANG_SITES(HANG_INFO)
+#undef HANG_INFO
+};
+
+RTC_NOINIT_ATTR HangDetector::State HangDetector::state;
+HangDetector::State HangDetector::previous;
+bool HangDetector::hasPrevious = false;
+int HangDetector::resetReason = 0;
+std::atomic<uint32_t> HangDetector::trailHead(0);
+HangDetector::SiteStats HangDetector::stats[HANG_SITE_COUNT];
+MetricCounter *HangDetector::overBudgetTotal = nullptr;
+MetricCounter *HangDetector::stallTotal = nullptr;
+const char *HangDetector::labels[HANG_MAX_LABELS] = {"-"};
+std::atomic<uint16_t> HangDetector::labelCount(1);
+
+static const char *resetReasonName(int reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_POWERON: return "power_on";
+    case ESP_RST_SW: return "software";
+    case ESP_RST_PANIC: return "panic";
+    case ESP_RST_INT_WDT: return "int_wdt";
+    case ESP_RST_TASK_WDT: return "task_wdt";
+    case ESP_RST_WDT: return "wdt";
+    case ESP_RST_BROWNOUT: return "brownout";
+    case ESP_RST_DEEPSLEEP: return "deep_sleep";
+    default: return "other";
+    }
+}
+
+// =========================================================
+// Setup
+// =========================================================
+void HangDetector::begin()
+{
+    resetReason = esp_reset_reason();
+
+    // RTC memory is garbage after power-on; after any other reset it holds
+    // the previous run's open sites and trail
+    if (state.magic == HANG_MAGIC && resetReason != ESP_RST_POWERON && resetReason != ESP_RST_BROWNOUT &&
+        resetReason != ESP_RST_DEEPSLEEP)
+    {
+        previous = state;
+        hasPrevious = true;
+
+        // The heartbeat is up to one monitor period old: anything stamped
+        // later happened closer to the reset
+        uint32_t last = previous.lastBeatMs;
+        for (uint8_t i = 0; i < HANG_SITE_COUNT; i++)
+            if (previous.open[i].startMs > last)
+                last = previous.open[i].startMs;
+        uint32_t newest = previous.head ? previous.trail[(previous.head - 1) & (HANG_TRAIL_SIZE - 1)].ms : 0;
+        if (newest > last)
+            last = newest;
+        previous.lastBeatMs = last;
+        Serial.printf("HangDetector: Reset (%s), cause %s, last beat %lu ms\n", resetReasonName(resetReason),
+                      previous.cause < HANG_SITE_COUNT ? SITES[previous.cause].name : "-",
+                      (unsigned long)previous.lastBeatMs);
+        for (uint8_t i = 0; i < HANG_SITE_COUNT; i++)
+        {
+            const OpenSlot &slot = previous.open[i];
+            // Labels are not registered yet this early: print the id
+            if (slot.startMs && previous.lastBeatMs >= slot.startMs)
+                Serial.printf("HangDetector:   open %s (label %u) for %lu ms\n", SITES[i].name, slot.label,
+                              (unsigned long)(previous.lastBeatMs - slot.startMs));
+        }
+    }
+
+    // The sequence restarts with the trail, or head would run ahead of it
+    memset(&state, 0, sizeof(state));
+    trailHead.store(0, std::memory_order_relaxed);
+    state.magic = HANG_MAGIC;
+    state.cause = HANG_SITE_COUNT;
+
+    // Totals only: the per-site breakdown is in /api/system/hangs
+    overBudgetTotal = Metrics::counter("hang_over_budget_total");
+    stallTotal = Metrics::counter("hang_stalls_total");
+
+    // Arduino already runs the TWDT for the idle tasks; re-init sets our
+    // timeout with panic (reset) enabled, then the loop task is added and
+    // fed by the core after every loop() pass
+    esp_task_wdt_init(HANG_TWDT_TIMEOUT_S, true);
+    enableLoopWDT();
+
+    xTaskCreatePinnedToCore(monitorTask, "hang", 3072, nullptr, 1, nullptr, 0);
+}
+
+// =========================================================
+// Hot path
+// =========================================================
+void HangDetector::crumb(HangSite site, uint8_t kind, uint16_t label)
+{
+    uint32_t seq = trailHead.fetch_add(1, std::memory_order_relaxed);
+    Breadcrumb &b = state.trail[seq & (HANG_TRAIL_SIZE - 1)];
+    b.ms = millis();
+    b.site = site;
+    b.kind = kind;
+    b.label = label;
+    state.head = seq + 1;
+}
+
+void HangDetector::enter(HangSite site, uint16_t label)
+{
+    OpenSlot &slot = state.open[site];
+    slot.label = label;
+    slot.stalled = 0;
+    uint32_t now = millis();
+    slot.startMs = now ? now : 1;
+    if (SITES[site].flags & HANG_TRAIL)
+        crumb(site, KIND_ENTER, label);
+}
+
+void HangDetector::leave(HangSite site)
+{
+    OpenSlot &slot = state.open[site];
+    uint32_t elapsed = millis() - slot.startMs;
+    slot.startMs = 0;
+
+    SiteStats &s = stats[site];
+    s.runs++;
+    if (elapsed > s.maxMs)
+        s.maxMs = elapsed;
+    bool over = elapsed > SITES[site].budgetMs;
+    if (over)
+    {
+        s.overBudget++;
+        Metrics::inc(overBudgetTotal);
+    }
+    if (over || (SITES[site].flags & HANG_TRAIL))
+        crumb(site, over ? KIND_OVER : KIND_EXIT, slot.label);
+}
+
+void HangDetector::feed()
+{
+    esp_task_wdt_reset();
+}
+
+uint16_t HangDetector::label(const char *name)
+{
+    uint16_t id = labelCount.fetch_add(1);
+    if (id >= HANG_MAX_LABELS)
+        return 0;
+    labels[id] = name;
+    return id;
+}
+
+void HangDetector::restart(HangSite site)
+{
+    state.cause = site;
+    state.lastBeatMs = millis();
+    crumb(site, KIND_RESTART, state.open[site].label);
+    Serial.printf("HangDetector: Restarting from %s\n", SITES[site].name);
+    delay(100);
+    ESP.restart();
+}
+
+// =========================================================
+// Monitor
+// =========================================================
+void HangDetector::monitorTask(void *)
+{
+    while (true)
+    {
+        uint32_t now = millis();
+        state.lastBeatMs = now;
+        for (uint8_t i = 0; i < HANG_SITE_COUNT; i++)
+        {
+            OpenSlot &slot = state.open[i];
+            uint32_t start = slot.startMs;
+            if (!start || now - start <= SITES[i].budgetMs)
+                continue;
+
+            if (!slot.stalled)
+            {
+                slot.stalled = 1;
+                stats[i].stalls++;
+                Metrics::inc(stallTotal);
+                crumb((HangSite)i, KIND_STALL, slot.label);
+                TRACE_WARN(HANG_STALL, i, now - start, SITES[i].budgetMs);
+            }
+            if (now - start > HANG_FATAL_MS)
+                restart((HangSite)i);
+        }
+        delay(HANG_MONITOR_INTERVAL_MS);
+    }
+}
+
+// =========================================================
+// Report
+// =========================================================
+void HangDetector::reportState(const State &s, uint32_t nowMs, JsonObject out)
+{
+    JsonArray open = out["open"].to<JsonArray>();
+    for (uint8_t i = 0; i < HANG_SITE_COUNT; i++)
+    {
+        const OpenSlot &slot = s.open[i];
+        if (!slot.startMs || nowMs < slot.startMs)
+            continue;
+        JsonObject o = open.add<JsonObject>();
+        o["site"] = SITES[i].name;
+        o["label"] = slot.label < HANG_MAX_LABELS && labels[slot.label] ? labels[slot.label] : "?";
+        o["elapsed_ms"] = nowMs - slot.startMs;
+        o["budget_ms"] = SITES[i].budgetMs;
+    }
+
+    // Oldest first
+    JsonArray trail = out["trail"].to<JsonArray>();
+    uint32_t count = s.head < HANG_TRAIL_SIZE ? s.head : HANG_TRAIL_SIZE;
+    for (uint32_t seq = s.head - count; seq != s.head; seq++)
+    {
+        const Breadcrumb &b = s.trail[seq & (HANG_TRAIL_SIZE - 1)];
+        if (b.site >= HANG_SITE_COUNT || b.kind > KIND_RESTART)
+            continue;
+        JsonObject o = trail.add<JsonObject>();
+        o["ms"] = b.ms;
+        o["site"] = SITES[b.site].name;
+        o["kind"] = KIND_NAMES[b.kind];
+        if (b.label && b.label < HANG_MAX_LABELS && labels[b.label])
+            o["label"] = labels[b.label];
+    }
+}
+
+void HangDetector::report(JsonDocument *doc)
+{
+    (*doc)["reset_reason"] = resetReasonName(resetReason);
+
+    // Labels are registered in the same order every boot, so ids recorded
+    // by the previous run resolve against this run's table
+    if (hasPrevious)
+    {
+        JsonObject last = (*doc)["previous"].to<JsonObject>();
+        last["cause"] = previous.cause < HANG_SITE_COUNT ? SITES[previous.cause].name : "-";
+        last["last_beat_ms"] = previous.lastBeatMs;
+        reportState(previous, previous.lastBeatMs, last);
+    }
+
+    JsonObject current = (*doc)["current"].to<JsonObject>();
+    reportState(state, millis(), current);
+
+    JsonArray sites = (*doc)["sites"].to<JsonArray>();
+    for (uint8_t i = 0; i < HANG_SITE_COUNT; i++)
+    {
+        JsonObject o = sites.add<JsonObject>();
+        o["site"] = SITES[i].name;
+        o["budget_ms"] = SITES[i].budgetMs;
+        o["runs"] = stats[i].runs;
+        o["over_budget"] = stats[i].overBudget;
+        o["stalls"] = stats[i].stalls;
+        o["max_ms"] = stats[i].maxMs;
+    }
+}
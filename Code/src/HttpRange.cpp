@@ -0,0 +1,102 @@
+#include "HttpRange.h"
+#include "HangDetector.h"
+
+enum RangeSpec : uint8_t
+{
+    RANGE_IGNORED,
+    RANGE_OK,
+    RANGE_UNSATISFIABLE
+};
+
+// "bytes=a-b", "bytes=a-", "bytes=-n"
+static RangeSpec parseSpec(const char *header, size_t size, size_t &first, size_t &last)
+{
+    if (strncmp(header, "bytes=", 6) != 0)
+        return RANGE_IGNORED;
+    const char *p = header + 6;
+    char *end;
+
+    if (*p == '-')
+    {
+        // Suffix: the last n bytes
+        unsigned long n = strtoul(p + 1, &end, 10);
+        if (end == p + 1 || *end != '\0')
+            return RANGE_IGNORED;
+        if (n == 0 || size == 0)
+            return RANGE_UNSATISFIABLE;
+        first = n >= size ? 0 : size - n;
+        last = size - 1;
+        return RANGE_OK;
+    }
+
+    unsigned long a = strtoul(p, &end, 10);
+    if (end == p || *end != '-')
+        return RANGE_IGNORED;
+    p = end + 1;
+    unsigned long b = size ? size - 1 : 0;
+    if (*p != '\0')
+    {
+        b = strtoul(p, &end, 10);
+        // Also catches "a-b,c-d": more than one range is not served
+        if (end == p || *end != '\0' || b < a)
+            return RANGE_IGNORED;
+    }
+    if (a >= size)
+        return RANGE_UNSATISFIABLE;
+    first = a;
+    last = b >= size ? size - 1 : b;
+    return RANGE_OK;
+}
+
+HttpRange HttpRange::resolve(const char *header, size_t size)
+{
+    HttpRange range;
+    range.code = 200;
+    range.first = 0;
+    range.length = size;
+    range.contentRange[0] = '\0';
+    if (!header || !*header)
+        return range;
+
+    size_t first, last;
+    switch (parseSpec(header, size, first, last))
+    {
+    case RANGE_OK:
+        range.code = 206;
+        range.first = first;
+        range.length = last - first + 1;
+        snprintf(range.contentRange, sizeof(range.contentRange), "bytes %u-%u/%u", (unsigned)first, (unsigned)last,
+                 (unsigned)size);
+        break;
+    case RANGE_UNSATISFIABLE:
+        range.code = 416;
+        range.length = 0;
+        snprintf(range.contentRange, sizeof(range.contentRange), "bytes */%u", (unsigned)size);
+        break;
+    default:
+        break;
+    }
+    return range;
+}
+
+size_t HttpRange::copy(File &file, Print &out, uint8_t *buf, size_t bufSize) const
+{
+    if (first && !file.seek(first))
+        return 0;
+
+    size_t sent = 0;
+    while (sent < length)
+    {
+        size_t want = length - sent < bufSize ? length - sent : bufSize;
+        size_t n = file.read(buf, want);
+        if (n == 0)
+            break;
+        size_t written = out.write(buf, n);
+        sent += written;
+        if (written != n)
+            break; // Client gone
+        // A large file to a slow client can outlast the loop task's watchdog
+        HangDetector::feed();
+    }
+    return sent;
+}
@@ -0,0 +1,163 @@
+#include "I2SAudioOutput.h"
+#include <driver/i2s.h>
+
+// Run this long without an underrun before the jitter target is shrunk
+#define JITTER_SHRINK_AFTER_MS 30000
+
+// =========================================================
+// Constructor
+// =========================================================
+I2SAudioOutput::I2SAudioOutput(AudioRingBuffer *ring)
+    : ring(ring), task(nullptr), running(false), sampleRate(AUDIO_SAMPLE_RATE),
+      priming(true), cleanChunks(0), underruns(0), framesPlayed(0),
+      jitterTarget(AUDIO_JITTER_MIN_FRAMES)
+{
+}
+
+// =========================================================
+// Initialization
+// =========================================================
+bool I2SAudioOutput::begin(uint32_t rate)
+{
+    if (running)
+        return true;
+
+    sampleRate = rate;
+
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX);
+    config.sample_rate = sampleRate;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+    config.dma_buf_count = I2S_DMA_BUF_COUNT;
+    config.dma_buf_len = I2S_DMA_BUF_LEN;
+    config.use_apll = true;          // Accurate 44.1 kHz clock
+    config.tx_desc_auto_clear = true; // Output silence instead of repeating stale DMA data
+
+    if (i2s_driver_install((i2s_port_t)I2S_OUT_PORT, &config, 0, nullptr) != ESP_OK)
+    {
+        Serial.println("AudioOut: I2S driver install failed.");
+        return false;
+    }
+
+    i2s_pin_config_t pins = {};
+    pins.bck_io_num = I2S_BCK_PIN;
+    pins.ws_io_num = I2S_WS_PIN;
+    pins.data_out_num = I2S_DATA_OUT_PIN;
+    pins.data_in_num = I2S_PIN_NO_CHANGE;
+    i2s_set_pin((i2s_port_t)I2S_OUT_PORT, &pins);
+
+    priming = true;
+    cleanChunks = 0;
+    running = true;
+    if (xTaskCreatePinnedToCore(taskEntry, "audio_out", 4096, this, AUDIO_TASK_PRIORITY, &task, AUDIO_TASK_CORE) != pdPASS)
+    {
+        Serial.println("AudioOut: Failed to start feeder task.");
+        running = false;
+        i2s_driver_uninstall((i2s_port_t)I2S_OUT_PORT);
+        return false;
+    }
+
+    Serial.printf("AudioOut: I2S started at %u Hz.\n", (unsigned)sampleRate);
+    return true;
+}
+
+void I2SAudioOutput::end()
+{
+    if (!running)
+        return;
+
+    running = false;
+    // The feeder wakes at least once per DMA buffer, then deletes itself
+    while (task != nullptr)
+        delay(1);
+
+    i2s_driver_uninstall((i2s_port_t)I2S_OUT_PORT);
+    Serial.println("AudioOut: I2S stopped.");
+}
+
+bool I2SAudioOutput::setSampleRate(uint32_t rate)
+{
+    if (rate == sampleRate)
+        return true;
+
+    sampleRate = rate;
+    if (!running)
+        return true;
+    return i2s_set_sample_rates((i2s_port_t)I2S_OUT_PORT, rate) == ESP_OK;
+}
+
+// =========================================================
+// Feeder Task
+// =========================================================
+void I2SAudioOutput::taskEntry(void *arg)
+{
+    I2SAudioOutput *self = static_cast<I2SAudioOutput *>(arg);
+    self->run();
+    self->task = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void I2SAudioOutput::run()
+{
+    size_t bytesWritten = 0;
+
+    while (running)
+    {
+        size_t got = 0;
+
+        if (priming && ring->available() >= jitterTarget.load(std::memory_order_relaxed))
+            priming = false;
+
+        if (!priming)
+        {
+            got = ring->read(chunk, I2S_DMA_BUF_LEN);
+            if (got < I2S_DMA_BUF_LEN)
+                onUnderrun();
+            else
+                onCleanChunk();
+        }
+
+        // Pad a short (or priming) chunk with silence so DMA timing stays intact
+        if (got < I2S_DMA_BUF_LEN)
+            memset(&chunk[got * 2], 0, (I2S_DMA_BUF_LEN - got) * 2 * sizeof(int16_t));
+
+        // Blocks until one of the two DMA buffers is free: this paces the task
+        i2s_write((i2s_port_t)I2S_OUT_PORT, chunk, sizeof(chunk), &bytesWritten, portMAX_DELAY);
+        framesPlayed.fetch_add(got, std::memory_order_relaxed);
+    }
+}
+
+// =========================================================
+// Adaptive Jitter Buffer
+// =========================================================
+void I2SAudioOutput::onUnderrun()
+{
+    underruns.fetch_add(1, std::memory_order_relaxed);
+    cleanChunks = 0;
+    priming = true;
+
+    // Grow by 50% so a source with bursty delivery settles quickly
+    size_t target = jitterTarget.load(std::memory_order_relaxed);
+    target += target / 2;
+    if (target > AUDIO_JITTER_MAX_FRAMES)
+        target = AUDIO_JITTER_MAX_FRAMES;
+    jitterTarget.store(target, std::memory_order_relaxed);
+}
+
+void I2SAudioOutput::onCleanChunk()
+{
+    cleanChunks++;
+    if ((uint64_t)cleanChunks * I2S_DMA_BUF_LEN * 1000 < (uint64_t)sampleRate * JITTER_SHRINK_AFTER_MS)
+        return;
+
+    // Shrink by 1/8 to win back latency once delivery has been steady
+    cleanChunks = 0;
+    size_t target = jitterTarget.load(std::memory_order_relaxed);
+    target -= target / 8;
+    if (target < AUDIO_JITTER_MIN_FRAMES)
+        target = AUDIO_JITTER_MIN_FRAMES;
+    jitterTarget.store(target, std::memory_order_relaxed);
+}
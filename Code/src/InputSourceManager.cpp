@@ -0,0 +1,160 @@
+#include "InputSourceManager.h"
+
+static const float SOURCE_MA[INPUT_SOURCE_COUNT] = {INPUT_MA_FM, INPUT_MA_BLUETOOTH};
+
+// =========================================================
+// Constructor / Initialization
+// =========================================================
+InputSourceManager::InputSourceManager(RadioController *controller, PowerManager *power, ConfigStore *config,
+                                       BluetoothSink *bluetooth)
+    : controller(controller), fmRadio(controller->getRadio()), powerManager(power), configStore(config),
+      bluetooth(bluetooth), inputSwitch(INPUT_FM), started(false), lastAccountMs(0), switchLatency(nullptr)
+{
+    memset(poweredMs, 0, sizeof(poweredMs));
+    memset(gatedMs, 0, sizeof(gatedMs));
+    memset(switchCount, 0, sizeof(switchCount));
+}
+
+void InputSourceManager::begin()
+{
+    for (uint8_t s = 0; s < INPUT_SOURCE_COUNT; s++)
+        switchCount[s] = Metrics::counter("input_switches_total", "to", InputSwitch::name((InputSource)s));
+    switchLatency = Metrics::histogram("input_switch_us");
+
+    // The tuner stays off at boot as before; a saved Bluetooth selection
+    // brings the stack up (in the background)
+    InputSource saved = configStore->get().inputSource == INPUT_BLUETOOTH ? INPUT_BLUETOOTH : INPUT_FM;
+    inputSwitch = InputSwitch(saved);
+    if (saved == INPUT_BLUETOOTH)
+        powerUp(INPUT_BLUETOOTH);
+
+    lastAccountMs = millis();
+    started.store(true, std::memory_order_release);
+    Serial.printf("InputSource: %s\n", InputSwitch::name(saved));
+}
+
+// =========================================================
+// Switching
+// =========================================================
+bool InputSourceManager::select(InputSource source)
+{
+    if (!isStarted() || !inputSwitch.request(source, millis()))
+        return false;
+
+    Serial.printf("InputSource: Switching to %s\n", InputSwitch::name(source));
+    configStore->get().inputSource = source;
+    configStore->commit();
+    configStore->saveCommonJson();
+    return true;
+}
+
+void InputSourceManager::poll()
+{
+    if (!isStarted())
+        return;
+
+    uint32_t now = millis();
+    bluetooth->poll();
+
+    // Someone else turned the tuner on while Bluetooth plays
+    if (!inputSwitch.isSwitching() && inputSwitch.getActive() == INPUT_BLUETOOTH && fmRadio->isPoweredOn())
+        select(INPUT_FM);
+
+    InputSwitchOutput out = inputSwitch.update(now, isReady(inputSwitch.getActive()));
+    if (out.powerDown >= 0)
+        powerDown((InputSource)out.powerDown);
+    if (out.powerUp >= 0)
+        powerUp((InputSource)out.powerUp);
+    if (out.ampPercent >= 0)
+        powerManager->setVolume(configStore->get().commonVolume * out.ampPercent / 100);
+    if (out.finished)
+    {
+        const InputSwitch::Stats &stats = inputSwitch.getStats();
+        Metrics::inc(switchCount[inputSwitch.getActive()]);
+        Metrics::record(switchLatency, stats.lastLatencyMs * 1000);
+        Serial.printf("InputSource: %s active after %lu ms (%lu ms muted)\n", InputSwitch::name(inputSwitch.getActive()),
+                      (unsigned long)stats.lastLatencyMs, (unsigned long)stats.lastMutedMs);
+    }
+
+    account(now);
+}
+
+// =========================================================
+// Sources
+// =========================================================
+bool InputSourceManager::isPowered(InputSource source) const
+{
+    return source == INPUT_BLUETOOTH ? bluetooth->isReady() : fmRadio->isPoweredOn();
+}
+
+bool InputSourceManager::isReady(InputSource source) const
+{
+    // The tuner is tuned when powerOn() returns; Bluetooth once discoverable
+    // (a phone may take a while longer to reconnect)
+    return isPowered(source);
+}
+
+void InputSourceManager::powerUp(InputSource source)
+{
+    if (source == INPUT_BLUETOOTH)
+        bluetooth->enable();
+    else if (!fmRadio->isPoweredOn())
+        fmRadio->powerOn();
+}
+
+void InputSourceManager::powerDown(InputSource source)
+{
+    if (source == INPUT_BLUETOOTH)
+        bluetooth->disable();
+    else if (fmRadio->isPoweredOn())
+        fmRadio->powerOff();
+}
+
+void InputSourceManager::account(uint32_t nowMs)
+{
+    uint32_t dt = nowMs - lastAccountMs;
+    lastAccountMs = nowMs;
+    InputSource active = inputSwitch.getActive();
+    for (uint8_t s = 0; s < INPUT_SOURCE_COUNT; s++)
+    {
+        if (isPowered((InputSource)s))
+            poweredMs[s] += dt;
+        else if (s != active && isPowered(active))
+            gatedMs[s] += dt;
+    }
+}
+
+// =========================================================
+// Status
+// =========================================================
+void InputSourceManager::getStatus(JsonDocument *doc)
+{
+    const InputSwitch::Stats &stats = inputSwitch.getStats();
+    (*doc)["active"] = InputSwitch::name(inputSwitch.getActive());
+    (*doc)["selected"] = InputSwitch::name(inputSwitch.getTarget());
+    (*doc)["phase"] = InputSwitch::phaseName(inputSwitch.getPhase());
+
+    JsonObject sw = (*doc)["switch"].to<JsonObject>();
+    sw["count"] = stats.switches;
+    sw["last_latency_ms"] = stats.lastLatencyMs;
+    sw["last_muted_ms"] = stats.lastMutedMs;
+    sw["max_latency_ms"] = stats.maxLatencyMs;
+    sw["ready_timeouts"] = stats.readyTimeouts;
+
+    bluetooth->getStatus(doc);
+    JsonObject fm = (*doc)["fm"].to<JsonObject>();
+    fm["powered"] = fmRadio->isPoweredOn();
+
+    // Charge not drawn by the idle source since boot, at the INPUT_MA_* model
+    double savedMah = 0;
+    uint64_t upMs = millis();
+    for (uint8_t s = 0; s < INPUT_SOURCE_COUNT; s++)
+    {
+        JsonObject o = (*doc)[InputSwitch::name((InputSource)s)].as<JsonObject>();
+        o["powered_s"] = poweredMs[s] / 1000;
+        o["gated_s"] = gatedMs[s] / 1000;
+        savedMah += gatedMs[s] * SOURCE_MA[s] / 3600000.0;
+    }
+    (*doc)["saved_mah"] = savedMah;
+    (*doc)["saved_ma_avg"] = upMs ? savedMah * 3600000.0 / upMs : 0.0;
+}
@@ -0,0 +1,125 @@
+#include "InputSwitch.h"
+
+InputSwitch::InputSwitch(InputSource initial)
+    : active(initial), target(initial), phase(PHASE_IDLE), percent(100), fromPercent(100), phaseStartMs(0),
+      requestMs(0), mutedAtMs(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+const char *InputSwitch::name(InputSource source)
+{
+    return source == INPUT_BLUETOOTH ? "bluetooth" : "fm";
+}
+
+const char *InputSwitch::phaseName(Phase p)
+{
+    switch (p)
+    {
+    case PHASE_FADE_OUT:
+        return "fade_out";
+    case PHASE_WAIT_READY:
+        return "wait_ready";
+    case PHASE_FADE_IN:
+        return "fade_in";
+    default:
+        return "idle";
+    }
+}
+
+// =========================================================
+// Requests
+// =========================================================
+bool InputSwitch::request(InputSource to, uint32_t nowMs)
+{
+    if (to >= INPUT_SOURCE_COUNT || to == target)
+        return false;
+
+    target = to;
+    if (phase == PHASE_FADE_OUT && to == active)
+    {
+        // Changed our mind before anything was powered down
+        startFade(PHASE_FADE_IN, nowMs);
+        return true;
+    }
+    if (phase == PHASE_IDLE)
+        requestMs = nowMs;
+    // While waiting or fading in, go back out from wherever the amp is
+    if (phase != PHASE_FADE_OUT)
+        startFade(PHASE_FADE_OUT, nowMs);
+    return true;
+}
+
+void InputSwitch::startFade(Phase fade, uint32_t nowMs)
+{
+    phase = fade;
+    phaseStartMs = nowMs;
+    fromPercent = percent;
+}
+
+// Linear fade from fromPercent; a partial fade takes its share of INPUT_RAMP_MS
+bool InputSwitch::ramp(uint32_t nowMs, uint8_t to)
+{
+    uint32_t distance = fromPercent > to ? fromPercent - to : to - fromPercent;
+    uint32_t durationMs = INPUT_RAMP_MS * distance / 100;
+    uint32_t elapsed = nowMs - phaseStartMs;
+    if (elapsed >= durationMs)
+    {
+        percent = to;
+        return true;
+    }
+    uint32_t step = distance * elapsed / durationMs;
+    percent = to > fromPercent ? fromPercent + step : fromPercent - step;
+    return false;
+}
+
+// =========================================================
+// Sequencing
+// =========================================================
+InputSwitchOutput InputSwitch::update(uint32_t nowMs, bool activeReady)
+{
+    InputSwitchOutput out = {-1, -1, -1, false};
+    uint8_t before = percent;
+
+    switch (phase)
+    {
+    case PHASE_FADE_OUT:
+        if (!ramp(nowMs, 0))
+            break;
+        // Muted: swap the powered source
+        out.powerDown = active;
+        out.powerUp = target;
+        active = target;
+        mutedAtMs = nowMs;
+        phase = PHASE_WAIT_READY;
+        phaseStartMs = nowMs;
+        break;
+
+    case PHASE_WAIT_READY:
+        if (!activeReady && nowMs - phaseStartMs < INPUT_READY_TIMEOUT_MS)
+            break;
+        if (!activeReady)
+            stats.readyTimeouts++;
+        startFade(PHASE_FADE_IN, nowMs);
+        stats.lastMutedMs = nowMs - mutedAtMs;
+        break;
+
+    case PHASE_FADE_IN:
+        if (!ramp(nowMs, 100))
+            break;
+        phase = PHASE_IDLE;
+        out.finished = true;
+        stats.switches++;
+        stats.lastLatencyMs = nowMs - requestMs;
+        if (stats.lastLatencyMs > stats.maxLatencyMs)
+            stats.maxLatencyMs = stats.lastLatencyMs;
+        break;
+
+    default:
+        break;
+    }
+
+    if (percent != before || out.powerDown >= 0)
+        out.ampPercent = percent;
+    return out;
+}
@@ -0,0 +1,155 @@
+#include "ListenStats.h"
+
+#define AGG_MAGIC 0x474C4E4CUL // "LNLG"
+#define AGG_VERSION 1
+#define DAY_S 86400L
+
+static_assert(sizeof(ListenRecord) == 16, "ListenRecord must stay 16 bytes on disk");
+static_assert((LISTEN_DAYS & (LISTEN_DAYS - 1)) == 0, "LISTEN_DAYS must be a power of two");
+
+ListenStats::ListenStats()
+{
+    clear();
+}
+
+void ListenStats::clear()
+{
+    memset(&agg, 0, sizeof(agg));
+    agg.magic = AGG_MAGIC;
+    agg.version = AGG_VERSION;
+    used = 0;
+}
+
+// =========================================================
+// Incremental update
+// =========================================================
+void ListenStats::apply(const ListenRecord &rec, int16_t tzOffsetMin)
+{
+    agg.seq++;
+    agg.sessions++;
+    agg.totalSeconds += rec.durationS;
+
+    if (rec.code == LISTEN_CODE_BLUETOOTH)
+    {
+        agg.bluetoothSeconds += rec.durationS;
+    }
+    else if (ListenAggregate::Station *s = station(rec.code))
+    {
+        // A split session is still one session
+        if (rec.endReason != LISTEN_END_SPLIT)
+            s->sessions++;
+        s->seconds += rec.durationS;
+    }
+
+    if (!rec.start)
+    {
+        agg.untimedSeconds += rec.durationS;
+        return;
+    }
+    uint32_t day = (uint32_t)(((int64_t)rec.start + tzOffsetMin * 60L) / DAY_S);
+    ListenAggregate::Day &d = agg.days[day & (LISTEN_DAYS - 1)];
+    if (d.day != day)
+    {
+        // Slot holds a day LISTEN_DAYS back (or a replayed record is older than it)
+        if (d.day > day)
+            return;
+        d.day = day;
+        d.seconds = 0;
+    }
+    d.seconds += rec.durationS;
+}
+
+// Existing entry, a free one, or the least-listened one taken over
+ListenAggregate::Station *ListenStats::station(uint16_t code)
+{
+    ListenAggregate::Station *least = nullptr;
+    for (uint8_t i = 0; i < used; i++)
+    {
+        ListenAggregate::Station &s = agg.stations[i];
+        if (s.code == code)
+            return &s;
+        if (!least || s.seconds < least->seconds)
+            least = &s;
+    }
+    if (used < LISTEN_MAX_STATIONS)
+        least = &agg.stations[used++];
+    else
+        agg.evicted++;
+    memset(least, 0, sizeof(*least));
+    least->code = code;
+    return least;
+}
+
+// =========================================================
+// Queries
+// =========================================================
+size_t ListenStats::top(const ListenAggregate::Station **out, size_t max) const
+{
+    // Insertion into the short output list; the table is at most 64 entries
+    size_t n = 0;
+    for (uint8_t i = 0; i < used; i++)
+    {
+        const ListenAggregate::Station *s = &agg.stations[i];
+        size_t pos = n;
+        while (pos > 0 && out[pos - 1]->seconds < s->seconds)
+            pos--;
+        if (pos >= max)
+            continue;
+        if (n < max)
+            n++;
+        for (size_t j = n - 1; j > pos; j--)
+            out[j] = out[j - 1];
+        out[pos] = s;
+    }
+    return n;
+}
+
+uint32_t ListenStats::secondsOn(uint32_t day) const
+{
+    const ListenAggregate::Day &d = agg.days[day & (LISTEN_DAYS - 1)];
+    return d.day == day ? d.seconds : 0;
+}
+
+// =========================================================
+// Persistence
+// =========================================================
+const ListenAggregate &ListenStats::image()
+{
+    agg.crc = 0;
+    agg.crc = crc16((const uint8_t *)&agg, sizeof(agg));
+    return agg;
+}
+
+bool ListenStats::load(const ListenAggregate &stored)
+{
+    ListenAggregate copy = stored;
+    copy.crc = 0;
+    if (stored.magic != AGG_MAGIC || stored.version != AGG_VERSION ||
+        stored.crc != crc16((const uint8_t *)&copy, sizeof(copy)))
+        return false;
+
+    agg = stored;
+    used = 0;
+    while (used < LISTEN_MAX_STATIONS && agg.stations[used].code != 0)
+        used++;
+    return true;
+}
+
+// CRC-16/CCITT-FALSE, as StationStore
+uint16_t ListenStats::crc16(const uint8_t *data, size_t len, uint16_t crc)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+uint16_t ListenStats::recordCrc(const ListenRecord &rec)
+{
+    ListenRecord copy = rec;
+    copy.crc = 0;
+    return crc16((const uint8_t *)&copy, sizeof(copy));
+}
@@ -0,0 +1,466 @@
+#include "ListeningLog.h"
+#include <sys/time.h>
+#include <time.h>
+#include "Schedule.h"
+
+#define LOG_MAGIC "FMLG"
+#define LOG_VERSION 1
+#define LOG_SLOTS (LISTEN_LOG_MAX_BYTES / sizeof(ListenRecord))
+
+// Slot 0 of each log file
+struct LogHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t baseSeq; // Sequence number of the first record in this file
+    uint8_t reserved[4];
+};
+
+static_assert(sizeof(LogHeader) == sizeof(ListenRecord), "LogHeader takes exactly one record slot");
+static_assert(LISTEN_BUFFER_RECORDS * sizeof(ListenRecord) == 512, "Buffer must be one SD sector");
+static_assert(LOG_SLOTS % LISTEN_BUFFER_RECORDS == 0, "Log files must end on a sector boundary");
+
+// =========================================================
+// Constructor / Initialization
+// =========================================================
+ListeningLog::ListeningLog(FMRadio *radio, InputSourceManager *inputs, BluetoothSink *bluetooth, ConfigStore *config,
+                           FileManager *fm)
+    : fmRadio(radio), inputSources(inputs), bluetooth(bluetooth), configStore(config), fileManager(fm), started(false),
+      sessionOpen(false), sessionContinued(false), sessionCode(0), sessionStartMs(0), rssiSum(0), rssiSamples(0),
+      rssiMin(0), sessionSource(INPUT_FM), lastSampleMs(0), buffered(0), bufferedSinceMs(0), fileBaseSeq(0),
+      fileRecords(0), rotatePending(false), flushes(0), bytesWritten(0), rotations(0), flushesSinceSave(0),
+      writeErrors(0), skippedShort(0), replayed(0), corrupt(0), flushLatency(nullptr)
+{
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void ListeningLog::begin()
+{
+    flushLatency = Metrics::histogram("listen_flush_us");
+    fileManager->makeDir(LISTEN_LOG_DIR);
+
+    uint32_t start = micros();
+    bool aggOk = loadAggregate();
+    if (!openLog())
+    {
+        // No usable log: keep the aggregates and continue their numbering
+        fileBaseSeq = stats.nextSeq();
+        fileRecords = 0;
+        rotatePending = false;
+        writeHeader(fileBaseSeq);
+    }
+    else
+    {
+        uint32_t endSeq = fileBaseSeq + fileRecords;
+        uint32_t from = stats.nextSeq();
+        if (!aggOk || from > endSeq)
+        {
+            // Aggregates missing or from another card: rebuild from the log
+            stats.clear();
+            from = 0;
+        }
+        if (from < fileBaseSeq)
+            replayed += replay(LISTEN_LOG_PREVIOUS, from);
+        replayed += replay(LISTEN_LOG_FILE, from);
+        stats.setNextSeq(endSeq);
+        if (replayed || !aggOk)
+            saveAggregate();
+    }
+
+    started.store(true, std::memory_order_release);
+    Serial.printf("ListeningLog: %lu records, %lu replayed in %lu us\n", (unsigned long)stats.nextSeq(),
+                  (unsigned long)replayed, (unsigned long)(micros() - start));
+}
+
+bool ListeningLog::wallClock(uint32_t &epoch)
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    epoch = (uint32_t)tv.tv_sec;
+    return epoch >= SCHEDULE_MIN_VALID_EPOCH;
+}
+
+// =========================================================
+// Sessions
+// =========================================================
+void ListeningLog::poll()
+{
+    if (!isStarted())
+        return;
+    uint32_t now = millis();
+
+    if (buffered && now - bufferedSinceMs >= LISTEN_FLUSH_INTERVAL_MS && !flush())
+        bufferedSinceMs = now; // Retry one interval later
+
+    if (now - lastSampleMs < LISTEN_SAMPLE_MS)
+        return;
+    lastSampleMs = now;
+
+    // What is audible: nothing while a switch is muting the amp
+    InputSource source = inputSources->getActive();
+    bool switching = source != inputSources->getSelected();
+    FMStatusSnapshot snap;
+    fmRadio->readStatus(snap);
+    bool playing;
+    uint16_t code;
+    if (source == INPUT_BLUETOOTH)
+    {
+        playing = bluetooth->isStreaming();
+        code = LISTEN_CODE_BLUETOOTH;
+    }
+    else
+    {
+        playing = snap.powered && snap.volume > 0;
+        code = snap.channelCode;
+    }
+    playing = playing && !switching;
+
+    if (sessionOpen)
+    {
+        if (source != sessionSource || (!playing && switching))
+            closeSession(LISTEN_END_INPUT, now);
+        else if (!playing)
+            closeSession(LISTEN_END_POWER, now);
+        else if (code != sessionCode)
+            closeSession(LISTEN_END_TUNE, now);
+        else if (now - sessionStartMs >= LISTEN_MAX_SESSION_S * 1000UL)
+        {
+            closeSession(LISTEN_END_SPLIT, now);
+            openSession(code, source, now);
+            sessionContinued = true;
+        }
+    }
+    if (playing && !sessionOpen)
+        openSession(code, source, now);
+
+    if (sessionOpen && source == INPUT_FM)
+    {
+        rssiSum += snap.rssi;
+        rssiSamples++;
+        if (snap.rssi < rssiMin)
+            rssiMin = snap.rssi;
+    }
+}
+
+void ListeningLog::openSession(uint16_t code, InputSource source, uint32_t nowMs)
+{
+    sessionOpen = true;
+    sessionContinued = false;
+    sessionCode = code;
+    sessionSource = source;
+    sessionStartMs = nowMs;
+    rssiSum = 0;
+    rssiSamples = 0;
+    rssiMin = 0xFF;
+}
+
+void ListeningLog::closeSession(ListenEnd reason, uint32_t nowMs)
+{
+    sessionOpen = false;
+    uint32_t durationS = (nowMs - sessionStartMs) / 1000;
+    // The tail of a split session is kept: it carries the session count
+    if (durationS < LISTEN_MIN_SESSION_S && !sessionContinued)
+    {
+        skippedShort++;
+        return;
+    }
+
+    ListenRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    uint32_t epoch;
+    rec.start = wallClock(epoch) ? epoch - durationS : 0;
+    rec.code = sessionCode;
+    rec.durationS = durationS;
+    rec.rssiAvg = rssiSamples ? rssiSum / rssiSamples : 0;
+    rec.rssiMin = rssiSamples ? rssiMin : 0;
+    rec.endReason = reason;
+    rec.seq = (uint16_t)stats.nextSeq();
+    rec.crc = ListenStats::recordCrc(rec);
+    stats.apply(rec, configStore->get().tzOffsetMin);
+
+    if (!buffered)
+        bufferedSinceMs = nowMs;
+    buffer[buffered++] = rec;
+
+    // Write when the buffer completes a sector of the file (or is full
+    // after a failed write)
+    if (slotAfterFlush() % LISTEN_BUFFER_RECORDS != 0 && buffered < LISTEN_BUFFER_RECORDS)
+        return;
+    if (!flush() && buffered == LISTEN_BUFFER_RECORDS)
+    {
+        // No card: the sessions stay in the aggregates, numbering follows the file
+        buffered = 0;
+        stats.setNextSeq(fileBaseSeq + fileRecords);
+    }
+}
+
+void ListeningLog::shutdown()
+{
+    if (!isStarted())
+        return;
+    if (sessionOpen)
+        closeSession(LISTEN_END_SHUTDOWN, millis());
+    flush();
+    saveAggregate();
+}
+
+// =========================================================
+// Log file
+// =========================================================
+// Slot (header = 0) the buffered records end at once written, counting
+// the rotation the next flush will do
+uint32_t ListeningLog::slotAfterFlush() const
+{
+    bool full = rotatePending || 1 + fileRecords >= LOG_SLOTS;
+    return (full ? 1 : 1 + fileRecords) + buffered;
+}
+
+bool ListeningLog::flush()
+{
+    if (!buffered)
+        return true;
+    uint32_t start = micros();
+
+    bool rotated = false;
+    if (rotatePending || 1 + fileRecords >= LOG_SLOTS)
+    {
+        if (!rotate())
+        {
+            writeErrors++;
+            return false;
+        }
+        rotated = true;
+    }
+
+    size_t bytes = buffered * sizeof(ListenRecord);
+    File file = fileManager->openFile(LISTEN_LOG_FILE, FILE_APPEND);
+    if (!file)
+    {
+        writeErrors++;
+        return false;
+    }
+    bool ok = file.write((const uint8_t *)buffer, bytes) == bytes;
+    file.close();
+    if (!ok)
+    {
+        // Part of the sector may be on the card: continue in a new file
+        rotatePending = true;
+        writeErrors++;
+        return false;
+    }
+
+    fileRecords += buffered;
+    buffered = 0;
+    flushes++;
+    bytesWritten += bytes;
+    if (rotated || ++flushesSinceSave >= LISTEN_AGG_SAVE_FLUSHES)
+        saveAggregate();
+    Metrics::record(flushLatency, micros() - start);
+    return true;
+}
+
+// listen.bin -> listen.1.bin (replacing it), new listen.bin continuing the numbering
+bool ListeningLog::rotate()
+{
+    uint32_t baseSeq = fileBaseSeq + fileRecords;
+    fileManager->removeFile(LISTEN_LOG_PREVIOUS);
+    fileManager->renamePath(LISTEN_LOG_FILE, LISTEN_LOG_PREVIOUS);
+    if (!writeHeader(baseSeq))
+        return false;
+
+    fileBaseSeq = baseSeq;
+    fileRecords = 0;
+    rotatePending = false;
+    rotations++;
+    Serial.printf("ListeningLog: Rotated, new file starts at record %lu\n", (unsigned long)baseSeq);
+    return true;
+}
+
+bool ListeningLog::writeHeader(uint32_t baseSeq)
+{
+    LogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LOG_MAGIC, 4);
+    header.version = LOG_VERSION;
+    header.recordSize = sizeof(ListenRecord);
+    header.baseSeq = baseSeq;
+
+    File file = fileManager->openFile(LISTEN_LOG_FILE, FILE_WRITE);
+    if (!file)
+        return false;
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+    file.close();
+    return ok;
+}
+
+bool ListeningLog::openLog()
+{
+    File file = fileManager->openFile(LISTEN_LOG_FILE);
+    if (!file)
+        return false;
+
+    LogHeader header;
+    size_t size = file.size();
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              memcmp(header.magic, LOG_MAGIC, 4) == 0 &&
+              header.version == LOG_VERSION &&
+              header.recordSize == sizeof(ListenRecord);
+    file.close();
+    if (!ok)
+    {
+        Serial.println("ListeningLog: listen.bin invalid, starting a new one.");
+        return false;
+    }
+
+    fileBaseSeq = header.baseSeq;
+    fileRecords = (size - sizeof(header)) / sizeof(ListenRecord);
+    // A write cut short leaves a partial record; appending after it
+    // would misalign everything that follows
+    rotatePending = (size - sizeof(header)) % sizeof(ListenRecord) != 0;
+    return true;
+}
+
+// Fold records with sequence >= fromSeq into the aggregates, a sector at a time
+size_t ListeningLog::replay(const char *path, uint32_t fromSeq)
+{
+    File file = fileManager->openFile(path);
+    if (!file)
+        return 0;
+
+    LogHeader header;
+    if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, LOG_MAGIC, 4) != 0 || header.recordSize != sizeof(ListenRecord))
+    {
+        file.close();
+        return 0;
+    }
+
+    int16_t tz = configStore->get().tzOffsetMin;
+    uint32_t seq = header.baseSeq;
+    size_t applied = 0;
+    size_t n;
+    // The write buffer is empty before begin() returns
+    while ((n = file.read((uint8_t *)buffer, sizeof(buffer)) / sizeof(ListenRecord)) > 0)
+    {
+        for (size_t i = 0; i < n; i++, seq++)
+        {
+            if (seq < fromSeq)
+                continue;
+            const ListenRecord &rec = buffer[i];
+            if (rec.seq != (uint16_t)seq || rec.crc != ListenStats::recordCrc(rec))
+            {
+                corrupt++;
+                continue;
+            }
+            stats.setNextSeq(seq);
+            stats.apply(rec, tz);
+            applied++;
+        }
+    }
+    file.close();
+    memset(buffer, 0, sizeof(buffer));
+    return applied;
+}
+
+// =========================================================
+// Aggregates
+// =========================================================
+bool ListeningLog::loadAggregate()
+{
+    File file = fileManager->openFile(LISTEN_AGG_FILE);
+    if (!file)
+        return false;
+    ListenAggregate stored;
+    bool ok = file.read((uint8_t *)&stored, sizeof(stored)) == sizeof(stored) && stats.load(stored);
+    file.close();
+    if (!ok)
+        Serial.println("ListeningLog: listen_agg.bin invalid, rebuilding from the log.");
+    return ok;
+}
+
+void ListeningLog::saveAggregate()
+{
+    // Only what is on the card: buffered records would be replayed twice
+    uint32_t next = stats.nextSeq();
+    stats.setNextSeq(next - buffered);
+    const ListenAggregate &image = stats.image();
+    stats.setNextSeq(next);
+
+    File file = fileManager->openFile(LISTEN_AGG_FILE, FILE_WRITE);
+    if (!file)
+        return;
+    file.write((const uint8_t *)&image, sizeof(image));
+    file.close();
+    flushesSinceSave = 0;
+}
+
+// =========================================================
+// Status
+// =========================================================
+void ListeningLog::getStatus(JsonDocument *doc, size_t topN, size_t days)
+{
+    const ListenAggregate &agg = stats.get();
+    (*doc)["sessions"] = agg.sessions;
+    (*doc)["total_s"] = agg.totalSeconds;
+    (*doc)["bluetooth_s"] = agg.bluetoothSeconds;
+    (*doc)["untimed_s"] = agg.untimedSeconds;
+
+    const ListenAggregate::Station *best[LISTEN_MAX_STATIONS];
+    size_t n = stats.top(best, topN < LISTEN_MAX_STATIONS ? topN : LISTEN_MAX_STATIONS);
+    uint32_t fmSeconds = agg.totalSeconds - agg.bluetoothSeconds;
+    JsonArray top = (*doc)["top"].to<JsonArray>();
+    for (size_t i = 0; i < n; i++)
+    {
+        JsonObject station = top.add<JsonObject>();
+        station["code"] = best[i]->code;
+        station["freq"] = best[i]->code / 100.0;
+        station["seconds"] = best[i]->seconds;
+        station["sessions"] = best[i]->sessions;
+        station["share"] = fmSeconds ? best[i]->seconds * 100.0 / fmSeconds : 0.0;
+    }
+
+    // Newest day first; empty without a wall clock
+    JsonArray perDay = (*doc)["days"].to<JsonArray>();
+    uint32_t epoch;
+    if (wallClock(epoch))
+    {
+        uint32_t today = (uint32_t)(((int64_t)epoch + configStore->get().tzOffsetMin * 60L) / 86400L);
+        for (size_t i = 0; i < days && i < LISTEN_DAYS; i++)
+        {
+            time_t t = (time_t)(today - i) * 86400;
+            struct tm tm;
+            gmtime_r(&t, &tm);
+            char date[12];
+            snprintf(date, sizeof(date), "%04d-%02d-%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+            JsonObject day = perDay.add<JsonObject>();
+            day["date"] = date;
+            day["seconds"] = stats.secondsOn(today - i);
+        }
+    }
+
+    // Not in the figures above until it ends
+    JsonObject current = (*doc)["current"].to<JsonObject>();
+    current["open"] = sessionOpen;
+    if (sessionOpen)
+    {
+        current["source"] = InputSwitch::name(sessionSource);
+        current["code"] = sessionCode;
+        current["seconds"] = (millis() - sessionStartMs) / 1000;
+    }
+
+    JsonObject log = (*doc)["log"].to<JsonObject>();
+    log["records"] = stats.nextSeq();
+    log["buffered"] = buffered;
+    log["file_records"] = fileRecords;
+    log["file_bytes"] = (1 + fileRecords) * sizeof(ListenRecord);
+    log["max_file_bytes"] = LISTEN_LOG_MAX_BYTES;
+    log["flushes"] = flushes;
+    log["bytes_written"] = bytesWritten;
+    log["rotations"] = rotations;
+    log["write_errors"] = writeErrors;
+    log["skipped_short"] = skippedShort;
+    log["replayed_at_boot"] = replayed;
+    log["corrupt"] = corrupt;
+    log["stations_evicted"] = agg.evicted;
+}
@@ -0,0 +1,242 @@
+#include "Metrics.h"
+#include <assert.h>
+
+// Pool fill levels are kept in uint8_t
+static_assert(METRICS_MAX_COUNTERS <= 255 && METRICS_MAX_GAUGES <= 255 && METRICS_MAX_HISTOGRAMS <= 255,
+              "Metrics pools are indexed with uint8_t");
+
+MetricCounter Metrics::counters[METRICS_MAX_COUNTERS];
+MetricGauge Metrics::gauges[METRICS_MAX_GAUGES];
+MetricHistogram Metrics::histograms[METRICS_MAX_HISTOGRAMS];
+uint8_t Metrics::counterCount = 0;
+uint8_t Metrics::gaugeCount = 0;
+uint8_t Metrics::histogramCount = 0;
+
+// Registration happens from boot tasks running in parallel
+static portMUX_TYPE registryLock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool sameLabel(const char *a, const char *b)
+{
+    if (!a || !b)
+        return a == b;
+    return strcmp(a, b) == 0;
+}
+
+// Find name+label in `pool` or claim the next free slot
+template <typename T, size_t N>
+static T *lookupOrAdd(T (&pool)[N], uint8_t &used, const char *name, const char *labelKey, const char *labelValue)
+{
+    T *found = nullptr;
+    portENTER_CRITICAL(&registryLock);
+    for (uint8_t i = 0; i < used && !found; i++)
+    {
+        if (strcmp(pool[i].name, name) == 0 && sameLabel(pool[i].labelKey, labelKey) &&
+            sameLabel(pool[i].labelValue, labelValue))
+            found = &pool[i];
+    }
+    if (!found && used < N)
+    {
+        found = &pool[used++];
+        found->name = name;
+        found->labelKey = labelKey;
+        found->labelValue = labelValue;
+    }
+    portEXIT_CRITICAL(&registryLock);
+
+    if (!found)
+    {
+        Serial.printf("Metrics: Pool full, '%s' not recorded.\n", name);
+        // Every registration comes from a fixed call site, so this shows up
+        // on the first run after the change that caused it
+        assert(!"Metrics pool full, raise METRICS_MAX_*");
+    }
+    return found;
+}
+
+// =========================================================
+// Registration
+// =========================================================
+MetricCounter *Metrics::counter(const char *name, const char *labelKey, const char *labelValue)
+{
+    return lookupOrAdd(counters, counterCount, name, labelKey, labelValue);
+}
+
+MetricGauge *Metrics::gauge(const char *name, const char *labelKey, const char *labelValue)
+{
+    return lookupOrAdd(gauges, gaugeCount, name, labelKey, labelValue);
+}
+
+MetricHistogram *Metrics::histogram(const char *name, const char *labelKey, const char *labelValue)
+{
+    return lookupOrAdd(histograms, histogramCount, name, labelKey, labelValue);
+}
+
+// =========================================================
+// Recording
+// =========================================================
+void MetricHistogram::record(uint32_t us)
+{
+    // log2 bucket: 0 -> 0, 1 -> 1, 2..3 -> 2, 4..7 -> 3, ...
+    uint8_t b = us == 0 ? 0 : 32 - __builtin_clz(us);
+    if (b >= METRICS_HIST_BUCKETS)
+        b = METRICS_HIST_BUCKETS - 1;
+
+    buckets[b].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(us, std::memory_order_relaxed);
+}
+
+void Metrics::sampleSystem()
+{
+    static MetricGauge *heapFree = gauge("heap_free_bytes");
+    static MetricGauge *heapMin = gauge("heap_min_free_bytes");
+    static MetricGauge *heapLargest = gauge("heap_largest_block_bytes");
+    static MetricGauge *heapFrag = gauge("heap_fragmentation_pct");
+    static MetricGauge *uptime = gauge("uptime_seconds");
+
+    uint32_t freeBytes = ESP.getFreeHeap();
+    uint32_t largest = ESP.getMaxAllocHeap();
+    set(heapFree, freeBytes);
+    set(heapMin, ESP.getMinFreeHeap());
+    set(heapLargest, largest);
+    // 0% = all free memory is one block
+    set(heapFrag, freeBytes ? 100 - (int32_t)((uint64_t)largest * 100 / freeBytes) : 0);
+    set(uptime, millis() / 1000);
+}
+
+// =========================================================
+// Text Exposition
+// =========================================================
+namespace
+{
+    // Fills the caller's buffer line by line, flushing when it is full
+    struct Writer
+    {
+        char *buf;
+        size_t size;
+        size_t used;
+        Metrics::EmitFn emit;
+        void *ctx;
+
+        void flush()
+        {
+            if (used)
+                emit(buf, used, ctx);
+            used = 0;
+        }
+
+        void line(const char *fmt, ...)
+        {
+            char tmp[160];
+            va_list args;
+            va_start(args, fmt);
+            int len = vsnprintf(tmp, sizeof(tmp), fmt, args);
+            va_end(args);
+            if (len <= 0)
+                return;
+            if ((size_t)len >= sizeof(tmp))
+                len = sizeof(tmp) - 1;
+
+            if (used + len > size)
+                flush();
+            memcpy(buf + used, tmp, len);
+            used += len;
+        }
+    };
+
+    // `{key="value"` without the closing brace, or "" when unlabeled
+    void labelOpen(char *out, size_t size, const char *key, const char *value)
+    {
+        if (key && value)
+            snprintf(out, size, "{%s=\"%s\"", key, value);
+        else
+            out[0] = '\0';
+    }
+
+    // Series of one family can be registered far apart (function-local
+    // statics register on first use), and a repeated TYPE line makes
+    // Prometheus reject the scrape: each family is rendered in full at
+    // its first entry
+    template <typename T>
+    bool firstOfFamily(const T *pool, uint8_t i)
+    {
+        for (uint8_t j = 0; j < i; j++)
+            if (strcmp(pool[j].name, pool[i].name) == 0)
+                return false;
+        return true;
+    }
+}
+
+void Metrics::render(char *buf, size_t bufSize, EmitFn emit, void *ctx)
+{
+    Writer w = {buf, bufSize, 0, emit, ctx};
+    char label[96];
+
+    for (uint8_t i = 0; i < counterCount; i++)
+    {
+        if (!firstOfFamily(counters, i))
+            continue;
+        w.line("# TYPE %s counter\n", counters[i].name);
+        for (uint8_t k = i; k < counterCount; k++)
+        {
+            const MetricCounter &c = counters[k];
+            if (strcmp(c.name, counters[i].name) != 0)
+                continue;
+            labelOpen(label, sizeof(label), c.labelKey, c.labelValue);
+            w.line("%s%s%s %u\n", c.name, label, label[0] ? "}" : "", (unsigned)c.value.load());
+        }
+    }
+
+    for (uint8_t i = 0; i < gaugeCount; i++)
+    {
+        if (!firstOfFamily(gauges, i))
+            continue;
+        w.line("# TYPE %s gauge\n", gauges[i].name);
+        for (uint8_t k = i; k < gaugeCount; k++)
+        {
+            const MetricGauge &g = gauges[k];
+            if (strcmp(g.name, gauges[i].name) != 0)
+                continue;
+            labelOpen(label, sizeof(label), g.labelKey, g.labelValue);
+            w.line("%s%s%s %d\n", g.name, label, label[0] ? "}" : "", (int)g.value.load());
+        }
+    }
+
+    for (uint8_t i = 0; i < histogramCount; i++)
+    {
+        if (!firstOfFamily(histograms, i))
+            continue;
+        bool typed = false;
+        for (uint8_t k = i; k < histogramCount; k++)
+        {
+            const MetricHistogram &h = histograms[k];
+            uint32_t count = h.count.load();
+            if (count == 0 || strcmp(h.name, histograms[i].name) != 0)
+                continue;
+            if (!typed)
+                w.line("# TYPE %s histogram\n", h.name);
+            typed = true;
+            labelOpen(label, sizeof(label), h.labelKey, h.labelValue);
+            const char *sep = label[0] ? "," : "{";
+
+            // Cumulative buckets, stopping after the highest non-empty one
+            uint8_t top = 0;
+            for (uint8_t b = 0; b < METRICS_HIST_BUCKETS; b++)
+                if (h.buckets[b].load())
+                    top = b;
+
+            uint32_t cumulative = 0;
+            for (uint8_t b = 0; b <= top && b < METRICS_HIST_BUCKETS - 1; b++)
+            {
+                cumulative += h.buckets[b].load();
+                w.line("%s_bucket%s%sle=\"%lu\"} %u\n", h.name, label, sep, (unsigned long)((1UL << b) - 1),
+                       (unsigned)cumulative);
+            }
+            w.line("%s_bucket%s%sle=\"+Inf\"} %u\n", h.name, label, sep, (unsigned)count);
+            w.line("%s_sum%s%s %llu\n", h.name, label, label[0] ? "}" : "", (unsigned long long)h.sum.load());
+            w.line("%s_count%s%s %u\n", h.name, label, label[0] ? "}" : "", (unsigned)count);
+        }
+    }
+
+    w.flush();
+}
@@ -0,0 +1,383 @@
+#include "OtaManager.h"
+#include <Update.h>
+#include <MD5Builder.h>
+#include "Metrics.h"
+
+// =========================================================
+// Constructor / Task
+// =========================================================
+OtaManager::OtaManager(FileManager *fm, ConfigStore *cs)
+    : fileManager(fm), configStore(cs), server(OTA_PORT), chunk(nullptr), busy(false), kind(KIND_NONE), state("idle"),
+      totalBytes(0), receivedBytes(0), startMs(0), durationMs(0), maxSliceUs(0), heapAtStart(0), heapLowest(0)
+{
+    message[0] = '\0';
+}
+
+void OtaManager::begin()
+{
+    server.begin();
+    xTaskCreatePinnedToCore(taskEntry, "ota", 6144, this, OTA_TASK_PRIORITY, nullptr, OTA_TASK_CORE);
+    Serial.printf("OTA: Listening on port %d\n", OTA_PORT);
+}
+
+void OtaManager::taskEntry(void *arg)
+{
+    OtaManager *self = static_cast<OtaManager *>(arg);
+    while (true)
+    {
+        WiFiClient client = self->server.available();
+        if (client)
+        {
+            self->serve(client);
+            client.stop();
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+// =========================================================
+// Request Handling
+// =========================================================
+void OtaManager::serve(WiFiClient &client)
+{
+    client.setTimeout(OTA_IO_TIMEOUT_MS / 1000);
+
+    // "POST /firmware?md5=... HTTP/1.1"
+    String request = client.readStringUntil('\n');
+    uint32_t length = 0;
+    uint32_t suppliedToken = 0;
+    while (true)
+    {
+        String header = client.readStringUntil('\n');
+        header.trim();
+        if (header.length() == 0)
+            break;
+        if (header.startsWith("Content-Length:") || header.startsWith("content-length:"))
+            length = header.substring(15).toInt();
+        else if (header.startsWith("X-Famio-Token:") || header.startsWith("x-famio-token:"))
+            suppliedToken = strtoul(header.substring(14).c_str(), nullptr, 10);
+    }
+
+    int tokenAt = request.indexOf("token=");
+    if (tokenAt >= 0)
+        suppliedToken = strtoul(request.c_str() + tokenAt + 6, nullptr, 10);
+
+    int md5At = request.indexOf("md5=");
+    String md5 = md5At >= 0 ? request.substring(md5At + 4, md5At + 4 + 32) : String();
+
+    if (!request.startsWith("POST ") || length == 0 || md5.length() != 32)
+    {
+        respond(client, 400, "{\"status\":\"error\", \"message\":\"POST /firmware|/ui?md5=<32 hex> with Content-Length\"}");
+        return;
+    }
+    // Checked before claiming the updater so a rejected client cannot
+    // hold it either
+    uint32_t token = configStore->get().controlToken;
+    if (!token || suppliedToken != token)
+    {
+        Serial.println("OTA: Rejected upload without a valid token");
+        respond(client, 401, "{\"status\":\"error\", \"message\":\"Missing or wrong token\"}");
+        return;
+    }
+    if (busy.exchange(true))
+    {
+        respond(client, 409, "{\"status\":\"error\", \"message\":\"Update already running\"}");
+        return;
+    }
+
+    // One chunk buffer for the duration of the transfer only
+    chunk = (uint8_t *)malloc(OTA_CHUNK_SIZE);
+    bool ok = false;
+    if (!chunk)
+    {
+        fail("out of memory");
+    }
+    else if (request.startsWith("POST /firmware"))
+    {
+        beginTransfer(KIND_FIRMWARE, length);
+        ok = receiveFirmware(client, md5);
+    }
+    else if (request.startsWith("POST /ui"))
+    {
+        beginTransfer(KIND_UI, length);
+        ok = receiveUiBundle(client, md5);
+    }
+    else
+    {
+        fail("unknown target");
+    }
+    free(chunk);
+    chunk = nullptr;
+
+    durationMs = millis() - startMs;
+    if (ok)
+    {
+        state = "done";
+        snprintf(message, sizeof(message), "%lu bytes in %lu ms", (unsigned long)receivedBytes,
+                 (unsigned long)durationMs);
+    }
+    Serial.printf("OTA: %s (%s), max slice %lu us, peak RAM %lu bytes\n", state, message,
+                  (unsigned long)maxSliceUs, (unsigned long)(heapAtStart - heapLowest));
+
+    char body[160];
+    snprintf(body, sizeof(body), "{\"status\":\"%s\", \"message\":\"%s\"}", ok ? "success" : "error", message);
+    respond(client, ok ? 200 : 500, body);
+
+    bool reboot = ok && kind == KIND_FIRMWARE;
+    busy.store(false);
+    if (reboot)
+    {
+        Serial.println("OTA: Restarting into the new firmware...");
+        delay(500);
+        ESP.restart();
+    }
+}
+
+bool OtaManager::receiveFirmware(WiFiClient &client, const String &md5)
+{
+    if (!Update.begin(totalBytes, U_FLASH))
+    {
+        fail(Update.errorString());
+        return false;
+    }
+    Update.setMD5(md5.c_str());
+
+    while (receivedBytes < totalBytes)
+    {
+        uint32_t sliceStart = micros();
+        size_t want = totalBytes - receivedBytes;
+        if (want > OTA_CHUNK_SIZE)
+            want = OTA_CHUNK_SIZE;
+        if (!readExact(client, chunk, want) || Update.write(chunk, want) != want)
+        {
+            Update.abort();
+            fail(Update.hasError() ? Update.errorString() : "connection lost");
+            return false;
+        }
+        noteSlice(sliceStart, want);
+    }
+
+    // end() checks the MD5 set above before marking the partition bootable
+    state = "verifying";
+    if (!Update.end(true))
+    {
+        fail(Update.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool OtaManager::receiveUiBundle(WiFiClient &client, const String &md5)
+{
+    MD5Builder hash;
+    hash.begin();
+
+    // Fresh staging directory
+    fileManager->removeTree(UI_STAGING_PATH);
+    if (!fileManager->makeDir(UI_STAGING_PATH))
+    {
+        fail("cannot create staging dir");
+        return false;
+    }
+
+    uint8_t head[8];
+    if (!readExact(client, head, 8))
+    {
+        fail("connection lost");
+        return false;
+    }
+    hash.add(head, 8);
+    uint32_t magic, fileCount;
+    memcpy(&magic, head, 4);
+    memcpy(&fileCount, head + 4, 4);
+    if (magic != UI_BUNDLE_MAGIC)
+    {
+        fail("not a UI bundle");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        uint8_t entry[6];
+        if (!readExact(client, entry, 6))
+        {
+            fail("connection lost");
+            return false;
+        }
+        hash.add(entry, 6);
+        uint16_t pathLen;
+        uint32_t size;
+        memcpy(&pathLen, entry, 2);
+        memcpy(&size, entry + 2, 4);
+
+        // Path relative to the UI root, e.g. "css/app.css"
+        char rel[96];
+        if (pathLen == 0 || pathLen >= sizeof(rel) || !readExact(client, (uint8_t *)rel, pathLen))
+        {
+            fail("bad path");
+            return false;
+        }
+        hash.add((uint8_t *)rel, pathLen);
+        rel[pathLen] = '\0';
+        if (strstr(rel, "..") || rel[0] == '/')
+        {
+            fail("bad path");
+            return false;
+        }
+
+        // Create intermediate directories
+        char path[FILE_PATH_MAX];
+        snprintf(path, sizeof(path), UI_STAGING_PATH "/%s", rel);
+        for (char *slash = strchr(path + 1, '/'); slash; slash = strchr(slash + 1, '/'))
+        {
+            *slash = '\0';
+            fileManager->makeDir(path);
+            *slash = '/';
+        }
+
+        File out = fileManager->openFile(path, FILE_WRITE);
+        if (!out)
+        {
+            fail("cannot write file");
+            return false;
+        }
+        while (size > 0)
+        {
+            uint32_t sliceStart = micros();
+            size_t want = size > OTA_CHUNK_SIZE ? OTA_CHUNK_SIZE : size;
+            if (!readExact(client, chunk, want) || out.write(chunk, want) != want)
+            {
+                out.close();
+                fail("write failed");
+                return false;
+            }
+            hash.add(chunk, want);
+            size -= want;
+            noteSlice(sliceStart, want);
+        }
+        out.close();
+    }
+
+    // Nothing in /famio/ui has been touched until the hash matches
+    state = "verifying";
+    hash.calculate();
+    if (!hash.toString().equalsIgnoreCase(md5))
+    {
+        fileManager->removeTree(UI_STAGING_PATH);
+        fail("MD5 mismatch");
+        return false;
+    }
+
+    // Swap: ui -> ui.old, ui.new -> ui. The window where /famio/ui is
+    // missing is two directory renames.
+    fileManager->removeTree(UI_PREVIOUS_PATH);
+    fileManager->renamePath(UI_PATH, UI_PREVIOUS_PATH);
+    if (!fileManager->renamePath(UI_STAGING_PATH, UI_PATH))
+    {
+        fileManager->renamePath(UI_PREVIOUS_PATH, UI_PATH);
+        fail("swap failed");
+        return false;
+    }
+    fileManager->removeTree(UI_PREVIOUS_PATH);
+
+    // Touch the marker so the manifest is rebuilt on the next lookup
+    File marker = fileManager->openFile(UI_PATH UI_MANIFEST_MARKER, FILE_WRITE);
+    if (marker)
+    {
+        marker.printf("%lu\n", millis());
+        marker.close();
+    }
+    return true;
+}
+
+// =========================================================
+// Helpers
+// =========================================================
+bool OtaManager::readExact(WiFiClient &client, uint8_t *buf, size_t len)
+{
+    size_t got = 0;
+    uint32_t lastData = millis();
+    while (got < len)
+    {
+        int avail = client.available();
+        if (avail > 0)
+        {
+            int n = client.read(buf + got, len - got);
+            if (n > 0)
+            {
+                got += n;
+                receivedBytes += n;
+                lastData = millis();
+                continue;
+            }
+        }
+        if (!client.connected() || millis() - lastData > OTA_IO_TIMEOUT_MS)
+            return false;
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+void OtaManager::beginTransfer(Kind k, uint32_t length)
+{
+    kind = k;
+    state = "receiving";
+    message[0] = '\0';
+    totalBytes = length;
+    receivedBytes = 0;
+    startMs = millis();
+    durationMs = 0;
+    maxSliceUs = 0;
+    heapAtStart = ESP.getFreeHeap() + OTA_CHUNK_SIZE; // Chunk buffer counts as used
+    heapLowest = ESP.getFreeHeap();
+}
+
+void OtaManager::noteSlice(uint32_t startUs, size_t bytes)
+{
+    static MetricHistogram *slice = Metrics::histogram("ota_slice_us");
+    static MetricCounter *written = Metrics::counter("ota_bytes_total");
+
+    uint32_t us = micros() - startUs;
+    if (us > maxSliceUs)
+        maxSliceUs = us;
+    Metrics::record(slice, us);
+    Metrics::inc(written, bytes);
+
+    uint32_t freeHeap = ESP.getFreeHeap();
+    if (freeHeap < heapLowest)
+        heapLowest = freeHeap;
+
+    // Give the rest of the system the CPU between slices
+    vTaskDelay(1);
+}
+
+void OtaManager::fail(const char *why)
+{
+    state = "error";
+    snprintf(message, sizeof(message), "%s", why ? why : "unknown");
+}
+
+void OtaManager::respond(WiFiClient &client, int code, const char *body)
+{
+    client.printf("HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nAccess-Control-Allow-Origin: *\r\n"
+                  "Connection: close\r\nContent-Length: %u\r\n\r\n",
+                  code, code == 200 ? "OK" : (code == 401 ? "Unauthorized" : "Error"), (unsigned)strlen(body));
+    client.print(body);
+}
+
+void OtaManager::getStatus(JsonDocument *doc)
+{
+    (*doc)["busy"] = busy.load();
+    (*doc)["kind"] = kind == KIND_FIRMWARE ? "firmware" : (kind == KIND_UI ? "ui" : "none");
+    (*doc)["state"] = state;
+    (*doc)["message"] = message;
+    (*doc)["port"] = OTA_PORT;
+    (*doc)["received"] = receivedBytes;
+    (*doc)["total"] = totalBytes;
+
+    uint32_t elapsed = busy.load() ? millis() - startMs : durationMs;
+    (*doc)["elapsed_ms"] = elapsed;
+    (*doc)["kbps"] = elapsed ? receivedBytes / elapsed : 0; // bytes/ms == kB/s
+    (*doc)["max_slice_us"] = maxSliceUs;
+    (*doc)["peak_ram"] = heapAtStart > heapLowest ? heapAtStart - heapLowest : 0;
+}
@@ -1,7 +1,10 @@
 #include "PowerManager.h"
+#include "TraceLog.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
 
 // Constructor
-PowerManager::PowerManager() : currentVolume(50)
+PowerManager::PowerManager() : currentVolume(50), shutdownHook(nullptr)
 {
 }
 
@@ -82,7 +85,7 @@ void PowerManager::setVolume(int level)
 
     // analogWrite(VOLUME_CONTROL_PIN, pwm_duty);
 
-    Serial.printf("PowerManager: Đặt âm lượng thành %d (PWM: %d)\n", currentVolume, pwm_duty);
+    TRACE_INFO(POWER_VOLUME, currentVolume, pwm_duty);
 }
 
 // =========================================================
@@ -110,10 +113,20 @@ int PowerManager::readPotentiometer()
 // 4. Quản lý Nguồn (Power Management)
 // =========================================================
 
-void PowerManager::shutdown()
+void PowerManager::shutdown(uint32_t wakeAfterS)
 {
     Serial.println("PowerManager: Đang chuyển sang chế độ Deep Sleep/Tắt nguồn...");
-    // esp_deep_sleep_start();
-    delay(100);
-    Serial.println("Hệ thống đã ngừng.");
+    if (shutdownHook)
+        shutdownHook();
+
+    // Amp về 0 (TPA3110), tắt hẳn Wi-Fi trước khi ngủ
+    setVolume(0);
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+
+    if (wakeAfterS)
+        esp_sleep_enable_timer_wakeup((uint64_t)wakeAfterS * 1000000ULL);
+    Serial.printf("PowerManager: Deep sleep, thức dậy sau %lu s.\n", (unsigned long)wakeAfterS);
+    Serial.flush();
+    esp_deep_sleep_start();
 }
\ No newline at end of file
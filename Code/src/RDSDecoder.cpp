@@ -0,0 +1,337 @@
+#include "RDSDecoder.h"
+
+// A character position is trusted once its score reaches this value:
+// two clean receptions, or one clean plus one lightly corrected block.
+#define RDS_STABLE_SCORE 4
+#define RDS_MAX_SCORE 8
+
+// PI/PTY need this many agreeing receptions
+#define RDS_PI_CONFIRM 4
+
+// =========================================================
+// Constructor / Reset
+// =========================================================
+RDSDecoder::RDSDecoder()
+    : version(0), groupsDecoded(0), blocksRejected(0)
+{
+    reset(0);
+}
+
+void RDSDecoder::reset(uint32_t nowMs)
+{
+    clearSlots(psSlots, RDS_PS_LENGTH);
+    clearSlots(rtSlots, RDS_RT_LENGTH);
+    psName[0] = '\0';
+    radioText[0] = '\0';
+    rtLength = RDS_RT_LENGTH;
+    rtAbFlag = -1;
+
+    pi = 0;
+    pty = 0;
+    piValid = false;
+    ptyValid = false;
+    piScore = 0;
+    ptyScore = 0;
+    clockValid = false;
+    memset(&clock, 0, sizeof(clock));
+
+    resetMs = nowMs;
+    psStableMs = 0;
+    version++;
+}
+
+void RDSDecoder::clearSlots(CharSlot *slots, size_t count)
+{
+    memset(slots, 0, count * sizeof(CharSlot));
+}
+
+// =========================================================
+// Confidence Weighting
+// =========================================================
+uint8_t RDSDecoder::weightFor(uint8_t bler)
+{
+    // Clean blocks count triple, heavily corrected blocks barely count
+    static const uint8_t weights[4] = {3, 2, 1, 0};
+    return weights[bler & 0x03];
+}
+
+bool RDSDecoder::feedSlot(CharSlot &slot, char ch, uint8_t weight)
+{
+    if (weight == 0)
+        return false;
+
+    if (ch == slot.value)
+    {
+        slot.score = slot.score + weight > RDS_MAX_SCORE ? RDS_MAX_SCORE : slot.score + weight;
+        slot.challengerScore = slot.challengerScore > weight ? slot.challengerScore - weight : 0;
+        return false;
+    }
+
+    if (ch == slot.challenger)
+    {
+        slot.challengerScore = slot.challengerScore + weight > RDS_MAX_SCORE ? RDS_MAX_SCORE : slot.challengerScore + weight;
+    }
+    else
+    {
+        slot.challenger = ch;
+        slot.challengerScore = weight;
+    }
+
+    if (slot.challengerScore > slot.score)
+    {
+        slot.value = slot.challenger;
+        slot.score = slot.challengerScore;
+        slot.challenger = 0;
+        slot.challengerScore = 0;
+        return true;
+    }
+    return false;
+}
+
+// =========================================================
+// Group Dispatch
+// =========================================================
+void RDSDecoder::processGroup(const uint16_t blocks[4], const uint8_t errors[4], uint32_t nowMs)
+{
+    // Block A: PI code. A stable PI that changes means a different station.
+    if (errors[0] < RDS_BLER_UNCORRECTABLE)
+    {
+        if (!piValid && piScore == 0)
+        {
+            pi = blocks[0];
+            piScore = 1;
+        }
+        else if (blocks[0] == pi)
+        {
+            if (piScore < RDS_PI_CONFIRM)
+                piScore++;
+            if (!piValid && piScore >= 2)
+            {
+                piValid = true;
+                version++;
+            }
+        }
+        else if (--piScore == 0)
+        {
+            // Station changed under us (e.g. after a seek): start over
+            if (piValid)
+                reset(nowMs);
+            pi = blocks[0];
+            piScore = 1;
+        }
+    }
+
+    // Block B carries the group type: nothing is decodable without it
+    if (errors[1] >= RDS_BLER_UNCORRECTABLE)
+    {
+        blocksRejected++;
+        return;
+    }
+
+    uint16_t blockB = blocks[1];
+    uint8_t groupType = blockB >> 12;
+    bool versionB = blockB & 0x0800;
+
+    uint8_t newPty = (blockB >> 5) & 0x1F;
+    if (newPty == pty)
+    {
+        if (ptyScore < RDS_PI_CONFIRM)
+            ptyScore++;
+        if (!ptyValid && ptyScore >= 2)
+        {
+            ptyValid = true;
+            version++;
+        }
+    }
+    else if (ptyScore <= 1)
+    {
+        pty = newPty;
+        ptyScore = 1;
+        if (ptyValid)
+        {
+            ptyValid = false;
+            version++;
+        }
+    }
+    else
+    {
+        ptyScore--;
+    }
+
+    switch (groupType)
+    {
+    case 0:
+        decodePs(blockB, blocks[3], errors[3]);
+        publishPs(nowMs);
+        break;
+    case 2:
+        decodeRadioText(blockB, blocks[2], blocks[3], errors[2], errors[3], versionB);
+        publishRadioText();
+        break;
+    case 4:
+        // Clock time is only trusted from (nearly) clean groups
+        if (!versionB && errors[2] <= 1 && errors[3] <= 1)
+            decodeClock(blockB, blocks[2], blocks[3]);
+        break;
+    default:
+        break;
+    }
+
+    groupsDecoded++;
+}
+
+// =========================================================
+// Group 0A/0B: Programme Service name
+// =========================================================
+void RDSDecoder::decodePs(uint16_t blockB, uint16_t blockD, uint8_t errD)
+{
+    uint8_t weight = weightFor(errD);
+    if (weight == 0)
+    {
+        blocksRejected++;
+        return;
+    }
+
+    uint8_t pos = (blockB & 0x03) * 2;
+    char hi = (char)(blockD >> 8);
+    char lo = (char)(blockD & 0xFF);
+
+    // Control codes never appear in a PS name: treat them as corruption
+    if ((uint8_t)hi >= 0x20)
+        feedSlot(psSlots[pos], hi, weight);
+    if ((uint8_t)lo >= 0x20)
+        feedSlot(psSlots[pos + 1], lo, weight);
+}
+
+void RDSDecoder::publishPs(uint32_t nowMs)
+{
+    char candidate[RDS_PS_LENGTH + 1];
+    for (uint8_t i = 0; i < RDS_PS_LENGTH; i++)
+    {
+        if (psSlots[i].score < RDS_STABLE_SCORE)
+            return;
+        candidate[i] = psSlots[i].value;
+    }
+    candidate[RDS_PS_LENGTH] = '\0';
+
+    if (strcmp(candidate, psName) == 0)
+        return;
+
+    memcpy(psName, candidate, sizeof(psName));
+    version++;
+    if (psStableMs == 0)
+        psStableMs = nowMs - resetMs > 0 ? nowMs - resetMs : 1;
+}
+
+// =========================================================
+// Group 2A/2B: RadioText
+// =========================================================
+void RDSDecoder::decodeRadioText(uint16_t blockB, uint16_t blockC, uint16_t blockD, uint8_t errC, uint8_t errD, bool versionB)
+{
+    // A/B flag toggles when the broadcaster starts a new message
+    int8_t ab = (blockB >> 4) & 0x01;
+    if (rtAbFlag != ab)
+    {
+        if (rtAbFlag != -1)
+        {
+            clearSlots(rtSlots, RDS_RT_LENGTH);
+            rtLength = RDS_RT_LENGTH;
+        }
+        rtAbFlag = ab;
+    }
+
+    uint8_t segment = blockB & 0x0F;
+    if (versionB)
+    {
+        // 2B: 2 chars per group from block D, 32 chars max
+        if (rtLength > RDS_RT_LENGTH / 2)
+            rtLength = RDS_RT_LENGTH / 2;
+        putRtChar(segment * 2, (char)(blockD >> 8), weightFor(errD));
+        putRtChar(segment * 2 + 1, (char)(blockD & 0xFF), weightFor(errD));
+    }
+    else
+    {
+        // 2A: 4 chars per group from blocks C and D
+        putRtChar(segment * 4, (char)(blockC >> 8), weightFor(errC));
+        putRtChar(segment * 4 + 1, (char)(blockC & 0xFF), weightFor(errC));
+        putRtChar(segment * 4 + 2, (char)(blockD >> 8), weightFor(errD));
+        putRtChar(segment * 4 + 3, (char)(blockD & 0xFF), weightFor(errD));
+    }
+}
+
+void RDSDecoder::putRtChar(uint8_t pos, char ch, uint8_t weight)
+{
+    if (weight == 0)
+    {
+        blocksRejected++;
+        return;
+    }
+    if (pos >= rtLength)
+        return;
+
+    // Carriage return marks the end of a short message
+    if (ch == '\r')
+    {
+        if (weight >= weightFor(1))
+            rtLength = pos;
+        return;
+    }
+    if ((uint8_t)ch < 0x20)
+        return;
+
+    feedSlot(rtSlots[pos], ch, weight);
+}
+
+void RDSDecoder::publishRadioText()
+{
+    if (rtLength == 0)
+        return;
+
+    char candidate[RDS_RT_LENGTH + 1];
+    for (uint8_t i = 0; i < rtLength; i++)
+    {
+        if (rtSlots[i].score < RDS_STABLE_SCORE)
+            return;
+        candidate[i] = rtSlots[i].value;
+    }
+
+    // Stations pad RadioText with spaces up to 64 chars
+    uint8_t len = rtLength;
+    while (len > 0 && candidate[len - 1] == ' ')
+        len--;
+    candidate[len] = '\0';
+
+    if (strcmp(candidate, radioText) == 0)
+        return;
+
+    memcpy(radioText, candidate, len + 1);
+    version++;
+}
+
+// =========================================================
+// Group 4A: Clock time and date
+// =========================================================
+void RDSDecoder::decodeClock(uint16_t blockB, uint16_t blockC, uint16_t blockD)
+{
+    ClockTime t;
+    t.mjd = ((uint32_t)(blockB & 0x03) << 15) | (blockC >> 1);
+    t.hour = ((blockC & 0x01) << 4) | (blockD >> 12);
+    t.minute = (blockD >> 6) & 0x3F;
+    t.offsetHalfHours = blockD & 0x1F;
+    if (blockD & 0x20)
+        t.offsetHalfHours = -t.offsetHalfHours;
+
+    if (t.hour > 23 || t.minute > 59)
+    {
+        blocksRejected++;
+        return;
+    }
+
+    if (clockValid && t.mjd == clock.mjd && t.hour == clock.hour &&
+        t.minute == clock.minute && t.offsetHalfHours == clock.offsetHalfHours)
+        return;
+
+    clock = t;
+    clockValid = true;
+    version++;
+}
@@ -0,0 +1,98 @@
+#include "RadioController.h"
+
+// =========================================================
+// Constructor
+// =========================================================
+RadioController::RadioController(FMRadio *radio) : fmRadio(radio), listener(nullptr), listenerCtx(nullptr)
+{
+}
+
+void RadioController::setListener(Listener fn, void *ctx)
+{
+    listener = fn;
+    listenerCtx = ctx;
+}
+
+RadioState RadioController::getState() const
+{
+    RadioState state;
+    state.channelCode = fmRadio->getCurrentChannel().code();
+    state.volume = fmRadio->getVolume();
+    state.powered = fmRadio->isPoweredOn();
+    return state;
+}
+
+// =========================================================
+// Command Dispatch
+// =========================================================
+bool RadioController::apply(const RadioCommand &cmd, RadioCommandSource source)
+{
+    RadioCommand effect = {RADIO_CMD_TUNE, 0};
+    // UDP and group sync start before the "tuner" boot step has loaded
+    // the config and stations
+    if (!fmRadio->isReady())
+        return false;
+
+    switch (cmd.type)
+    {
+    case RADIO_CMD_TUNE:
+    {
+        if (cmd.value <= 0 || cmd.value > 0xFFFF)
+            return false;
+        Channel channel((uint16_t)cmd.value);
+        if (!FMRadio::isValidChannel(channel))
+            return false;
+        // Replicated commands are idempotent: skip the retune and the save
+        if (source != RADIO_SRC_GROUP || channel.snapped(RDA5807_BAND, RDA5807_SPACE) != fmRadio->getCurrentChannel())
+            fmRadio->setFrequency(channel);
+        break;
+    }
+
+    case RADIO_CMD_VOLUME:
+        if (cmd.value < 0 || cmd.value > 15)
+            return false;
+        fmRadio->setVolume((uint8_t)cmd.value);
+        effect.type = RADIO_CMD_VOLUME;
+        break;
+
+    case RADIO_CMD_PRESET:
+        if (cmd.value < 0 || cmd.value > 255)
+            return false;
+        fmRadio->selectSavedChannel((uint8_t)cmd.value);
+        break;
+
+    case RADIO_CMD_SEEK_UP:
+        fmRadio->seekUp();
+        break;
+
+    case RADIO_CMD_SEEK_DOWN:
+        fmRadio->seekDown();
+        break;
+
+    case RADIO_CMD_SEEK_NEXT:
+        fmRadio->autoSeekNext();
+        break;
+
+    case RADIO_CMD_POWER:
+        if (cmd.value && !fmRadio->isPoweredOn())
+            fmRadio->powerOn(); // Falls back to begin() on first power-up
+        else if (!cmd.value && fmRadio->isPoweredOn())
+            fmRadio->powerOff();
+        effect.type = RADIO_CMD_POWER;
+        break;
+
+    default:
+        return false;
+    }
+
+    if (effect.type == RADIO_CMD_TUNE)
+        effect.value = fmRadio->getCurrentChannel().code();
+    else if (effect.type == RADIO_CMD_VOLUME)
+        effect.value = fmRadio->getVolume();
+    else
+        effect.value = fmRadio->isPoweredOn() ? 1 : 0;
+
+    if (listener && source != RADIO_SRC_GROUP)
+        listener(effect, source, listenerCtx);
+    return true;
+}
@@ -0,0 +1,218 @@
+#include "Schedule.h"
+
+#define DAY_MS 86400000ULL
+
+Schedule::Schedule(ScheduleState &state)
+    : state(state), fadeStartMs(0), fadeMs(0), fadingIn(false), sleepAtMs(0), sleepFadeMs(0), lastPercent(-1)
+{
+}
+
+void Schedule::reset(const ScheduleAlarm *alarms, int16_t tzOffsetMin)
+{
+    memset(&state, 0, sizeof(state));
+    state.magic = SCHEDULE_MAGIC;
+    memcpy(state.alarms, alarms, sizeof(state.alarms));
+    state.tzOffsetMin = tzOffsetMin;
+}
+
+// =========================================================
+// Calendar
+// =========================================================
+uint64_t Schedule::localDayStart(uint64_t nowMs, int16_t tzOffsetMin, uint8_t &weekday)
+{
+    int64_t offsetMs = (int64_t)tzOffsetMin * 60000;
+    uint64_t day = ((int64_t)nowMs + offsetMs) / DAY_MS;
+    weekday = (day + 4) % 7; // 1970-01-01 was a Thursday
+    return day * DAY_MS - offsetMs;
+}
+
+uint64_t Schedule::nextAlarmMs(uint64_t nowMs, int8_t *index) const
+{
+    uint8_t weekday;
+    uint64_t dayStart = localDayStart(nowMs, state.tzOffsetMin, weekday);
+    uint64_t best = 0;
+
+    // Today plus a full week covers every weekly pattern
+    for (uint8_t d = 0; d <= 7; d++, dayStart += DAY_MS, weekday = (weekday + 1) % 7)
+    {
+        for (uint8_t i = 0; i < SCHEDULE_MAX_ALARMS; i++)
+        {
+            const ScheduleAlarm &a = state.alarms[i];
+            if (!a.enabled || (a.days && !(a.days & (1 << weekday))))
+                continue;
+            uint64_t at = dayStart + ((uint32_t)a.hour * 60 + a.minute) * 60000ULL;
+            if (at >= nowMs && (!best || at < best))
+            {
+                best = at;
+                if (index)
+                    *index = i;
+            }
+        }
+        if (best)
+            break; // Later days can only be later
+    }
+    return best;
+}
+
+// =========================================================
+// Timers
+// =========================================================
+void Schedule::startSleepTimer(uint64_t nowMs, uint32_t minutes, uint16_t fadeSec)
+{
+    if (!minutes)
+    {
+        sleepAtMs = 0;
+        return;
+    }
+    sleepAtMs = nowMs + minutes * 60000ULL;
+    sleepFadeMs = (uint32_t)fadeSec * 1000;
+    if (sleepFadeMs > minutes * 60000UL)
+        sleepFadeMs = minutes * 60000UL;
+}
+
+void Schedule::cancelTimers()
+{
+    fadingIn = false;
+    sleepAtMs = 0;
+    lastPercent = -1;
+}
+
+ScheduleOutput Schedule::update(uint64_t nowMs, bool clockValid)
+{
+    ScheduleOutput out = {-1, -1, false, 0};
+
+    // Alarms: the first one due since the last fired minute, unless it is
+    // older than the grace period
+    if (clockValid)
+    {
+        uint64_t from = nowMs > SCHEDULE_GRACE_S * 1000ULL ? nowMs - SCHEDULE_GRACE_S * 1000ULL : 0;
+        uint64_t afterFired = (uint64_t)(state.lastFiredMin + 1) * 60000ULL;
+        if (state.lastFiredMin && afterFired > from)
+            from = afterFired;
+
+        int8_t index = -1;
+        uint64_t at = nextAlarmMs(from, &index);
+        if (at && at <= nowMs)
+        {
+            ScheduleAlarm &a = state.alarms[index];
+            state.lastFiredMin = at / 60000;
+            if (!a.days)
+                a.enabled = 0;
+
+            out.fireAlarm = index;
+            fadingIn = true;
+            fadeStartMs = nowMs;
+            fadeMs = (uint32_t)a.fadeSec * 1000;
+            lastPercent = -1;
+            sleepAtMs = 0;
+            if (a.durationMin)
+                startSleepTimer(nowMs, a.durationMin, a.fadeSec);
+        }
+    }
+
+    int8_t percent = -1;
+    if (fadingIn)
+    {
+        uint64_t elapsed = nowMs - fadeStartMs;
+        percent = (!fadeMs || elapsed >= fadeMs) ? 100 : (int8_t)(elapsed * 100 / fadeMs);
+        if (percent == 100)
+            fadingIn = false;
+    }
+
+    if (sleepAtMs)
+    {
+        if (nowMs >= sleepAtMs)
+        {
+            sleepAtMs = 0;
+            fadingIn = false;
+            percent = 0;
+            out.sleep = true;
+            if (clockValid)
+            {
+                uint64_t next = nextAlarmMs(nowMs);
+                if (next)
+                {
+                    uint64_t wakeS = (next - nowMs) / 1000;
+                    out.wakeInS = wakeS > SCHEDULE_WAKE_LEAD_S ? wakeS - SCHEDULE_WAKE_LEAD_S : 1;
+                }
+            }
+        }
+        else if (sleepFadeMs && nowMs + sleepFadeMs >= sleepAtMs)
+        {
+            // Fade out from wherever a fade-in got to
+            int8_t down = (int8_t)((sleepAtMs - nowMs) * 100 / sleepFadeMs);
+            fadingIn = false;
+            percent = percent >= 0 && percent < down ? percent : down;
+        }
+    }
+
+    if (percent >= 0 && (percent != lastPercent || out.sleep))
+    {
+        out.ampPercent = percent;
+        lastPercent = percent;
+    }
+    return out;
+}
+
+// =========================================================
+// Current estimate (virtual clock)
+// =========================================================
+Schedule::Estimate Schedule::estimate(float capacityMah) const
+{
+    // Run this schedule for a week on a copy: jump through deep sleep,
+    // step 1 s while awake. Starts on a Sunday at local midnight, asleep.
+    ScheduleState copy = state;
+    copy.lastFiredMin = 0;
+    Schedule sim(copy);
+
+    const uint64_t start = 1704585600000ULL - (int64_t)state.tzOffsetMin * 60000; // 2024-01-07
+    const uint64_t end = start + 7 * DAY_MS;
+    uint64_t t = start;
+    double mAms = 0;
+    uint64_t awakeMs = 0;
+    uint32_t wakes = 0;
+
+    while (t < end)
+    {
+        uint64_t alarm = sim.nextAlarmMs(t);
+        uint64_t wakeAt = alarm > SCHEDULE_WAKE_LEAD_S * 1000ULL ? alarm - SCHEDULE_WAKE_LEAD_S * 1000ULL : alarm;
+        if (!alarm || wakeAt >= end)
+        {
+            mAms += (double)(end - t) * SCHEDULE_MA_DEEP_SLEEP;
+            break;
+        }
+        if (wakeAt > t)
+        {
+            mAms += (double)(wakeAt - t) * SCHEDULE_MA_DEEP_SLEEP;
+            t = wakeAt;
+        }
+        wakes++;
+
+        bool playing = false;
+        uint64_t wokeAt = t;
+        while (t < end)
+        {
+            ScheduleOutput out = sim.update(t, true);
+            if (out.fireAlarm >= 0)
+            {
+                playing = true;
+                if (!sim.hasSleepTimer())
+                    sim.startSleepTimer(t, SCHEDULE_DEFAULT_LISTEN_MIN, copy.alarms[out.fireAlarm].fadeSec);
+            }
+            if (out.sleep)
+                break;
+            if (!playing && t - wokeAt > (SCHEDULE_WAKE_LEAD_S + SCHEDULE_GRACE_S) * 1000ULL)
+                break; // Woke for nothing (cannot happen unless the table changed)
+            mAms += 1000.0 * (playing ? SCHEDULE_MA_PLAYING : SCHEDULE_MA_BOOT);
+            awakeMs += 1000;
+            t += 1000;
+        }
+    }
+
+    Estimate e;
+    e.avgMa = (float)(mAms / (7 * DAY_MS));
+    e.awakeMinPerDay = awakeMs / 60000.0f / 7;
+    e.wakesPerDay = wakes / 7.0f;
+    e.batteryDays = e.avgMa > 0 ? capacityMah / e.avgMa / 24 : 0;
+    return e;
+}
@@ -0,0 +1,199 @@
+#include "ScheduleEngine.h"
+#include <sys/time.h>
+#include <esp_sleep.h>
+
+// Survives deep sleep (re-initialised on every other kind of reset)
+RTC_DATA_ATTR static ScheduleState rtcState;
+
+ScheduleEngine::ScheduleEngine(RadioController *controller, PowerManager *power, ConfigStore *config, FileManager *fm)
+    : controller(controller), powerManager(power), configStore(config), fileManager(fm), schedule(rtcState),
+      started(false), resumed(false), lastPollMs(0), estimateDirty(true), alarmsFired(nullptr), sleeps(nullptr)
+{
+}
+
+// =========================================================
+// Setup
+// =========================================================
+void ScheduleEngine::begin()
+{
+    alarmsFired = Metrics::counter("schedule_alarms_fired_total");
+    sleeps = Metrics::counter("schedule_sleeps_total");
+
+    const RuntimeConfig &cfg = configStore->get();
+    resumed = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && schedule.isValid();
+    if (!resumed)
+        schedule.reset(cfg.alarms, cfg.tzOffsetMin);
+
+    bool clockValid;
+    uint64_t now = nowMs(clockValid);
+    int8_t index = -1;
+    uint64_t next = clockValid ? schedule.nextAlarmMs(now, &index) : 0;
+    Serial.printf("ScheduleEngine: %s, clock %s, next alarm %d in %lu s\n", resumed ? "Resumed after deep sleep" : "Fresh start",
+                  clockValid ? "valid" : "not set", index, (unsigned long)(next ? (next - now) / 1000 : 0));
+    started.store(true, std::memory_order_release);
+}
+
+uint64_t ScheduleEngine::nowMs(bool &clockValid)
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    clockValid = (uint32_t)tv.tv_sec >= SCHEDULE_MIN_VALID_EPOCH;
+    return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// =========================================================
+// Periodic work
+// =========================================================
+void ScheduleEngine::poll()
+{
+    if (!isStarted() || millis() - lastPollMs < SCHEDULE_POLL_INTERVAL_MS)
+        return;
+    lastPollMs = millis();
+
+    bool clockValid;
+    uint64_t now = nowMs(clockValid);
+    ScheduleOutput out = schedule.update(now, clockValid);
+
+    if (out.fireAlarm >= 0)
+        fire((uint8_t)out.fireAlarm);
+    if (out.ampPercent >= 0)
+        powerManager->setVolume(configStore->get().commonVolume * out.ampPercent / 100);
+    if (out.sleep)
+        sleepNow(out.wakeInS);
+}
+
+void ScheduleEngine::fire(uint8_t index)
+{
+    const ScheduleAlarm &a = schedule.getState().alarms[index];
+    Serial.printf("ScheduleEngine: Alarm %u, preset %u, volume %u\n", index, a.preset, a.volume);
+    Metrics::inc(alarmsFired);
+
+    // Amp silent first; update() ramps it up from the next poll
+    powerManager->setVolume(0);
+    controller->apply({RADIO_CMD_POWER, 1}, RADIO_SRC_SCHEDULE);
+    controller->apply({RADIO_CMD_PRESET, a.preset}, RADIO_SRC_SCHEDULE);
+    controller->apply({RADIO_CMD_VOLUME, a.volume}, RADIO_SRC_SCHEDULE);
+
+    // A one-shot alarm was disabled by firing it
+    if (!a.days)
+        persist();
+}
+
+void ScheduleEngine::sleepNow(uint32_t wakeInS)
+{
+    Serial.printf("ScheduleEngine: Sleeping, wake in %lu s\n", (unsigned long)wakeInS);
+    Metrics::inc(sleeps);
+    // Power-off also writes a pending tune/volume change
+    controller->apply({RADIO_CMD_POWER, 0}, RADIO_SRC_SCHEDULE);
+    powerManager->shutdown(wakeInS);
+}
+
+// =========================================================
+// Config
+// =========================================================
+void ScheduleEngine::persist()
+{
+    estimateDirty = true;
+    const ScheduleState &state = schedule.getState();
+    RuntimeConfig &cfg = configStore->get();
+    memcpy(cfg.alarms, state.alarms, sizeof(cfg.alarms));
+    cfg.tzOffsetMin = state.tzOffsetMin;
+    configStore->commit();
+
+    // schedule.json stays the editable copy (imported by ConfigStore)
+    JsonDocument doc;
+    doc["tz_offset_min"] = state.tzOffsetMin;
+    JsonArray alarms = doc["alarms"].to<JsonArray>();
+    for (uint8_t i = 0; i < SCHEDULE_MAX_ALARMS; i++)
+    {
+        const ScheduleAlarm &a = state.alarms[i];
+        JsonObject o = alarms.add<JsonObject>();
+        o["enabled"] = a.enabled;
+        o["days"] = a.days;
+        o["hour"] = a.hour;
+        o["minute"] = a.minute;
+        o["preset"] = a.preset;
+        o["volume"] = a.volume;
+        o["fade"] = a.fadeSec;
+        o["duration"] = a.durationMin;
+    }
+    fileManager->saveJsonFile(CONFIG_FILE_PATH SCHEDULE_CONFIG_FILE, doc);
+}
+
+bool ScheduleEngine::setAlarm(uint8_t index, const ScheduleAlarm &alarm)
+{
+    if (index >= SCHEDULE_MAX_ALARMS || alarm.hour > 23 || alarm.minute > 59 || alarm.volume > 15 || alarm.days > 0x7F)
+        return false;
+    schedule.getState().alarms[index] = alarm;
+    persist();
+    return true;
+}
+
+void ScheduleEngine::setTimezone(int16_t offsetMin)
+{
+    schedule.getState().tzOffsetMin = offsetMin;
+    persist();
+}
+
+void ScheduleEngine::setSleepTimer(uint32_t minutes, uint16_t fadeSec)
+{
+    bool clockValid;
+    schedule.startSleepTimer(nowMs(clockValid), minutes, fadeSec);
+    // Cancelling mid-fade: back to the listening level
+    if (!minutes)
+        powerManager->setVolume(configStore->get().commonVolume);
+}
+
+// =========================================================
+// Status
+// =========================================================
+void ScheduleEngine::getStatus(JsonDocument *doc)
+{
+    bool clockValid;
+    uint64_t now = nowMs(clockValid);
+    const ScheduleState &state = schedule.getState();
+
+    (*doc)["clock_valid"] = clockValid;
+    (*doc)["now"] = (uint32_t)(now / 1000);
+    (*doc)["tz_offset_min"] = state.tzOffsetMin;
+    (*doc)["resumed"] = resumed;
+
+    JsonArray alarms = (*doc)["alarms"].to<JsonArray>();
+    for (uint8_t i = 0; i < SCHEDULE_MAX_ALARMS; i++)
+    {
+        const ScheduleAlarm &a = state.alarms[i];
+        JsonObject o = alarms.add<JsonObject>();
+        o["index"] = i;
+        o["enabled"] = a.enabled != 0;
+        o["days"] = a.days;
+        o["hour"] = a.hour;
+        o["minute"] = a.minute;
+        o["preset"] = a.preset;
+        o["volume"] = a.volume;
+        o["fade"] = a.fadeSec;
+        o["duration"] = a.durationMin;
+    }
+
+    int8_t index = -1;
+    uint64_t next = clockValid ? schedule.nextAlarmMs(now, &index) : 0;
+    if (next)
+    {
+        (*doc)["next_alarm"]["index"] = index;
+        (*doc)["next_alarm"]["in_s"] = (uint32_t)((next - now) / 1000);
+    }
+    if (schedule.hasSleepTimer())
+        (*doc)["sleep_in_s"] = (uint32_t)((schedule.getSleepAtMs() - now) / 1000);
+
+    // A simulated week: a few ms, so only when the table changed
+    if (estimateDirty)
+    {
+        estimateCache = schedule.estimate(SCHEDULE_BATTERY_MAH);
+        estimateDirty = false;
+    }
+    const Schedule::Estimate &e = estimateCache;
+    JsonObject est = (*doc)["estimate"].to<JsonObject>();
+    est["avg_ma"] = e.avgMa;
+    est["awake_min_per_day"] = e.awakeMinPerDay;
+    est["wakes_per_day"] = e.wakesPerDay;
+    est["battery_days"] = e.batteryDays;
+}
@@ -0,0 +1,206 @@
+#include "SignalMonitor.h"
+
+static const char *const TIER_NAMES[SIGNAL_TIER_COUNT] = {"sec", "min", "hour"};
+
+// =========================================================
+// Constructor
+// =========================================================
+SignalMonitor::SignalMonitor() : started(false), mono(false), belowCount(0), aboveCount(0), blendSwitches(nullptr)
+{
+    static const uint32_t periods[SIGNAL_TIER_COUNT] = {1000UL, 60000UL, 3600000UL};
+    Slot *slots[SIGNAL_TIER_COUNT] = {secSlots, minSlots, hourSlots};
+    static const uint16_t sizes[SIGNAL_TIER_COUNT] = {SIGNAL_SEC_SLOTS, SIGNAL_MIN_SLOTS, SIGNAL_HOUR_SLOTS};
+
+    for (uint8_t t = 0; t < SIGNAL_TIER_COUNT; t++)
+    {
+        rings[t].slots = slots[t];
+        rings[t].size = sizes[t];
+        rings[t].head = 0;
+        rings[t].filled = 0;
+        rings[t].periodMs = periods[t];
+        resetAccumulator(rings[t].acc, 0);
+    }
+}
+
+void SignalMonitor::resetAccumulator(Accumulator &acc, uint32_t startMs)
+{
+    acc.startMs = startMs;
+    acc.sum = 0;
+    acc.count = 0;
+    acc.stereoCount = 0;
+    acc.min = 0xFF;
+    acc.max = 0;
+}
+
+// =========================================================
+// Sampling
+// =========================================================
+void SignalMonitor::addSample(uint8_t rssi, bool stereo, uint32_t nowMs)
+{
+    if (!started)
+    {
+        started = true;
+        blendSwitches = Metrics::counter("fm_mono_blend_switches_total");
+        for (uint8_t t = 0; t < SIGNAL_TIER_COUNT; t++)
+            rings[t].acc.startMs = nowMs;
+    }
+
+    for (uint8_t t = 0; t < SIGNAL_TIER_COUNT; t++)
+    {
+        Ring &ring = rings[t];
+        uint16_t closed = advance(ring, nowMs);
+        // Blend decisions follow completed seconds that actually had samples
+        if (t == SIGNAL_TIER_SEC && closed)
+        {
+            const Slot &last = ring.slots[(ring.head + ring.size - 1) % ring.size];
+            if (last.min != 0xFF)
+                updateBlend(last);
+        }
+
+        Accumulator &acc = ring.acc;
+        acc.sum += rssi;
+        acc.count++;
+        if (stereo)
+            acc.stereoCount++;
+        if (rssi < acc.min)
+            acc.min = rssi;
+        if (rssi > acc.max)
+            acc.max = rssi;
+    }
+}
+
+uint16_t SignalMonitor::advance(Ring &ring, uint32_t nowMs)
+{
+    uint16_t closed = 0;
+    while (nowMs - ring.acc.startMs >= ring.periodMs)
+    {
+        push(ring);
+        closed++;
+        // A gap longer than the ring only needs one pass of empty slots
+        if (closed >= ring.size && nowMs - ring.acc.startMs >= ring.periodMs)
+        {
+            uint32_t periods = (nowMs - ring.acc.startMs) / ring.periodMs;
+            resetAccumulator(ring.acc, ring.acc.startMs + periods * ring.periodMs);
+            break;
+        }
+    }
+    return closed;
+}
+
+void SignalMonitor::push(Ring &ring)
+{
+    Accumulator &acc = ring.acc;
+    Slot &slot = ring.slots[ring.head];
+    if (acc.count)
+    {
+        slot.min = acc.min;
+        slot.max = acc.max;
+        slot.avg = (uint8_t)((acc.sum + acc.count / 2) / acc.count);
+        slot.stereoPct = (uint8_t)((uint32_t)acc.stereoCount * 100 / acc.count);
+    }
+    else
+    {
+        slot.min = 0xFF;
+        slot.max = 0;
+        slot.avg = 0;
+        slot.stereoPct = 0;
+    }
+
+    ring.head = (ring.head + 1) % ring.size;
+    if (ring.filled < ring.size)
+        ring.filled++;
+    resetAccumulator(acc, acc.startMs + ring.periodMs);
+}
+
+// =========================================================
+// Mono Blend
+// =========================================================
+void SignalMonitor::updateBlend(const Slot &second)
+{
+    if (second.avg < MONO_BLEND_ON_RSSI)
+    {
+        aboveCount = 0;
+        if (belowCount < MONO_BLEND_HOLD_S)
+            belowCount++;
+    }
+    else if (second.avg > MONO_BLEND_OFF_RSSI)
+    {
+        belowCount = 0;
+        if (aboveCount < MONO_BLEND_HOLD_S)
+            aboveCount++;
+    }
+    else
+    {
+        // Between the thresholds: keep the current mode
+        belowCount = 0;
+        aboveCount = 0;
+    }
+
+    bool next = mono;
+    if (!mono && belowCount >= MONO_BLEND_HOLD_S)
+        next = true;
+    else if (mono && aboveCount >= MONO_BLEND_HOLD_S)
+        next = false;
+
+    if (next != mono)
+    {
+        mono = next;
+        Metrics::inc(blendSwitches);
+    }
+}
+
+// =========================================================
+// History Output
+// =========================================================
+bool SignalMonitor::parseTier(const char *name, SignalTier &out)
+{
+    for (uint8_t t = 0; t < SIGNAL_TIER_COUNT; t++)
+    {
+        if (strcmp(name, TIER_NAMES[t]) == 0)
+        {
+            out = (SignalTier)t;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SignalMonitor::renderHistory(SignalTier tier, char *buf, size_t bufSize, Metrics::EmitFn emit, void *ctx) const
+{
+    const Ring &ring = rings[tier];
+    uint16_t first = (ring.head + ring.size - ring.filled) % ring.size;
+    size_t len = 0;
+
+    // {"tier":"sec","period_ms":1000,"end_ms":...,"min":[..],"max":[..],"avg":[..],"stereo":[..]}
+    len += snprintf(buf + len, bufSize - len, "{\"tier\":\"%s\",\"period_ms\":%lu,\"end_ms\":%lu,\"mono_blend\":%s",
+                    TIER_NAMES[tier], (unsigned long)ring.periodMs, (unsigned long)ring.acc.startMs,
+                    mono ? "true" : "false");
+
+    static const char *const COLUMNS[4] = {"min", "max", "avg", "stereo"};
+    for (uint8_t col = 0; col < 4; col++)
+    {
+        if (bufSize - len < 16)
+        {
+            emit(buf, len, ctx);
+            len = 0;
+        }
+        len += snprintf(buf + len, bufSize - len, ",\"%s\":[", COLUMNS[col]);
+        for (uint16_t i = 0; i < ring.filled; i++)
+        {
+            // Flush before the buffer can overflow (one value is at most 5 bytes)
+            if (bufSize - len < 8)
+            {
+                emit(buf, len, ctx);
+                len = 0;
+            }
+            const Slot &s = ring.slots[(first + i) % ring.size];
+            int value = -1;
+            if (s.min != 0xFF)
+                value = col == 0 ? s.min : col == 1 ? s.max : col == 2 ? s.avg : s.stereoPct;
+            len += snprintf(buf + len, bufSize - len, i ? ",%d" : "%d", value);
+        }
+        buf[len++] = ']';
+    }
+    buf[len++] = '}';
+    emit(buf, len, ctx);
+}
@@ -0,0 +1,211 @@
+#include "Spectrum.h"
+#include <math.h>
+
+static_assert((SPECTRUM_FFT_SIZE / 2) >= 4 && ((SPECTRUM_FFT_SIZE / 2) & (SPECTRUM_FFT_SIZE / 2 - 1)) == 0 &&
+                  ((SPECTRUM_FFT_SIZE / 2) & 0x55555555) != 0,
+              "SPECTRUM_FFT_SIZE / 2 must be a power of 4");
+
+Spectrum::Spectrum()
+    : sampleRate(0), seq(0), fullScaleBandDb(0), fullScaleDb(0)
+{
+}
+
+// =========================================================
+// Tables
+// =========================================================
+void Spectrum::begin(uint32_t rate)
+{
+    sampleRate = rate;
+    const uint16_t n = SPECTRUM_FFT_SIZE;
+
+    // Periodic Hann
+    for (uint16_t i = 0; i < n; i++)
+        window[i] = (int16_t)lroundf((0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / n)) * 32767.0f);
+
+    for (uint16_t k = 0; k < n * 3 / 4; k++)
+    {
+        float angle = 2.0f * (float)M_PI * k / n;
+        twiddle[k].re = (int16_t)lroundf(cosf(angle) * 32767.0f);
+        twiddle[k].im = (int16_t)lroundf(sinf(angle) * 32767.0f);
+    }
+
+    // Base-4 digit reversal of the FFT index
+    uint8_t digits = 0;
+    for (uint16_t m = FFT_POINTS; m > 1; m >>= 2)
+        digits++;
+    for (uint16_t i = 0; i < FFT_POINTS; i++)
+    {
+        uint16_t r = 0;
+        for (uint8_t d = 0; d < digits; d++)
+            r |= ((i >> (2 * d)) & 3) << (2 * (digits - 1 - d));
+        digitReverse[i] = r;
+    }
+
+    // Log-spaced bands; every band gets at least one bin of its own
+    float ratio = (float)SPECTRUM_MAX_HZ / SPECTRUM_MIN_HZ;
+    for (uint8_t b = 0; b <= SPECTRUM_BANDS; b++)
+    {
+        float hz = SPECTRUM_MIN_HZ * powf(ratio, (float)b / SPECTRUM_BANDS);
+        int32_t bin = lroundf(hz * n / rate);
+        if (bin < 1)
+            bin = 1;
+        if (b > 0 && bin <= bandStart[b - 1])
+            bin = bandStart[b - 1] + 1;
+        bandStart[b] = bin;
+    }
+    // The split pass reads bin N/2 - k, so the last usable bin is N/2 - 1
+    if (bandStart[SPECTRUM_BANDS] > FFT_POINTS)
+        bandStart[SPECTRUM_BANDS] = FFT_POINTS;
+
+    // Output is the DFT times 1/N (2/N from the FFT, 1/2 at the input).
+    // A sine of amplitude A under Hann lands as A/4 in its bin and A/8 in
+    // each neighbour: band power 3*A^2/32.
+    fullScaleDb = halfDb(32767ULL * 32767ULL);
+    fullScaleBandDb = halfDb(32767ULL * 32767ULL * 3 / 32);
+}
+
+uint16_t Spectrum::getBandHz(uint8_t band) const
+{
+    return (uint32_t)bandStart[band] * sampleRate / SPECTRUM_FFT_SIZE;
+}
+
+// =========================================================
+// Levels
+// =========================================================
+int32_t Spectrum::halfDb(uint64_t v)
+{
+    if (v == 0)
+        v = 1;
+    uint8_t msb = 63 - __builtin_clzll(v);
+    // 16 fraction bits below the leading one, plus a parabola for log2(1+f)
+    uint32_t f = (uint32_t)((v << (63 - msb)) >> 47) & 0xFFFF;
+    uint32_t log2Q16 = ((uint32_t)msb << 16) + f + (uint32_t)(((uint64_t)f * (65536 - f) * 22714) >> 32);
+    // 20*log10(2) = 6.0206 half-dB per octave of power
+    return (int32_t)(((uint64_t)log2Q16 * 394566 + (1ULL << 31)) >> 32);
+}
+
+uint8_t Spectrum::level(int32_t db, int32_t reference)
+{
+    int32_t v = 255 + db - reference;
+    return v < 0 ? 0 : (v > 255 ? 255 : (uint8_t)v);
+}
+
+// =========================================================
+// Radix-4 FFT (in place, input already digit-reversed)
+// =========================================================
+void Spectrum::fft()
+{
+    for (uint16_t span = 4; span <= FFT_POINTS; span <<= 2)
+    {
+        const uint16_t q = span >> 2;
+        const uint16_t step = 2 * (FFT_POINTS / span); // Twiddle index step in W_N units
+
+        for (uint16_t j = 0; j < q; j++)
+        {
+            const Complex16 w1 = twiddle[j * step];
+            const Complex16 w2 = twiddle[2 * j * step];
+            const Complex16 w3 = twiddle[3 * j * step];
+
+            for (uint16_t i = j; i < FFT_POINTS; i += span)
+            {
+                Complex16 &pa = buf[i];
+                Complex16 &pb = buf[i + q];
+                Complex16 &pc = buf[i + 2 * q];
+                Complex16 &pd = buf[i + 3 * q];
+
+                int32_t ar = pa.re, ai = pa.im;
+                int32_t br, bi, cr, ci, dr, di;
+                if (j == 0)
+                {
+                    br = pb.re, bi = pb.im;
+                    cr = pc.re, ci = pc.im;
+                    dr = pd.re, di = pd.im;
+                }
+                else
+                {
+                    // x * (cos - j*sin)
+                    br = (pb.re * w1.re + pb.im * w1.im + 0x4000) >> 15;
+                    bi = (pb.im * w1.re - pb.re * w1.im + 0x4000) >> 15;
+                    cr = (pc.re * w2.re + pc.im * w2.im + 0x4000) >> 15;
+                    ci = (pc.im * w2.re - pc.re * w2.im + 0x4000) >> 15;
+                    dr = (pd.re * w3.re + pd.im * w3.im + 0x4000) >> 15;
+                    di = (pd.im * w3.re - pd.re * w3.im + 0x4000) >> 15;
+                }
+
+                int32_t t0r = ar + cr, t0i = ai + ci;
+                int32_t t1r = ar - cr, t1i = ai - ci;
+                int32_t t2r = br + dr, t2i = bi + di;
+                int32_t t3r = br - dr, t3i = bi - di;
+
+                // 1/4 per stage keeps every value inside int16
+                pa.re = (t0r + t2r + 2) >> 2;
+                pa.im = (t0i + t2i + 2) >> 2;
+                pb.re = (t1r + t3i + 2) >> 2; // (a - c) - j(b - d)
+                pb.im = (t1i - t3r + 2) >> 2;
+                pc.re = (t0r - t2r + 2) >> 2;
+                pc.im = (t0i - t2i + 2) >> 2;
+                pd.re = (t1r - t3i + 2) >> 2; // (a - c) + j(b - d)
+                pd.im = (t1i + t3r + 2) >> 2;
+            }
+        }
+    }
+}
+
+// =========================================================
+// Frame
+// =========================================================
+void Spectrum::analyze(const int16_t *samples, size_t count, SpectrumFrame &out)
+{
+    out.type = SPECTRUM_FRAME_TYPE;
+    out.bandCount = SPECTRUM_BANDS;
+    out.seq = seq++;
+
+    // Peak / RMS over everything since the last frame
+    uint32_t peak = 0;
+    uint64_t sumSquares = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t s = samples[i];
+        uint32_t mag = s < 0 ? -s : s;
+        if (mag > peak)
+            peak = mag;
+        sumSquares += (uint32_t)(s * s);
+    }
+    out.peak = level(halfDb((uint64_t)peak * peak), fullScaleDb);
+    out.rms = count ? level(halfDb(sumSquares / count), fullScaleDb) : 0;
+
+    // Window the newest N samples at half scale (headroom for the rotations)
+    // and pack even/odd samples as re/im, stored in digit-reversed order
+    const int16_t *src = samples + (count > SPECTRUM_FFT_SIZE ? count - SPECTRUM_FFT_SIZE : 0);
+    uint16_t pad = count < SPECTRUM_FFT_SIZE ? SPECTRUM_FFT_SIZE - count : 0;
+    for (uint16_t m = 0; m < FFT_POINTS; m++)
+    {
+        uint16_t n = 2 * m;
+        int32_t even = n < pad ? 0 : src[n - pad];
+        int32_t odd = n + 1 < pad ? 0 : src[n + 1 - pad];
+        Complex16 &z = buf[digitReverse[m]];
+        z.re = (even * window[n] + 0x8000) >> 16;
+        z.im = (odd * window[n + 1] + 0x8000) >> 16;
+    }
+
+    fft();
+
+    // Split the packed spectrum into the real signal's bins and sum the
+    // power per band: X[k] = E[k] + W_N^k * O[k]
+    for (uint8_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        uint64_t power = 0;
+        for (uint16_t k = bandStart[b]; k < bandStart[b + 1]; k++)
+        {
+            const Complex16 &a = buf[k];
+            const Complex16 &c = buf[FFT_POINTS - k];
+            int32_t er = a.re + c.re, ei = a.im - c.im; // 2*E
+            int32_t orr = a.im + c.im, oi = c.re - a.re; // 2*O = -j * (a - conj(c))
+            const Complex16 &w = twiddle[k];
+            int32_t xr = (er + ((orr * w.re + oi * w.im + 0x4000) >> 15)) >> 1;
+            int32_t xi = (ei + ((oi * w.re - orr * w.im + 0x4000) >> 15)) >> 1;
+            power += (uint32_t)(xr * xr) + (uint32_t)(xi * xi);
+        }
+        out.bands[b] = level(halfDb(power), fullScaleBandDb);
+    }
+}
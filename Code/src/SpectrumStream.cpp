@@ -0,0 +1,355 @@
+#include "SpectrumStream.h"
+#include <driver/i2s.h>
+#include <driver/adc.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/version.h>
+#include "Metrics.h"
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define WS_OP_BINARY 0x82 // FIN + binary
+#define WS_OP_CLOSE 0x08
+
+// =========================================================
+// Constructor / Initialization
+// =========================================================
+SpectrumStream::SpectrumStream()
+    : server(SPECTRUM_WS_PORT), subscribers(0), task(nullptr), running(false), latest(), latestCount(0),
+      sentCount(0), dcQ4(-1), adcEnabled(false), stride(1), hops(0), budgetCycles(0), avgCycles(0),
+      maxCycles(0), frames(0), overBudget(0)
+{
+    frameLock = portMUX_INITIALIZER_UNLOCKED;
+    for (uint8_t i = 0; i < SPECTRUM_MAX_CLIENTS; i++)
+        active[i] = false;
+}
+
+bool SpectrumStream::begin()
+{
+    if (running.load(std::memory_order_acquire))
+        return true;
+
+    spectrum.begin(SPECTRUM_SAMPLE_RATE);
+
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+    config.sample_rate = SPECTRUM_SAMPLE_RATE;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_MSB;
+    config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+    config.dma_buf_count = 4; // ~93 ms of slack for a late task
+    config.dma_buf_len = 512;
+
+    if (i2s_driver_install((i2s_port_t)SPECTRUM_I2S_PORT, &config, 0, nullptr) != ESP_OK)
+    {
+        Serial.println("Spectrum: I2S ADC driver install failed.");
+        return false;
+    }
+    i2s_set_adc_mode(ADC_UNIT_1, SPECTRUM_ADC_CHANNEL);
+    // Sampling starts with the first subscriber
+    i2s_adc_disable((i2s_port_t)SPECTRUM_I2S_PORT);
+
+    budgetCycles = (uint64_t)ESP.getCpuFreqMHz() * 1000000ULL * SPECTRUM_CPU_BUDGET_PERCENT / 100 / SPECTRUM_FRAME_HZ;
+
+    running.store(true, std::memory_order_release);
+    if (xTaskCreatePinnedToCore(taskEntry, "spectrum", 4096, this, SPECTRUM_TASK_PRIORITY, &task, SPECTRUM_TASK_CORE) != pdPASS)
+    {
+        Serial.println("Spectrum: Failed to start capture task.");
+        running.store(false, std::memory_order_release);
+        i2s_driver_uninstall((i2s_port_t)SPECTRUM_I2S_PORT);
+        return false;
+    }
+
+    server.begin();
+    server.setNoDelay(true);
+    Serial.printf("Spectrum: %u Hz, %u bands at %u Hz, ws://:%d/spectrum\n", (unsigned)SPECTRUM_SAMPLE_RATE,
+                  (unsigned)SPECTRUM_BANDS, (unsigned)SPECTRUM_FRAME_HZ, SPECTRUM_WS_PORT);
+    return true;
+}
+
+// =========================================================
+// Capture task
+// =========================================================
+void SpectrumStream::taskEntry(void *arg)
+{
+    static_cast<SpectrumStream *>(arg)->run();
+}
+
+void SpectrumStream::run()
+{
+    while (true)
+    {
+        if (subscribers.load() == 0)
+        {
+            setCapture(false);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        setCapture(true);
+
+        // Blocks for one hop (40 ms); the DMA keeps filling meanwhile
+        size_t bytes = 0;
+        i2s_read((i2s_port_t)SPECTRUM_I2S_PORT, raw, sizeof(raw), &bytes, pdMS_TO_TICKS(200));
+        size_t count = bytes / sizeof(raw[0]);
+        if (count < SPECTRUM_HOP || ++hops % stride)
+            continue;
+
+        uint32_t start = ESP.getCycleCount();
+        convert(count);
+        SpectrumFrame frame;
+        spectrum.analyze(samples, count, frame);
+        uint32_t cycles = ESP.getCycleCount() - start;
+
+        portENTER_CRITICAL(&frameLock);
+        latest = frame;
+        latestCount++;
+        portEXIT_CRITICAL(&frameLock);
+
+        noteCycles(cycles);
+    }
+}
+
+void SpectrumStream::setCapture(bool on)
+{
+    if (on == adcEnabled)
+        return;
+    if (on)
+    {
+        dcQ4 = -1;
+        i2s_zero_dma_buffer((i2s_port_t)SPECTRUM_I2S_PORT);
+        i2s_adc_enable((i2s_port_t)SPECTRUM_I2S_PORT);
+    }
+    else
+    {
+        i2s_adc_disable((i2s_port_t)SPECTRUM_I2S_PORT);
+    }
+    adcEnabled = on;
+}
+
+// 12-bit ADC words -> Q15 around the measured midpoint
+void SpectrumStream::convert(size_t count)
+{
+    // The I2S ADC mode delivers samples in swapped pairs, with the channel
+    // number in the top 4 bits
+    int32_t sum = 0;
+    for (size_t i = 0; i + 1 < count; i += 2)
+    {
+        uint16_t first = raw[i + 1] & 0x0FFF;
+        raw[i + 1] = raw[i] & 0x0FFF;
+        raw[i] = first;
+        sum += raw[i] + raw[i + 1];
+    }
+
+    // Slow DC tracker: follows the bias network as it drifts, not the audio
+    int32_t meanQ4 = (sum << 4) / (int32_t)count;
+    dcQ4 = dcQ4 < 0 ? meanQ4 : dcQ4 + (meanQ4 - dcQ4) / 8;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t v = ((int32_t)raw[i] << 4) - dcQ4;
+        samples[i] = v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+    }
+}
+
+void SpectrumStream::noteCycles(uint32_t cycles)
+{
+    static MetricCounter *frameCount = Metrics::counter("spectrum_frames_total");
+    static MetricCounter *overCount = Metrics::counter("spectrum_over_budget_total");
+    static MetricGauge *cpu = Metrics::gauge("spectrum_cpu_permille");
+
+    int32_t avg = avgCycles.load(std::memory_order_relaxed);
+    avg = avg ? avg + ((int32_t)cycles - avg) / 8 : cycles;
+    avgCycles.store(avg, std::memory_order_relaxed);
+    if (cycles > maxCycles.load(std::memory_order_relaxed))
+        maxCycles.store(cycles, std::memory_order_relaxed);
+    frames.fetch_add(1, std::memory_order_relaxed);
+    Metrics::inc(frameCount);
+
+    if (cycles > budgetCycles)
+    {
+        overBudget.fetch_add(1, std::memory_order_relaxed);
+        Metrics::inc(overCount);
+    }
+    // Over budget on average: halve the frame rate until the full rate
+    // would fit in half the budget
+    if (stride == 1 && (uint32_t)avg > budgetCycles)
+    {
+        stride = 2;
+        Serial.println("Spectrum: Over CPU budget, halving the frame rate.");
+    }
+    else if (stride == 2 && (uint32_t)avg < budgetCycles / 2)
+    {
+        stride = 1;
+    }
+    Metrics::set(cpu, (uint64_t)avg * 1000 * SPECTRUM_CPU_BUDGET_PERCENT / 100 / stride / budgetCycles);
+}
+
+// =========================================================
+// WebSocket subscribers (loop task)
+// =========================================================
+void SpectrumStream::poll()
+{
+    if (!running.load(std::memory_order_acquire))
+        return;
+
+    WiFiClient incoming = server.available();
+    if (incoming)
+    {
+        uint8_t slot = SPECTRUM_MAX_CLIENTS;
+        for (uint8_t i = 0; i < SPECTRUM_MAX_CLIENTS && slot == SPECTRUM_MAX_CLIENTS; i++)
+            if (!active[i])
+                slot = i;
+
+        if (slot == SPECTRUM_MAX_CLIENTS)
+        {
+            incoming.print("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+            incoming.stop();
+        }
+        else if (handshake(incoming))
+        {
+            incoming.setNoDelay(true);
+            clients[slot] = incoming;
+            active[slot] = true;
+            if (subscribers.fetch_add(1) == 0)
+                xTaskNotifyGive(task);
+        }
+        else
+        {
+            incoming.stop();
+        }
+    }
+
+    if (subscribers.load() == 0)
+        return;
+
+    SpectrumFrame frame;
+    uint32_t count;
+    portENTER_CRITICAL(&frameLock);
+    frame = latest;
+    count = latestCount;
+    portEXIT_CRITICAL(&frameLock);
+
+    bool fresh = count != sentCount;
+    sentCount = count;
+    uint8_t message[2 + sizeof(SpectrumFrame)] = {WS_OP_BINARY, sizeof(SpectrumFrame)};
+    memcpy(message + 2, &frame, sizeof(frame));
+
+    for (uint8_t i = 0; i < SPECTRUM_MAX_CLIENTS; i++)
+    {
+        if (!active[i])
+            continue;
+        WiFiClient &client = clients[i];
+        if (!client.connected())
+        {
+            dropClient(i);
+            continue;
+        }
+
+        // Only a close frame is acted on; anything else is discarded
+        if (client.available())
+        {
+            bool close = (client.read() & 0x0F) == WS_OP_CLOSE;
+            uint8_t scratch[32];
+            while (client.available())
+                client.read(scratch, sizeof(scratch));
+            if (close)
+            {
+                const uint8_t reply[2] = {0x80 | WS_OP_CLOSE, 0};
+                client.write(reply, sizeof(reply));
+                dropClient(i);
+                continue;
+            }
+        }
+
+        // A short write means the socket buffer (seconds of frames) is full
+        if (fresh && client.write(message, sizeof(message)) != sizeof(message))
+            dropClient(i);
+    }
+}
+
+bool SpectrumStream::handshake(WiFiClient &client)
+{
+    client.setTimeout(SPECTRUM_HANDSHAKE_TIMEOUT_S);
+
+    // "GET /spectrum HTTP/1.1"
+    String request = client.readStringUntil('\n');
+    String key;
+    while (true)
+    {
+        String header = client.readStringUntil('\n');
+        header.trim();
+        if (header.length() == 0)
+            break;
+        if (header.startsWith("Sec-WebSocket-Key:") || header.startsWith("sec-websocket-key:"))
+        {
+            key = header.substring(18);
+            key.trim();
+        }
+    }
+
+    if (!request.startsWith("GET /spectrum") || key.length() == 0 || key.length() > 32)
+    {
+        client.print("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+        return false;
+    }
+
+    // Sec-WebSocket-Accept = base64(sha1(key + GUID))
+    String input = key + WS_GUID;
+    unsigned char digest[20];
+#if MBEDTLS_VERSION_MAJOR >= 3
+    mbedtls_sha1((const unsigned char *)input.c_str(), input.length(), digest);
+#else
+    mbedtls_sha1_ret((const unsigned char *)input.c_str(), input.length(), digest);
+#endif
+    unsigned char accept[32];
+    size_t acceptLen = 0;
+    mbedtls_base64_encode(accept, sizeof(accept), &acceptLen, digest, sizeof(digest));
+    accept[acceptLen] = '\0';
+
+    client.printf("HTTP/1.1 101 Switching Protocols\r\n"
+                  "Upgrade: websocket\r\n"
+                  "Connection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: %s\r\n\r\n",
+                  (const char *)accept);
+    Serial.printf("Spectrum: Subscriber %s connected.\n", client.remoteIP().toString().c_str());
+    return true;
+}
+
+void SpectrumStream::dropClient(uint8_t i)
+{
+    clients[i].stop();
+    active[i] = false;
+    subscribers.fetch_sub(1);
+}
+
+// =========================================================
+// Status
+// =========================================================
+void SpectrumStream::getStatus(JsonDocument *doc)
+{
+    uint32_t cpuHz = ESP.getCpuFreqMHz() * 1000000UL;
+    uint32_t avg = avgCycles.load(std::memory_order_relaxed);
+
+    (*doc)["running"] = running.load(std::memory_order_acquire);
+    (*doc)["port"] = SPECTRUM_WS_PORT;
+    (*doc)["path"] = "/spectrum";
+    (*doc)["subscribers"] = subscribers.load();
+    (*doc)["sample_rate"] = SPECTRUM_SAMPLE_RATE;
+    (*doc)["fft_size"] = SPECTRUM_FFT_SIZE;
+    (*doc)["frame_hz"] = SPECTRUM_FRAME_HZ / stride;
+    (*doc)["frame_bytes"] = sizeof(SpectrumFrame);
+
+    // Lower edge of each band, then the upper edge of the last one
+    JsonArray edges = (*doc)["band_hz"].to<JsonArray>();
+    for (uint8_t b = 0; b < SPECTRUM_BANDS; b++)
+        edges.add(spectrum.getBandHz(b));
+    edges.add(SPECTRUM_MAX_HZ);
+
+    JsonObject cpu = (*doc)["cpu"].to<JsonObject>();
+    cpu["frames"] = frames.load();
+    cpu["cycles_avg"] = avg;
+    cpu["cycles_max"] = maxCycles.load();
+    cpu["percent"] = cpuHz ? (float)avg * SPECTRUM_FRAME_HZ / stride * 100.0f / cpuHz : 0.0f;
+    cpu["budget_percent"] = SPECTRUM_CPU_BUDGET_PERCENT;
+    cpu["over_budget"] = overBudget.load();
+}
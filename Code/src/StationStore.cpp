@@ -0,0 +1,480 @@
+#include "StationStore.h"
+
+#define STORE_MAGIC "FMST"
+#define STORE_VERSION 1
+#define INDEX_TOMBSTONE 0xFFFF
+
+struct StoreHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+    uint16_t capacity;
+    uint8_t reserved[6];
+};
+
+static_assert(sizeof(StationRecord) == 32, "StationRecord must stay 32 bytes on disk");
+static_assert(sizeof(StoreHeader) == 16, "StoreHeader must stay 16 bytes on disk");
+static_assert(STATION_MAX <= 256, "Preset list stores slots as uint8_t");
+
+// =========================================================
+// Constructor
+// =========================================================
+StationStore::StationStore(FileManager *fm)
+    : fileManager(fm), used(0), numPresets(0), tombstones(0), nextPresetOrder(0),
+      fresh(false), loadMicros(0)
+{
+    memset(records, 0, sizeof(records));
+    memset(index, 0, sizeof(index));
+    memset(dirty, 0, sizeof(dirty));
+}
+
+// =========================================================
+// Load / Create
+// =========================================================
+bool StationStore::begin()
+{
+    fresh = false;
+    if (load())
+        return true;
+
+    // Missing or unreadable store: start empty and write a blank file
+    memset(records, 0, sizeof(records));
+    memset(dirty, 0, sizeof(dirty));
+    rebuildIndex();
+    rebuildPresets();
+    fresh = true;
+    return saveAll();
+}
+
+bool StationStore::load()
+{
+    uint32_t start = micros();
+
+    File file = fileManager->openFile(STATION_STORE_FILE);
+    if (!file)
+        return false;
+
+    StoreHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              memcmp(header.magic, STORE_MAGIC, 4) == 0 &&
+              header.version == STORE_VERSION &&
+              header.recordSize == sizeof(StationRecord) &&
+              header.capacity == STATION_MAX;
+
+    // One sequential read for the whole table
+    if (ok)
+        ok = file.read((uint8_t *)records, sizeof(records)) == sizeof(records);
+    file.close();
+
+    if (!ok)
+    {
+        Serial.println("StationStore: stations.bin invalid, recreating.");
+        return false;
+    }
+
+    // Drop records that fail their CRC rather than the whole store
+    size_t corrupt = 0;
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        if (records[i].code != 0 && records[i].crc != recordCrc(records[i]))
+        {
+            memset(&records[i], 0, sizeof(StationRecord));
+            corrupt++;
+        }
+    }
+
+    memset(dirty, 0, sizeof(dirty));
+    rebuildIndex();
+    rebuildPresets();
+    loadMicros = micros() - start;
+
+    Serial.printf("StationStore: %u stations (%u presets) loaded in %lu us",
+                  (unsigned)used, (unsigned)numPresets, (unsigned long)loadMicros);
+    if (corrupt)
+        Serial.printf(", %u corrupt records dropped", (unsigned)corrupt);
+    Serial.println();
+    return true;
+}
+
+bool StationStore::saveAll()
+{
+    File file = fileManager->openFile(STATION_STORE_FILE, FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("StationStore: Cannot create stations.bin.");
+        return false;
+    }
+
+    StoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STORE_MAGIC, 4);
+    header.version = STORE_VERSION;
+    header.recordSize = sizeof(StationRecord);
+    header.capacity = STATION_MAX;
+
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        if (records[i].code != 0)
+            records[i].crc = recordCrc(records[i]);
+    }
+
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)records, sizeof(records)) == sizeof(records);
+    file.close();
+
+    if (ok)
+        memset(dirty, 0, sizeof(dirty));
+    return ok;
+}
+
+bool StationStore::writeRecord(size_t slot)
+{
+    // "r+" keeps the file intact, only this record's 32 bytes are rewritten
+    File file = fileManager->openFile(STATION_STORE_FILE, "r+");
+    if (!file)
+        return false;
+
+    if (records[slot].code != 0)
+        records[slot].crc = recordCrc(records[slot]);
+
+    bool ok = file.seek(sizeof(StoreHeader) + slot * sizeof(StationRecord)) &&
+              file.write((const uint8_t *)&records[slot], sizeof(StationRecord)) == sizeof(StationRecord);
+    file.close();
+
+    if (ok)
+        dirty[slot / 32] &= ~(1UL << (slot % 32));
+    return ok;
+}
+
+// =========================================================
+// Hash Index (open addressing, linear probing)
+// =========================================================
+uint16_t StationStore::hashSlot(uint16_t code)
+{
+    // Fibonacci hashing spreads the evenly spaced channel codes
+    return (uint16_t)(((uint32_t)code * 2654435761UL) >> 23) & (STATION_INDEX_SIZE - 1);
+}
+
+void StationStore::indexInsert(uint16_t code, size_t slot)
+{
+    uint16_t h = hashSlot(code);
+    while (index[h] != 0 && index[h] != INDEX_TOMBSTONE)
+        h = (h + 1) & (STATION_INDEX_SIZE - 1);
+    if (index[h] == INDEX_TOMBSTONE)
+        tombstones--;
+    index[h] = slot + 1;
+}
+
+void StationStore::indexRemove(uint16_t code, size_t slot)
+{
+    uint16_t h = hashSlot(code);
+    while (index[h] != 0)
+    {
+        if (index[h] == slot + 1)
+        {
+            index[h] = INDEX_TOMBSTONE;
+            tombstones++;
+            break;
+        }
+        h = (h + 1) & (STATION_INDEX_SIZE - 1);
+    }
+
+    // Long probe chains of tombstones slow lookups down: compact
+    if (tombstones > STATION_INDEX_SIZE / 4)
+        rebuildIndex();
+}
+
+void StationStore::rebuildIndex()
+{
+    memset(index, 0, sizeof(index));
+    tombstones = 0;
+    used = 0;
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        if (records[i].code != 0)
+        {
+            indexInsert(records[i].code, i);
+            used++;
+        }
+    }
+}
+
+int StationStore::find(Channel channel) const
+{
+    uint16_t code = channel.code();
+    if (code == 0)
+        return -1;
+
+    uint16_t h = hashSlot(code);
+    while (index[h] != 0)
+    {
+        if (index[h] != INDEX_TOMBSTONE && records[index[h] - 1].code == code)
+            return index[h] - 1;
+        h = (h + 1) & (STATION_INDEX_SIZE - 1);
+    }
+    return -1;
+}
+
+const StationRecord *StationStore::get(Channel channel) const
+{
+    int slot = find(channel);
+    return slot < 0 ? nullptr : &records[slot];
+}
+
+// =========================================================
+// Record Allocation
+// =========================================================
+int StationStore::upsert(Channel channel)
+{
+    int slot = find(channel);
+    if (slot >= 0)
+        return slot;
+
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        if (records[i].code == 0)
+        {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0)
+        slot = evictSlot();
+    if (slot < 0)
+        return -1;
+
+    StationRecord &rec = records[slot];
+    memset(&rec, 0, sizeof(rec));
+    rec.code = channel.code();
+    rec.lastRssi = -1;
+    indexInsert(rec.code, slot);
+    used++;
+    markDirty(slot);
+    return slot;
+}
+
+int StationStore::evictSlot()
+{
+    // Full: forget the least played station that is not a preset
+    int victim = -1;
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        if (records[i].flags & STATION_FLAG_FAVORITE)
+            continue;
+        if (victim < 0 || records[i].playCount < records[victim].playCount)
+            victim = i;
+    }
+    if (victim < 0)
+        return -1;
+
+    uint16_t code = records[victim].code;
+    memset(&records[victim], 0, sizeof(StationRecord));
+    used--;
+    indexRemove(code, victim);
+    return victim;
+}
+
+// =========================================================
+// Presets
+// =========================================================
+void StationStore::rebuildPresets()
+{
+    numPresets = 0;
+    nextPresetOrder = 0;
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        if (records[i].code == 0 || !(records[i].flags & STATION_FLAG_FAVORITE))
+            continue;
+
+        // Insertion sort by presetOrder, the list is small and only rebuilt on load
+        size_t pos = numPresets;
+        while (pos > 0 && records[presets[pos - 1]].presetOrder > records[i].presetOrder)
+        {
+            presets[pos] = presets[pos - 1];
+            pos--;
+        }
+        presets[pos] = i;
+        numPresets++;
+
+        if (records[i].presetOrder >= nextPresetOrder)
+            nextPresetOrder = records[i].presetOrder + 1;
+    }
+}
+
+const StationRecord *StationStore::presetAt(size_t i) const
+{
+    if (i >= numPresets)
+        return nullptr;
+    return &records[presets[i]];
+}
+
+bool StationStore::addPreset(Channel channel)
+{
+    int slot = upsert(channel);
+    if (slot < 0)
+    {
+        Serial.println("StationStore: No free slot for preset.");
+        return false;
+    }
+
+    StationRecord &rec = records[slot];
+    if (rec.flags & STATION_FLAG_FAVORITE)
+        return true; // Already a preset
+
+    rec.flags |= STATION_FLAG_FAVORITE;
+    rec.presetOrder = nextPresetOrder++;
+    presets[numPresets++] = slot;
+    return writeRecord(slot);
+}
+
+bool StationStore::removePreset(size_t i)
+{
+    if (i >= numPresets)
+        return false;
+
+    // The station itself stays in the database, only the flag goes
+    size_t slot = presets[i];
+    records[slot].flags &= ~STATION_FLAG_FAVORITE;
+    memmove(&presets[i], &presets[i + 1], numPresets - i - 1);
+    numPresets--;
+    return writeRecord(slot);
+}
+
+// =========================================================
+// Metadata (deferred writes)
+// =========================================================
+void StationStore::notePlay(Channel channel)
+{
+    int slot = upsert(channel);
+    if (slot < 0)
+        return;
+    records[slot].playCount++;
+    markDirty(slot);
+}
+
+void StationStore::noteRssi(Channel channel, int rssi)
+{
+    int slot = find(channel);
+    if (slot < 0 || records[slot].lastRssi == rssi)
+        return;
+    records[slot].lastRssi = rssi;
+    markDirty(slot);
+}
+
+void StationStore::setName(Channel channel, const char *name)
+{
+    int slot = find(channel);
+    if (slot < 0 || strncmp(records[slot].name, name, STATION_NAME_LEN - 1) == 0)
+        return;
+    strncpy(records[slot].name, name, STATION_NAME_LEN - 1);
+    records[slot].name[STATION_NAME_LEN - 1] = '\0';
+    markDirty(slot);
+}
+
+bool StationStore::isDirty() const
+{
+    for (size_t i = 0; i < STATION_MAX / 32; i++)
+    {
+        if (dirty[i])
+            return true;
+    }
+    return false;
+}
+
+void StationStore::flush()
+{
+    if (!isDirty())
+        return;
+
+    File file = fileManager->openFile(STATION_STORE_FILE, "r+");
+    if (!file)
+    {
+        Serial.println("StationStore: Flush failed, cannot open stations.bin.");
+        return;
+    }
+
+    for (size_t slot = 0; slot < STATION_MAX; slot++)
+    {
+        if (!(dirty[slot / 32] & (1UL << (slot % 32))))
+            continue;
+
+        if (records[slot].code != 0)
+            records[slot].crc = recordCrc(records[slot]);
+        file.seek(sizeof(StoreHeader) + slot * sizeof(StationRecord));
+        file.write((const uint8_t *)&records[slot], sizeof(StationRecord));
+    }
+    file.close();
+    memset(dirty, 0, sizeof(dirty));
+}
+
+// =========================================================
+// Benchmark: binary store vs JSON
+// =========================================================
+void StationStore::benchmark(JsonDocument *out)
+{
+    flush();
+
+    uint32_t t0 = micros();
+    saveAll();
+    uint32_t binSave = micros() - t0;
+
+    t0 = micros();
+    load();
+    uint32_t binLoad = micros() - t0;
+
+    // Same content in the old fm.json "channels" shape
+    JsonDocument doc;
+    JsonArray channels = doc["channels"].to<JsonArray>();
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        if (records[i].code == 0)
+            continue;
+        char freq[CHANNEL_STR_LEN];
+        size_t len = Channel(records[i].code).format(freq);
+        JsonObject ch = channels.add<JsonObject>();
+        ch["freq"] = serialized(freq, len);
+        ch["name"] = records[i].name;
+        ch["rssi"] = records[i].lastRssi;
+        ch["favorite"] = (records[i].flags & STATION_FLAG_FAVORITE) != 0;
+        ch["plays"] = records[i].playCount;
+    }
+
+    t0 = micros();
+    fileManager->saveJsonFile(STATION_BENCH_FILE, doc);
+    uint32_t jsonSave = micros() - t0;
+
+    doc.clear();
+    t0 = micros();
+    fileManager->loadJsonFile(STATION_BENCH_FILE, &doc);
+    uint32_t jsonLoad = micros() - t0;
+    fileManager->removeFile(STATION_BENCH_FILE);
+
+    (*out)["stations"] = used;
+    (*out)["binary_save_us"] = binSave;
+    (*out)["binary_load_us"] = binLoad;
+    (*out)["json_save_us"] = jsonSave;
+    (*out)["json_load_us"] = jsonLoad;
+    Serial.printf("StationStore: bench %u stations, bin save/load %lu/%lu us, json save/load %lu/%lu us\n",
+                  (unsigned)used, (unsigned long)binSave, (unsigned long)binLoad,
+                  (unsigned long)jsonSave, (unsigned long)jsonLoad);
+}
+
+// =========================================================
+// CRC-16/CCITT-FALSE
+// =========================================================
+uint16_t StationStore::recordCrc(const StationRecord &rec)
+{
+    StationRecord copy = rec;
+    copy.crc = 0;
+    const uint8_t *p = (const uint8_t *)&copy;
+
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < sizeof(copy); i++)
+    {
+        crc ^= (uint16_t)p[i] << 8;
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
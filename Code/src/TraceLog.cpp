@@ -0,0 +1,169 @@
+#include "TraceLog.h"
+
+TraceLog::Record TraceLog::ring[TRACE_RING_SIZE];
+std::atomic<uint32_t> TraceLog::head(0);
+std::atomic<uint32_t> TraceLog::dropped(0);
+FileManager *TraceLog::fileManager = nullptr;
+
+static const char *const EVENT_FORMATS[TRACE_EVENT_COUNT] = {
+#define TRACE_FORMAT(id, fmt) fmt,
+    TRACE_EVENTS(TRACE_FORMAT)
+#undef TRACE_FORMAT
+};
+
+static const char LEVEL_CHARS[] = "-EWID";
+
+// =========================================================
+// Producer
+// =========================================================
+void TraceLog::log(uint8_t level, uint16_t event, int32_t a0, int32_t a1, int32_t a2)
+{
+    uint32_t seq = head.fetch_add(1, std::memory_order_relaxed);
+    Record &r = ring[seq & (TRACE_RING_SIZE - 1)];
+
+    // Readers ignore the slot until seq is published again
+    r.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    r.timestampUs = micros();
+    r.event = event;
+    r.level = level;
+    r.args[0] = a0;
+    r.args[1] = a1;
+    r.args[2] = a2;
+    r.seq.store(seq + 1, std::memory_order_release);
+}
+
+// =========================================================
+// Readers
+// =========================================================
+int TraceLog::read(uint32_t seq, Record &out)
+{
+    const Record &r = ring[seq & (TRACE_RING_SIZE - 1)];
+    uint32_t tag = r.seq.load(std::memory_order_acquire);
+    if (tag != seq + 1)
+        return tag == 0 ? 0 : -1;
+
+    out.timestampUs = r.timestampUs;
+    out.event = r.event;
+    out.level = r.level;
+    memcpy(out.args, r.args, sizeof(out.args));
+
+    // Overwritten while copying?
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return r.seq.load(std::memory_order_relaxed) == seq + 1 ? 1 : -1;
+}
+
+size_t TraceLog::format(const Record &r, uint32_t seq, char *buf, size_t size)
+{
+    const char *fmt = r.event < TRACE_EVENT_COUNT ? EVENT_FORMATS[r.event] : "?";
+    int len = snprintf(buf, size, "[%10lu] %c #%lu ", (unsigned long)r.timestampUs,
+                       LEVEL_CHARS[r.level < 5 ? r.level : 0], (unsigned long)seq);
+    if (len < 0 || (size_t)len >= size)
+        return 0;
+    int body = snprintf(buf + len, size - len, fmt, r.args[0], r.args[1], r.args[2]);
+    if (body < 0)
+        return 0;
+    len += body;
+    if ((size_t)len >= size - 1)
+        len = size - 2;
+    buf[len++] = '\n';
+    buf[len] = '\0';
+    return len;
+}
+
+void TraceLog::toText(uint32_t since, String &out, uint32_t &next)
+{
+    uint32_t end = head.load(std::memory_order_acquire);
+    uint32_t oldest = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+    if (since < oldest)
+        since = oldest;
+
+    out.reserve((end - since) * 64);
+    char line[160];
+    Record r;
+    for (uint32_t seq = since; seq < end; seq++)
+    {
+        if (read(seq, r) > 0 && format(r, seq, line, sizeof(line)))
+            out += line;
+    }
+    next = end;
+}
+
+// =========================================================
+// Drain Task
+// =========================================================
+void TraceLog::begin(FileManager *fm)
+{
+    fileManager = TRACE_TO_SD ? fm : nullptr;
+    xTaskCreate(drainTask, "trace", 3072, nullptr, 1, nullptr);
+}
+
+void TraceLog::drainTask(void *)
+{
+    uint32_t cursor = 0;
+    char line[160];
+    Record r;
+
+    while (true)
+    {
+        uint32_t end = head.load(std::memory_order_acquire);
+        if (end - cursor > TRACE_RING_SIZE)
+        {
+            // Producers lapped us: skip to the oldest entry still in the ring
+            dropped.fetch_add(end - cursor - TRACE_RING_SIZE, std::memory_order_relaxed);
+            cursor = end - TRACE_RING_SIZE;
+        }
+
+        File sd;
+        if (fileManager && cursor != end)
+            sd = fileManager->openFile(TRACE_SD_FILE, FILE_APPEND);
+
+        for (; cursor != end; cursor++)
+        {
+            int state = read(cursor, r);
+            if (state == 0)
+                break; // Producer mid-write: pick it up next round
+            if (state < 0)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            size_t len = format(r, cursor, line, sizeof(line));
+            Serial.write((const uint8_t *)line, len);
+            if (sd)
+                sd.write((const uint8_t *)line, len);
+        }
+
+        if (sd)
+            sd.close();
+        vTaskDelay(pdMS_TO_TICKS(TRACE_DRAIN_INTERVAL_MS));
+    }
+}
+
+// =========================================================
+// Microbenchmark
+// =========================================================
+void TraceLog::benchmark(JsonDocument *doc)
+{
+    // Kept small: the printf side blocks on the UART at 115200 baud
+    const uint16_t N = 32;
+
+    uint32_t start = ESP.getCycleCount();
+    for (uint16_t i = 0; i < N; i++)
+        log(TRACE_LEVEL_DEBUG, TRACE_BENCH, i, 0, 0);
+    uint32_t traceCycles = (ESP.getCycleCount() - start) / N;
+
+    Serial.flush();
+    start = ESP.getCycleCount();
+    for (uint16_t i = 0; i < N; i++)
+        Serial.printf("TraceLog: bench %d %d %d\n", i, 0, 0);
+    uint32_t printfCycles = (ESP.getCycleCount() - start) / N;
+
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    (*doc)["events"] = N;
+    (*doc)["trace_cycles"] = traceCycles;
+    (*doc)["trace_ns"] = traceCycles * 1000 / mhz;
+    (*doc)["printf_cycles"] = printfCycles;
+    (*doc)["printf_ns"] = printfCycles * 1000 / mhz;
+}
@@ -0,0 +1,143 @@
+#include "UdpControl.h"
+
+#define UDP_CONTROL_MAGIC 0x4346 // "FC"
+#define UDP_CONTROL_VERSION 1
+
+// =========================================================
+// Constructor / Setup
+// =========================================================
+UdpControl::UdpControl(RadioController *ctrl, ConfigStore *config)
+    : controller(ctrl), configStore(config), started(false), latency(nullptr), duplicates(nullptr), rejected(nullptr)
+{
+    for (uint8_t i = 0; i < UDP_CONTROL_MAX_CLIENTS; i++)
+        clients[i] = Client();
+}
+
+void UdpControl::begin(uint16_t port)
+{
+    latency = Metrics::histogram("udp_control_us");
+    duplicates = Metrics::counter("udp_control_duplicates_total");
+    rejected = Metrics::counter("udp_control_rejected_total");
+
+    udp.begin(port);
+    started.store(true, std::memory_order_release);
+    Serial.printf("UdpControl: Listening on UDP %u%s\n", port, configStore->get().controlToken ? " (token required)" : "");
+}
+
+// =========================================================
+// Request Handling
+// =========================================================
+void UdpControl::poll()
+{
+    if (!isStarted())
+        return;
+
+    int len;
+    while ((len = udp.parsePacket()) > 0)
+    {
+        Request req;
+        if (len != (int)sizeof(req) || udp.read((uint8_t *)&req, sizeof(req)) != (int)sizeof(req))
+            continue;
+        if (req.magic != UDP_CONTROL_MAGIC || req.version != UDP_CONTROL_VERSION)
+            continue;
+        handle(req, udp.remoteIP(), udp.remotePort());
+    }
+}
+
+void UdpControl::handle(const Request &req, IPAddress ip, uint16_t port)
+{
+    MetricTimer timer(latency);
+    Response resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.magic = UDP_CONTROL_MAGIC;
+    resp.version = UDP_CONTROL_VERSION;
+    resp.op = req.op;
+    resp.seq = req.seq;
+
+    uint32_t token = configStore->get().controlToken;
+    Client *client = nullptr;
+
+    if (token && req.token != token)
+    {
+        resp.status = UDP_STATUS_AUTH;
+    }
+    else if (req.op == OP_STATUS)
+    {
+        resp.status = UDP_STATUS_OK;
+    }
+    else
+    {
+        client = findClient(ip, port);
+        if (client->hasSeq && req.seq == client->lastSeq)
+        {
+            // Retransmission: same answer, no second tune/volume step
+            client->lastUsedMs = millis();
+            Metrics::inc(duplicates);
+            udp.beginPacket(ip, port);
+            udp.write((const uint8_t *)&client->lastResponse, sizeof(Response));
+            udp.endPacket();
+            return;
+        }
+        // Serial arithmetic so the counter may wrap
+        if (client->hasSeq && (int32_t)(req.seq - client->lastSeq) < 0)
+        {
+            resp.status = UDP_STATUS_STALE;
+            client = nullptr;
+        }
+        else
+        {
+            RadioCommand cmd = {(RadioCommandType)req.op, req.value};
+            bool known = req.op >= OP_TUNE && req.op <= OP_SEEK_NEXT;
+            resp.status = known && controller->apply(cmd, RADIO_SRC_UDP) ? UDP_STATUS_OK : UDP_STATUS_INVALID;
+        }
+    }
+
+    if (resp.status != UDP_STATUS_OK)
+        Metrics::inc(rejected);
+    fillState(resp);
+
+    if (client)
+    {
+        client->hasSeq = true;
+        client->lastSeq = req.seq;
+        client->lastUsedMs = millis();
+        client->lastResponse = resp;
+    }
+
+    udp.beginPacket(ip, port);
+    udp.write((const uint8_t *)&resp, sizeof(resp));
+    udp.endPacket();
+}
+
+void UdpControl::fillState(Response &resp)
+{
+    RadioState state = controller->getState();
+    int rssi = controller->getRadio()->getRssi();
+    resp.flags = state.powered ? 0x01 : 0;
+    resp.channelCode = state.channelCode;
+    resp.volume = state.volume;
+    resp.rssi = rssi < 0 ? 0 : (uint8_t)rssi;
+}
+
+UdpControl::Client *UdpControl::findClient(IPAddress ip, uint16_t port)
+{
+    Client *oldest = &clients[0];
+    for (uint8_t i = 0; i < UDP_CONTROL_MAX_CLIENTS; i++)
+    {
+        Client &c = clients[i];
+        if (c.port == port && c.ip == ip)
+            return &c;
+        if (!c.port)
+        {
+            oldest = &c;
+            break;
+        }
+        if (c.lastUsedMs < oldest->lastUsedMs)
+            oldest = &c;
+    }
+
+    *oldest = Client();
+    oldest->ip = ip;
+    oldest->port = port;
+    return oldest;
+}
@@ -0,0 +1,84 @@
+#include "UiFlash.h"
+#include "UiManifest.h"
+
+struct __attribute__((packed)) UiFlashHeader
+{
+    uint32_t magic;
+    uint32_t count;
+    uint32_t imageSize;
+    uint32_t reserved;
+};
+
+UiFlash::UiFlash() : base(nullptr), index(nullptr), count(0), handle(0)
+{
+}
+
+// =========================================================
+// Setup
+// =========================================================
+bool UiFlash::begin()
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           (esp_partition_subtype_t)UI_FLASH_SUBTYPE, UI_FLASH_PARTITION);
+    if (!part)
+    {
+        Serial.println("UiFlash: No " UI_FLASH_PARTITION " partition.");
+        return false;
+    }
+
+    const void *ptr = nullptr;
+    if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle) != ESP_OK)
+    {
+        Serial.println("UiFlash: mmap failed.");
+        return false;
+    }
+
+    // Validate before trusting any offset: an erased or half-written
+    // partition must not send the server reading outside the mapping
+    const UiFlashHeader *header = (const UiFlashHeader *)ptr;
+    bool valid = header->magic == UI_FLASH_MAGIC && header->imageSize <= part->size &&
+                 sizeof(UiFlashHeader) + (uint64_t)header->count * sizeof(Entry) <= header->imageSize;
+    const Entry *entries = (const Entry *)((const uint8_t *)ptr + sizeof(UiFlashHeader));
+    for (uint32_t i = 0; valid && i < header->count; i++)
+    {
+        valid = (uint64_t)entries[i].offset + entries[i].size <= header->imageSize &&
+                (i == 0 || entries[i - 1].hash < entries[i].hash);
+    }
+    if (!valid)
+    {
+        Serial.println("UiFlash: Partition holds no valid UI image.");
+        spi_flash_munmap(handle);
+        return false;
+    }
+
+    base = (const uint8_t *)ptr;
+    count = header->count;
+    index = entries;
+    Serial.printf("UiFlash: %lu files, %lu KB mapped from flash.\n", (unsigned long)count,
+                  (unsigned long)(header->imageSize / 1024));
+    return true;
+}
+
+// =========================================================
+// Lookup
+// =========================================================
+const UiFlash::Entry *UiFlash::find(const char *relPath) const
+{
+    if (!index)
+        return nullptr;
+
+    uint32_t hash = UiManifest::hashPath(relPath);
+    uint32_t lo = 0, hi = count;
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        uint32_t h = index[mid].hash;
+        if (h == hash)
+            return &index[mid];
+        if (h < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return nullptr;
+}
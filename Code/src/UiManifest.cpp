@@ -0,0 +1,186 @@
+#include "UiManifest.h"
+
+// Extension -> MIME, index 0 is the fallback
+static const char *const MIME_TYPES[][2] = {
+    {"", "application/octet-stream"},
+    {".html", "text/html"},
+    {".htm", "text/html"},
+    {".css", "text/css"},
+    {".js", "application/javascript"},
+    {".png", "image/png"},
+    {".jpg", "image/jpeg"},
+    {".jpeg", "image/jpeg"},
+    {".gif", "image/gif"},
+    {".svg", "image/svg+xml"},
+    {".ico", "image/x-icon"},
+    {".json", "application/json"},
+    {".txt", "text/plain"},
+    {".woff2", "font/woff2"},
+    {".mp3", "audio/mpeg"},
+    {".wav", "audio/wav"},
+};
+static const uint8_t MIME_COUNT = sizeof(MIME_TYPES) / sizeof(MIME_TYPES[0]);
+
+// =========================================================
+// Constructor
+// =========================================================
+UiManifest::UiManifest() : count(0), ready(false), buildUs(0), markerSize(0), markerMtime(0)
+{
+    memset(table, 0, sizeof(table));
+}
+
+void UiManifest::clear()
+{
+    memset(table, 0, sizeof(table));
+    count = 0;
+    ready = false;
+}
+
+// =========================================================
+// Helpers
+// =========================================================
+uint32_t UiManifest::hashPath(const char *relPath)
+{
+    // FNV-1a; 0 is reserved for empty slots
+    uint32_t h = 2166136261UL;
+    while (*relPath)
+    {
+        h ^= (uint8_t)*relPath++;
+        h *= 16777619UL;
+    }
+    return h ? h : 1;
+}
+
+uint8_t UiManifest::mimeIndex(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    if (!dot)
+        return 0;
+    for (uint8_t i = 1; i < MIME_COUNT; i++)
+    {
+        if (strcasecmp(dot, MIME_TYPES[i][0]) == 0)
+            return i;
+    }
+    return 0;
+}
+
+const char *UiManifest::mimeType(uint8_t index)
+{
+    return MIME_TYPES[index < MIME_COUNT ? index : 0][1];
+}
+
+UiManifest::Entry *UiManifest::slotFor(uint32_t hash)
+{
+    // Linear probing; stops at the entry or the first empty slot
+    uint32_t i = hash & (UI_MANIFEST_SLOTS - 1);
+    for (uint16_t n = 0; n < UI_MANIFEST_SLOTS; n++)
+    {
+        Entry &e = table[i];
+        if (e.hash == hash || e.hash == 0)
+            return &e;
+        i = (i + 1) & (UI_MANIFEST_SLOTS - 1);
+    }
+    return nullptr;
+}
+
+const UiManifest::Entry *UiManifest::find(const char *relPath) const
+{
+    if (!ready)
+        return nullptr;
+    Entry *e = const_cast<UiManifest *>(this)->slotFor(hashPath(relPath));
+    return e && e->hash ? e : nullptr;
+}
+
+// =========================================================
+// Build
+// =========================================================
+void UiManifest::add(const char *relPath, uint32_t size, uint32_t mtime)
+{
+    size_t len = strlen(relPath);
+    bool gz = len > 3 && strcmp(relPath + len - 3, ".gz") == 0;
+
+    char base[128];
+    if (gz)
+    {
+        // Attach "/app.js.gz" to the "/app.js" entry
+        if (len - 3 >= sizeof(base))
+            return;
+        memcpy(base, relPath, len - 3);
+        base[len - 3] = '\0';
+        relPath = base;
+    }
+
+    uint32_t hash = hashPath(relPath);
+    Entry *e = slotFor(hash);
+    if (!e)
+        return;
+
+    if (e->hash == 0)
+    {
+        if (count >= UI_MANIFEST_SLOTS * 3 / 4)
+            return;
+        e->hash = hash;
+        e->mime = mimeIndex(relPath);
+        e->flags = gz ? GZIP_ONLY : 0;
+        count++;
+    }
+
+    if (gz)
+    {
+        e->flags |= HAS_GZIP;
+        e->gzSize = size;
+        if (e->flags & GZIP_ONLY)
+            e->mtime = mtime;
+    }
+    else
+    {
+        e->flags &= ~GZIP_ONLY;
+        e->size = size;
+        e->mtime = mtime;
+    }
+}
+
+void UiManifest::walk(File dir, size_t rootLen, uint8_t depth, uint32_t &sdOps)
+{
+    File entry = dir.openNextFile();
+    while (entry)
+    {
+        sdOps++;
+        const char *path = entry.path();
+        if (entry.isDirectory())
+        {
+            if (depth < UI_MANIFEST_MAX_DEPTH)
+                walk(entry, rootLen, depth + 1, sdOps);
+        }
+        else if (strlen(path) > rootLen)
+        {
+            add(path + rootLen, entry.size(), (uint32_t)entry.getLastWrite());
+        }
+        entry.close();
+        entry = dir.openNextFile();
+    }
+}
+
+size_t UiManifest::build(File root, const char *rootPath, uint32_t &sdOps)
+{
+    uint32_t start = micros();
+    clear();
+    if (!root || !root.isDirectory())
+        return 0;
+
+    walk(root, strlen(rootPath), 0, sdOps);
+    buildUs = micros() - start;
+    ready = true;
+    return count;
+}
+
+void UiManifest::setMarker(uint32_t size, uint32_t mtime)
+{
+    markerSize = size;
+    markerMtime = mtime;
+}
+
+bool UiManifest::markerChanged(uint32_t size, uint32_t mtime) const
+{
+    return size != markerSize || mtime != markerMtime;
+}
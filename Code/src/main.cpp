@@ -11,16 +11,48 @@
 #include "FMRadio.h"
 #include "AppWebServer.h"
 #include "ConnectivityManager.h"
+#include "ConfigStore.h"
+#include "BootProfiler.h"
+#include "BootSequencer.h"
+#include "TraceLog.h"
+#include "OtaManager.h"
+#include "RadioController.h"
+#include "GroupSync.h"
+#include "UdpControl.h"
+#include "UiFlash.h"
+#include "HangDetector.h"
+#include "ScheduleEngine.h"
+#include "SpectrumStream.h"
+#include "AudioRingBuffer.h"
+#include "I2SAudioOutput.h"
+#include "BluetoothSink.h"
+#include "InputSourceManager.h"
+#include "ListeningLog.h"
+#include "Capture.h"
 
 // =========================================================
 // Khai báo các Đối tượng Toàn cục (Global Managers)
 // =========================================================
 
 FileManager fileManager;
+ConfigStore configStore(&fileManager);
 PowerManager powerManager;
-FMRadio fmRadio(&fileManager);
-ConnectivityManager connectivityManager(&fileManager);
-AppWebServer appWebServer(&fmRadio, &powerManager, &fileManager, &connectivityManager);
+FMRadio fmRadio(&fileManager, &configStore);
+ConnectivityManager connectivityManager(&fileManager, &configStore);
+OtaManager otaManager(&fileManager, &configStore);
+RadioController radioController(&fmRadio);
+GroupSync groupSync(&radioController, &configStore);
+UdpControl udpControl(&radioController, &configStore);
+UiFlash uiFlash;
+ScheduleEngine scheduleEngine(&radioController, &powerManager, &configStore, &fileManager);
+SpectrumStream spectrumStream;
+AudioRingBuffer audioRing;
+I2SAudioOutput audioOutput(&audioRing);
+BluetoothSink bluetoothSink(&audioRing, &audioOutput);
+InputSourceManager inputSources(&radioController, &powerManager, &configStore, &bluetoothSink);
+ListeningLog listeningLog(&fmRadio, &inputSources, &bluetoothSink, &configStore, &fileManager);
+AppWebServer appWebServer(&radioController, &powerManager, &fileManager, &connectivityManager, &configStore, &otaManager, &groupSync, &uiFlash, &scheduleEngine, &spectrumStream, &inputSources, &listeningLog);
+BootSequencer boot;
 
 // =========================================================
 // Setup() - Khởi tạo Hệ thống
@@ -28,45 +60,114 @@ AppWebServer appWebServer(&fmRadio, &powerManager, &fileManager, &connectivityMa
 
 void setup()
 {
+    int phase = BootProfiler::start("serial");
     Serial.begin(115200);
-    delay(100);
     Serial.println("\n--- Bắt đầu Hệ thống Famio FM Radio ESP32 ---");
+    // Log sự kiện được định dạng và in ra ở task nền, không chặn nơi gọi
+    TraceLog::begin(&fileManager);
+    // Ghi/phát lại trace theo yêu cầu (/api/system/capture), không làm gì khi chưa bật
+    Capture::begin(&fileManager);
+    // Watchdog + breadcrumb trong RTC: báo lại nơi bị treo ở lần boot trước
+    HangDetector::begin();
+    BootProfiler::end(phase);
 
-    // Khởi tạo PowerManager và SD Card trước
-    powerManager.begin();
-    SPI.begin(SPI_SCK_PIN, SPI_MISO_PIN, SPI_MOSI_PIN, SD_CS_PIN);
-    if (!fileManager.begin())
-    {
-        Serial.println("Lỗi nghiêm trọng: Không thể khởi tạo SD Card.");
-        return;
-    }
+    // Đồ thị khởi tạo: mỗi bước chạy trong task riêng ngay khi các bước
+    // phụ thuộc đã xong, nên SD, I2C, Wi-Fi và mDNS chồng lên nhau.
+    uint32_t power = boot.add("power", []()
+                              { powerManager.begin(); });
 
-    // 1. TẢI CẤU HÌNH (Sử dụng JsonDocument, phù hợp với v7)
-    JsonDocument commonConfig;
+    uint32_t sd = boot.add("sd", []()
+                           {
+        SPI.begin(SPI_SCK_PIN, SPI_MISO_PIN, SPI_MOSI_PIN, SD_CS_PIN);
+        if (!fileManager.begin())
+        {
+            // Vẫn chạy tiếp: cấu hình có trong NVS, API vẫn phục vụ được
+            Serial.println("Lỗi nghiêm trọng: Không thể khởi tạo SD Card.");
+        } });
 
-    // Đường dẫn được lấy từ Constants.h (PROJECT_ROOT_DIR)
-    if (!fileManager.loadJsonFile(CONFIG_FILE_PATH COMMON_CONFIG_FILE, &commonConfig))
-    {
-        Serial.println("Không tải được /config/common.json. Sử dụng cấu hình mặc định.");
-    }
+    // UI đóng gói trong flash: chỉ map partition, có sẵn kể cả khi không có thẻ SD
+    uint32_t ui = boot.add("uiflash", []()
+                           {
+        if (!uiFlash.begin())
+            Serial.println("SETUP: Không có UI trong flash, chỉ phục vụ /ui từ SD."); });
 
-    int initialVolume = commonConfig["volume"] | 50;
-    float initialFreq = commonConfig["freq"] | 99.5f;
+    uint32_t i2c = boot.add("i2c", []()
+                            {
+        Wire.begin();
+        // HOẶC: Wire.begin(SDA_PIN, SCL_PIN); nếu bạn dùng chân tùy chỉnh
+        Serial.println("SETUP: Khởi tạo I2C Bus thành công."); });
 
-    // QUẢN LÝ KẾT NỐI WI-FI
-    if (!connectivityManager.begin())
-    {
-        // Nếu kết nối/cấu hình thất bại, khởi động lại để thử lại
-        Serial.println("Hệ thống không thể kết nối");
-        while (1)
-            ;
-    }
+    // 1. TẢI CẤU HÌNH: snapshot NVS không cần SD, chỉ chờ SD khi phải import JSON
+    uint32_t config = boot.add("config", [sd]()
+                      {
+        if (configStore.loadSnapshot())
+        {
+            Serial.println("ConfigStore: Config ready from NVS snapshot.");
+            return;
+        }
+        boot.waitFor(sd);
+        configStore.begin(); });
+
+    // QUẢN LÝ KẾT NỐI WI-FI: bắt đầu kết nối, không chờ
+    uint32_t wifiStart = boot.add("wifi_start", []()
+                                  { connectivityManager.startAssociation(); }, config);
+
+    // Đọc danh sách đài từ SD trước khi bật tuner
+    uint32_t tuner = boot.add("tuner", []()
+                              { fmRadio.prepare(); }, config | sd | i2c);
+
+    // Báo thức/hẹn giờ tắt: trạng thái trong RTC còn nguyên sau deep sleep
+    boot.add("schedule", []()
+             { scheduleEngine.begin(); }, config | tuner | power);
+
+    // Nguồn vào FM/Bluetooth: chỉ nguồn đã chọn được cấp nguồn (stack BT bật ở nền)
+    uint32_t input = boot.add("input", []()
+                              {
+        bluetoothSink.begin();
+        inputSources.begin(); }, config | tuner | power);
+
+    // Lịch sử nghe: nạp bảng tổng hợp, chỉ đọc lại phần log ghi sau nó.
+    // Trước deep sleep ghi nốt phiên đang nghe xuống SD.
+    boot.add("listening", []()
+             {
+        listeningLog.begin();
+        powerManager.setShutdownHook([]()
+                                     { listeningLog.shutdown(); }); }, sd | input);
+
+    // KHỞI TẠO WEB SERVER: chỉ cần network stack đã sẵn sàng
+    uint32_t http = boot.add("http", []()
+                             { appWebServer.begin(); }, wifiStart | ui);
+
+    // Cổng upload OTA (task riêng trên core 0)
+    boot.add("ota", []()
+             { otaManager.begin(); }, wifiStart | sd);
+
+    // Nhóm đa phòng: mở cổng UDP, tìm thiết bị khác qua mDNS
+    boot.add("group", []()
+             { groupSync.begin(); }, wifiStart | config);
 
-    // KHỞI TẠO WEB SERVER
-    appWebServer.begin();
-    Wire.begin();
-    // HOẶC: Wire.begin(SDA_PIN, SCL_PIN); nếu bạn dùng chân tùy chỉnh
-    Serial.println("SETUP: Khởi tạo I2C Bus thành công.");
+    // Điều khiển nhị phân qua UDP cho remote/núm xoay
+    boot.add("udp_control", []()
+             { udpControl.begin(); }, wifiStart | config);
+
+    // Phổ âm thanh/VU: I2S0 đọc ADC, chỉ lấy mẫu khi có client WebSocket
+    boot.add("spectrum", []()
+             { spectrumStream.begin(); }, wifiStart);
+
+    uint32_t wifiAssoc = boot.add("wifi_assoc", []()
+                                  { connectivityManager.waitForAssociation(); }, wifiStart);
+
+    boot.add("mdns", []()
+             { connectivityManager.startMdns(); }, wifiAssoc);
+
+    // Giờ thật cho báo thức (sau deep sleep RTC vẫn giữ giờ, NTP chỉ hiệu chỉnh)
+    boot.add("ntp", []()
+             { configTime(0, 0, NTP_SERVER); }, wifiAssoc);
+
+    boot.start();
+
+    // loop() bắt đầu phục vụ HTTP ngay; Wi-Fi/mDNS/tuner tiếp tục ở nền
+    boot.waitFor(http | power);
 }
 
 // =========================================================
@@ -75,6 +176,29 @@ void setup()
 
 void loop()
 {
+    // Mỗi bước có ngân sách thời gian riêng (xem HANG_SITES)
+    HangGuard guard(HANG_LOOP);
     appWebServer.handleClient();
+    {
+        HangGuard step(HANG_FM_POLL);
+        fmRadio.poll();
+    }
+    {
+        HangGuard step(HANG_GROUP_POLL);
+        groupSync.poll();
+    }
+    {
+        HangGuard step(HANG_UDP_POLL);
+        udpControl.poll();
+    }
+    {
+        HangGuard step(HANG_SPECTRUM_POLL);
+        spectrumStream.poll();
+    }
+    inputSources.poll();
+    listeningLog.poll();
+    Capture::poll();
+    scheduleEngine.poll();
+    connectivityManager.poll();
     delay(10);
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// =========================================================
+// Host stand-in for the Arduino core (env:native only)
+// =========================================================
+// Just enough of the API for the hardware-free modules under test.
+// Time is virtual: millis()/micros() only move through delay(),
+// delayMicroseconds() or HostClock::advanceUs(), so tests are exact.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+
+namespace HostClock
+{
+    inline uint64_t nowUs = 0;
+    inline void advanceUs(uint64_t us) { nowUs += us; }
+    inline void advanceMs(uint64_t ms) { nowUs += ms * 1000; }
+}
+
+inline uint32_t millis() { return (uint32_t)(HostClock::nowUs / 1000); }
+inline uint32_t micros() { return (uint32_t)HostClock::nowUs; }
+inline void delay(uint32_t ms) { HostClock::advanceMs(ms); }
+inline void delayMicroseconds(uint32_t us) { HostClock::advanceUs(us); }
+inline void yield() {}
+
+template <typename T>
+inline T constrain(T x, T low, T high) { return x < low ? low : (x > high ? high : x); }
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+// FreeRTOS critical sections: tests drive shared state from one thread
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+// FreeRTOS tasks are not started: tests call the polled paths themselves
+typedef void (*TaskFunction_t)(void *);
+typedef void *TaskHandle_t;
+typedef uint32_t TickType_t;
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+inline int xTaskCreate(TaskFunction_t, const char *, uint32_t, void *, unsigned, TaskHandle_t *) { return pdPASS; }
+inline int xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, unsigned, TaskHandle_t *, int)
+{
+    return pdPASS;
+}
+inline void vTaskDelay(TickType_t ticks) { HostClock::advanceMs(ticks); }
+inline void enableLoopWDT() {}
+
+// Chip info; the cycle counter runs at 240 MHz of virtual time
+class EspClass
+{
+public:
+    void restart()
+    {
+        fprintf(stderr, "ESP.restart() called\n");
+        abort();
+    }
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMinFreeHeap() { return 150000; }
+    uint32_t getMaxAllocHeap() { return 100000; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount() { return (uint32_t)(HostClock::nowUs * 240); }
+    uint64_t getEfuseMac() { return 0x8C2CB06BA124ULL; }
+};
+
+inline EspClass ESP;
+
+class String
+{
+public:
+    String(const char *s = "") : str(s ? s : "") {}
+    String(const std::string &s) : str(s) {}
+    String(int v) : str(std::to_string(v)) {}
+    String(unsigned v) : str(std::to_string(v)) {}
+    String(long v) : str(std::to_string(v)) {}
+    String(unsigned long v) : str(std::to_string(v)) {}
+    const char *c_str() const { return str.c_str(); }
+    unsigned length() const { return str.size(); }
+    bool concat(const char *s) { str += s; return true; }
+    bool concat(char c) { str += c; return true; }
+    bool reserve(unsigned n) { str.reserve(n); return true; }
+    long toInt() const { return atol(str.c_str()); }
+    float toFloat() const { return (float)atof(str.c_str()); }
+    int indexOf(const char *s) const
+    {
+        size_t p = str.find(s);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    String substring(unsigned from, unsigned to = ~0u) const
+    {
+        return String(str.substr(from, to == ~0u ? std::string::npos : to - from));
+    }
+    char operator[](unsigned i) const { return str[i]; }
+    String &operator+=(const String &s) { str += s.str; return *this; }
+    String &operator+=(const char *s) { str += s; return *this; }
+    String &operator+=(char c) { str += c; return *this; }
+    bool operator==(const String &s) const { return str == s.str; }
+    bool operator==(const char *s) const { return str == s; }
+    bool operator!=(const char *s) const { return str != s; }
+
+private:
+    std::string str;
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *data, size_t len)
+    {
+        size_t n = 0;
+        while (len-- && write(*data++))
+            n++;
+        return n;
+    }
+    size_t write(const char *s, size_t len) { return write((const uint8_t *)s, len); }
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t println(const char *s = "") { return print(s) + print("\n"); }
+    size_t println(const String &s) { return println(s.c_str()); }
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        return write((const uint8_t *)buf, n < 0 ? 0 : (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+    }
+    virtual void flush() {}
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(char *buf, size_t len)
+    {
+        size_t n = 0;
+        int c;
+        while (n < len && (c = read()) >= 0)
+            buf[n++] = (char)c;
+        return n;
+    }
+    size_t readBytes(uint8_t *buf, size_t len) { return readBytes((char *)buf, len); }
+};
+
+// Log output goes to stdout; HOST_QUIET=1 in the environment silences it
+class HardwareSerial : public Stream
+{
+public:
+    using Print::write;
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *data, size_t len) override
+    {
+        static const bool quiet = getenv("HOST_QUIET") != nullptr;
+        if (!quiet)
+            fwrite(data, 1, len, stdout);
+        return len;
+    }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    operator bool() const { return true; }
+};
+
+inline HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,18 @@
+#ifndef HOST_ESPMDNS_H
+#define HOST_ESPMDNS_H
+
+#include "IPAddress.h"
+
+// No multicast on the host: queries find nothing, peers are added statically
+class MDNSResponder
+{
+public:
+    bool begin(const char *) { return true; }
+    void addService(const char *, const char *, uint16_t) {}
+    int queryService(const char *, const char *) { return 0; }
+    IPAddress IP(int) { return IPAddress(); }
+};
+
+inline MDNSResponder MDNS;
+
+#endif // HOST_ESPMDNS_H
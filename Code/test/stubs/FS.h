@@ -0,0 +1,189 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include "Arduino.h"
+#include <dirent.h>
+#include <memory>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+// =========================================================
+// Files on a host directory (env:native only)
+// =========================================================
+// Paths are card paths ("/famio/..."); HostFs::root is the directory
+// that stands in for the card. Handles share one open file as on the
+// ESP32 core: copies refer to the same file, close() closes it for all.
+namespace HostFs
+{
+    inline std::string root = "/tmp/famio-native-sd";
+    inline std::string path(const char *cardPath) { return root + cardPath; }
+}
+
+class File : public Stream
+{
+public:
+    using Print::write;
+
+    File() {}
+    File(const char *cardPath, const char *mode)
+    {
+        std::string host = HostFs::path(cardPath);
+        struct stat st;
+        bool isDir = stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+        if (isDir && mode[0] == 'r')
+        {
+            DIR *dir = opendir(host.c_str());
+            if (dir)
+                impl = std::make_shared<Impl>(cardPath, nullptr, dir);
+            return;
+        }
+        const char *hostMode = mode[0] == 'w' ? "wb" : mode[0] == 'a' ? "ab" : mode[1] == '+' ? "r+b" : "rb";
+        FILE *fp = isDir ? nullptr : fopen(host.c_str(), hostMode);
+        if (fp)
+            impl = std::make_shared<Impl>(cardPath, fp, nullptr);
+    }
+
+    explicit operator bool() const { return impl && (impl->fp || impl->dir); }
+    void close()
+    {
+        if (impl)
+            impl->close();
+        impl.reset();
+    }
+
+    size_t size() const
+    {
+        if (!impl || !impl->fp)
+            return 0;
+        fflush(impl->fp);
+        struct stat st;
+        return fstat(fileno(impl->fp), &st) == 0 ? (size_t)st.st_size : 0;
+    }
+    size_t position() const { return impl && impl->fp ? (size_t)ftell(impl->fp) : 0; }
+    bool seek(uint32_t pos, SeekMode mode = SeekSet)
+    {
+        return impl && impl->fp && fseek(impl->fp, (long)pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+    }
+
+    size_t read(uint8_t *buf, size_t len) { return impl && impl->fp ? fread(buf, 1, len, impl->fp) : 0; }
+    int read() override
+    {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int peek() override
+    {
+        int c = read();
+        if (c >= 0)
+            fseek(impl->fp, -1, SEEK_CUR);
+        return c;
+    }
+    int available() override
+    {
+        if (!impl || !impl->fp)
+            return 0;
+        long here = ftell(impl->fp);
+        fseek(impl->fp, 0, SEEK_END);
+        long end = ftell(impl->fp);
+        fseek(impl->fp, here, SEEK_SET);
+        return (int)(end - here);
+    }
+    size_t write(const uint8_t *data, size_t len) override { return impl && impl->fp ? fwrite(data, 1, len, impl->fp) : 0; }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    void flush() override
+    {
+        if (impl && impl->fp)
+            fflush(impl->fp);
+    }
+
+    bool isDirectory() const { return impl && impl->dir; }
+    File openNextFile(const char *mode = FILE_READ)
+    {
+        if (!isDirectory())
+            return File();
+        while (struct dirent *e = readdir(impl->dir))
+        {
+            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+                continue;
+            std::string child = impl->cardPath + "/" + e->d_name;
+            return File(child.c_str(), mode);
+        }
+        return File();
+    }
+    void rewindDirectory()
+    {
+        if (isDirectory())
+            rewinddir(impl->dir);
+    }
+
+    const char *path() const { return impl ? impl->cardPath.c_str() : ""; }
+    const char *name() const
+    {
+        const char *p = path();
+        const char *slash = strrchr(p, '/');
+        return slash ? slash + 1 : p;
+    }
+    time_t getLastWrite()
+    {
+        struct stat st;
+        return impl && stat(HostFs::path(impl->cardPath.c_str()).c_str(), &st) == 0 ? st.st_mtime : 0;
+    }
+
+private:
+    struct Impl
+    {
+        std::string cardPath;
+        FILE *fp;
+        DIR *dir;
+        Impl(const char *p, FILE *f, DIR *d) : cardPath(p), fp(f), dir(d) {}
+        ~Impl() { close(); }
+        void close()
+        {
+            if (fp)
+                fclose(fp);
+            if (dir)
+                closedir(dir);
+            fp = nullptr;
+            dir = nullptr;
+        }
+    };
+    std::shared_ptr<Impl> impl;
+};
+
+namespace fs
+{
+    class FS
+    {
+    public:
+        File open(const char *path, const char *mode = FILE_READ, bool = false) { return File(path, mode); }
+        File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+        bool exists(const char *path)
+        {
+            struct stat st;
+            return stat(HostFs::path(path).c_str(), &st) == 0;
+        }
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool remove(const char *path) { return unlink(HostFs::path(path).c_str()) == 0; }
+        bool rename(const char *from, const char *to)
+        {
+            return ::rename(HostFs::path(from).c_str(), HostFs::path(to).c_str()) == 0;
+        }
+        bool mkdir(const char *path) { return ::mkdir(HostFs::path(path).c_str(), 0755) == 0; }
+        bool rmdir(const char *path) { return ::rmdir(HostFs::path(path).c_str()) == 0; }
+    };
+}
+using fs::FS;
+
+#endif // HOST_FS_H
@@ -0,0 +1,296 @@
+#ifndef HOST_RDA5807_H
+#define HOST_RDA5807_H
+
+#include "Wire.h"
+#include <vector>
+
+// =========================================================
+// Simulated RDA5807 on the host I2C bus (env:native only)
+// =========================================================
+// Register-level model of what FMRadio and FastTuner rely on:
+// - 0x10 reads 0x0A.. sequentially, writes 0x02.. sequentially; 0x11 is
+//   random access (register byte, then words).
+// - TUNE in 0x03 sets STC after a random 10-40 ms; RSSI then settles on
+//   the station's level with a 3 ms time constant.
+// - SEEK in 0x02 steps one channel per seekStepUs to the next station at
+//   or above seekRssi, wrapping at the band edges.
+// - Stations with RDS send 0A (PS) and 2A (RadioText) groups every
+//   ~88 ms once tuned; RDSR flags a group not read yet.
+// Time is HostClock, so results are exact and repeatable for a seed.
+class HostRda5807 : public HostI2cDevice
+{
+public:
+    struct Station
+    {
+        uint16_t code; // 10 kHz units
+        uint8_t rssi;  // 0-63
+        bool stereo;
+        uint16_t pi;   // 0 = no RDS
+        uint8_t pty;
+        const char *ps; // 8 characters
+        const char *rt;
+    };
+
+    uint32_t stcMinUs = 10000;
+    uint32_t stcMaxUs = 40000;
+    float rssiTauUs = 3000;
+    uint32_t seekStepUs = 8000;
+    uint8_t seekRssi = 25;
+    uint8_t noiseRssi = 8;
+    uint32_t groupUs = 87600;
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+
+    explicit HostRda5807(uint32_t seed = 1) : rng(seed ? seed : 1)
+    {
+        memset(regs, 0, sizeof(regs));
+        regs[0x00] = 0x5804; // Chip id
+    }
+
+    void addStation(const Station &s) { stations.push_back(s); }
+
+    // What the chip is doing right now
+    uint16_t reg(uint8_t r)
+    {
+        update();
+        return r >= 0x0A && r <= 0x0F ? status(r) : regs[r & 0x0F];
+    }
+    bool enabled() const { return regs[0x02] & 0x0001; }
+    bool muted() const { return !(regs[0x02] & 0x4000); }
+    bool mono() const { return regs[0x02] & 0x2000; }
+    bool rdsEnabled() const { return regs[0x02] & 0x0008; }
+    uint8_t gpio() const { return regs[0x04] & 0x3F; }
+    uint8_t volume() const { return regs[0x05] & 0x0F; }
+    uint16_t channelCode() const { return codeOf(chan); }
+
+    bool i2cWrite(uint8_t address, const uint8_t *data, size_t len) override
+    {
+        if (address == 0x11)
+        {
+            if (!len)
+                return true;
+            pointer = data[0];
+            writeWords(pointer, data + 1, len - 1);
+            return true;
+        }
+        if (address == 0x10)
+        {
+            writeWords(0x02, data, len);
+            return true;
+        }
+        return false;
+    }
+
+    size_t i2cRead(uint8_t address, uint8_t *data, size_t len) override
+    {
+        if (address != 0x10 && address != 0x11)
+            return 0;
+        uint8_t r = address == 0x10 ? 0x0A : pointer;
+        update();
+        bool rdsRead = false;
+        for (size_t i = 0; i + 1 < len; i += 2, r++)
+        {
+            uint16_t v = status(r);
+            data[i] = v >> 8;
+            data[i + 1] = v & 0xFF;
+            rdsRead |= r == 0x0D;
+        }
+        // Blocks read: the group is no longer new
+        if (rdsRead && rdsIndex >= 0)
+            groupRead = rdsIndex;
+        reads++;
+        return len & ~(size_t)1;
+    }
+
+private:
+    std::vector<Station> stations;
+    uint16_t regs[16];
+    uint8_t pointer = 0x0A;
+    uint32_t rng;
+
+    uint16_t chan = 0;           // READCHAN
+    bool tuning = false;
+    bool seeking = false;
+    bool seekFailed = false;
+    uint64_t stcAtUs = 0;        // Tune/seek completes; RSSI settles from here
+    uint8_t settleFrom = 0;
+    int64_t rdsIndex = -1;       // Newest group sent, -1 = none yet
+    int64_t groupRead = -1;
+
+    uint32_t random(uint32_t lo, uint32_t hi)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return lo + rng % (hi - lo + 1);
+    }
+
+    uint8_t band() const { return (regs[0x03] >> 2) & 0x03; }
+    uint16_t bandStart() const { return band() == 0 ? 8700 : band() == 3 ? 6500 : 7600; }
+    // CHAN counts 100/200/50/25 kHz steps; 10 kHz codes round down
+    uint16_t spacingKHz() const
+    {
+        static const uint16_t steps[4] = {100, 200, 50, 25};
+        return steps[regs[0x03] & 0x03];
+    }
+    uint16_t bandEnd() const { return band() == 1 ? 9100 : band() == 3 ? 7600 : 10800; }
+    uint16_t codeOf(uint16_t c) const { return bandStart() + (uint16_t)((uint32_t)c * spacingKHz() / 10); }
+
+    const Station *stationAt(uint16_t code) const
+    {
+        for (const Station &s : stations)
+            if (s.code == code)
+                return &s;
+        return nullptr;
+    }
+
+    void writeWords(uint8_t r, const uint8_t *data, size_t len)
+    {
+        for (size_t i = 0; i + 1 < len; i += 2, r++)
+            writeRegister(r & 0x0F, (uint16_t)(data[i] << 8) | data[i + 1]);
+    }
+
+    void writeRegister(uint8_t r, uint16_t v)
+    {
+        writes++;
+        update();
+        uint16_t old = regs[r];
+        regs[r] = v;
+        if (!enabled())
+            return;
+        if (r == 0x03 && (v & 0x0010))
+        {
+            chan = v >> 6;
+            startSettling(random(stcMinUs, stcMaxUs));
+            tuning = true;
+        }
+        else if (r == 0x02 && (v & 0x0100) && !(old & 0x0100))
+        {
+            // Seek: find the next station now, complete after the steps it takes
+            bool up = v & 0x0200;
+            bool wrap = !(v & 0x0080);
+            uint16_t steps = 0;
+            uint16_t c = chan;
+            uint16_t last = (uint16_t)((uint32_t)(bandEnd() - bandStart()) * 10 / spacingKHz());
+            seekFailed = true;
+            for (uint16_t i = 0; i <= last; i++)
+            {
+                steps++;
+                if (up)
+                    c = c >= last ? (wrap ? 0 : c) : c + 1;
+                else
+                    c = c == 0 ? (wrap ? last : c) : c - 1;
+                const Station *s = stationAt(codeOf(c));
+                if (s && s->rssi >= seekRssi)
+                {
+                    seekFailed = false;
+                    break;
+                }
+            }
+            chan = c;
+            startSettling((uint32_t)steps * seekStepUs);
+            seeking = true;
+        }
+    }
+
+    void startSettling(uint32_t afterUs)
+    {
+        stcAtUs = HostClock::nowUs + afterUs;
+        settleFrom = (uint8_t)random(0, 10);
+        rdsIndex = groupRead = -1;
+    }
+
+    // Tune/seek completion happens in the background
+    void update()
+    {
+        if ((tuning || seeking) && HostClock::nowUs >= stcAtUs)
+        {
+            tuning = false;
+            if (seeking)
+            {
+                seeking = false;
+                regs[0x02] &= ~0x0100;
+            }
+        }
+        const Station *s = stationAt(channelCode());
+        if (!tuning && !seeking && enabled() && (regs[0x02] & 0x0008) && s && s->pi)
+        {
+            // First group one period after the tune completes
+            int64_t n = (int64_t)((HostClock::nowUs - stcAtUs) / groupUs) - 1;
+            rdsIndex = n;
+        }
+    }
+
+    uint8_t rssiNow() const
+    {
+        if (tuning || seeking || !enabled())
+            return noiseRssi;
+        const Station *s = stationAt(channelCode());
+        float target = s ? s->rssi : noiseRssi;
+        float t = (float)(HostClock::nowUs - stcAtUs);
+        float v = target + (settleFrom - target) * expf(-t / rssiTauUs);
+        return (uint8_t)lroundf(v);
+    }
+
+    uint16_t status(uint8_t r)
+    {
+        const Station *s = stationAt(channelCode());
+        bool done = enabled() && !tuning && !seeking;
+        if (r == 0x0A)
+        {
+            uint16_t v = chan & 0x03FF;
+            if (done)
+                v |= 0x4000; // STC
+            if (done && seekFailed)
+                v |= 0x2000; // SF
+            if (rdsIndex > groupRead)
+                v |= 0x8000 | 0x1000; // RDSR, RDSS
+            if (done && s && s->stereo && !(regs[0x02] & 0x2000))
+                v |= 0x0400; // ST
+            return v;
+        }
+        if (r == 0x0B)
+            return (uint16_t)(rssiNow() << 9) | (done && s ? 0x0180 : 0);
+        if (r >= 0x0C && r <= 0x0F)
+        {
+            uint16_t blocks[4] = {0, 0, 0, 0};
+            if (rdsIndex >= 0)
+                group(*s, (uint32_t)rdsIndex, blocks);
+            return blocks[r - 0x0C];
+        }
+        return regs[r & 0x0F];
+    }
+
+    // Group n of the station's cycle: PS segments with a RadioText
+    // segment after every second one
+    static void group(const Station &s, uint32_t n, uint16_t blocks[4])
+    {
+        char rt[64];
+        memset(rt, ' ', sizeof(rt));
+        size_t rtLen = strlen(s.rt);
+        memcpy(rt, s.rt, rtLen < 64 ? rtLen : 64);
+        if (rtLen < 64)
+            rt[rtLen++] = '\r';
+        uint8_t rtSegments = (rtLen + 3) / 4;
+
+        blocks[0] = s.pi;
+        uint16_t common = (uint16_t)(s.pty & 0x1F) << 5;
+        uint32_t cycle = n / 3;
+        if (n % 3 < 2)
+        {
+            uint8_t seg = (cycle * 2 + n % 3) & 0x03;
+            blocks[1] = 0x0000 | common | seg;
+            blocks[2] = 0xE0CD;
+            blocks[3] = (uint16_t)(s.ps[seg * 2] << 8) | (uint8_t)s.ps[seg * 2 + 1];
+        }
+        else
+        {
+            uint8_t seg = cycle % rtSegments;
+            blocks[1] = 0x2000 | common | seg;
+            blocks[2] = (uint16_t)(rt[seg * 4] << 8) | (uint8_t)rt[seg * 4 + 1];
+            blocks[3] = (uint16_t)(rt[seg * 4 + 2] << 8) | (uint8_t)rt[seg * 4 + 3];
+        }
+    }
+};
+
+#endif // HOST_RDA5807_H
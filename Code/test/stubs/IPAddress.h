@@ -0,0 +1,28 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include "Arduino.h"
+
+// IPv4 address, a.b.c.d kept as a host-order word
+class IPAddress
+{
+public:
+    IPAddress() : addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr((uint32_t)a << 24 | b << 16 | c << 8 | d) {}
+    explicit IPAddress(uint32_t address) : addr(address) {}
+
+    operator uint32_t() const { return addr; }
+    bool operator==(const IPAddress &o) const { return addr == o.addr; }
+    bool operator!=(const IPAddress &o) const { return addr != o.addr; }
+    String toString() const
+    {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", addr >> 24, (addr >> 16) & 0xFF, (addr >> 8) & 0xFF, addr & 0xFF);
+        return String(text);
+    }
+
+private:
+    uint32_t addr;
+};
+
+#endif // HOST_IPADDRESS_H
@@ -0,0 +1,63 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include "Arduino.h"
+#include <map>
+#include <vector>
+
+// =========================================================
+// NVS in RAM (env:native only)
+// =========================================================
+// Namespaces survive across Preferences objects for the whole process, as
+// flash would across reboots; HostNvs::erase() is a fresh chip.
+namespace HostNvs
+{
+    inline std::map<std::string, std::vector<uint8_t>> entries;
+    inline void erase() { entries.clear(); }
+}
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false)
+    {
+        space = name;
+        this->readOnly = readOnly;
+        open = true;
+        return true;
+    }
+    void end() { open = false; }
+
+    size_t putBytes(const char *key, const void *value, size_t len)
+    {
+        if (!open || readOnly)
+            return 0;
+        const uint8_t *p = (const uint8_t *)value;
+        HostNvs::entries[keyFor(key)].assign(p, p + len);
+        return len;
+    }
+    size_t getBytesLength(const char *key)
+    {
+        auto it = HostNvs::entries.find(keyFor(key));
+        return open && it != HostNvs::entries.end() ? it->second.size() : 0;
+    }
+    size_t getBytes(const char *key, void *buf, size_t maxLen)
+    {
+        auto it = HostNvs::entries.find(keyFor(key));
+        if (!open || it == HostNvs::entries.end() || it->second.size() > maxLen)
+            return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    bool isKey(const char *key) { return HostNvs::entries.count(keyFor(key)) != 0; }
+    bool remove(const char *key) { return open && !readOnly && HostNvs::entries.erase(keyFor(key)) != 0; }
+
+private:
+    std::string space;
+    bool readOnly = false;
+    bool open = false;
+
+    std::string keyFor(const char *key) const { return space + "/" + key; }
+};
+
+#endif // HOST_PREFERENCES_H
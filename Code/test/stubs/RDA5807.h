@@ -0,0 +1,114 @@
+#ifndef HOST_RDA5807_LIB_H
+#define HOST_RDA5807_LIB_H
+
+#include "Wire.h"
+
+// =========================================================
+// PU2CLR RDA5807 library, the calls FMRadio makes (env:native only)
+// =========================================================
+// Same method names and register effects, written through Wire to
+// whatever device is attached (HostRda5807 in tests).
+#define RDA_SEEK_WRAP 0
+#define RDA_SEEK_STOP 1
+#define RDA_SEEK_DOWN 0
+#define RDA_SEEK_UP 1
+
+class RDA5807
+{
+public:
+    void setup(uint8_t = 0, uint8_t = 0)
+    {
+        reg02 = 0xC00D; // DHIZ, DMUTE, RDS_EN, NEW_METHOD, ENABLE
+        reg05 = 0x888F;
+        setRegister(0x02, 0x0002); // Soft reset
+        setRegister(0x02, reg02);
+        setRegister(0x05, reg05);
+    }
+
+    void setBand(uint8_t band) { reg03 = (reg03 & ~0x000C) | ((band & 0x03) << 2); }
+    void setSpace(uint8_t space) { reg03 = (reg03 & ~0x0003) | (space & 0x03); }
+
+    void setVolume(uint8_t volume)
+    {
+        reg05 = (reg05 & ~0x000F) | (volume & 0x0F);
+        setRegister(0x05, reg05);
+    }
+
+    void setMono(bool mono)
+    {
+        reg02 = mono ? (reg02 | 0x2000) : (reg02 & ~0x2000);
+        setRegister(0x02, reg02);
+    }
+
+    void setRDS(bool enable)
+    {
+        reg02 = enable ? (reg02 | 0x0008) : (reg02 & ~0x0008);
+        setRegister(0x02, reg02);
+    }
+
+    void setGpio(uint8_t gpio1, uint8_t gpio2, uint8_t gpio3 = 0)
+    {
+        setRegister(0x04, (uint16_t)((gpio3 & 0x03) << 4 | (gpio2 & 0x03) << 2 | (gpio1 & 0x03)));
+    }
+
+    // Starts the chip's seek and polls STC every 30 ms, as the library
+    void seek(uint8_t mode, uint8_t direction, void (*)() = nullptr)
+    {
+        reg02 = (reg02 & ~0x0380) | 0x0100 | (direction ? 0x0200 : 0) | (mode == RDA_SEEK_STOP ? 0x0080 : 0);
+        setRegister(0x02, reg02);
+        for (int i = 0; i < 200 && !(getRegister(0x0A) & 0x4000); i++)
+            delay(30);
+        reg02 &= ~0x0100;
+        setRegister(0x02, reg02);
+    }
+
+    uint16_t getRealFrequency()
+    {
+        static const uint16_t starts[4] = {8700, 7600, 7600, 6500};
+        static const uint16_t stepsKHz[4] = {100, 200, 50, 25};
+        return starts[(reg03 >> 2) & 0x03] + (uint32_t)(getRegister(0x0A) & 0x03FF) * stepsKHz[reg03 & 0x03] / 10;
+    }
+
+    // As the library: 0x02, 0x04 and 0x05 start over (no RDS, stereo,
+    // GPIOs high-Z, volume 0)
+    void powerUp()
+    {
+        reg02 = 0xC001; // DHIZ, DMUTE, ENABLE
+        reg05 &= ~0x000F;
+        setRegister(0x02, reg02);
+        setRegister(0x04, 0x0000);
+        setRegister(0x05, reg05);
+    }
+    void powerDown()
+    {
+        reg02 &= ~0x0001;
+        setRegister(0x02, reg02);
+    }
+
+private:
+    uint16_t reg02 = 0;
+    uint16_t reg03 = 0;
+    uint16_t reg05 = 0;
+
+    void setRegister(uint8_t reg, uint16_t value)
+    {
+        Wire.beginTransmission(0x11);
+        Wire.write(reg);
+        Wire.write(value >> 8);
+        Wire.write(value & 0xFF);
+        Wire.endTransmission();
+    }
+
+    uint16_t getRegister(uint8_t reg)
+    {
+        Wire.beginTransmission(0x11);
+        Wire.write(reg);
+        Wire.endTransmission(false);
+        if (Wire.requestFrom((uint8_t)0x11, (uint8_t)2) != 2)
+            return 0;
+        uint16_t hi = Wire.read();
+        return (hi << 8) | (uint8_t)Wire.read();
+    }
+};
+
+#endif // HOST_RDA5807_LIB_H
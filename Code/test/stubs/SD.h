@@ -0,0 +1,38 @@
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum
+{
+    CARD_NONE,
+    CARD_MMC,
+    CARD_SD,
+    CARD_SDHC,
+    CARD_UNKNOWN
+} sdcard_type_t;
+
+// The card is HostFs::root; "inserted" is false to run without a card
+class SDFS : public fs::FS
+{
+public:
+    bool inserted = true;
+
+    bool begin(uint8_t = 5, SPIClass & = SPI, uint32_t = 4000000, const char * = "/sd", uint8_t = 5, bool = false)
+    {
+        if (!inserted)
+            return false;
+        ::mkdir(HostFs::root.c_str(), 0755);
+        return true;
+    }
+    void end() {}
+    sdcard_type_t cardType() { return inserted ? CARD_SDHC : CARD_NONE; }
+    uint64_t cardSize() { return 8ULL << 30; }
+    uint64_t totalBytes() { return cardSize(); }
+    uint64_t usedBytes() { return 0; }
+};
+
+inline SDFS SD;
+
+#endif // HOST_SD_H
@@ -0,0 +1,15 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "Arduino.h"
+
+class SPIClass
+{
+public:
+    void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t = -1) {}
+    void end() {}
+};
+
+inline SPIClass SPI;
+
+#endif // HOST_SPI_H
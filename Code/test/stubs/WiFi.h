@@ -0,0 +1,24 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "IPAddress.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+// Station that never joins a network; units on the host bus (WiFiUdp.h)
+// all share the loopback address
+class WiFiClass
+{
+public:
+    wl_status_t status() { return WL_DISCONNECTED; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+};
+
+inline WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
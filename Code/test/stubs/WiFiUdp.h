@@ -0,0 +1,132 @@
+#ifndef HOST_WIFIUDP_H
+#define HOST_WIFIUDP_H
+
+#include "IPAddress.h"
+#include <vector>
+
+// =========================================================
+// In-memory UDP bus (env:native only)
+// =========================================================
+// Every unit is on the loopback address (WiFi.h), so sockets are keyed
+// by port. A datagram reaches its socket
+// latencyUs (+ up to jitterUs) after endPacket() on HostClock, or is lost
+// with lossPercent probability. Tests that run several units each on its
+// own clock set HostClock before a unit's turn; a datagram is readable
+// once that unit's clock has passed its arrival time.
+namespace HostUdp
+{
+    struct Datagram
+    {
+        uint32_t toAddr;
+        uint16_t toPort;
+        uint32_t fromAddr;
+        uint16_t fromPort;
+        uint64_t arriveUs;
+        std::vector<uint8_t> data;
+    };
+
+    inline std::vector<Datagram> inFlight;
+    inline uint32_t latencyUs = 1000;
+    inline uint32_t jitterUs = 0;
+    inline uint8_t lossPercent = 0;
+    inline uint32_t rng = 1;
+    inline uint32_t sent = 0;
+    inline uint32_t lost = 0;
+
+    inline uint32_t random()
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+
+    // Forget everything queued for a socket (a unit that was switched off)
+    inline void flush(uint16_t port)
+    {
+        for (size_t i = inFlight.size(); i-- > 0;)
+            if (inFlight[i].toPort == port)
+                inFlight.erase(inFlight.begin() + i);
+    }
+
+    inline void reset()
+    {
+        inFlight.clear();
+        latencyUs = 1000;
+        jitterUs = 0;
+        lossPercent = 0;
+        rng = 1;
+        sent = lost = 0;
+    }
+}
+
+class WiFiUDP
+{
+public:
+    uint8_t begin(uint16_t port)
+    {
+        localPort = port;
+        return 1;
+    }
+    void stop() { localPort = 0; }
+
+    int beginPacket(IPAddress ip, uint16_t port)
+    {
+        out = HostUdp::Datagram{(uint32_t)ip, port, 0x7F000001, localPort, 0, {}};
+        return 1;
+    }
+    size_t write(const uint8_t *data, size_t len)
+    {
+        out.data.insert(out.data.end(), data, data + len);
+        return len;
+    }
+    int endPacket()
+    {
+        HostUdp::sent++;
+        if (HostUdp::random() % 100 < HostUdp::lossPercent)
+        {
+            HostUdp::lost++;
+            return 1; // Sent as far as the sender can tell
+        }
+        out.arriveUs = HostClock::nowUs + HostUdp::latencyUs +
+                       (HostUdp::jitterUs ? HostUdp::random() % HostUdp::jitterUs : 0);
+        HostUdp::inFlight.push_back(out);
+        return 1;
+    }
+
+    // Oldest datagram for this socket that has arrived by now
+    int parsePacket()
+    {
+        size_t best = SIZE_MAX;
+        for (size_t i = 0; i < HostUdp::inFlight.size(); i++)
+        {
+            const HostUdp::Datagram &d = HostUdp::inFlight[i];
+            if (d.toPort == localPort && d.arriveUs <= HostClock::nowUs &&
+                (best == SIZE_MAX || d.arriveUs < HostUdp::inFlight[best].arriveUs))
+                best = i;
+        }
+        if (best == SIZE_MAX)
+            return 0;
+        in = HostUdp::inFlight[best];
+        HostUdp::inFlight.erase(HostUdp::inFlight.begin() + best);
+        readPos = 0;
+        return (int)in.data.size();
+    }
+    int read(uint8_t *data, size_t len)
+    {
+        size_t n = in.data.size() - readPos < len ? in.data.size() - readPos : len;
+        memcpy(data, in.data.data() + readPos, n);
+        readPos += n;
+        return (int)n;
+    }
+    IPAddress remoteIP() { return IPAddress(in.fromAddr); }
+    uint16_t remotePort() { return in.fromPort; }
+
+private:
+    uint16_t localPort = 0;
+    HostUdp::Datagram out;
+    HostUdp::Datagram in;
+    size_t readPos = 0;
+};
+
+#endif // HOST_WIFIUDP_H
@@ -0,0 +1,96 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+// =========================================================
+// Host I2C bus (env:native only)
+// =========================================================
+// Transactions go to whatever HostI2cDevice is attached; with none, every
+// address NACKs. Each transaction advances the virtual clock by its bit
+// time at the bus clock, so code timed with micros() sees the bus cost.
+class HostI2cDevice
+{
+public:
+    virtual ~HostI2cDevice() {}
+    // A write transaction; false = address NACK
+    virtual bool i2cWrite(uint8_t address, const uint8_t *data, size_t len) = 0;
+    // A read transaction; returns the bytes supplied (0 = address NACK)
+    virtual size_t i2cRead(uint8_t address, uint8_t *data, size_t len) = 0;
+};
+
+class TwoWire : public Stream
+{
+public:
+    using Print::write;
+
+    bool begin(int = -1, int = -1, uint32_t frequency = 0)
+    {
+        if (frequency)
+            clockHz = frequency;
+        return true;
+    }
+    bool setClock(uint32_t frequency)
+    {
+        clockHz = frequency;
+        return true;
+    }
+
+    void attach(HostI2cDevice *dev) { device = dev; }
+    uint32_t getTransactions() const { return transactions; }
+
+    void beginTransmission(uint8_t address)
+    {
+        txAddress = address;
+        txLen = 0;
+    }
+    size_t write(uint8_t c) override
+    {
+        if (txLen >= sizeof(txBuf))
+            return 0;
+        txBuf[txLen++] = c;
+        return 1;
+    }
+    // 0 = ACK, 2 = address NACK (as the ESP32 core)
+    uint8_t endTransmission(bool = true)
+    {
+        busTime(txLen);
+        return device && device->i2cWrite(txAddress, txBuf, txLen) ? 0 : 2;
+    }
+    uint8_t requestFrom(uint8_t address, uint8_t len)
+    {
+        if (len > sizeof(rxBuf))
+            len = sizeof(rxBuf);
+        busTime(len);
+        rxLen = device ? device->i2cRead(address, rxBuf, len) : 0;
+        rxPos = 0;
+        return (uint8_t)rxLen;
+    }
+    uint8_t requestFrom(int address, int len) { return requestFrom((uint8_t)address, (uint8_t)len); }
+
+    int available() override { return (int)(rxLen - rxPos); }
+    int read() override { return rxPos < rxLen ? rxBuf[rxPos++] : -1; }
+    int peek() override { return rxPos < rxLen ? rxBuf[rxPos] : -1; }
+
+private:
+    HostI2cDevice *device = nullptr;
+    uint32_t clockHz = 100000;
+    uint32_t transactions = 0;
+    uint8_t txAddress = 0;
+    uint8_t txBuf[64];
+    size_t txLen = 0;
+    uint8_t rxBuf[64];
+    size_t rxLen = 0;
+    size_t rxPos = 0;
+
+    // Start + address + 9 clocks per byte + stop
+    void busTime(size_t bytes)
+    {
+        transactions++;
+        HostClock::advanceUs((uint64_t)(9 * (bytes + 1) + 2) * 1000000 / clockHz);
+    }
+};
+
+inline TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,28 @@
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+typedef enum
+{
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO
+} esp_reset_reason_t;
+
+// What the next boot reports as its reset cause; a test sets it before
+// calling a module's begin() again to play a watchdog or software reset
+namespace HostReset
+{
+    inline esp_reset_reason_t reason = ESP_RST_POWERON;
+}
+
+inline esp_reset_reason_t esp_reset_reason() { return HostReset::reason; }
+
+#endif // HOST_ESP_SYSTEM_H
@@ -0,0 +1,10 @@
+#ifndef HOST_ESP_TASK_WDT_H
+#define HOST_ESP_TASK_WDT_H
+
+// Task watchdog: nothing to feed on the host
+typedef int esp_err_t;
+inline esp_err_t esp_task_wdt_init(uint32_t, bool) { return 0; }
+inline esp_err_t esp_task_wdt_reset() { return 0; }
+inline esp_err_t esp_task_wdt_add(void *) { return 0; }
+
+#endif // HOST_ESP_TASK_WDT_H
@@ -0,0 +1,239 @@
+#include <unity.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include "AdmissionControl.h"
+
+static const uint32_t LEGIT_IP = 0x0A00000A;
+static const uint32_t FLOOD_IP = 0x0A000064; // + 0..5
+
+// Counts the answers equal to `want` when one client asks once per ms
+static uint32_t admittedOver(AdmissionControl &ac, uint32_t ip, RouteClass cls, uint32_t ms, Admission want)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ms; i++)
+    {
+        if (ac.admit(ip, cls) == want)
+            n++;
+        HostClock::advanceMs(1);
+    }
+    return n;
+}
+
+void setUp() { HostClock::nowUs = 1000000; }
+void tearDown() {}
+
+static void test_client_budget_is_burst_plus_rate()
+{
+    AdmissionControl ac;
+    // Status: burst 10, then 10/s -> 10 + 20 in two seconds, the rest 429
+    uint32_t ok = admittedOver(ac, LEGIT_IP, ROUTE_STATUS, 2000, ADMIT_OK);
+    TEST_ASSERT_INT_WITHIN(1, 30, ok);
+    // Credit is spent as soon as it accrues: nothing left within the same ms
+    ac.admit(LEGIT_IP, ROUTE_STATUS);
+    TEST_ASSERT_EQUAL(ADMIT_RATE_LIMITED, ac.admit(LEGIT_IP, ROUTE_STATUS));
+}
+
+static void test_control_is_never_shed_for_global_load()
+{
+    AdmissionControl ac;
+    // 16 clients each within their own control budget: 320 requests/s
+    // together, far past any shared bucket, and all of them get through
+    for (uint32_t ms = 0; ms < 3000; ms += 50)
+    {
+        for (uint32_t c = 0; c < ADMISSION_MAX_CLIENTS; c++)
+            TEST_ASSERT_EQUAL(ADMIT_OK, ac.admit(FLOOD_IP + c, ROUTE_CONTROL));
+        HostClock::advanceMs(50);
+    }
+}
+
+// A 503 is the server's load, not the client's: its own bucket keeps the
+// token, so once the shared bucket refills it still has its full burst
+static void test_overload_refunds_the_client_token()
+{
+    AdmissionControl ac;
+    // Six clients empty the shared heavy bucket (burst 4) in one go
+    for (uint32_t c = 0; c < 6; c++)
+        ac.admit(FLOOD_IP + c, ROUTE_HEAVY);
+
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL(ADMIT_OVERLOADED, ac.admit(LEGIT_IP, ROUTE_HEAVY));
+
+    // Enough for the shared bucket to refill, too little for the client's
+    // (1/s) to have earned three tokens back
+    HostClock::advanceMs(2000);
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL(ADMIT_OK, ac.admit(LEGIT_IP, ROUTE_HEAVY));
+    TEST_ASSERT_EQUAL(ADMIT_RATE_LIMITED, ac.admit(LEGIT_IP, ROUTE_HEAVY));
+}
+
+static void test_least_recent_client_is_evicted()
+{
+    AdmissionControl ac;
+    // The legit client spends its heavy burst, then 16 newer clients push it out
+    for (int i = 0; i < 3; i++)
+        ac.admit(LEGIT_IP, ROUTE_HEAVY);
+    TEST_ASSERT_EQUAL(ADMIT_RATE_LIMITED, ac.admit(LEGIT_IP, ROUTE_HEAVY));
+    HostClock::advanceMs(1);
+    for (uint32_t c = 0; c < ADMISSION_MAX_CLIENTS; c++)
+    {
+        ac.admit(FLOOD_IP + c, ROUTE_CONTROL);
+        HostClock::advanceMs(1);
+    }
+    // Back as a new client with full buckets
+    HostClock::advanceMs(600); // Shared heavy bucket refills 1 token
+    TEST_ASSERT_EQUAL(ADMIT_OK, ac.admit(LEGIT_IP, ROUTE_HEAVY));
+}
+
+// =========================================================
+// Load test on the virtual clock
+// =========================================================
+// One single-threaded server, as in AppWebServer: handled requests cost
+// 2-5 ms, rejected ones 0.2 ms. Six clients flood status in a closed loop
+// (next request 1 ms after each response); one client alternates status
+// and a tune every 50 ms.
+struct LoadResult
+{
+    uint32_t floodServed;
+    uint32_t legitSent;
+    uint32_t legitControlOk;
+    uint32_t legitStatusOk;
+    uint32_t p50Us;
+    uint32_t p99Us;
+};
+
+static LoadResult runLoad(bool admission, uint64_t durationUs)
+{
+    struct Request
+    {
+        int client; // -1 = legit
+        RouteClass cls;
+        uint64_t arrivalUs;
+    };
+
+    AdmissionControl ac;
+    std::deque<Request> queue;
+    std::vector<uint32_t> latencies;
+    LoadResult r = {};
+
+    const int floods = 6;
+    uint64_t floodAt[floods] = {};
+    bool floodWaiting[floods] = {};
+    uint64_t legitAt = 0;
+    uint32_t legitSeq = 0;
+
+    bool busy = false;
+    Request current = {};
+    uint64_t doneAt = 0;
+    uint32_t rng = 1;
+    const uint64_t start = HostClock::nowUs;
+
+    while (true)
+    {
+        uint64_t next = legitAt;
+        for (int i = 0; i < floods; i++)
+            if (!floodWaiting[i])
+                next = std::min(next, floodAt[i]);
+        if (busy)
+            next = std::min(next, doneAt);
+        if (next >= durationUs)
+            break;
+        HostClock::nowUs = start + next;
+
+        if (busy && doneAt == next)
+        {
+            busy = false;
+            if (current.client >= 0)
+            {
+                floodWaiting[current.client] = false;
+                floodAt[current.client] = next + 1000;
+            }
+            else
+                latencies.push_back((uint32_t)(next - current.arrivalUs));
+        }
+
+        for (int i = 0; i < floods; i++)
+        {
+            if (!floodWaiting[i] && floodAt[i] <= next)
+            {
+                queue.push_back({i, ROUTE_STATUS, next});
+                floodWaiting[i] = true;
+            }
+        }
+        if (legitAt <= next)
+        {
+            queue.push_back({-1, (legitSeq++ & 1) ? ROUTE_CONTROL : ROUTE_STATUS, next});
+            r.legitSent++;
+            legitAt += 50000;
+        }
+
+        if (!busy && !queue.empty())
+        {
+            current = queue.front();
+            queue.pop_front();
+            uint32_t ip = current.client < 0 ? LEGIT_IP : FLOOD_IP + current.client;
+            Admission a = admission ? ac.admit(ip, current.cls) : ADMIT_OK;
+            uint32_t cost = 200;
+            if (a == ADMIT_OK)
+            {
+                rng = rng * 1103515245 + 12345;
+                cost = 2000 + (rng >> 16) % 3001;
+                if (current.client >= 0)
+                    r.floodServed++;
+                else if (current.cls == ROUTE_CONTROL)
+                    r.legitControlOk++;
+                else
+                    r.legitStatusOk++;
+            }
+            doneAt = next + cost;
+            busy = true;
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    r.p50Us = latencies[latencies.size() / 2];
+    r.p99Us = latencies[latencies.size() * 99 / 100];
+    return r;
+}
+
+static void report(const char *name, const LoadResult &r)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%s: legit p50 %lu us, p99 %lu us, flood served %lu, legit status ok %lu/%lu",
+             name, (unsigned long)r.p50Us, (unsigned long)r.p99Us, (unsigned long)r.floodServed,
+             (unsigned long)r.legitStatusOk, (unsigned long)(r.legitSent / 2));
+    TEST_MESSAGE(line);
+}
+
+static void test_flood_does_not_starve_a_legit_client()
+{
+    const uint64_t fiveSeconds = 5000000;
+    LoadResult open = runLoad(false, fiveSeconds);
+    LoadResult limited = runLoad(true, fiveSeconds);
+    report("no admission", open);
+    report("admission", limited);
+
+    // Without admission the legit client waits behind the whole flood queue
+    TEST_ASSERT_GREATER_THAN(10000, open.p50Us);
+    // With it, the flood is cut to its budgets (6 x (10 + 5 x 10) per
+    // client, and 40 + 5 x 40 for the shared bucket) and the legit
+    // client's tunes always get through, within a request or two of wait
+    TEST_ASSERT_LESS_OR_EQUAL(240, limited.floodServed);
+    TEST_ASSERT_EQUAL(limited.legitSent / 2, limited.legitControlOk);
+    // Its status polls (10/s, its own rate) come out of the shared
+    // bucket's reserve, which the flooders cannot reach
+    TEST_ASSERT_GREATER_OR_EQUAL(limited.legitSent / 2 * 9 / 10, limited.legitStatusOk);
+    TEST_ASSERT_LESS_THAN(8000, limited.p50Us);
+    TEST_ASSERT_LESS_THAN(open.p50Us / 2, limited.p50Us);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_client_budget_is_burst_plus_rate);
+    RUN_TEST(test_control_is_never_shed_for_global_load);
+    RUN_TEST(test_overload_refunds_the_client_token);
+    RUN_TEST(test_least_recent_client_is_evicted);
+    RUN_TEST(test_flood_does_not_starve_a_legit_client);
+    return UNITY_END();
+}
@@ -0,0 +1,172 @@
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include "AudioRingBuffer.h"
+
+// Frames carry their own sequence number: L = n, R = ~n
+static void fill(int16_t *pcm, uint32_t first, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++)
+    {
+        pcm[2 * i] = (int16_t)(first + i);
+        pcm[2 * i + 1] = (int16_t) ~(first + i);
+    }
+}
+
+static size_t mismatches(const int16_t *pcm, uint32_t first, size_t frames)
+{
+    size_t bad = 0;
+    for (size_t i = 0; i < frames; i++)
+        if (pcm[2 * i] != (int16_t)(first + i) || pcm[2 * i + 1] != (int16_t) ~(first + i))
+            bad++;
+    return bad;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_capacity_rounds_up_to_power_of_two()
+{
+    AudioRingBuffer ring;
+    TEST_ASSERT_TRUE(ring.begin(1000));
+    TEST_ASSERT_EQUAL(1024, ring.capacity());
+    TEST_ASSERT_EQUAL(0, ring.available());
+    TEST_ASSERT_EQUAL(1024, ring.freeSpace());
+}
+
+static void test_wraps_and_counts_overrun_underrun()
+{
+    AudioRingBuffer ring;
+    ring.begin(8);
+    int16_t in[2 * 12], out[2 * 12];
+
+    // Move the indices off zero so the next write wraps
+    fill(in, 0, 6);
+    TEST_ASSERT_EQUAL(6, ring.write(in, 6));
+    TEST_ASSERT_EQUAL(6, ring.read(out, 6));
+
+    fill(in, 6, 12);
+    TEST_ASSERT_EQUAL(8, ring.write(in, 12)); // 4 frames do not fit
+    TEST_ASSERT_EQUAL(1, ring.getOverruns());
+    TEST_ASSERT_EQUAL(4, ring.getDroppedFrames());
+
+    TEST_ASSERT_EQUAL(8, ring.read(out, 12)); // Asked for more than buffered
+    TEST_ASSERT_EQUAL(1, ring.getUnderruns());
+    TEST_ASSERT_EQUAL(0, mismatches(out, 6, 8));
+}
+
+struct MarkLog
+{
+    int low = 0;
+    int high = 0;
+};
+
+static void onMark(AudioRingBuffer::Watermark mark, size_t, void *ctx)
+{
+    MarkLog *log = (MarkLog *)ctx;
+    if (mark == AudioRingBuffer::WATERMARK_LOW)
+        log->low++;
+    else
+        log->high++;
+}
+
+static void test_watermarks_fire_once_per_crossing()
+{
+    AudioRingBuffer ring;
+    MarkLog log;
+    ring.begin(64);
+    ring.setWatermarks(8, 48, onMark, &log);
+    int16_t pcm[2 * 64];
+    fill(pcm, 0, 64);
+
+    ring.write(pcm, 40);
+    ring.write(pcm, 10); // 50 >= high
+    ring.write(pcm, 4);  // Still above: no second callback
+    TEST_ASSERT_EQUAL(1, log.high);
+
+    ring.read(pcm, 50); // 4 left <= low
+    ring.read(pcm, 2);
+    TEST_ASSERT_EQUAL(1, log.low);
+
+    // The producer re-arms on a write that leaves the fill below the mark
+    ring.write(pcm, 10);
+    ring.write(pcm, 40);
+    TEST_ASSERT_EQUAL(2, log.high);
+}
+
+// One producer and one consumer thread move 4 M frames with random chunk
+// sizes and random stalls on both sides; every frame must come out once,
+// in order, with both channels intact
+static void test_spsc_stress_with_random_stalls()
+{
+    const uint32_t total = 4000000;
+    const size_t maxChunk = 300;
+    AudioRingBuffer ring;
+    TEST_ASSERT_TRUE(ring.begin(1000));
+
+    std::atomic<size_t> bad(0);
+    std::atomic<uint32_t> consumed(0);
+
+    std::thread producer([&]()
+                         {
+        std::mt19937 rng(1);
+        int16_t pcm[2 * maxChunk];
+        uint32_t next = 0;
+        while (next < total)
+        {
+            size_t n = rng() % maxChunk + 1;
+            if (n > total - next)
+                n = total - next;
+            // Only offer what fits, so overruns stay at zero
+            size_t space = ring.freeSpace();
+            if (n > space)
+                n = space;
+            if (n)
+            {
+                fill(pcm, next, n);
+                next += ring.write(pcm, n);
+            }
+            else
+                std::this_thread::yield();
+            if (rng() % 1000 == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(rng() % 500));
+        } });
+
+    std::thread consumer([&]()
+                         {
+        std::mt19937 rng(2);
+        int16_t pcm[2 * maxChunk];
+        uint32_t next = 0;
+        while (next < total)
+        {
+            size_t n = ring.read(pcm, rng() % maxChunk + 1);
+            bad += mismatches(pcm, next, n);
+            next += n;
+            if (!n)
+                std::this_thread::yield();
+            if (rng() % 1000 == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(rng() % 500));
+        }
+        consumed = next; });
+
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_EQUAL(0, bad.load());
+    TEST_ASSERT_EQUAL(total, consumed.load());
+    TEST_ASSERT_EQUAL(0, ring.getOverruns());
+    TEST_ASSERT_EQUAL(0, ring.getDroppedFrames());
+    TEST_ASSERT_EQUAL(0, ring.available());
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_rounds_up_to_power_of_two);
+    RUN_TEST(test_wraps_and_counts_overrun_underrun);
+    RUN_TEST(test_watermarks_fire_once_per_crossing);
+    RUN_TEST(test_spsc_stress_with_random_stalls);
+    return UNITY_END();
+}
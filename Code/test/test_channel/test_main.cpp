@@ -0,0 +1,136 @@
+#include <unity.h>
+#include "Channel.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Every 10 kHz point of every band formats and parses back to itself, and
+// snapping lands on a valid raster point no further than half a step away
+static void test_round_trip_every_band_and_spacing()
+{
+    char text[CHANNEL_STR_LEN];
+    for (uint8_t band = 0; band < 4; band++)
+    {
+        for (uint8_t space = 0; space < 4; space++)
+        {
+            uint16_t step = Channel::rasterStep(space);
+            uint32_t valid = 0;
+            for (uint16_t code = Channel::bandStart(band); code <= Channel::bandEnd(band); code++)
+            {
+                Channel ch(code);
+                size_t len = ch.format(text);
+                TEST_ASSERT_EQUAL(strlen(text), len);
+                TEST_ASSERT_LESS_THAN(CHANNEL_STR_LEN, len);
+
+                Channel back;
+                TEST_ASSERT_TRUE_MESSAGE(Channel::parse(text, back), text);
+                TEST_ASSERT_EQUAL_UINT16_MESSAGE(code, back.code(), text);
+
+                Channel snapped = ch.snapped(band, space);
+                TEST_ASSERT_TRUE(snapped.isValid(band, space));
+                TEST_ASSERT_LESS_OR_EQUAL(step / 2, abs((int)snapped.code() - (int)code));
+                if (ch.isValid(band, space))
+                {
+                    TEST_ASSERT_EQUAL_UINT16(code, snapped.code());
+                    uint16_t chan = ch.chipChannel(band, space);
+                    TEST_ASSERT_EQUAL_UINT16(code, Channel::fromChipChannel(chan, band, space).code());
+                    valid++;
+                }
+            }
+            // Both band edges are raster points, so the count is exact
+            TEST_ASSERT_EQUAL((Channel::bandEnd(band) - Channel::bandStart(band)) / step + 1, valid);
+        }
+    }
+}
+
+static void test_snapping_clamps_to_the_band()
+{
+    TEST_ASSERT_EQUAL_UINT16(8700, Channel(100).snapped(0, 0).code());
+    TEST_ASSERT_EQUAL_UINT16(10800, Channel(12000).snapped(0, 0).code());
+    TEST_ASSERT_EQUAL_UINT16(9100, Channel(9110).snapped(1, 1).code());
+    TEST_ASSERT_EQUAL_UINT16(9950, Channel(9948).snapped(0, 2).code());
+    TEST_ASSERT_EQUAL_UINT16(9955, Channel(9954).snapped(0, 3).code());
+}
+
+// The chip counts 25 kHz channels at space=3 even though only every other
+// one is on the raster: 87.55 MHz is chip channel 22, not raster step 11
+static void test_chip_channel_counts_chip_spacing()
+{
+    TEST_ASSERT_EQUAL_UINT16(128, Channel(9980).chipChannel(0, 0));
+    TEST_ASSERT_EQUAL_UINT16(64, Channel(9980).chipChannel(0, 1));
+    TEST_ASSERT_EQUAL_UINT16(256, Channel(9980).chipChannel(0, 2));
+    TEST_ASSERT_EQUAL_UINT16(22, Channel(8755).chipChannel(0, 3));
+    TEST_ASSERT_EQUAL_UINT16(8755, Channel::fromChipChannel(22, 0, 3).code());
+}
+
+static void test_parse_is_exact_decimal()
+{
+    Channel ch;
+    TEST_ASSERT_TRUE(Channel::parse("99.95", ch));
+    TEST_ASSERT_EQUAL_UINT16(9995, ch.code());
+    TEST_ASSERT_TRUE(Channel::parse("99.5", ch));
+    TEST_ASSERT_EQUAL_UINT16(9950, ch.code());
+    TEST_ASSERT_TRUE(Channel::parse("108", ch));
+    TEST_ASSERT_EQUAL_UINT16(10800, ch.code());
+    TEST_ASSERT_TRUE(Channel::parse(" 87.6 ", ch));
+    TEST_ASSERT_EQUAL_UINT16(8760, ch.code());
+    TEST_ASSERT_TRUE(Channel::parse(".5", ch));
+    TEST_ASSERT_EQUAL_UINT16(50, ch.code());
+    // Third decimal rounds to the nearest 10 kHz, further digits are ignored
+    TEST_ASSERT_TRUE(Channel::parse("87.125", ch));
+    TEST_ASSERT_EQUAL_UINT16(8713, ch.code());
+    TEST_ASSERT_TRUE(Channel::parse("87.1249", ch));
+    TEST_ASSERT_EQUAL_UINT16(8712, ch.code());
+}
+
+static void test_parse_rejects_malformed_text()
+{
+    Channel ch(1234);
+    const char *bad[] = {"", " ", ".", "abc", "99.5x", "9 9", "1000", "-99.5", "0", "0.00", "99,5", "655.36"};
+    for (const char *text : bad)
+        TEST_ASSERT_FALSE_MESSAGE(Channel::parse(text, ch), text);
+    TEST_ASSERT_FALSE(Channel::parse(nullptr, ch));
+    TEST_ASSERT_EQUAL_UINT16(1234, ch.code()); // Untouched on failure
+}
+
+static void test_from_mhz_rounds_legacy_floats()
+{
+    TEST_ASSERT_EQUAL_UINT16(9995, Channel::fromMHz(99.95f).code());
+    TEST_ASSERT_EQUAL_UINT16(10170, Channel::fromMHz(101.7f).code());
+    TEST_ASSERT_EQUAL_UINT16(8750, Channel::fromMHz(87.5f).code());
+    TEST_ASSERT_TRUE(Channel::fromMHz(0.0f).isNull());
+    TEST_ASSERT_TRUE(Channel::fromMHz(-1.0f).isNull());
+    TEST_ASSERT_TRUE(Channel::fromMHz(700.0f).isNull());
+
+    // Every 10 kHz point survives the float round trip of old JSON files
+    for (uint16_t code = 6500; code <= 10800; code++)
+        TEST_ASSERT_EQUAL_UINT16(code, Channel::fromMHz(code / 100.0f).code());
+}
+
+static void test_format_uses_one_decimal_unless_needed()
+{
+    char text[CHANNEL_STR_LEN];
+    Channel(9950).format(text);
+    TEST_ASSERT_EQUAL_STRING("99.5", text);
+    Channel(9955).format(text);
+    TEST_ASSERT_EQUAL_STRING("99.55", text);
+    Channel(10800).format(text);
+    TEST_ASSERT_EQUAL_STRING("108.0", text);
+    Channel(6500).format(text);
+    TEST_ASSERT_EQUAL_STRING("65.0", text);
+    Channel(905).format(text);
+    TEST_ASSERT_EQUAL_STRING("9.05", text);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_every_band_and_spacing);
+    RUN_TEST(test_snapping_clamps_to_the_band);
+    RUN_TEST(test_chip_channel_counts_chip_spacing);
+    RUN_TEST(test_parse_is_exact_decimal);
+    RUN_TEST(test_parse_rejects_malformed_text);
+    RUN_TEST(test_from_mhz_rounds_legacy_floats);
+    RUN_TEST(test_format_uses_one_decimal_unless_needed);
+    return UNITY_END();
+}
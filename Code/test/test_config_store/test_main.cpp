@@ -0,0 +1,115 @@
+#include <unity.h>
+#include <filesystem>
+#include "ConfigStore.h"
+#include "FMRadio.h"
+#include "FileManager.h"
+#include "HostRda5807.h"
+
+#define CARD "/tmp/famio-native-config"
+
+// What the next boot would load
+static bool snapshotOnFlash(RuntimeConfig *out = nullptr)
+{
+    FileManager files;
+    ConfigStore next(&files);
+    if (!next.loadSnapshot())
+        return false;
+    if (out)
+        *out = next.get();
+    return true;
+}
+
+void setUp()
+{
+    HostClock::nowUs = 1000000;
+    HostNvs::erase();
+    HostFs::root = CARD;
+    std::filesystem::remove_all(CARD);
+    SD.inserted = true;
+}
+
+void tearDown()
+{
+    SD.inserted = true;
+    Wire.attach(nullptr);
+}
+
+// First boot of a unit without a card: nothing to import, so nothing is
+// written on its own, but what the user sets up must stick
+static void test_no_card_saves_user_changes()
+{
+    SD.inserted = false;
+    HostRda5807 chip;
+    Wire.attach(&chip);
+    FileManager files;
+    ConfigStore config(&files);
+    FMRadio radio(&files, &config);
+
+    TEST_ASSERT_FALSE(files.begin());
+    config.begin();
+    TEST_ASSERT_TRUE(config.isImportPending());
+
+    // Boot tunes to the default channel: not a reason to write a snapshot
+    radio.begin();
+    delay(CONFIG_SAVE_DELAY_MS + 100);
+    radio.poll();
+    TEST_ASSERT_FALSE(snapshotOnFlash());
+
+    // Provisioning (ConnectivityManager::saveCredentials)
+    RuntimeConfig &cfg = config.get();
+    strncpy(cfg.staSsid, "home", sizeof(cfg.staSsid) - 1);
+    strncpy(cfg.staPass, "secret-pass", sizeof(cfg.staPass) - 1);
+    TEST_ASSERT_TRUE(config.commit());
+    TEST_ASSERT_FALSE(config.isImportPending());
+
+    RuntimeConfig saved;
+    TEST_ASSERT_TRUE(snapshotOnFlash(&saved));
+    TEST_ASSERT_EQUAL_STRING("home", saved.staSsid);
+    TEST_ASSERT_EQUAL_STRING("secret-pass", saved.staPass);
+
+    // A volume change goes through the deferred save
+    radio.setVolume(4);
+    delay(CONFIG_SAVE_DELAY_MS + 100);
+    radio.poll();
+    TEST_ASSERT_TRUE(snapshotOnFlash(&saved));
+    TEST_ASSERT_EQUAL(4, saved.fmVolume);
+    TEST_ASSERT_EQUAL_STRING("home", saved.staSsid);
+}
+
+// A common.json that cannot be parsed right now (cut short, card glitch)
+// is left alone: rewriting it from an empty document would drop
+// udp_token, and a token of 0 opens UDP control to anyone
+static void test_unreadable_common_json_is_not_rewritten()
+{
+    FileManager files;
+    ConfigStore config(&files);
+    TEST_ASSERT_TRUE(files.begin());
+    std::filesystem::create_directories(CARD PROJECT_ROOT_DIR CONFIG_FILE_PATH);
+    std::string path = CARD PROJECT_ROOT_DIR CONFIG_FILE_PATH COMMON_CONFIG_FILE;
+
+    const char truncated[] = "{\"volume\": 40, \"freq\": 101.3, \"udp_token\": 31337, \"gro";
+    FILE *fp = fopen(path.c_str(), "wb");
+    fwrite(truncated, 1, strlen(truncated), fp);
+    fclose(fp);
+
+    config.get().groupEnabled = 1;
+    TEST_ASSERT_FALSE(config.saveCommonJson());
+    fp = fopen(path.c_str(), "rb");
+    char back[128] = {0};
+    fread(back, 1, sizeof(back) - 1, fp);
+    fclose(fp);
+    TEST_ASSERT_EQUAL_STRING(truncated, back);
+
+    // No file yet: written from scratch
+    std::filesystem::remove(path);
+    TEST_ASSERT_TRUE(config.saveCommonJson());
+    TEST_ASSERT_TRUE(std::filesystem::exists(path));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_card_saves_user_changes);
+    RUN_TEST(test_unreadable_common_json_is_not_rewritten);
+    return UNITY_END();
+}
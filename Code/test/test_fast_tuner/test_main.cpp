@@ -0,0 +1,185 @@
+#include <unity.h>
+#include <algorithm>
+#include <vector>
+#include "FastTuner.h"
+#include "HostRda5807.h"
+
+#define BAND 0  // 87-108 MHz
+#define SPACE 0 // 100 kHz
+
+// Forwards to the chip and keeps the register writes in order
+class WriteLog : public HostI2cDevice
+{
+public:
+    explicit WriteLog(HostRda5807 &chip) : chip(chip) {}
+    std::vector<std::pair<uint8_t, uint16_t>> writes;
+
+    bool i2cWrite(uint8_t address, const uint8_t *data, size_t len) override
+    {
+        if (address == RDA5807_I2C_REG_ADDR && len == 3)
+            writes.push_back({data[0], (uint16_t)(data[1] << 8 | data[2])});
+        return chip.i2cWrite(address, data, len);
+    }
+    size_t i2cRead(uint8_t address, uint8_t *data, size_t len) override { return chip.i2cRead(address, data, len); }
+
+private:
+    HostRda5807 &chip;
+};
+
+static const uint16_t STATIONS[] = {8870, 9110, 9450, 9650, 9910, 10030, 10270, 10470, 10650, 10790};
+
+static void addStations(HostRda5807 &chip)
+{
+    uint8_t rssi = 20;
+    for (uint16_t code : STATIONS)
+    {
+        chip.addStation({code, rssi, true, 0, 0, nullptr, nullptr});
+        rssi += 4;
+    }
+}
+
+static void powerUp(FastTuner &tuner)
+{
+    tuner.writeRegister(0x02, 0xC00D); // DHIZ, DMUTE, RDS, NEW_METHOD, ENABLE
+}
+
+void setUp()
+{
+    HostClock::nowUs = 1000000;
+    Wire.setClock(400000);
+}
+
+void tearDown() { Wire.attach(nullptr); }
+
+// Muted for the retune only: 0x02 without DMUTE, then 0x03, then 0x02
+// back exactly as it was
+static void test_tune_mutes_locks_and_restores_reg02()
+{
+    HostRda5807 chip(3);
+    addStations(chip);
+    WriteLog log(chip);
+    Wire.attach(&log);
+    FastTuner tuner(&Wire);
+    powerUp(tuner);
+    log.writes.clear();
+
+    FastTuner::Result r = tuner.tune(10270, BAND, SPACE);
+    TEST_ASSERT_TRUE(r.completed);
+    TEST_ASSERT_EQUAL_UINT16(10270, r.channelCode);
+    TEST_ASSERT_EQUAL_UINT16(10270, chip.channelCode());
+    TEST_ASSERT_INT_WITHIN(FAST_TUNE_RSSI_EPS, 44, r.rssi);
+    TEST_ASSERT_TRUE(r.stcUs >= 10000 && r.stcUs <= 40000 + FAST_TUNE_POLL_US + 500);
+
+    TEST_ASSERT_EQUAL(3, log.writes.size());
+    TEST_ASSERT_EQUAL(0x02, log.writes[0].first);
+    TEST_ASSERT_EQUAL_HEX16(0x800D, log.writes[0].second);
+    TEST_ASSERT_EQUAL(0x03, log.writes[1].first);
+    TEST_ASSERT_EQUAL(0x02, log.writes[2].first);
+    TEST_ASSERT_EQUAL_HEX16(0xC00D, log.writes[2].second);
+    TEST_ASSERT_FALSE(chip.muted());
+}
+
+// A chip that never sets STC: give up after the timeout, still unmute
+static void test_timeout_restores_output()
+{
+    HostRda5807 chip(3);
+    addStations(chip);
+    Wire.attach(&chip);
+    FastTuner tuner(&Wire);
+    tuner.writeRegister(0x02, 0xC00C); // ENABLE clear: the tune never completes
+
+    FastTuner::Result r = tuner.tune(9910, BAND, SPACE);
+    TEST_ASSERT_FALSE(r.completed);
+    TEST_ASSERT_GREATER_OR_EQUAL(FAST_TUNE_TIMEOUT_MS * 1000UL, r.stcUs);
+    TEST_ASSERT_LESS_THAN((FAST_TUNE_TIMEOUT_MS + 5) * 1000UL, r.totalUs);
+    TEST_ASSERT_EQUAL_HEX16(0xC00C, chip.reg(0x02));
+}
+
+// 25 kHz spacing: CHAN is written and READCHAN decoded in chip channels
+// (25 kHz), not in 50 kHz raster steps
+static void test_space_25khz_counts_chip_channels()
+{
+    HostRda5807 chip(5);
+    chip.addStation({8755, 40, true, 0, 0, nullptr, nullptr});
+    WriteLog log(chip);
+    Wire.attach(&log);
+    FastTuner tuner(&Wire);
+    powerUp(tuner);
+    log.writes.clear();
+
+    FastTuner::Result r = tuner.tune(8755, BAND, 3);
+    TEST_ASSERT_TRUE(r.completed);
+    TEST_ASSERT_EQUAL(0x03, log.writes[1].first);
+    TEST_ASSERT_EQUAL(22, log.writes[1].second >> 6);
+    TEST_ASSERT_EQUAL_UINT16(8755, chip.channelCode());
+    TEST_ASSERT_EQUAL_UINT16(8755, r.channelCode);
+    TEST_ASSERT_INT_WITHIN(FAST_TUNE_RSSI_EPS, 40, r.rssi);
+}
+
+// No chip on the bus: nothing to mute or restore, and no hang
+static void test_missing_chip_times_out()
+{
+    FastTuner tuner(&Wire);
+    FastTuner::Result r = tuner.tune(9910, BAND, SPACE);
+    TEST_ASSERT_FALSE(r.completed);
+    TEST_ASSERT_LESS_THAN((FAST_TUNE_TIMEOUT_MS + 5) * 1000UL, r.totalUs);
+}
+
+// =========================================================
+// 300 preset switches
+// =========================================================
+// STC after 10-40 ms, RSSI settling with a 3 ms time constant, 400 kHz
+// bus. Target: mute to unmute under 80 ms, every time.
+static void test_three_hundred_tunes()
+{
+    HostRda5807 chip(41);
+    addStations(chip);
+    Wire.attach(&chip);
+    FastTuner tuner(&Wire);
+    powerUp(tuner);
+
+    std::vector<uint32_t> total, stc;
+    uint32_t timeouts = 0;
+    uint32_t rng = 7;
+    uint16_t last = 0;
+    for (int i = 0; i < 300; i++)
+    {
+        uint16_t code;
+        do
+        {
+            rng = rng * 1103515245 + 12345;
+            code = STATIONS[(rng >> 16) % (sizeof(STATIONS) / sizeof(STATIONS[0]))];
+        } while (code == last);
+        last = code;
+
+        FastTuner::Result r = tuner.tune(code, BAND, SPACE);
+        if (!r.completed)
+            timeouts++;
+        TEST_ASSERT_EQUAL_UINT16(code, r.channelCode);
+        TEST_ASSERT_FALSE(chip.muted());
+        total.push_back(r.totalUs);
+        stc.push_back(r.stcUs);
+        HostClock::advanceMs(500); // Listening between presses
+    }
+
+    std::sort(total.begin(), total.end());
+    std::sort(stc.begin(), stc.end());
+    TEST_ASSERT_EQUAL(0, timeouts);
+    TEST_ASSERT_LESS_THAN(80000, total.back());
+
+    char line[128];
+    snprintf(line, sizeof(line), "300 tunes: total p50 %.1f ms, p99 %.1f ms, max %.1f ms; STC p50 %.1f ms",
+             total[150] / 1000.0, total[297] / 1000.0, total.back() / 1000.0, stc[150] / 1000.0);
+    TEST_MESSAGE(line);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tune_mutes_locks_and_restores_reg02);
+    RUN_TEST(test_timeout_restores_output);
+    RUN_TEST(test_space_25khz_counts_chip_channels);
+    RUN_TEST(test_missing_chip_times_out);
+    RUN_TEST(test_three_hundred_tunes);
+    return UNITY_END();
+}
@@ -0,0 +1,67 @@
+#include <unity.h>
+#include <filesystem>
+#include "ConfigStore.h"
+#include "FMRadio.h"
+#include "FileManager.h"
+#include "HostRda5807.h"
+
+#define CARD "/tmp/famio-native-fm"
+
+void setUp()
+{
+    HostClock::nowUs = 1000000;
+    HostNvs::erase();
+    HostFs::root = CARD;
+    std::filesystem::remove_all(CARD);
+    std::filesystem::create_directories(CARD PROJECT_ROOT_DIR CONFIG_FILE_PATH);
+    Wire.setClock(400000);
+}
+
+void tearDown() { Wire.attach(nullptr); }
+
+// Power off and on from the web or UDP takes the warm path (no begin()):
+// the chip must come back with RDS, the forced mono and the GPIOs that
+// begin() set, not the library's powerUp() defaults
+static void test_power_cycle_keeps_rds_mono_and_gpio()
+{
+    HostRda5807 chip;
+    chip.addStation({10110, 40, true, 0x1234, 10, "FAMIO   ", nullptr});
+    Wire.attach(&chip);
+    FileManager files;
+    ConfigStore config(&files);
+    FMRadio radio(&files, &config);
+    TEST_ASSERT_TRUE(files.begin());
+    config.begin();
+    radio.begin();
+    radio.setFrequency(Channel(10110));
+    radio.setVolume(6);
+    radio.setStereo(false);
+    TEST_ASSERT_TRUE(chip.rdsEnabled());
+    TEST_ASSERT_TRUE(chip.mono());
+    uint8_t gpio = chip.gpio();
+
+    radio.powerOff();
+    TEST_ASSERT_FALSE(chip.enabled());
+    radio.powerOn();
+
+    TEST_ASSERT_TRUE(chip.enabled());
+    TEST_ASSERT_TRUE(chip.rdsEnabled());
+    TEST_ASSERT_TRUE(chip.mono());
+    TEST_ASSERT_EQUAL(gpio, chip.gpio());
+    TEST_ASSERT_EQUAL(6, chip.volume());
+    TEST_ASSERT_EQUAL_UINT16(10110, chip.channelCode());
+
+    // And stereo again once the user allows it
+    radio.setStereo(true);
+    radio.powerOff();
+    radio.powerOn();
+    TEST_ASSERT_FALSE(chip.mono());
+    TEST_ASSERT_TRUE(chip.rdsEnabled());
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_power_cycle_keeps_rds_mono_and_gpio);
+    return UNITY_END();
+}
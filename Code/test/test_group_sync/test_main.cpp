@@ -0,0 +1,328 @@
+#include <unity.h>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ConfigStore.h"
+#include "FMRadio.h"
+#include "FileManager.h"
+#include "GroupSync.h"
+#include "RadioController.h"
+#include "HostRda5807.h"
+
+#define NODES 4
+#define BASE_PORT 6000 // Not GROUP_PORT: static peers, no mDNS task
+#define LOOP_US 1000   // An idle loop() pass
+
+// =========================================================
+// Four units on one host bus, each on its own clock
+// =========================================================
+// Every unit has its own tuner, card and NVS. The unit whose clock is
+// furthest behind runs its next loop() pass, so a 35 ms retune on one unit
+// does not hold up the others; datagrams arrive 1 ms after they are sent.
+struct Node
+{
+    HostRda5807 chip;
+    std::string card;
+    std::map<std::string, std::vector<uint8_t>> nvs;
+    FileManager files;
+    ConfigStore config{&files};
+    FMRadio radio{&files, &config};
+    RadioController controller{&radio};
+    GroupSync group{&controller, &config};
+    uint64_t clockUs = 0;
+    bool alive = true;
+
+    explicit Node(uint32_t seed) : chip(seed) {}
+};
+
+static std::unique_ptr<Node> nodes[NODES];
+
+// Make `n` the unit that is running: its clock, tuner, card and NVS
+static void enter(Node &n)
+{
+    HostClock::nowUs = n.clockUs;
+    Wire.attach(&n.chip);
+    HostFs::root = n.card;
+    HostNvs::entries.swap(n.nvs);
+}
+
+static void leave(Node &n)
+{
+    n.clockUs = HostClock::nowUs;
+    HostNvs::entries.swap(n.nvs);
+    Wire.attach(nullptr);
+}
+
+static void step(Node &n)
+{
+    enter(n);
+    uint64_t start = HostClock::nowUs;
+    n.group.poll();
+    n.radio.poll();
+    HostClock::nowUs = std::max(HostClock::nowUs, start + LOOP_US);
+    leave(n);
+}
+
+static Node &earliest()
+{
+    Node *first = nullptr;
+    for (auto &n : nodes)
+        if (n->alive && (!first || n->clockUs < first->clockUs))
+            first = n.get();
+    return *first;
+}
+
+static bool converged()
+{
+    const Node *ref = nullptr;
+    for (auto &n : nodes)
+    {
+        if (!n->alive)
+            continue;
+        if (!ref)
+        {
+            ref = n.get();
+            continue;
+        }
+        RadioState a = ref->controller.getState();
+        RadioState b = n->controller.getState();
+        if (a.channelCode != b.channelCode || a.volume != b.volume || a.powered != b.powered)
+            return false;
+    }
+    return true;
+}
+
+// Step live units in time order until `done` holds; returns the clock of
+// the unit that got there, or UINT64_MAX after `limitUs`
+template <typename F>
+static uint64_t runUntil(uint64_t limitUs, F done)
+{
+    uint64_t start = earliest().clockUs;
+    while (earliest().clockUs - start < limitUs)
+    {
+        Node &n = earliest();
+        step(n);
+        if (done())
+            return n.clockUs;
+    }
+    return UINT64_MAX;
+}
+
+static void runFor(uint64_t us)
+{
+    runUntil(us, [] { return false; });
+}
+
+// A listener's change on unit `i` (HTTP, UDP control); returns the time
+// until every live unit plays the same thing
+static uint64_t change(int i, const RadioCommand &cmd, uint64_t limitUs = 2000000)
+{
+    // Start once every unit has caught up with the last one to finish
+    // (a retune may still be running on another unit's clock)
+    uint64_t latest = 0;
+    for (auto &u : nodes)
+        if (u->alive)
+            latest = std::max(latest, u->clockUs);
+    while (earliest().clockUs < latest)
+        step(earliest());
+    Node &n = *nodes[i];
+    while (&earliest() != &n)
+        step(earliest());
+    uint64_t start = n.clockUs;
+    enter(n);
+    TEST_ASSERT_TRUE(n.controller.apply(cmd, RADIO_SRC_HTTP));
+    leave(n);
+    uint64_t at = runUntil(limitUs, converged);
+    return at == UINT64_MAX ? at : at - start;
+}
+
+static int leaderIndex()
+{
+    for (int i = 0; i < NODES; i++)
+        if (nodes[i]->alive && nodes[i]->group.isLeader())
+            return i;
+    return -1;
+}
+
+static bool agreeOnLeader()
+{
+    int leader = leaderIndex();
+    if (leader < 0)
+        return false;
+    for (auto &n : nodes)
+        if (n->alive && n->group.getLeaderId() != nodes[leader]->group.getNodeId())
+            return false;
+    return true;
+}
+
+static const uint16_t CHANNELS[] = {8870, 9110, 9450, 9650, 9910, 10030, 10270, 10470, 10650, 10790};
+
+// Alternating retunes and volume steps that always change something
+static RadioCommand nextChange(uint32_t k)
+{
+    if (k % 2 == 0)
+        return {RADIO_CMD_TUNE, CHANNELS[(k / 2) % 10]};
+    return {RADIO_CMD_VOLUME, (int32_t)(1 + (k / 2) % 15)};
+}
+
+static void report(const char *name, std::vector<uint64_t> us)
+{
+    std::sort(us.begin(), us.end());
+    char line[128];
+    snprintf(line, sizeof(line), "%s: %u changes, converged p50 %.1f ms, p90 %.1f ms, max %.1f ms", name,
+             (unsigned)us.size(), us[us.size() / 2] / 1000.0, us[us.size() * 9 / 10] / 1000.0, us.back() / 1000.0);
+    TEST_MESSAGE(line);
+}
+
+void setUp()
+{
+    HostUdp::reset();
+    for (int i = 0; i < NODES; i++)
+    {
+        nodes[i].reset(new Node(i + 1));
+        Node &n = *nodes[i];
+        n.card = "/tmp/famio-native-group/" + std::to_string(i);
+        std::filesystem::remove_all(n.card);
+        std::filesystem::create_directories(n.card + PROJECT_ROOT_DIR CONFIG_FILE_PATH);
+        n.clockUs = 1000000 + i * 137; // Units do not boot in lockstep
+
+        enter(n);
+        Wire.setClock(400000);
+        TEST_ASSERT_TRUE(n.files.begin());
+        n.config.begin();
+        n.radio.begin();
+        n.group.begin(BASE_PORT + i);
+        n.group.setEnabled(true);
+        for (int j = 0; j < NODES; j++)
+            if (j != i)
+                n.group.addPeer(IPAddress(127, 0, 0, 1), BASE_PORT + j);
+        leave(n);
+    }
+    // Heartbeats go round and every unit settles on the same leader
+    runFor(3000000);
+}
+
+void tearDown()
+{
+    for (auto &n : nodes)
+        n.reset();
+}
+
+static void test_lowest_node_id_leads()
+{
+    uint32_t lowest = UINT32_MAX;
+    for (auto &n : nodes)
+        lowest = std::min(lowest, n->group.getNodeId());
+
+    int leaders = 0;
+    for (auto &n : nodes)
+    {
+        leaders += n->group.isLeader();
+        TEST_ASSERT_EQUAL_UINT32(lowest, n->group.getLeaderId());
+    }
+    TEST_ASSERT_EQUAL(1, leaders);
+    TEST_ASSERT_TRUE(converged());
+}
+
+// Followers forward their change, the leader sequences it and every unit
+// applies it. A retune costs an STC wait (10-40 ms) on the unit it came
+// from, then on the leader, then on the followers.
+static void test_follower_changes_converge()
+{
+    int leader = leaderIndex();
+    std::vector<uint64_t> tunes, volumes;
+    for (uint32_t k = 0; k < 60; k++)
+    {
+        int from = (leader + 1 + k % (NODES - 1)) % NODES;
+        RadioCommand cmd = nextChange(k);
+        uint64_t took = change(from, cmd);
+        TEST_ASSERT_TRUE_MESSAGE(took != UINT64_MAX, "change never converged");
+        (cmd.type == RADIO_CMD_TUNE ? tunes : volumes).push_back(took);
+    }
+    TEST_ASSERT_EQUAL(leader, leaderIndex());
+    std::sort(volumes.begin(), volumes.end());
+    std::sort(tunes.begin(), tunes.end());
+    // Volume: forward + CMD, a few ms of bus; a retune: three STC waits
+    TEST_ASSERT_LESS_THAN(20000, volumes.back());
+    TEST_ASSERT_LESS_THAN(3 * 60000 + 20000, tunes.back());
+    report("follower volume", volumes);
+    report("follower retune", tunes);
+}
+
+// The leader drops off: the others elect the next lowest id once its
+// heartbeats are GROUP_PEER_TIMEOUT_MS old, and keep replicating. When it
+// comes back with stale settings it leads again but takes the group's state.
+static void test_leader_failover_and_rejoin()
+{
+    int old = leaderIndex();
+    Node &gone = *nodes[old];
+    gone.alive = false;
+
+    uint64_t at = runUntil(10000000, agreeOnLeader);
+    TEST_ASSERT_TRUE(at != UINT64_MAX);
+    uint64_t failover = at - gone.clockUs;
+    TEST_ASSERT_TRUE(failover <= (GROUP_PEER_TIMEOUT_MS + GROUP_HEARTBEAT_MS) * 1000ULL);
+    TEST_ASSERT_TRUE(failover >= (GROUP_PEER_TIMEOUT_MS - GROUP_HEARTBEAT_MS) * 1000ULL);
+    int next = leaderIndex();
+    TEST_ASSERT_TRUE(next != old);
+
+    int follower = (next + 1) % NODES == old ? (next + 2) % NODES : (next + 1) % NODES;
+    TEST_ASSERT_TRUE(change(follower, {RADIO_CMD_TUNE, 10110}) != UINT64_MAX);
+    TEST_ASSERT_TRUE(change(follower, {RADIO_CMD_VOLUME, 4}) != UINT64_MAX);
+
+    // Back after a while, on what it played before it went away
+    runFor(2000000);
+    HostUdp::flush(BASE_PORT + old);
+    uint64_t back = earliest().clockUs;
+    gone.clockUs = back;
+    gone.alive = true;
+    enter(gone);
+    gone.radio.setFrequency(Channel(9000));
+    gone.radio.setVolume(12);
+    leave(gone);
+
+    at = runUntil(5000000, [] { return agreeOnLeader() && converged(); });
+    TEST_ASSERT_TRUE(at != UINT64_MAX);
+    uint64_t rejoin = at - back;
+    TEST_ASSERT_EQUAL(old, leaderIndex());
+    RadioState state = gone.controller.getState();
+    TEST_ASSERT_EQUAL_UINT16(10110, state.channelCode);
+    TEST_ASSERT_EQUAL(4, state.volume);
+
+    char line[96];
+    snprintf(line, sizeof(line), "failover after %.2f s, rejoined leader caught up in %.0f ms", failover / 1e6,
+             rejoin / 1e3);
+    TEST_MESSAGE(line);
+}
+
+// One datagram in five lost: heartbeat resends and forward retries still
+// bring every unit to the same state. The slowest change had its forward
+// lost twice in a row, so allow three retries plus the retunes.
+static void test_twenty_percent_loss()
+{
+    HostUdp::lossPercent = 20;
+    HostUdp::rng = 7;
+    std::vector<uint64_t> took;
+    for (uint32_t k = 0; k < 80; k++)
+    {
+        uint64_t us = change(k % NODES, nextChange(k));
+        TEST_ASSERT_TRUE_MESSAGE(us != UINT64_MAX, "change never converged");
+        took.push_back(us);
+    }
+    std::sort(took.begin(), took.end());
+    TEST_ASSERT_LESS_OR_EQUAL(4 * GROUP_RETRY_MS * 1000, took.back());
+    report("20% loss", took);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lowest_node_id_leads);
+    RUN_TEST(test_follower_changes_converge);
+    RUN_TEST(test_leader_failover_and_rejoin);
+    RUN_TEST(test_twenty_percent_loss);
+    return UNITY_END();
+}
@@ -0,0 +1,112 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <esp_system.h>
+#include "HangDetector.h"
+
+// HangDetector is all static and RTC_NOINIT state lives on across begin()
+// calls in one process, as it does across resets on the device. The tests
+// run in boot order: power-on first, then a wedge and a watchdog reset.
+
+static uint16_t setfreqLabel;
+
+void setUp() {}
+void tearDown() {}
+
+// Power-on: RTC memory is garbage, nothing from "before" is reported
+static void test_power_on_reports_no_previous_run()
+{
+    HostClock::nowUs = 1000000;
+    HostReset::reason = ESP_RST_POWERON;
+    HangDetector::enter(HANG_WIFI_ASSOC);
+    HangDetector::begin();
+    setfreqLabel = HangDetector::label("/api/fm/setfreq");
+
+    JsonDocument doc;
+    HangDetector::report(&doc);
+    TEST_ASSERT_EQUAL_STRING("power_on", doc["reset_reason"].as<const char *>());
+    TEST_ASSERT_TRUE(doc["previous"].isNull());
+    TEST_ASSERT_EQUAL(0, doc["current"]["open"].size());
+}
+
+// Leaving a site after its budget is an SLO miss with an "over" breadcrumb;
+// per-loop sites stay out of the trail when they keep to their budget
+static void test_over_budget_and_trail()
+{
+    HangDetector::enter(HANG_LOOP);
+    delay(10);
+    HangDetector::leave(HANG_LOOP);
+    {
+        HangGuard tune(HANG_FM_TUNE);
+        delay(150);
+    }
+
+    JsonDocument doc;
+    HangDetector::report(&doc);
+    JsonVariant tune = doc["sites"][(size_t)HANG_FM_TUNE];
+    TEST_ASSERT_EQUAL_STRING("fm_tune", tune["site"].as<const char *>());
+    TEST_ASSERT_EQUAL(1, tune["runs"].as<int>());
+    TEST_ASSERT_EQUAL(1, tune["over_budget"].as<int>());
+    TEST_ASSERT_EQUAL(150, tune["max_ms"].as<int>());
+    TEST_ASSERT_EQUAL(0, doc["sites"][(size_t)HANG_LOOP]["over_budget"].as<int>());
+
+    JsonVariant trail = doc["current"]["trail"];
+    TEST_ASSERT_EQUAL(2, trail.size());
+    TEST_ASSERT_EQUAL_STRING("enter", trail[0]["kind"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("over", trail[1]["kind"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("fm_tune", trail[1]["site"].as<const char *>());
+}
+
+// An HTTP handler wedged inside a tune, then the task watchdog resets the
+// unit: the next boot reports both sites open and the breadcrumbs leading
+// there, and starts its own run clean
+static void test_watchdog_reset_keeps_open_sites_and_trail()
+{
+    HangDetector::enter(HANG_HTTP, setfreqLabel);
+    delay(2);
+    HangDetector::enter(HANG_FM_TUNE);
+    uint32_t wedgedAt = millis();
+    delay(HANG_TWDT_TIMEOUT_S * 1000);
+
+    HostReset::reason = ESP_RST_TASK_WDT;
+    HostClock::nowUs = 1000000;
+    HangDetector::begin();
+
+    JsonDocument doc;
+    HangDetector::report(&doc);
+    TEST_ASSERT_EQUAL_STRING("task_wdt", doc["reset_reason"].as<const char *>());
+    JsonVariant previous = doc["previous"];
+    TEST_ASSERT_FALSE(previous.isNull());
+    TEST_ASSERT_EQUAL_STRING("-", previous["cause"].as<const char *>());
+    // No monitor task on the host: the newest stamp stands in for its beat
+    TEST_ASSERT_EQUAL(wedgedAt, previous["last_beat_ms"].as<uint32_t>());
+
+    JsonVariant open = previous["open"];
+    TEST_ASSERT_EQUAL(2, open.size());
+    TEST_ASSERT_EQUAL_STRING("http", open[0]["site"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("/api/fm/setfreq", open[0]["label"].as<const char *>());
+    TEST_ASSERT_EQUAL(2, open[0]["elapsed_ms"].as<int>());
+    TEST_ASSERT_EQUAL_STRING("fm_tune", open[1]["site"].as<const char *>());
+    TEST_ASSERT_EQUAL(0, open[1]["elapsed_ms"].as<int>());
+
+    // Last two breadcrumbs: into the handler, into the tune
+    JsonVariant trail = previous["trail"];
+    size_t n = trail.size();
+    TEST_ASSERT_TRUE(n >= 2);
+    TEST_ASSERT_EQUAL_STRING("http", trail[n - 2]["site"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("enter", trail[n - 2]["kind"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("/api/fm/setfreq", trail[n - 2]["label"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("fm_tune", trail[n - 1]["site"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("enter", trail[n - 1]["kind"].as<const char *>());
+
+    TEST_ASSERT_EQUAL(0, doc["current"]["open"].size());
+    TEST_ASSERT_EQUAL(0, doc["current"]["trail"].size());
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_power_on_reports_no_previous_run);
+    RUN_TEST(test_over_budget_and_trail);
+    RUN_TEST(test_watchdog_reset_keeps_open_sites_and_trail);
+    return UNITY_END();
+}
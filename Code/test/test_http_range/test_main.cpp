@@ -0,0 +1,173 @@
+#include <unity.h>
+#include <filesystem>
+#include <string>
+#include "Constants.h"
+#include "FileManager.h"
+#include "HttpRange.h"
+
+#define CARD "/tmp/famio-native-range"
+#define FILE_SIZE 20000
+
+// What the socket received; stops accepting after `limit` bytes (client gone)
+class ClientSink : public Print
+{
+public:
+    std::string body;
+    size_t limit = SIZE_MAX;
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *data, size_t len) override
+    {
+        size_t n = body.size() + len > limit ? limit - body.size() : len;
+        body.append((const char *)data, n);
+        return n;
+    }
+};
+
+static FileManager *files;
+static std::string content;
+
+// Smaller than the file, so a full response takes several reads
+static uint8_t buffer[4096];
+
+void setUp()
+{
+    HostFs::root = CARD;
+    std::filesystem::remove_all(CARD);
+    std::filesystem::create_directories(CARD PROJECT_ROOT_DIR "/ui");
+    content.clear();
+    for (int i = 0; i < FILE_SIZE; i++)
+        content.push_back((char)(i * 7 + i / 256));
+    FILE *fp = fopen(CARD PROJECT_ROOT_DIR "/ui/big.bin", "wb");
+    fwrite(content.data(), 1, content.size(), fp);
+    fclose(fp);
+    fp = fopen(CARD PROJECT_ROOT_DIR "/ui/empty.txt", "wb");
+    fclose(fp);
+
+    files = new FileManager();
+    TEST_ASSERT_TRUE(files->begin());
+}
+
+void tearDown() { delete files; }
+
+// resolve() and copy() as streamFile() chains them
+static HttpRange stream(const char *header, std::string &body, const char *path = "/ui/big.bin")
+{
+    File file = files->openFile(path);
+    TEST_ASSERT_TRUE((bool)file);
+    HttpRange range = HttpRange::resolve(header, file.size());
+    ClientSink client;
+    if (range.code != 416)
+        TEST_ASSERT_EQUAL(range.length, range.copy(file, client, buffer, sizeof(buffer)));
+    file.close();
+    body = client.body;
+    return range;
+}
+
+static void test_no_range_sends_whole_file()
+{
+    std::string body;
+    HttpRange range = stream(nullptr, body);
+    TEST_ASSERT_EQUAL(200, range.code);
+    TEST_ASSERT_EQUAL_STRING("", range.contentRange);
+    TEST_ASSERT_TRUE(body == content);
+}
+
+static void test_closed_range()
+{
+    std::string body;
+    HttpRange range = stream("bytes=100-4195", body);
+    TEST_ASSERT_EQUAL(206, range.code);
+    TEST_ASSERT_EQUAL_STRING("bytes 100-4195/20000", range.contentRange);
+    TEST_ASSERT_TRUE(body == content.substr(100, 4096));
+
+    range = stream("bytes=19000-", body);
+    TEST_ASSERT_EQUAL(206, range.code);
+    TEST_ASSERT_EQUAL_STRING("bytes 19000-19999/20000", range.contentRange);
+    TEST_ASSERT_TRUE(body == content.substr(19000));
+}
+
+// "bytes=-n": the last n bytes, the whole file when n is larger
+static void test_suffix_range()
+{
+    std::string body;
+    HttpRange range = stream("bytes=-500", body);
+    TEST_ASSERT_EQUAL(206, range.code);
+    TEST_ASSERT_EQUAL_STRING("bytes 19500-19999/20000", range.contentRange);
+    TEST_ASSERT_TRUE(body == content.substr(19500));
+
+    range = stream("bytes=-50000", body);
+    TEST_ASSERT_EQUAL(206, range.code);
+    TEST_ASSERT_EQUAL_STRING("bytes 0-19999/20000", range.contentRange);
+    TEST_ASSERT_TRUE(body == content);
+}
+
+// An end past EOF is cut to the last byte; a start past EOF is 416
+static void test_end_past_eof()
+{
+    std::string body;
+    HttpRange range = stream("bytes=19990-30000", body);
+    TEST_ASSERT_EQUAL(206, range.code);
+    TEST_ASSERT_EQUAL(10, range.length);
+    TEST_ASSERT_EQUAL_STRING("bytes 19990-19999/20000", range.contentRange);
+    TEST_ASSERT_TRUE(body == content.substr(19990));
+
+    range = stream("bytes=20000-20010", body);
+    TEST_ASSERT_EQUAL(416, range.code);
+    TEST_ASSERT_EQUAL_STRING("bytes */20000", range.contentRange);
+    TEST_ASSERT_EQUAL(0, body.size());
+}
+
+static void test_unsatisfiable()
+{
+    std::string body;
+    TEST_ASSERT_EQUAL(416, stream("bytes=-0", body).code);
+    HttpRange range = stream("bytes=0-", body, "/ui/empty.txt");
+    TEST_ASSERT_EQUAL(416, range.code);
+    TEST_ASSERT_EQUAL_STRING("bytes */0", range.contentRange);
+
+    // No Range on an empty file is a plain empty 200
+    range = stream(nullptr, body, "/ui/empty.txt");
+    TEST_ASSERT_EQUAL(200, range.code);
+    TEST_ASSERT_EQUAL(0, range.length);
+}
+
+// Several ranges, other units and bad syntax are not served as ranges:
+// the whole body goes out with 200
+static void test_ignored_headers_send_whole_file()
+{
+    const char *const headers[] = {"bytes=0-1,5-6", "bytes=-5,0-1", "items=0-5", "bytes=5-2", "bytes=abc", "bytes=-x", "bytes="};
+    for (const char *header : headers)
+    {
+        std::string body;
+        HttpRange range = stream(header, body);
+        TEST_ASSERT_EQUAL_MESSAGE(200, range.code, header);
+        TEST_ASSERT_EQUAL_STRING("", range.contentRange);
+        TEST_ASSERT_TRUE_MESSAGE(body == content, header);
+    }
+}
+
+// A client that goes away mid-body ends the copy early
+static void test_client_gone()
+{
+    File file = files->openFile("/ui/big.bin");
+    HttpRange range = HttpRange::resolve("bytes=1000-", file.size());
+    ClientSink client;
+    client.limit = 5000;
+    TEST_ASSERT_EQUAL(5000, range.copy(file, client, buffer, sizeof(buffer)));
+    file.close();
+    TEST_ASSERT_TRUE(client.body == content.substr(1000, 5000));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_range_sends_whole_file);
+    RUN_TEST(test_closed_range);
+    RUN_TEST(test_suffix_range);
+    RUN_TEST(test_end_past_eof);
+    RUN_TEST(test_unsatisfiable);
+    RUN_TEST(test_ignored_headers_send_whole_file);
+    RUN_TEST(test_client_gone);
+    return UNITY_END();
+}
@@ -0,0 +1,199 @@
+#include <unity.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "InputSwitch.h"
+
+// Steps the switch every 10 ms (as loop() does) with the active source
+// ready `readyAfterMs` after it was powered up (`poweredAt`, 0 = not yet);
+// returns the time the switch finished
+static uint32_t runSwitch(InputSwitch &sw, uint32_t now, uint32_t poweredAt, uint32_t readyAfterMs,
+                          int8_t &lastPercent)
+{
+    for (uint32_t end = now + 10000; now < end; now += 10)
+    {
+        bool ready = poweredAt && now - poweredAt >= readyAfterMs;
+        InputSwitchOutput out = sw.update(now, ready);
+        if (out.powerUp >= 0)
+            poweredAt = now;
+        if (out.ampPercent >= 0)
+            lastPercent = out.ampPercent;
+        if (out.finished)
+            return now;
+    }
+    return now;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_switch_fades_out_swaps_muted_and_fades_in()
+{
+    InputSwitch sw(INPUT_FM);
+    TEST_ASSERT_FALSE(sw.request(INPUT_FM, 0)); // Already there
+    TEST_ASSERT_TRUE(sw.request(INPUT_BLUETOOTH, 0));
+
+    int8_t percent = 100;
+    uint32_t swappedAt = 0;
+    uint32_t now = 10;
+    for (; now < 1000 && !swappedAt; now += 10)
+    {
+        InputSwitchOutput out = sw.update(now, false);
+        if (out.ampPercent >= 0)
+            percent = out.ampPercent;
+        if (out.powerDown >= 0)
+        {
+            // Old source off and new one on only once the amp is at 0
+            TEST_ASSERT_EQUAL(0, percent);
+            TEST_ASSERT_EQUAL(INPUT_FM, out.powerDown);
+            TEST_ASSERT_EQUAL(INPUT_BLUETOOTH, out.powerUp);
+            swappedAt = now;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(INPUT_RAMP_MS, swappedAt);
+    TEST_ASSERT_EQUAL(InputSwitch::PHASE_WAIT_READY, sw.getPhase());
+
+    uint32_t done = runSwitch(sw, now, swappedAt, 500, percent);
+    TEST_ASSERT_EQUAL(100, percent);
+    TEST_ASSERT_FALSE(sw.isSwitching());
+    TEST_ASSERT_EQUAL(INPUT_BLUETOOTH, sw.getActive());
+    TEST_ASSERT_EQUAL(1, sw.getStats().switches);
+    TEST_ASSERT_EQUAL(done, sw.getStats().lastLatencyMs);
+    TEST_ASSERT_EQUAL(500, sw.getStats().lastMutedMs);
+    TEST_ASSERT_EQUAL(0, sw.getStats().readyTimeouts);
+}
+
+// A second tap while fading out turns the fade around before anything is
+// powered down
+static void test_double_tap_reverses_fade_out()
+{
+    InputSwitch sw(INPUT_FM);
+    sw.request(INPUT_BLUETOOTH, 0);
+    int8_t percent = 100;
+    for (uint32_t now = 10; now <= 60; now += 10)
+    {
+        InputSwitchOutput out = sw.update(now, true);
+        if (out.ampPercent >= 0)
+            percent = out.ampPercent;
+    }
+    TEST_ASSERT_GREATER_THAN(0, percent);
+    TEST_ASSERT_TRUE(sw.request(INPUT_FM, 60));
+    TEST_ASSERT_EQUAL(InputSwitch::PHASE_FADE_IN, sw.getPhase());
+
+    for (uint32_t now = 70; sw.isSwitching(); now += 10)
+    {
+        InputSwitchOutput out = sw.update(now, true);
+        TEST_ASSERT_EQUAL(-1, out.powerDown);
+        TEST_ASSERT_EQUAL(-1, out.powerUp);
+        if (out.ampPercent >= 0)
+            percent = out.ampPercent;
+    }
+    TEST_ASSERT_EQUAL(100, percent);
+    TEST_ASSERT_EQUAL(INPUT_FM, sw.getActive());
+}
+
+static void test_never_ready_fades_in_after_timeout()
+{
+    InputSwitch sw(INPUT_FM);
+    sw.request(INPUT_BLUETOOTH, 0);
+    int8_t percent = 100;
+    uint32_t done = runSwitch(sw, 10, 0, UINT32_MAX, percent);
+    TEST_ASSERT_EQUAL(1, sw.getStats().readyTimeouts);
+    TEST_ASSERT_EQUAL(100, percent);
+    TEST_ASSERT_GREATER_OR_EQUAL(INPUT_READY_TIMEOUT_MS, done);
+}
+
+// =========================================================
+// 8 h session with stand-in sources
+// =========================================================
+// FM is ready 40-90 ms after power-up, Bluetooth 450-1100 ms. The user
+// flips sources every 5-40 min, one flip in ten is a double tap.
+static void test_eight_hour_session()
+{
+    struct StandIn
+    {
+        uint32_t upMinMs, upMaxMs;
+        float ma;
+        bool powered;
+        uint32_t readyAt;
+    };
+    StandIn sources[INPUT_SOURCE_COUNT] = {{40, 90, INPUT_MA_FM, true, 0},
+                                           {450, 1100, INPUT_MA_BLUETOOTH, false, 0}};
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> gap(5 * 60000, 40 * 60000);
+    InputSwitch sw(INPUT_FM);
+    const uint32_t end = 8 * 3600 * 1000UL;
+    uint32_t nextFlip = 60000;
+    int8_t percent = 100;
+    uint32_t audibleOverlap = 0;
+    double poweredMah = 0;
+    double bothOnMah = 0;
+    std::vector<uint32_t> toFm, toBt;
+
+    for (uint32_t now = 0; now < end; now += 10)
+    {
+        if (now >= nextFlip)
+        {
+            sw.request(sw.getTarget() == INPUT_FM ? INPUT_BLUETOOTH : INPUT_FM, now);
+            nextFlip = rng() % 10 == 0 ? now + 100 : now + gap(rng);
+        }
+
+        const StandIn &active = sources[sw.getActive()];
+        InputSwitchOutput out = sw.update(now, active.powered && now >= active.readyAt);
+        if (out.powerDown >= 0)
+            sources[out.powerDown].powered = false;
+        if (out.powerUp >= 0)
+        {
+            StandIn &s = sources[out.powerUp];
+            s.powered = true;
+            s.readyAt = now + std::uniform_int_distribution<uint32_t>(s.upMinMs, s.upMaxMs)(rng);
+        }
+        if (out.ampPercent >= 0)
+            percent = out.ampPercent;
+        if (out.finished)
+            (sw.getActive() == INPUT_FM ? toFm : toBt).push_back(sw.getStats().lastLatencyMs);
+
+        int on = 0;
+        for (const StandIn &s : sources)
+        {
+            if (s.powered)
+            {
+                poweredMah += s.ma * 10 / 3.6e6;
+                on++;
+            }
+        }
+        bothOnMah += (INPUT_MA_FM + INPUT_MA_BLUETOOTH) * 10 / 3.6e6;
+        if (on > 1 && percent > 0)
+            audibleOverlap++;
+    }
+
+    TEST_ASSERT_GREATER_THAN(10, sw.getStats().switches);
+    TEST_ASSERT_EQUAL(0, sw.getStats().readyTimeouts);
+    TEST_ASSERT_EQUAL(0, audibleOverlap);
+
+    std::sort(toFm.begin(), toFm.end());
+    std::sort(toBt.begin(), toBt.end());
+    // Fade out + power-up + fade in; Bluetooth's slower stack shows
+    TEST_ASSERT_LESS_OR_EQUAL(2 * INPUT_RAMP_MS + 90 + 20, toFm.back());
+    TEST_ASSERT_LESS_OR_EQUAL(2 * INPUT_RAMP_MS + 1100 + 20, toBt.back());
+    TEST_ASSERT_TRUE(poweredMah < bothOnMah * 0.6);
+
+    char line[160];
+    snprintf(line, sizeof(line),
+             "%lu switches; to FM p50 %lu max %lu ms; to BT p50 %lu max %lu ms; %.0f mAh vs %.0f both on (saves %.1f mA)",
+             (unsigned long)sw.getStats().switches, (unsigned long)toFm[toFm.size() / 2], (unsigned long)toFm.back(),
+             (unsigned long)toBt[toBt.size() / 2], (unsigned long)toBt.back(), poweredMah, bothOnMah,
+             (bothOnMah - poweredMah) / 8);
+    TEST_MESSAGE(line);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_switch_fades_out_swaps_muted_and_fades_in);
+    RUN_TEST(test_double_tap_reverses_fade_out);
+    RUN_TEST(test_never_ready_fades_in_after_timeout);
+    RUN_TEST(test_eight_hour_session);
+    return UNITY_END();
+}
@@ -0,0 +1,202 @@
+#include <unity.h>
+#include <random>
+#include <vector>
+#include "ListenStats.h"
+
+static const int16_t UTC_PLUS_7 = 420;
+static const uint32_t JAN_2026 = 1767225600; // 2026-01-01 00:00 UTC
+
+static ListenRecord record(uint32_t start, uint16_t code, uint16_t durationS, uint8_t endReason = LISTEN_END_TUNE)
+{
+    ListenRecord rec = {};
+    rec.start = start;
+    rec.code = code;
+    rec.durationS = durationS;
+    rec.rssiAvg = 40;
+    rec.rssiMin = 30;
+    rec.endReason = endReason;
+    return rec;
+}
+
+// Numbers and seals a record the way ListeningLog does before applying it
+static void append(std::vector<ListenRecord> &log, ListenStats &stats, ListenRecord rec)
+{
+    rec.seq = (uint16_t)stats.nextSeq();
+    rec.crc = ListenStats::recordCrc(rec);
+    log.push_back(rec);
+    stats.apply(rec, UTC_PLUS_7);
+}
+
+// ListeningLog::replay(): records from `from` on, skipping bad ones
+static void replay(ListenStats &stats, const std::vector<ListenRecord> &log, uint32_t from)
+{
+    for (uint32_t seq = from; seq < log.size(); seq++)
+    {
+        const ListenRecord &rec = log[seq];
+        if (rec.seq != (uint16_t)seq || rec.crc != ListenStats::recordCrc(rec))
+            continue;
+        stats.setNextSeq(seq);
+        stats.apply(rec, UTC_PLUS_7);
+    }
+    stats.setNextSeq(log.size());
+}
+
+static bool sameImage(ListenStats &a, ListenStats &b)
+{
+    return memcmp(&a.image(), &b.image(), sizeof(ListenAggregate)) == 0;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_totals_stations_and_days()
+{
+    ListenStats stats;
+    std::vector<ListenRecord> log;
+    // 2026-01-01 23:30 UTC is already Jan 2 at UTC+7
+    append(log, stats, record(JAN_2026 + 23 * 3600 + 1800, 9910, 3600, LISTEN_END_SPLIT));
+    append(log, stats, record(JAN_2026 + 24 * 3600 + 1800, 9910, 600));
+    append(log, stats, record(JAN_2026 + 25 * 3600, LISTEN_CODE_BLUETOOTH, 1200));
+    append(log, stats, record(0, 10270, 300)); // Clock never set
+
+    const ListenAggregate &agg = stats.get();
+    TEST_ASSERT_EQUAL_UINT32(4, agg.sessions);
+    TEST_ASSERT_EQUAL_UINT32(5700, agg.totalSeconds);
+    TEST_ASSERT_EQUAL_UINT32(1200, agg.bluetoothSeconds);
+    TEST_ASSERT_EQUAL_UINT32(300, agg.untimedSeconds);
+
+    const ListenAggregate::Station *top[4];
+    TEST_ASSERT_EQUAL(2, stats.top(top, 4));
+    TEST_ASSERT_EQUAL_UINT16(9910, top[0]->code);
+    TEST_ASSERT_EQUAL_UINT16(1, top[0]->sessions); // The split continues one session
+    TEST_ASSERT_EQUAL_UINT32(4200, top[0]->seconds);
+    TEST_ASSERT_EQUAL_UINT16(10270, top[1]->code);
+
+    uint32_t jan2 = JAN_2026 / 86400 + 1;
+    TEST_ASSERT_EQUAL_UINT32(5400, stats.secondsOn(jan2));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.secondsOn(jan2 - 1));
+    // Its ring slot is reused LISTEN_DAYS later, and the old day reads 0
+    append(log, stats, record(JAN_2026 + LISTEN_DAYS * 86400UL + 86400 + 3600, 9910, 60));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.secondsOn(jan2));
+    TEST_ASSERT_EQUAL_UINT32(60, stats.secondsOn(jan2 + LISTEN_DAYS));
+}
+
+static void test_full_table_takes_over_least_listened()
+{
+    ListenStats stats;
+    std::vector<ListenRecord> log;
+    for (uint16_t i = 0; i < LISTEN_MAX_STATIONS; i++)
+        append(log, stats, record(JAN_2026, 8750 + i * 10, 1000 + i));
+    append(log, stats, record(JAN_2026, 10800, 50));
+
+    TEST_ASSERT_EQUAL_UINT32(1, stats.get().evicted);
+    const ListenAggregate::Station *top[LISTEN_MAX_STATIONS];
+    TEST_ASSERT_EQUAL(LISTEN_MAX_STATIONS, stats.top(top, LISTEN_MAX_STATIONS));
+    for (size_t i = 0; i < LISTEN_MAX_STATIONS; i++)
+        TEST_ASSERT_TRUE(top[i]->code != 8750); // The 1000 s one made room
+    TEST_ASSERT_EQUAL_UINT16(10800, top[LISTEN_MAX_STATIONS - 1]->code);
+}
+
+static void test_load_rejects_damaged_image()
+{
+    ListenStats stats;
+    std::vector<ListenRecord> log;
+    append(log, stats, record(JAN_2026, 9910, 600));
+    ListenAggregate stored = stats.image();
+
+    ListenStats fresh;
+    TEST_ASSERT_TRUE(fresh.load(stored));
+    TEST_ASSERT_EQUAL_UINT32(1, fresh.nextSeq());
+    stored.totalSeconds++;
+    TEST_ASSERT_FALSE(fresh.load(stored));
+}
+
+// =========================================================
+// 400 days with reboots
+// =========================================================
+// 3-8 sessions a day over a Zipf-like mix of 12 presets, one in ten on
+// Bluetooth, long ones split at an hour. At random points the device
+// "reboots": the saved image is loaded into a fresh ListenStats and the
+// records written since are replayed, as ListeningLog::begin() does. The
+// result must equal a rescan of the whole log, and the running totals.
+static void test_catch_up_matches_full_rescan()
+{
+    std::mt19937 rng(49);
+    const uint16_t presets[12] = {9910, 10270, 9450, 8990, 10470, 9750, 10030, 9150, 8850, 10650, 9330, 10120};
+    std::vector<double> weights;
+    for (int i = 0; i < 12; i++)
+        weights.push_back(1.0 / (i + 1));
+    std::discrete_distribution<int> preset(weights.begin(), weights.end());
+
+    ListenStats running;
+    ListenAggregate saved = running.image();
+    std::vector<ListenRecord> log;
+    uint32_t reboots = 0;
+    uint32_t replayedMax = 0;
+
+    for (uint32_t day = 0; day < 400; day++)
+    {
+        uint32_t t = JAN_2026 + day * 86400 + 6 * 3600;
+        int sessions = 3 + rng() % 6;
+        for (int s = 0; s < sessions; s++)
+        {
+            uint16_t code = rng() % 10 == 0 ? LISTEN_CODE_BLUETOOTH : presets[preset(rng)];
+            uint32_t length = 10 + rng() % 5400;
+            while (length > 3600)
+            {
+                append(log, running, record(t, code, 3600, LISTEN_END_SPLIT));
+                t += 3600;
+                length -= 3600;
+            }
+            append(log, running, record(t, code, length));
+            t += length + rng() % 7200;
+        }
+
+        // Saved every few days, as every 8th flush does
+        if (rng() % 3 == 0)
+            saved = running.image();
+
+        if (rng() % 4 == 0)
+        {
+            ListenStats booted;
+            TEST_ASSERT_TRUE(booted.load(saved));
+            uint32_t from = booted.nextSeq();
+            replay(booted, log, from);
+            replayedMax = std::max(replayedMax, (uint32_t)(log.size() - from));
+
+            ListenStats rescan;
+            replay(rescan, log, 0);
+            TEST_ASSERT_TRUE(sameImage(booted, rescan));
+            TEST_ASSERT_TRUE(sameImage(booted, running));
+            reboots++;
+        }
+    }
+
+    // A record written after the last save and damaged on the card is
+    // skipped by the catch-up and by a rescan alike
+    for (int i = 0; i < 5; i++)
+        append(log, running, record(JAN_2026 + 401 * 86400 + i * 600, presets[i], 300));
+    log[log.size() - 3].durationS ^= 1;
+    ListenStats booted;
+    TEST_ASSERT_TRUE(booted.load(saved));
+    replay(booted, log, booted.nextSeq());
+    ListenStats rescan;
+    replay(rescan, log, 0);
+    TEST_ASSERT_TRUE(sameImage(booted, rescan));
+    TEST_ASSERT_EQUAL_UINT32(log.size(), booted.nextSeq());
+
+    char line[128];
+    snprintf(line, sizeof(line), "%u records, %u reboots, catch-up replayed at most %u records",
+             (unsigned)log.size(), (unsigned)reboots, (unsigned)replayedMax);
+    TEST_MESSAGE(line);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_totals_stations_and_days);
+    RUN_TEST(test_full_table_takes_over_least_listened);
+    RUN_TEST(test_load_rejects_damaged_image);
+    RUN_TEST(test_catch_up_matches_full_rescan);
+    return UNITY_END();
+}
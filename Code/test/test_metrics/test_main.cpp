@@ -0,0 +1,71 @@
+#include <unity.h>
+#include <string>
+#include "Metrics.h"
+
+static void append(const char *data, size_t len, void *ctx)
+{
+    static_cast<std::string *>(ctx)->append(data, len);
+}
+
+// Small buffer: the page goes out in many chunks, as on the device
+static std::string scrape()
+{
+    std::string page;
+    char buf[64];
+    Metrics::render(buf, sizeof(buf), append, &page);
+    return page;
+}
+
+static size_t occurrences(const std::string &text, const std::string &what)
+{
+    size_t n = 0;
+    for (size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1))
+        n++;
+    return n;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Series of one family registered apart (as FileManager's function-local
+// statics do on first use) still share one TYPE line and sit together
+static void test_family_rendered_once_and_together()
+{
+    MetricHistogram *load = Metrics::histogram("sd_op_us", "op", "load_json");
+    MetricCounter *errors = Metrics::counter("sd_errors_total");
+    MetricHistogram *tune = Metrics::histogram("fm_tune_us");
+    MetricHistogram *open = Metrics::histogram("sd_op_us", "op", "open");
+    MetricCounter *sent = Metrics::counter("udp_tx_total", "peer", "a");
+    Metrics::counter("sd_errors_total", "kind", "crc");
+    Metrics::counter("udp_tx_total", "peer", "b");
+    Metrics::histogram("sd_op_us", "op", "never_hit");
+    Metrics::record(load, 1200);
+    Metrics::record(tune, 30000);
+    Metrics::record(open, 300);
+    Metrics::inc(errors);
+    Metrics::inc(sent, 3);
+
+    std::string page = scrape();
+    TEST_ASSERT_EQUAL(1, occurrences(page, "# TYPE sd_op_us histogram\n"));
+    TEST_ASSERT_EQUAL(1, occurrences(page, "# TYPE sd_errors_total counter\n"));
+    TEST_ASSERT_EQUAL(1, occurrences(page, "# TYPE udp_tx_total counter\n"));
+    TEST_ASSERT_EQUAL(0, occurrences(page, "never_hit"));
+
+    // No other family between the TYPE line and the family's last series
+    size_t type = page.find("# TYPE sd_op_us histogram");
+    size_t lastSeries = page.rfind("sd_op_us_count{op=\"open\"} 1");
+    TEST_ASSERT_TRUE(lastSeries != std::string::npos);
+    TEST_ASSERT_TRUE(type < page.find("sd_op_us_count{op=\"load_json\"} 1"));
+    TEST_ASSERT_EQUAL(std::string::npos, page.substr(type, lastSeries - type).find("fm_tune_us"));
+
+    size_t errorsType = page.find("# TYPE sd_errors_total counter");
+    TEST_ASSERT_TRUE(page.find("sd_errors_total{kind=\"crc\"} 0") < page.find("# TYPE udp_tx_total"));
+    TEST_ASSERT_TRUE(errorsType < page.find("sd_errors_total 1"));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_family_rendered_once_and_together);
+    return UNITY_END();
+}
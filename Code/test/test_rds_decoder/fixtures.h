@@ -0,0 +1,635 @@
+// Generated by make_fixtures.py, do not edit
+// <ms> <A> <B> <C> <D> <BLER A-D>
+
+static const char RDS_STRONG[] = R"(
+0 3201 0140 E0CD 564F 0000
+87 3201 0141 E0CD 5620 0000
+175 3201 0142 E0CD 4754 0010
+262 3201 0143 E0CD 2020 0000
+350 3201 2140 4E68 6163 0000
+438 3201 2141 2056 6965 0000
+525 3201 2142 7560 6D6F 0220
+613 3201 2143 6920 6E67 0001
+700 3201 0140 E0CD 564F 0000
+788 3201 0141 E0CD 5620 0100
+876 3201 0142 E0CD 4754 0000
+963 99ED 0143 E0CD 2020 3000
+1051 3201 2144 6179 0D20 0000
+1138 3201 2140 4E68 6163 0000
+1226 3201 2141 2056 6965 0000
+1313 3201 2142 7420 6D6F 0000
+1401 3201 0140 E0CD 564F 0000
+1489 3201 0141 E0CD 5620 0000
+1576 3201 0142 E0CD 4754 0000
+1664 3201 0143 E0CD 2020 0000
+1751 3201 2143 6920 6E67 0000
+1839 3201 2144 6179 0D20 0000
+1927 3201 2140 4E68 6163 0100
+2014 3201 2141 2056 6965 0000
+2102 3201 0140 E0CD 564F 0000
+2189 3201 0141 E0CD 5620 0000
+2277 3201 0142 E0CD 4754 0000
+2365 3201 0143 E0CD 2020 0000
+2452 3201 2142 7420 6D6F 0000
+2540 3201 2143 6920 6E67 0000
+2627 3201 2144 6179 0D20 0000
+2715 3201 2140 4E68 6163 0000
+2803 3201 0140 E0CD 564F 0000
+2890 3201 0141 E0CD 5620 0000
+2978 3201 0142 E0CD 4754 0000
+3065 3201 0143 CBF8 D1C7 0033
+3153 1F9C 2141 2056 6965 3000
+3241 3201 2142 7420 6D6F 0000
+3328 3201 2143 6920 6E67 0000
+3416 3201 2144 6179 0D20 0000
+3503 3201 0140 E0CD 564F 0000
+3591 3201 0141 E0CD 5620 0000
+3679 3201 0142 E0CD 4754 0000
+3766 3201 0143 E0CD 2020 0000
+3854 3201 2140 4E68 6163 0000
+3941 3201 2141 2056 6965 0000
+4029 3201 2142 7420 6D6F 0000
+4117 3201 2143 6920 6E67 0000
+4204 3201 0140 E0CD 564F 0000
+4292 3201 0141 E0CD 5620 0000
+4379 3201 0142 E0CD 4754 0000
+4467 3201 0143 E0CD 2020 0000
+4555 3201 2144 6179 0D20 0000
+4642 3201 2140 4E68 6163 0000
+4730 3201 2141 2056 6965 0000
+4818 3201 2142 7420 6D6F 0000
+4905 3201 4141 DC4E 678E 0001
+4993 3201 0140 E0CD 564F 0000
+5080 3201 0141 E0CD 5620 1000
+5168 3201 0142 E0CD 4754 0000
+5256 3201 0143 E0CD 2020 0000
+5343 3201 2143 6920 6E67 0000
+5431 3201 2144 6179 0D20 0000
+5518 3201 2140 4E68 6163 0000
+5606 3201 2141 2056 6965 0000
+5694 3201 0140 E0CD 564F 0000
+5781 3201 0141 E0CD 5620 0000
+5869 3201 0142 E0CD 4754 0000
+5956 3201 0143 E0CD 2020 0010
+)";
+
+static const char RDS_WEAK[] = R"(
+0 3201 0140 CF72 75D0 0133
+87 35D3 0141 E0CD 5620 3100
+175 3201 0142 E0CD 4754 0001
+262 3201 0143 E0CD 2020 0100
+350 3201 2140 4E68 6163 0110
+438 3201 2141 2056 6965 0010
+525 3201 2142 7420 6D6F 0000
+613 3201 2143 ACF7 6E67 0031
+700 3201 0140 E0CD 564F 0111
+788 3201 0141 E0CD 5620 0100
+876 3201 0142 E0CD 4754 0100
+963 3201 0143 E0CD 2828 1002
+1051 C8BF 2144 6179 0D20 3001
+1138 3201 2140 4E68 6163 0000
+1226 3201 2141 2056 6965 0000
+1313 3201 2142 7420 6D6F 0100
+1401 3201 0140 E0CD 564F 0000
+1489 3201 0141 E0CD 5620 0001
+1576 3201 0142 E0CD 4754 0000
+1664 3201 0143 E0CD 2020 0001
+1751 3201 2143 6920 6E67 0001
+1839 3201 2144 6179 0D20 0001
+1927 3201 2140 4E68 6163 0000
+2014 8043 2141 551F 6965 3230
+2102 3201 0140 E0CD 564F 0000
+2189 3201 0141 E0CD 5620 0000
+2277 3201 0142 E0CD 4754 0001
+2365 3201 0143 E0CD 2020 0100
+2452 3201 2142 7420 6D6F 0000
+2540 3201 2143 6920 6E67 0000
+2627 3201 2144 6179 0D20 1000
+2715 3201 2140 4E68 6163 0010
+2803 3201 CF03 E0CD 564F 0300
+2890 3201 0141 E0CD 5620 0000
+2978 3201 0142 E0CD 4754 0000
+3065 3201 0143 E0CD 2020 0000
+3153 3201 2141 2056 6965 0000
+3241 3201 2142 7420 6DEE 1112
+3328 CCD3 3DE1 6408 1651 3333
+3416 7C4E 99A1 22FE 0D20 3331
+3503 3201 0140 E0CD 564F 1000
+3591 3201 0141 E0CD 5620 0000
+3679 3201 0142 E0CD 4754 0100
+3766 3201 0143 E0CD 2020 1000
+3854 3201 2140 4E68 6163 0001
+3941 3201 2141 2056 6965 0000
+4029 3201 2142 7420 6D6F 0000
+4117 3201 2143 6920 6E67 0100
+4204 3201 0140 E0CD 564F 0000
+4292 3201 0141 E0CD 5620 0000
+4379 3201 0142 E0CD CA35 0003
+4467 4256 6C32 E0CD 2020 3300
+4555 3201 2144 6179 0D20 1110
+4642 3201 2140 4E68 6163 0000
+4730 3201 2141 2056 6965 0000
+4818 3201 2142 7420 6D6F 0100
+4905 3201 E91D 85A2 678E 0330
+4993 3201 0140 E0CD 564F 0010
+5080 3201 0141 E0CD 5620 0000
+5168 3201 0142 B141 496B 0033
+5256 F758 0143 E0CD 2020 3111
+5343 3201 2143 6920 6E67 1001
+5431 3201 2144 6179 C16B 0003
+5518 3201 2140 4E68 6163 2100
+5606 3201 2141 2056 6965 0000
+5694 3201 0140 E0CD 564F 0000
+5781 3201 0141 E0CD 5620 0100
+5869 3201 0142 E0CD 4754 0000
+5956 3201 0143 E0CD 2020 0100
+6044 3201 2142 7420 6D6F 0000
+6132 3201 2143 6920 6E67 1001
+6219 3201 2144 6179 0D20 0000
+6307 3201 2140 4E68 6163 0000
+6394 3201 0140 E0CD 564F 1001
+6482 3201 0141 E0CD 5620 0000
+6570 3201 0142 E0CD 4754 0001
+6657 3201 0143 E0CD 2020 0011
+6745 3201 2141 2056 8873 0003
+6832 3201 2142 7420 6D6F 0001
+6920 3201 2143 26A3 6F66 0032
+7008 9853 CC14 BE14 18BD 3333
+7095 1B19 53E5 4602 534F 3332
+7183 7FB6 0141 E0CD 5620 3200
+7270 3201 0142 E0CD 4754 0000
+7358 3201 0143 E0CD 2020 0000
+7446 3201 2140 4E68 6163 0001
+7533 3201 2141 4F5A 6965 1032
+7621 3201 2142 7420 6D6F 0000
+7708 3201 2143 6920 6E67 1000
+7796 1E08 0944 E0CD 2F5D 3223
+7884 3201 0141 E0CD 5620 1011
+7971 3201 0142 E0CD 4754 0001
+8059 3201 0143 78D1 2020 0030
+8146 3201 2144 6179 0D20 0000
+8234 3201 2140 4E68 6163 0000
+8322 3201 2141 2056 6965 0010
+8409 3201 2142 7420 6D6F 0000
+8497 3201 0140 E0CD 564F 0000
+8584 73C9 0141 E0CD 5620 3000
+8672 3201 0142 E0CD 4754 0110
+8760 3201 0143 E0CD 2020 0220
+8847 3201 2143 1ABC 6E67 0030
+8935 3201 2144 6179 0D20 0001
+9022 3201 2140 4E68 6163 0001
+9110 3201 2141 2056 6965 0000
+9198 3201 0140 E0CD 564F 0000
+9285 3201 0141 E0CD 5620 0001
+9373 3201 0142 E0CD 4754 1010
+9460 3201 0143 E0CD 9750 0103
+9548 CCE5 614A 5CB5 507A 3233
+9636 38B8 2143 6920 6E67 3000
+9723 3201 2144 6179 0D20 1001
+9811 3201 2140 4E68 6163 0000
+9898 3201 4141 DC4E 678E 0000
+9986 3201 0140 E0CD 564F 0100
+10074 3201 0141 E0CD 5620 0010
+10161 3201 0142 8141 CF01 0033
+10249 3201 0143 4E11 8AF8 2233
+10336 5DE6 7639 B596 4EEC 3333
+10424 9331 A598 7C21 6D6F 3322
+10512 BCF5 518D 6920 81F8 3323
+10599 3201 2144 6179 0D20 2002
+10687 7A87 47BD E0CD 5ACE 3323
+10774 1209 7A3E 8AC3 D630 2332
+10862 4CE2 BAD5 E0CD 4754 3300
+10950 3201 0143 E0CD 2020 0000
+11037 3201 2140 4E68 6163 0010
+11125 3201 2141 2056 6965 2001
+11212 3201 2142 7420 6D6F 0000
+11300 3201 2143 6920 6E67 0100
+11388 3201 0140 E0CD 564F 0000
+11475 3201 815A EDA9 68A9 1333
+11563 3201 8F4F 9AD8 0305 2333
+11650 3201 0143 E0CD 2020 2000
+11738 3201 2144 6179 0D20 1100
+11826 3201 2140 4E68 6163 1000
+11913 3201 2141 2056 6965 0100
+12001 3201 2142 7420 6D6F 0001
+12088 3201 0140 E0CD 564F 0000
+12176 3201 0141 E0CD 5620 0100
+12264 3201 0142 E0CD 4754 0101
+12351 3201 0143 E0CD 2020 0000
+12439 3201 2143 6920 6E67 0001
+12526 3201 A161 6179 0D20 2311
+12614 3201 2140 4E68 6163 0000
+12702 3201 2141 2056 6965 0000
+12789 3201 0140 E0CD 564F 0001
+12877 3201 0141 E0CD 5620 0000
+12964 3201 0142 E0CD 4754 0000
+13052 3201 0143 E0CD 2020 0001
+13140 3201 2142 7420 6D6F 0000
+13227 3201 2143 6920 6E67 0010
+13315 3201 2144 6179 0D20 0112
+13402 FDC0 2935 F093 6163 3332
+13490 3201 2C13 E0CD 7457 2323
+13578 3201 0141 4CE0 5620 2232
+13665 4CF6 0142 E0CD 4754 3001
+13753 3201 0143 E0CD 2020 0000
+13840 3201 2141 2056 6965 1010
+13928 3201 2142 7420 6D6F 0000
+14016 3201 2143 6920 6E67 0000
+14103 3201 2144 6179 0D20 0010
+14191 3201 0140 E0CD 564F 0001
+14278 3201 0141 E0CD 5620 0000
+14366 3201 0142 E0CD 4754 0000
+14454 3201 0143 E0CD 2020 1000
+14541 3201 2140 4E68 6163 0100
+14629 3201 2141 2056 6965 0100
+14716 3201 2142 7420 6D6F 0001
+14804 3201 2143 6920 6E67 0000
+14892 3201 4141 DC4E 93E5 0123
+14979 3201 0140 E0CD 564F 2010
+15067 3201 0141 E0CD 5620 0000
+15154 3201 0142 E0CD 4754 0011
+15242 3201 0143 E0CD 2020 0002
+15330 277D 254C 6179 2E55 3223
+15417 3201 496E 0294 6163 2330
+15505 3201 2141 2056 6965 1110
+15592 3201 2142 7420 6D6F 0000
+15680 3201 0140 E0CD 564F 0001
+15768 3201 0141 E0CD 5620 0000
+15855 3201 0142 E0CD 4754 0000
+15943 3201 0143 E0CD 2020 1011
+16030 3201 2143 6920 6E67 1010
+16118 3201 2144 6179 0D20 1000
+16206 3201 2140 4E68 6163 0100
+16293 3201 2141 729C C61C 0033
+16381 3934 D952 26B7 564F 3331
+16468 3201 0141 E0CD 5620 0000
+16556 3201 0142 E0CD 4754 0000
+16644 3201 0143 E0CD 2020 0100
+16731 3201 2142 7420 6D6F 1010
+16819 3201 2143 6920 6E67 0000
+16906 3201 2144 6179 0D20 0110
+16994 3201 2140 9B39 4196 0033
+17082 3201 0140 E0CD 564F 0010
+17169 3201 0141 E0CD 5620 0000
+17257 3201 0142 E0CD 4754 0001
+17344 3201 0143 E0CD 2020 0010
+17432 3201 2141 2056 6965 0000
+17520 3201 2142 7420 6D6F 0000
+17607 3201 2143 6920 6E67 0010
+17695 3201 2144 6179 0D20 0100
+17782 3201 0140 E0CD 564F 0000
+17870 3201 0141 E0CD 5620 1000
+17958 3201 0142 E0CD 4754 0010
+18045 3201 0143 E0CD 2020 0000
+18133 3201 2140 4E68 6163 1000
+18220 3201 2141 2056 6965 0000
+18308 3201 2142 7420 6D6F 0100
+18396 3201 2143 6920 6E67 0010
+18483 3201 0140 E0CD 0923 0003
+18571 3201 0141 E0CD FE6B 2223
+18658 2169 0142 F0ED 4754 3222
+18746 3201 0143 E0CD 2020 2100
+18834 3201 2144 6179 0D20 1000
+18921 3201 2140 4E68 6163 0101
+19009 3201 33E1 2056 6965 0311
+19096 3201 2142 7420 6D6F 1100
+19184 3201 0140 E0CD 564F 0000
+19272 3201 0141 E0CD 5620 0100
+19359 3201 0142 E0CD 4754 0000
+19447 3201 0143 E0CD 2020 0000
+19534 3201 2143 6920 6E67 0110
+19622 3201 2144 6179 0D20 0000
+19709 3201 2140 4E68 6163 0000
+19797 3201 2141 2056 6965 0100
+19885 3201 4141 DC4E 678E 0000
+19972 6BE2 CE31 F1CD 3FA0 3323
+)";
+
+static const char RDS_PI_CHANGE[] = R"(
+0 3201 0140 E0CD 564F 0000
+87 3201 0141 E0CD 5620 0000
+175 3201 0142 E0CD 4754 0000
+262 3201 0143 E0CD 2020 0000
+350 3201 2140 4E68 6163 0000
+438 3201 2141 2056 6965 0000
+525 3201 2142 7420 6D6F 0000
+613 3201 2143 6920 6E67 0000
+700 3201 0140 E0CD 564F 0000
+788 3201 0141 E0CD 5620 0000
+876 3201 0142 E0CD 4754 0000
+963 3201 0143 E0CD 2020 0000
+1051 3201 2144 6179 1F1B 0003
+1138 3201 2140 4E68 6163 0000
+1226 3201 2141 2056 6965 0000
+1313 3201 2142 7420 6D6F 0000
+1401 3201 0140 E0CD 564F 0000
+1489 3201 0141 E0CD 5620 0000
+1576 3201 0142 E0CD 4754 0000
+1664 3201 0143 E0CD 2020 0000
+1751 3201 2143 6920 6E67 0000
+1839 3201 2144 6179 0D20 0000
+1927 3201 2140 4E68 6163 0000
+2014 3201 2141 2056 6965 0000
+2102 3201 0140 E0CD 564F 0000
+2189 3201 0141 E0CD 5620 0000
+2277 3201 0142 E0CD 4754 0000
+2365 3201 0143 E0CD 2020 0000
+2452 3201 2142 7420 6D6F 0000
+2540 3201 2143 6920 6E67 0000
+2627 3201 2144 6179 0D20 1000
+2715 3201 2140 4E68 6163 0000
+2803 3201 0140 E0CD 564F 0000
+2890 3201 0141 E0CD 5620 0000
+2978 3201 0142 E0CD 4754 0100
+3065 3201 0143 E0CD 2020 0000
+3153 3201 2141 2056 6965 0000
+3241 3201 2142 7420 6D6F 0000
+3328 3201 2143 6920 6E67 0000
+3416 3201 2144 6179 0D20 0001
+3503 3201 0140 E0CD 564F 0000
+3591 3201 0141 E0CD 5620 0000
+3679 3201 0142 E0CD 4754 0000
+3766 3201 0143 E0CD 2020 0000
+3854 3201 2140 4E68 6163 0000
+3941 3201 2141 2056 6965 0000
+4029 3202 00A0 E0CD 564F 0000
+4117 3202 00A1 E0CD 5631 0000
+4204 3202 00A2 E0CD 2020 0000
+4292 3202 00A3 E0CD 2020 0000
+4379 3202 20A0 5468 6F69 0000
+4467 3202 20A1 2073 750D 0000
+4555 3202 20A0 5468 6F69 0000
+4642 3202 20A1 2073 750D 0000
+4730 3202 00A0 E0CD 564F 0000
+4818 3202 00A1 E0CD 5631 0000
+4905 3202 00A2 E0CD 2020 0000
+4993 3202 00A3 E0CD 2020 0000
+5080 3202 20A0 5468 6F69 0000
+5168 3202 20A1 2073 750D 0000
+5256 3202 20A0 5468 6F69 0000
+5343 3202 20A1 2073 750D 0000
+5431 3202 00A0 E0CD 564F 0000
+5518 3202 00A1 E0CD 5631 0000
+5606 3202 00A2 E0CD 2020 0000
+5694 3202 00A3 E0CD 2020 0000
+5781 3202 20A0 5468 6F69 0000
+5869 3202 20A1 2073 750D 0010
+5956 3202 20A0 5468 6F69 0001
+6044 3202 20A1 2073 750D 0000
+6132 3202 00A0 E0CD 564F 0000
+6219 3202 00A1 E0CD 5631 0000
+6307 3202 00A2 E0CD 2020 0000
+6394 3202 00A3 E0CD 2020 0000
+6482 3202 20A0 5468 6F69 0000
+6570 3202 20A1 2073 750D 0000
+6657 3202 20A0 5468 6F69 0000
+6745 3202 20A1 2073 750D 0000
+6832 3202 00A0 E0CD 564F 0000
+6920 3202 00A1 E0CD 5631 0000
+7008 3202 00A2 E0CD 2020 0000
+7095 3202 00A3 E0CD 2020 0000
+7183 3202 20A0 5468 6F69 0000
+7270 3202 20A1 2073 750D 0000
+7358 3202 20A0 5468 6F69 0000
+7446 3202 20A1 2073 750D 0000
+7533 3202 00A0 E0CD 564F 0000
+7621 3202 00A1 E0CD 5631 0001
+7708 3202 00A2 E0CD 2020 0000
+7796 3202 00A3 E0CD 2020 0000
+7884 3202 20A0 5468 6F69 0000
+7971 3202 20A1 2073 750D 0000
+8059 3202 20A0 5468 6F69 0000
+8146 3202 20A1 2073 750D 0010
+8234 3202 00A0 E0CD 564F 0000
+8322 3202 00A1 E0CD 5631 0000
+8409 3202 00A2 E0CD 2020 0000
+8497 3202 00A3 E0CD 2020 1000
+8584 3202 20A0 5468 6F69 0000
+8672 3202 20A1 2073 750D 0000
+8760 3202 20A0 5468 6F69 0000
+8847 3202 20A1 2073 750D 0000
+8935 3202 40A1 DC4E 678E 0000
+9022 3202 00A0 E0CD 564F 0000
+9110 3202 00A1 E0CD 5631 0000
+9198 3202 00A2 E0CD 2020 0100
+9285 3202 00A3 E0CD 2020 0100
+9373 3202 20A0 5468 6F69 0000
+9460 3202 20A1 2073 750D 0000
+9548 3202 20A0 5468 6F69 0000
+9636 3202 20A1 C9CF 750D 0030
+9723 3202 00A0 E0CD 564F 0000
+9811 3202 00A1 E0CD 5631 0000
+9898 3202 00A2 E0CD 2020 0000
+9986 3202 00A3 E0CD 2020 0000
+10074 3202 20A0 5468 6F69 0000
+10161 3202 20A1 2073 750D 0000
+10249 3202 20A0 5468 6F69 0000
+10336 3202 20A1 2073 750D 0100
+10424 3202 00A0 E0CD 564F 0000
+10512 3202 00A1 E0CD 5631 0000
+10599 3202 00A2 E0CD 2020 0000
+10687 3202 00A3 E0CD 2020 0000
+10774 3202 20A0 5468 6F69 0000
+10862 3202 20A1 2073 750D 0000
+10950 3202 20A0 5468 6F69 0000
+11037 3202 20A1 2073 750D 0000
+11125 3202 00A0 E0CD 564F 0000
+11212 3202 00A1 E0CD 5631 0000
+11300 3202 00A2 E0CD 2020 0000
+11388 3202 00A3 E0CD 2020 0000
+11475 3202 20A0 5468 6F69 1000
+11563 3202 20A1 2073 750D 0000
+11650 3202 20A0 5468 6F69 0000
+11738 3202 20A1 2073 750D 0000
+11826 3202 00A0 E0CD 564F 0000
+11913 3202 00A1 E0CD 5631 0000
+12001 3202 00A2 E0CD 2020 0000
+)";
+
+static const char RDS_RT_TOGGLE[] = R"(
+0 3201 0140 E0CD 564F 1010
+87 3201 0141 E0CD 5620 0000
+175 3201 0142 E0CD 4754 0000
+262 3201 0143 E0CD 2020 0000
+350 3201 2140 4B65 7420 0000
+438 3201 2141 7865 2074 0000
+525 3201 2142 7265 6E20 0000
+613 3201 2143 6361 7520 0000
+700 3201 0140 E0CD 564F 0000
+788 3201 0141 E0CD 5620 0000
+876 3201 0142 E0CD 4754 0000
+963 3201 0143 E0CD 2020 0100
+1051 3201 2144 5361 6920 0000
+1138 3201 2145 476F 6E0D 0000
+1226 3201 2140 4B65 7420 0000
+1313 3201 2141 7865 2074 0000
+1401 3201 0140 E0CD 564F 0000
+1489 3201 0D41 67DD 3BC9 0233
+1576 B523 0142 EB6E 4754 3230
+1664 3201 0143 E0CD 2020 0000
+1751 3201 2142 7265 6E20 0000
+1839 3201 2143 6361 7520 0000
+1927 3201 2144 5361 6920 0000
+2014 3201 2145 476F 6E0D 0000
+2102 3201 0140 E0CD 564F 0000
+2189 3201 0141 E0CD 5620 0000
+2277 3201 0142 E0CD 4754 0000
+2365 3201 0143 E0CD 2020 0000
+2452 3201 2140 4B65 7420 0000
+2540 3201 2141 7865 2074 0000
+2627 3201 2142 7265 6E20 0000
+2715 3201 2143 6361 7520 0000
+2803 3201 0140 E0CD 564F 0000
+2890 3201 0141 E0CD 5620 0000
+2978 3201 0142 E0CD 4754 0000
+3065 3201 0143 E0CD 2020 0000
+3153 3201 2144 5361 6920 0000
+3241 3201 2145 476F 6E0D 0010
+3328 3201 2140 4B65 7420 0000
+3416 3201 2141 7865 2074 0000
+3503 3201 0140 E0CD 564F 0000
+3591 3201 0141 E0CD 5620 0000
+3679 3201 0142 E0CD 4754 0000
+3766 3201 0143 E0CD 2020 0000
+3854 3201 2142 7265 6E20 0000
+3941 3201 2143 6361 7520 0000
+4029 3201 2144 5361 6920 0000
+4117 3201 2145 476F 6E0D 0000
+4204 3201 0140 E0CD 564F 0000
+4292 3201 0141 E0CD 5620 0000
+4379 3201 0142 E0CD 4754 0000
+4467 3201 0143 E0CD 2020 0000
+4555 3201 2140 4B65 7420 0001
+4642 3201 2141 7865 2074 0000
+4730 3201 2142 7265 6E20 0000
+4818 3201 2143 6361 7520 0000
+4905 3201 4141 DC4E 678E 0000
+4993 3201 0140 E0CD 564F 0000
+5080 3201 0141 E0CD 5620 1000
+5168 3201 0142 E0CD 4754 0100
+5256 3201 0143 E0CD 2020 0000
+5343 3201 2144 5361 6920 0000
+5431 3201 2145 476F 6E0D 0000
+5518 3201 2140 4B65 7420 0000
+5606 5F67 2141 7865 2074 3000
+5694 3201 0140 E0CD 564F 0000
+5781 3201 0141 E0CD 5620 0000
+5869 3201 0142 E0CD 4754 0000
+5956 3201 0143 E0CD 2020 0000
+6044 3201 2142 7265 6E20 0000
+6132 3201 2143 6361 7520 0000
+6219 3201 2144 5361 6920 0000
+6307 3201 2145 476F 6E0D 0000
+6394 3201 0140 E0CD 564F 0000
+6482 3201 0141 E0CD 5620 0000
+6570 3201 0142 E0CD 4754 0000
+6657 3201 0143 E0CD 2020 0000
+6745 3201 2140 4B65 7420 0000
+6832 3201 2141 7865 2074 0000
+6920 3201 2142 7265 6E20 0000
+7008 3201 2143 6361 7520 0000
+7095 3201 0140 E0CD C5BF 0003
+7183 3201 0141 E0CD 5620 0000
+7270 3201 0142 E0CD 4754 0000
+7358 3201 0143 E0CD 2020 0000
+7446 3201 2144 5361 6920 0000
+7533 3201 2145 476F 6E0D 0000
+7621 3201 2140 4B65 7420 0010
+7708 3201 2141 7865 2074 0000
+7796 3201 0140 E0CD 564F 0000
+7884 3201 0141 E0CD 5620 0000
+7971 3201 0142 E0CD 4754 0000
+8059 3201 0140 E0CD 564F 0000
+8146 3201 0141 E0CD 5620 0000
+8234 3201 0142 E0CD 4754 0000
+8322 3201 0143 E0CD 2020 0000
+8409 3201 2150 4475 6F6E 0000
+8497 3201 2151 6720 7468 0010
+8584 3201 2152 6F6E 6720 0000
+8672 3201 2153 7468 6F61 0000
+8760 3201 0140 E0CD 564F 0000
+8847 E655 0141 E0CD 5620 3000
+8935 3201 0142 E0CD 4754 0100
+9022 3201 0143 E0CD 2020 0000
+9110 3201 2154 6E67 0D20 0000
+9198 3201 2150 4475 6F6E 0000
+9285 3201 2151 6720 7468 0000
+9373 3201 2152 6F6E 6720 0000
+9460 3201 0140 E0CD 564F 0000
+9548 3201 0141 E0CD 5620 0000
+9636 3201 0142 E0CD 4754 0000
+9723 3201 0143 E0CD 2020 0000
+9811 3201 2153 7468 6F61 0000
+9898 3201 2154 6E67 0D20 0000
+9986 3201 2150 4475 6F6E 0000
+10074 3201 2151 6720 7468 0000
+10161 3201 0140 E0CD 564F 0000
+10249 3201 0141 E0CD 5620 0000
+10336 3201 0142 E0CD 4754 0000
+10424 3201 0143 E0CD 2020 0000
+10512 3201 2152 6F6E 6720 0000
+10599 3201 2153 7468 6F61 0000
+10687 3201 2154 6E67 0D20 0000
+10774 3201 2150 4475 6F6E 0000
+10862 3201 0140 E0CD 564F 0000
+10950 3201 0141 E0CD 5620 0000
+11037 3201 0142 E0CD 4754 0000
+11125 3201 0143 E44D 68A6 0023
+11212 3201 4A6E 6720 7468 2320
+11300 3201 2152 6F6E 6720 0000
+11388 3201 2153 7468 6F61 0000
+11475 3201 2154 6E67 0D20 0000
+11563 3201 0140 E0CD 564F 0000
+11650 3201 0141 E0CD 5620 0000
+11738 3201 0142 E0CD 4754 0000
+11826 3201 0143 E0CD 2020 0000
+11913 3201 2150 4475 6F6E 0000
+12001 3201 2151 6720 7468 0000
+12088 3201 98D2 6F6E 6720 2300
+12176 3201 2153 7468 6F61 0001
+12264 3201 0140 E0CD 564F 0000
+12351 3201 0141 E0CD 5620 0000
+12439 3201 0142 E0CD 4754 0000
+12526 3201 0143 E0CD 2020 0000
+12614 3201 2154 6E67 0D20 0000
+12702 3201 2150 4475 6F6E 0000
+12789 3201 2151 6720 7468 0000
+12877 3201 2152 6F6E 6720 0010
+12964 3201 4141 DC4E 678E 0000
+13052 3201 0140 E0CD 564F 0000
+13140 3201 0141 E0CD 5620 0000
+13227 3201 0142 E0CD 4754 0000
+13315 3201 0143 E0CD 2020 0000
+13402 3201 2153 7468 6F61 0000
+13490 3201 2154 6E67 0D20 0000
+13578 3201 2150 4475 6F6E 0000
+13665 3201 2151 6720 7468 1000
+13753 3201 0140 E0CD 564F 0000
+13840 3201 0141 E0CD 5620 0000
+13928 3201 0142 E0CD 4754 0000
+14016 3201 0143 E0CD 2020 0000
+14103 3201 2152 6F6E 6720 0000
+14191 3201 2153 7468 6F61 0000
+14278 3201 2154 6E67 0D20 0000
+14366 3201 2150 4475 6F6E 0000
+14454 3201 0140 E0CD 564F 1000
+14541 3201 0141 E0CD 5620 0000
+14629 3201 0142 E0CD 4754 0000
+14716 3201 0143 E0CD 2020 0000
+14804 3201 2151 6720 7468 0000
+14892 3201 2152 6F6E 6720 0001
+14979 02CD 2153 7468 6F61 3000
+15067 3201 2154 6E67 0D20 0000
+15154 3201 0140 E0CD 564F 0000
+15242 3201 0141 E0CD 5620 0000
+15330 3201 0142 E0CD 4754 0000
+15417 3201 0143 E0CD 2020 0000
+15505 3201 2150 4475 6F6E 0100
+15592 3201 2151 6720 7468 0000
+15680 3201 2152 6F6E 6720 0000
+15768 3201 2153 7468 6F61 0000
+15855 3201 0140 E0CD 564F 0100
+15943 3201 0141 E0CD 5620 0000
+16030 3201 0142 E0CD 4754 0000
+)";
+
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Regenerate fixtures.h: RDS group streams for test_rds_decoder.
+
+Each line is one group as the tuner hands it over:
+    <ms since tune> <block A> <B> <C> <D> <BLER A><BLER B><BLER C><BLER D>
+(hex blocks, BLER 0-3 as in RDA5807 0x0B/0x0F). Real captures in the same
+format can be pasted in as extra fixtures.
+
+The broadcast side follows a common encoder schedule (PS 0A x4, RadioText
+2A x4, 4A clock every 7 cycles, 87.6 ms per group). Reception goes through
+a Gilbert-Elliott burst channel; BLER 2 blocks are sometimes miscorrected
+(two flipped bits) and BLER 3 blocks carry garbage, like the chip does.
+
+Usage: make_fixtures.py > fixtures.h
+"""
+import random
+
+GROUP_MS = 87.6  # 104 bits at 1187.5 bit/s
+
+
+def groups(pi, pty, ps, rt, ab=0, mjd=60967, hour=6, minute=30, offset=14):
+    ps = ps.ljust(8)
+    text = rt + "\r"
+    text += " " * (-len(text) % 4)
+    segments = len(text) // 4
+    seg = 0
+    cycle = 0
+    while True:
+        for s in range(4):
+            yield (pi, (pty << 5) | s, 0xE0CD, (ord(ps[2 * s]) << 8) | ord(ps[2 * s + 1]))
+        for _ in range(4):
+            c = (ord(text[4 * seg]) << 8) | ord(text[4 * seg + 1])
+            d = (ord(text[4 * seg + 2]) << 8) | ord(text[4 * seg + 3])
+            yield (pi, (2 << 12) | (pty << 5) | (ab << 4) | seg, c, d)
+            seg = (seg + 1) % segments
+        cycle += 1
+        if cycle % 7 == 0:
+            yield (pi, (4 << 12) | (pty << 5) | ((mjd >> 15) & 3),
+                   ((mjd & 0x7FFF) << 1) | (hour >> 4), ((hour & 0xF) << 12) | (minute << 6) | offset)
+
+
+def channel(p_error, burst):
+    bad = [False]
+
+    def bler():
+        if bad[0]:
+            bad[0] = random.random() >= 1 / burst
+        else:
+            bad[0] = random.random() < p_error / burst
+        if bad[0]:
+            return random.choice([2, 3, 3])
+        return 1 if random.random() < p_error else 0
+    return bler
+
+
+def receive(word, bler):
+    if bler == 3:
+        return random.getrandbits(16)
+    if bler == 2 and random.random() < 0.3:
+        return word ^ (1 << random.randrange(16)) ^ (1 << random.randrange(16))
+    return word
+
+
+def stream(source, seconds, p_error, burst, seed, start_ms=0.0):
+    random.seed(seed)
+    bler = channel(p_error, burst)
+    lines = []
+    t = start_ms
+    for group in source:
+        if t - start_ms >= seconds * 1000:
+            break
+        errors = [bler() for _ in range(4)]
+        words = [receive(w, e) for w, e in zip(group, errors)]
+        lines.append("%d %04X %04X %04X %04X %d%d%d%d" % ((int(t),) + tuple(words) + tuple(errors)))
+        t += GROUP_MS
+    return lines, t
+
+
+def main():
+    vov = ("VOV GT", "Nhac Viet moi ngay")
+    strong, _ = stream(groups(0x3201, 10, *vov), 6, 0.02, 2, seed=11)
+    weak, _ = stream(groups(0x3201, 10, *vov), 20, 0.18, 4, seed=12)
+    before, t = stream(groups(0x3201, 10, *vov), 4, 0.02, 2, seed=13)
+    after, _ = stream(groups(0x3202, 5, "VOV1", "Thoi su"), 8, 0.02, 2, seed=14, start_ms=t)
+    first, t = stream(groups(0x3201, 10, "VOV GT", "Ket xe tren cau Sai Gon", ab=0), 8, 0.02, 2, seed=15)
+    second, _ = stream(groups(0x3201, 10, "VOV GT", "Duong thong thoang", ab=1), 8, 0.02, 2, seed=16, start_ms=t)
+
+    print("// Generated by make_fixtures.py, do not edit")
+    print("// <ms> <A> <B> <C> <D> <BLER A-D>\n")
+    for name, lines in (("STRONG", strong), ("WEAK", weak), ("PI_CHANGE", before + after),
+                        ("RT_TOGGLE", first + second)):
+        print('static const char RDS_%s[] = R"(' % name)
+        print("\n".join(lines))
+        print(')";\n')
+
+
+if __name__ == "__main__":
+    main()
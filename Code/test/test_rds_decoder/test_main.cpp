@@ -0,0 +1,175 @@
+#include <unity.h>
+#include "RDSDecoder.h"
+#include "fixtures.h"
+
+// Feeds a fixture stream group by group. `onGroup` (optional) runs after
+// every group so a test can watch what gets published and when.
+struct Replay
+{
+    RDSDecoder decoder;
+    uint32_t groups = 0;
+    uint32_t startVersion = 0;
+
+    template <typename F>
+    void run(const char *stream, F onGroup)
+    {
+        decoder.reset(0);
+        startVersion = decoder.getVersion();
+        const char *p = stream;
+        unsigned ms, a, b, c, d;
+        char bler[5];
+        int used;
+        while (sscanf(p, " %u %x %x %x %x %4s%n", &ms, &a, &b, &c, &d, bler, &used) == 6)
+        {
+            uint16_t blocks[4] = {(uint16_t)a, (uint16_t)b, (uint16_t)c, (uint16_t)d};
+            uint8_t errors[4];
+            for (int i = 0; i < 4; i++)
+                errors[i] = bler[i] - '0';
+            decoder.processGroup(blocks, errors, ms);
+            groups++;
+            onGroup(decoder, ms);
+            p += used;
+        }
+    }
+
+    void run(const char *stream)
+    {
+        run(stream, [](const RDSDecoder &, uint32_t) {});
+    }
+};
+
+static void report(const char *name, const RDSDecoder &decoder)
+{
+    char line[96];
+    snprintf(line, sizeof(line), "%s: PS stable after %lu ms, %lu groups, %lu blocks rejected", name,
+             (unsigned long)decoder.getTimeToStablePsMs(), (unsigned long)decoder.getGroupsDecoded(),
+             (unsigned long)decoder.getBlocksRejected());
+    TEST_MESSAGE(line);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_strong_signal_converges_within_two_ps_cycles()
+{
+    Replay replay;
+    replay.run(RDS_STRONG);
+
+    TEST_ASSERT_EQUAL_STRING("VOV GT  ", replay.decoder.getPsName());
+    TEST_ASSERT_EQUAL_STRING("Nhac Viet moi ngay", replay.decoder.getRadioText());
+    TEST_ASSERT_TRUE(replay.decoder.hasPi());
+    TEST_ASSERT_EQUAL_HEX16(0x3201, replay.decoder.getPi());
+    TEST_ASSERT_TRUE(replay.decoder.hasPty());
+    TEST_ASSERT_EQUAL(10, replay.decoder.getPty());
+
+    // One PS cycle is 4 of every 8-9 groups (~0.75 s); clean blocks
+    // settle a name on the second reception
+    TEST_ASSERT_GREATER_THAN(0, replay.decoder.getTimeToStablePsMs());
+    TEST_ASSERT_LESS_OR_EQUAL(1600, replay.decoder.getTimeToStablePsMs());
+    report("strong", replay.decoder);
+}
+
+static void test_clock_time_decoded()
+{
+    Replay replay;
+    replay.run(RDS_STRONG);
+
+    TEST_ASSERT_TRUE(replay.decoder.hasClock());
+    const RDSDecoder::ClockTime &clock = replay.decoder.getClock();
+    TEST_ASSERT_EQUAL(60967, clock.mjd);
+    TEST_ASSERT_EQUAL(6, clock.hour);
+    TEST_ASSERT_EQUAL(30, clock.minute);
+    TEST_ASSERT_EQUAL(14, clock.offsetHalfHours); // UTC+7
+}
+
+// Burst errors with miscorrected BLER 2 blocks: the name takes longer but
+// nothing but the right name (or nothing) is ever published
+static void test_weak_signal_never_publishes_a_wrong_name()
+{
+    Replay replay;
+    uint32_t wrong = 0;
+    uint32_t wrongText = 0;
+    replay.run(RDS_WEAK, [&](const RDSDecoder &decoder, uint32_t)
+               {
+        if (decoder.hasPsName() && strcmp(decoder.getPsName(), "VOV GT  ") != 0)
+            wrong++;
+        if (decoder.hasRadioText() && strcmp(decoder.getRadioText(), "Nhac Viet moi ngay") != 0)
+            wrongText++; });
+
+    TEST_ASSERT_EQUAL(0, wrong);
+    TEST_ASSERT_EQUAL(0, wrongText);
+    TEST_ASSERT_EQUAL_STRING("VOV GT  ", replay.decoder.getPsName());
+    TEST_ASSERT_EQUAL_STRING("Nhac Viet moi ngay", replay.decoder.getRadioText());
+    TEST_ASSERT_GREATER_THAN(0, replay.decoder.getBlocksRejected());
+    TEST_ASSERT_LESS_OR_EQUAL(6000, replay.decoder.getTimeToStablePsMs());
+    report("weak", replay.decoder);
+}
+
+// The tuner lands on another station without a retune call (seek, fade):
+// the new PI resets the decoder and the new name replaces the old one
+static void test_pi_change_resets_and_reconverges()
+{
+    Replay replay;
+    uint32_t switchMs = 0;
+    uint32_t newNameMs = 0;
+    replay.run(RDS_PI_CHANGE, [&](const RDSDecoder &decoder, uint32_t ms)
+               {
+        if (!switchMs && decoder.hasPi() && decoder.getPi() == 0x3202)
+            switchMs = ms;
+        if (!newNameMs && strcmp(decoder.getPsName(), "VOV1    ") == 0)
+            newNameMs = ms; });
+
+    TEST_ASSERT_EQUAL_HEX16(0x3202, replay.decoder.getPi());
+    TEST_ASSERT_EQUAL(5, replay.decoder.getPty());
+    TEST_ASSERT_EQUAL_STRING("VOV1    ", replay.decoder.getPsName());
+    TEST_ASSERT_EQUAL_STRING("Thoi su", replay.decoder.getRadioText());
+    TEST_ASSERT_GREATER_THAN(0, switchMs);
+    TEST_ASSERT_GREATER_OR_EQUAL(switchMs, newNameMs);
+    TEST_ASSERT_LESS_OR_EQUAL(2000, newNameMs - switchMs);
+    // Time to stable counts from the reset the PI change caused
+    TEST_ASSERT_LESS_OR_EQUAL(2000, replay.decoder.getTimeToStablePsMs());
+    report("pi change", replay.decoder);
+}
+
+// A/B flag toggle: the old message is dropped, never mixed with the new one
+static void test_radiotext_ab_toggle_replaces_message()
+{
+    Replay replay;
+    bool sawFirst = false;
+    uint32_t mixed = 0;
+    replay.run(RDS_RT_TOGGLE, [&](const RDSDecoder &decoder, uint32_t)
+               {
+        if (!decoder.hasRadioText())
+            return;
+        const char *rt = decoder.getRadioText();
+        if (strcmp(rt, "Ket xe tren cau Sai Gon") == 0)
+            sawFirst = true;
+        else if (strcmp(rt, "Duong thong thoang") != 0)
+            mixed++; });
+
+    TEST_ASSERT_TRUE(sawFirst);
+    TEST_ASSERT_EQUAL(0, mixed);
+    TEST_ASSERT_EQUAL_STRING("Duong thong thoang", replay.decoder.getRadioText());
+}
+
+// The version only moves when published data changes, so /api/fm/rds?since
+// answers 304 while a steady station keeps repeating itself: one bump each
+// for PI, PTY, PS, RadioText and the first clock time
+static void test_version_only_moves_on_changes()
+{
+    Replay replay;
+    replay.run(RDS_STRONG);
+    TEST_ASSERT_EQUAL(5, replay.decoder.getVersion() - replay.startVersion);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_strong_signal_converges_within_two_ps_cycles);
+    RUN_TEST(test_clock_time_decoded);
+    RUN_TEST(test_weak_signal_never_publishes_a_wrong_name);
+    RUN_TEST(test_pi_change_resets_and_reconverges);
+    RUN_TEST(test_radiotext_ab_toggle_replaces_message);
+    RUN_TEST(test_version_only_moves_on_changes);
+    return UNITY_END();
+}
@@ -0,0 +1,427 @@
+#include <unity.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Capture.h"
+#include "ConfigStore.h"
+#include "FMRadio.h"
+#include "FileManager.h"
+#include "RadioController.h"
+#include "HostRda5807.h"
+
+// HTTPMethod values (http_parser) as CAP_HTTP records them
+#define METHOD_DELETE 0
+#define METHOD_GET 1
+#define METHOD_POST 3
+
+#define LOOP_MS 10 // loop() cadence: radio.poll() and Capture::poll()
+
+static const char *CARD = "/tmp/famio-native-replay";
+
+// What the field unit receives: three stations with RDS, one without
+static const HostRda5807::Station FIELD[] = {
+    {9110, 38, true, 0x3201, 10, "VOV GT  ", "Nhac Viet moi ngay"},
+    {9650, 30, true, 0x3202, 5, "VOV1    ", "Thoi su"},
+    {9950, 36, true, 0x3203, 1, "VOV3    ", "Am nhac"},
+    {10270, 44, false, 0, 0, nullptr, nullptr},
+};
+
+// =========================================================
+// One unit: the modules main.cpp wires together for FM
+// =========================================================
+struct Unit
+{
+    FileManager files;
+    ConfigStore config{&files};
+    FMRadio radio{&files, &config};
+    RadioController controller{&radio};
+
+    // Boot as setup() does: card, config, then the tuner (before any trace
+    // starts, like a unit that was already playing when recording began)
+    void boot()
+    {
+        TEST_ASSERT_TRUE(files.begin());
+        config.begin();
+        Capture::begin(&files);
+        radio.begin();
+    }
+};
+
+struct Request
+{
+    uint32_t us; // From the start of the trace
+    uint8_t method;
+    std::string line; // "uri?name=value&..."
+};
+
+struct FileOp
+{
+    uint8_t op;
+    bool ok;
+    uint32_t bytes;
+    std::string path;
+    bool operator==(const FileOp &o) const { return op == o.op && ok == o.ok && bytes == o.bytes && path == o.path; }
+};
+
+struct Trace
+{
+    std::vector<Request> requests; // By start time
+    std::vector<FileOp> files;
+    uint32_t tunerEvents = 0;
+    uint32_t endUs = 0;
+};
+
+// Everything a run leaves behind that the FM logic decided
+struct Outcome
+{
+    FMStatusSnapshot status;
+    std::string stationsBin;
+    std::map<std::string, std::vector<uint8_t>> nvs;
+    Trace trace; // What the unit itself recorded while running
+    uint32_t skipped = 0;
+};
+
+static std::string readHostFile(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeHostFile(const std::string &path, const std::string &data)
+{
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream(path, std::ios::binary) << data;
+}
+
+// Same layout as Capture::readEvent() and tools/capture_trace.py
+static Trace parseTrace(const std::string &data)
+{
+    Trace trace;
+    CaptureHeader header;
+    TEST_ASSERT_TRUE(data.size() >= sizeof(header));
+    memcpy(&header, data.data(), sizeof(header));
+    TEST_ASSERT_EQUAL_MEMORY("FMCP", header.magic, 4);
+
+    const uint8_t *p = (const uint8_t *)data.data();
+    for (size_t at = header.headerSize; at + 6 <= data.size();)
+    {
+        uint8_t type = p[at];
+        uint8_t len = p[at + 1];
+        uint32_t us;
+        memcpy(&us, p + at + 2, 4);
+        const uint8_t *payload = p + at + 6;
+        if (at + 6 + len > data.size())
+            break;
+        at += 6 + len;
+        trace.endUs = std::max(trace.endUs, us);
+
+        if (type == CAP_HTTP && len >= 18)
+            trace.requests.push_back({us, payload[0], std::string((const char *)payload + 18, len - 18)});
+        else if (type == CAP_FILE && len >= 14)
+        {
+            uint32_t bytes;
+            memcpy(&bytes, payload + 6, 4);
+            trace.files.push_back({payload[0], payload[1] != 0, bytes, std::string((const char *)payload + 14, len - 14)});
+        }
+        else if (type >= CAP_TUNER_BLOCK && type <= CAP_TUNER_STC)
+            trace.tunerEvents++;
+    }
+    // Requests are written when they finish, stamped with when they began
+    std::stable_sort(trace.requests.begin(), trace.requests.end(),
+                     [](const Request &a, const Request &b) { return a.us < b.us; });
+    return trace;
+}
+
+static bool queryArg(const std::string &line, const char *name, String &value)
+{
+    size_t q = line.find('?');
+    std::string key = std::string(name) + "=";
+    for (size_t at = q; at != std::string::npos && at < line.size(); at = line.find('&', at + 1))
+    {
+        if (line.compare(at + 1, key.size(), key) == 0)
+        {
+            size_t from = at + 1 + key.size();
+            value = String(line.substr(from, line.find('&', from) - from).c_str());
+            return true;
+        }
+    }
+    return false;
+}
+
+// The FM routes of AppWebServer: the same RadioController commands and
+// FMRadio calls for a recorded request line. False for routes that do not
+// drive the radio (status reads, pages, capture control).
+static bool dispatch(Unit &unit, const std::string &line)
+{
+    std::string route = line.substr(0, line.find('?'));
+    String arg;
+    if (route == "/api/fm/power" && queryArg(line, "state", arg))
+        unit.controller.apply({RADIO_CMD_POWER, arg == "on" ? 1 : 0}, RADIO_SRC_HTTP);
+    else if (route == "/api/fm/setfreq" && queryArg(line, "freq", arg))
+    {
+        Channel channel;
+        if (Channel::parse(arg.c_str(), channel))
+            unit.controller.apply({RADIO_CMD_TUNE, channel.code()}, RADIO_SRC_HTTP);
+    }
+    else if (route == "/api/fm/seek" && queryArg(line, "direction", arg))
+        unit.controller.apply({arg == "up" ? RADIO_CMD_SEEK_UP : arg == "down" ? RADIO_CMD_SEEK_DOWN : RADIO_CMD_SEEK_NEXT, 0},
+                              RADIO_SRC_HTTP);
+    else if (route == "/api/fm/volume" && queryArg(line, "level", arg))
+        unit.controller.apply({RADIO_CMD_VOLUME, (int32_t)arg.toInt()}, RADIO_SRC_HTTP);
+    else if (route == "/api/fm/save")
+        unit.radio.saveChannel(unit.radio.getCurrentChannel());
+    else if (route == "/api/fm/select" && queryArg(line, "index", arg))
+        unit.controller.apply({RADIO_CMD_PRESET, (int32_t)arg.toInt()}, RADIO_SRC_HTTP);
+    else if (route == "/api/fm/delete" && queryArg(line, "index", arg))
+        unit.radio.deleteChannel(arg.toInt());
+    else
+        return false;
+    return true;
+}
+
+// loop() on the virtual clock for `durationUs` from now, handling each
+// request once its time has come (as the web server would between polls).
+// Recorded into `recordAs` when given.
+static Outcome run(Unit &unit, const std::vector<Request> &requests, uint32_t durationUs, const char *recordAs,
+                   const char *replay = nullptr)
+{
+    Outcome outcome;
+    if (recordAs)
+        TEST_ASSERT_TRUE(Capture::startRecording(recordAs));
+    if (replay)
+        TEST_ASSERT_TRUE(Capture::startReplay(replay));
+
+    const uint64_t start = HostClock::nowUs;
+    size_t next = 0;
+    for (uint64_t tick = 0; tick * LOOP_MS * 1000 < durationUs; tick++)
+    {
+        HostClock::nowUs = std::max(HostClock::nowUs, start + tick * LOOP_MS * 1000);
+        while (next < requests.size() && start + requests[next].us <= HostClock::nowUs)
+        {
+            const Request &req = requests[next++];
+            uint32_t begin = micros();
+            if (!dispatch(unit, req.line))
+                outcome.skipped++;
+            Capture::request(req.method, req.line.c_str(), begin, ESP.getFreeHeap());
+        }
+        unit.radio.poll();
+        Capture::poll();
+    }
+    Capture::stop();
+
+    unit.radio.readStatus(outcome.status);
+    outcome.stationsBin = readHostFile(std::string(CARD) + PROJECT_ROOT_DIR STATION_STORE_FILE);
+    outcome.nvs = HostNvs::entries;
+    if (recordAs)
+    {
+        char path[FILE_PATH_MAX];
+        Capture::pathFor(recordAs, path, sizeof(path));
+        outcome.trace = parseTrace(readHostFile(std::string(CARD) + PROJECT_ROOT_DIR + path));
+    }
+    return outcome;
+}
+
+// Freshly set up card (project and config folders, plus the traces to
+// replay) and empty NVS, same start time
+static void resetUnit(const std::map<std::string, std::string> &traces = {})
+{
+    std::filesystem::remove_all(CARD);
+    std::filesystem::create_directories(std::string(CARD) + PROJECT_ROOT_DIR CONFIG_FILE_PATH);
+    for (const auto &t : traces)
+    {
+        char path[FILE_PATH_MAX];
+        Capture::pathFor(t.first.c_str(), path, sizeof(path));
+        writeHostFile(std::string(CARD) + PROJECT_ROOT_DIR + path, t.second);
+    }
+    HostNvs::erase();
+    HostClock::nowUs = 5000000;
+}
+
+static std::string traceBytes(const char *name)
+{
+    char path[FILE_PATH_MAX];
+    Capture::pathFor(name, path, sizeof(path));
+    return readHostFile(std::string(CARD) + PROJECT_ROOT_DIR + path);
+}
+
+// A listening session: tune around, store presets, recall one, delete
+// one, power cycle. Long enough for the minute-long station flush.
+static const std::vector<Request> SESSION = {
+    {1000000, METHOD_POST, "/api/fm/setfreq?freq=91.1"},
+    {4000000, METHOD_POST, "/api/fm/save"},
+    {5000000, METHOD_POST, "/api/fm/volume?level=6"},
+    {6000000, METHOD_POST, "/api/fm/setfreq?freq=96.5"},
+    {9000000, METHOD_POST, "/api/fm/save"},
+    {10000000, METHOD_POST, "/api/fm/setfreq?freq=102.7"},
+    {12000000, METHOD_POST, "/api/fm/save"},
+    {13000000, METHOD_GET, "/api/fm/select?index=0"},
+    {16000000, METHOD_DELETE, "/api/fm/delete?index=1"},
+    {17000000, METHOD_GET, "/api/fm/status"},
+    {20000000, METHOD_POST, "/api/fm/power?state=off"},
+    {22000000, METHOD_POST, "/api/fm/power?state=on"},
+};
+static const uint32_t SESSION_US = 65000000;
+
+static std::unique_ptr<HostRda5807> fieldChip()
+{
+    std::unique_ptr<HostRda5807> chip(new HostRda5807(11));
+    for (const HostRda5807::Station &s : FIELD)
+        chip->addStation(s);
+    return chip;
+}
+
+// The field unit records the session; its trace is what gets replayed
+static Outcome recordField()
+{
+    resetUnit();
+    std::unique_ptr<HostRda5807> chip = fieldChip();
+    Wire.attach(chip.get());
+    std::unique_ptr<Unit> unit(new Unit);
+    unit->boot();
+    Outcome outcome = run(*unit, SESSION, SESSION_US, "field");
+    Wire.attach(nullptr);
+    return outcome;
+}
+
+static void assertSameOutcome(const Outcome &field, const Outcome &bench)
+{
+    TEST_ASSERT_EQUAL_UINT16(field.status.channelCode, bench.status.channelCode);
+    TEST_ASSERT_EQUAL(field.status.volume, bench.status.volume);
+    TEST_ASSERT_EQUAL(field.status.rssi, bench.status.rssi);
+    TEST_ASSERT_EQUAL(field.status.stereo, bench.status.stereo);
+    TEST_ASSERT_EQUAL(field.status.powered, bench.status.powered);
+    TEST_ASSERT_EQUAL(field.status.hasPs, bench.status.hasPs);
+    TEST_ASSERT_EQUAL_STRING(field.status.ps, bench.status.ps);
+    // Presets, names from RDS, RSSI and play counts as written to SD
+    TEST_ASSERT_EQUAL(field.stationsBin.size(), bench.stationsBin.size());
+    TEST_ASSERT_TRUE(field.stationsBin == bench.stationsBin);
+    TEST_ASSERT_TRUE(field.nvs == bench.nvs);
+}
+
+void setUp()
+{
+    HostFs::root = CARD;
+    Wire.setClock(400000);
+}
+
+void tearDown()
+{
+    Capture::stop();
+    Wire.attach(nullptr);
+}
+
+// The session itself: presets named from RDS on the field unit
+static void test_field_session_records_tuner_and_file_streams()
+{
+    Outcome field = recordField();
+    TEST_ASSERT_EQUAL(1, field.skipped); // Only the status read
+    TEST_ASSERT_EQUAL(SESSION.size(), field.trace.requests.size());
+    TEST_ASSERT_GREATER_THAN(1000, field.trace.tunerEvents);
+    TEST_ASSERT_GREATER_THAN(0, field.trace.files.size());
+
+    TEST_ASSERT_TRUE(field.status.powered);
+    TEST_ASSERT_EQUAL_UINT16(9110, field.status.channelCode);
+    TEST_ASSERT_TRUE(field.status.hasPs);
+    TEST_ASSERT_EQUAL_STRING("VOV GT  ", field.status.ps);
+    TEST_ASSERT_EQUAL(6, field.status.volume);
+    TEST_ASSERT_EQUAL(STATION_MAX * sizeof(StationRecord) + 16, field.stationsBin.size());
+}
+
+// A bench unit whose own tuner hears nothing ends up exactly where the
+// field unit did: same status, same stations.bin, same NVS snapshot and
+// the same FileManager operations in the same order
+static void test_replay_reproduces_field_outcome()
+{
+    Outcome field = recordField();
+    std::string trace = traceBytes("field");
+
+    resetUnit({{"field", trace}});
+    HostRda5807 bench(29); // Answers the library's setup/volume writes only
+    Wire.attach(&bench);
+    std::unique_ptr<Unit> unit(new Unit);
+    unit->boot();
+    Trace recorded = parseTrace(trace);
+    Outcome replayed = run(*unit, recorded.requests, SESSION_US, "bench", "field");
+
+    // Every recorded read was consumed and none fell through to the bench chip
+    TEST_ASSERT_FALSE(Capture::isReplaying());
+    TEST_ASSERT_EQUAL(0, replayed.trace.tunerEvents);
+    assertSameOutcome(field, replayed);
+    TEST_ASSERT_EQUAL(recorded.files.size(), replayed.trace.files.size());
+    for (size_t i = 0; i < recorded.files.size(); i++)
+        TEST_ASSERT_TRUE_MESSAGE(recorded.files[i] == replayed.trace.files[i], recorded.files[i].path.c_str());
+
+    char line[128];
+    snprintf(line, sizeof(line), "%u requests, %lu tuner reads, %u file ops replayed; ps '%s' on %u",
+             (unsigned)recorded.requests.size(), (unsigned long)recorded.tunerEvents, (unsigned)recorded.files.size(),
+             replayed.status.ps, replayed.status.channelCode);
+    TEST_MESSAGE(line);
+}
+
+// Control: the same requests on the bench unit without the trace. Nothing
+// is named, so the outcome above came from the recorded tuner stream.
+static void test_bench_alone_does_not_match()
+{
+    Outcome field = recordField();
+    std::string trace = traceBytes("field");
+
+    resetUnit();
+    HostRda5807 bench(29);
+    Wire.attach(&bench);
+    std::unique_ptr<Unit> unit(new Unit);
+    unit->boot();
+    Outcome alone = run(*unit, parseTrace(trace).requests, SESSION_US, nullptr);
+
+    TEST_ASSERT_FALSE(alone.status.hasPs);
+    TEST_ASSERT_FALSE(field.stationsBin == alone.stationsBin);
+}
+
+// A trace pulled from a unit (GET /api/system/capture/file?name=...):
+//   CAPTURE_TRACE=/path/to/trace.bin pio test -e native -f test_replay
+// Replayed on a fresh card, so file results only match a trace recorded
+// from a freshly formatted card; differences are reported, not failed.
+static void test_field_trace_from_env()
+{
+    const char *path = getenv("CAPTURE_TRACE");
+    if (!path)
+        TEST_IGNORE_MESSAGE("CAPTURE_TRACE not set");
+
+    std::string data = readHostFile(path);
+    TEST_ASSERT_GREATER_THAN(sizeof(CaptureHeader), data.size());
+    Trace recorded = parseTrace(data);
+
+    resetUnit({{"field", data}});
+    HostRda5807 bench(29);
+    Wire.attach(&bench);
+    std::unique_ptr<Unit> unit(new Unit);
+    unit->boot();
+    Outcome replayed = run(*unit, recorded.requests, recorded.endUs + LOOP_MS * 1000, "bench", "field");
+    TEST_ASSERT_FALSE(Capture::isReplaying());
+
+    size_t same = 0;
+    while (same < recorded.files.size() && same < replayed.trace.files.size() &&
+           recorded.files[same] == replayed.trace.files[same])
+        same++;
+    char line[192];
+    snprintf(line, sizeof(line),
+             "%u requests (%lu not FM), %lu tuner reads (%lu fell through); first %u of %u file ops match; ends on %u '%s' rssi %u",
+             (unsigned)recorded.requests.size(), (unsigned long)replayed.skipped, (unsigned long)recorded.tunerEvents,
+             (unsigned long)replayed.trace.tunerEvents, (unsigned)same, (unsigned)recorded.files.size(),
+             replayed.status.channelCode, replayed.status.ps, replayed.status.rssi);
+    TEST_MESSAGE(line);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_field_session_records_tuner_and_file_streams);
+    RUN_TEST(test_replay_reproduces_field_outcome);
+    RUN_TEST(test_bench_alone_does_not_match);
+    RUN_TEST(test_field_trace_from_env);
+    return UNITY_END();
+}
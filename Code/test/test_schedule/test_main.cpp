@@ -0,0 +1,198 @@
+#include <unity.h>
+#include "Schedule.h"
+
+#define MIN_MS 60000ULL
+#define HOUR_MS 3600000ULL
+
+// Monday 2024-01-08 06:00 at UTC+7 (2024-01-07 23:00 UTC)
+static const uint64_t MONDAY_0600 = 1704668400000ULL;
+static const int16_t UTC_PLUS_7 = 420;
+
+static ScheduleAlarm alarms[SCHEDULE_MAX_ALARMS];
+
+void setUp()
+{
+    memset(alarms, 0, sizeof(alarms));
+    alarms[0] = {1, 0x3E, 6, 30, 2, 8, 60, 45}; // Weekdays 06:30, 1 min fade, off after 45 min
+    alarms[1] = {1, 0x41, 8, 0, 1, 6, 120, 0};  // Weekends 08:00, keeps playing
+}
+
+void tearDown() {}
+
+// What happened while stepping the virtual RTC once a second
+struct Run
+{
+    int8_t fired = -1;
+    uint64_t firedAt = 0;
+    uint64_t sleptAt = 0;
+    uint32_t wakeInS = 0;
+    int8_t lastPercent = -1;
+    uint32_t fadeInSteps = 0;
+};
+
+static Run runUntilSleep(Schedule &schedule, uint64_t from, uint64_t to)
+{
+    Run run;
+    for (uint64_t t = from; t < to; t += 1000)
+    {
+        ScheduleOutput out = schedule.update(t, true);
+        if (out.fireAlarm >= 0)
+        {
+            run.fired = out.fireAlarm;
+            run.firedAt = t;
+        }
+        if (out.ampPercent >= 0)
+        {
+            if (out.ampPercent > run.lastPercent && run.fired >= 0)
+                run.fadeInSteps++;
+            run.lastPercent = out.ampPercent;
+        }
+        if (out.sleep)
+        {
+            run.sleptAt = t;
+            run.wakeInS = out.wakeInS;
+            break;
+        }
+    }
+    return run;
+}
+
+static void test_next_alarm_respects_day_mask_and_timezone()
+{
+    ScheduleState state;
+    Schedule schedule(state);
+    schedule.reset(alarms, UTC_PLUS_7);
+
+    int8_t index = -1;
+    TEST_ASSERT_EQUAL_UINT64(MONDAY_0600 + 30 * MIN_MS, schedule.nextAlarmMs(MONDAY_0600, &index));
+    TEST_ASSERT_EQUAL(0, index);
+
+    // Friday 07:00 -> Saturday 08:00 (weekend alarm, weekday one is past)
+    uint64_t friday0700 = MONDAY_0600 + 4 * 24 * HOUR_MS + HOUR_MS;
+    TEST_ASSERT_EQUAL_UINT64(friday0700 + 25 * HOUR_MS, schedule.nextAlarmMs(friday0700, &index));
+    TEST_ASSERT_EQUAL(1, index);
+}
+
+// Fires on time, fades in, fades out at the auto-off and sleeps until
+// just before Tuesday's alarm
+static void test_alarm_fires_fades_and_sleeps_until_next()
+{
+    ScheduleState state;
+    Schedule schedule(state);
+    schedule.reset(alarms, UTC_PLUS_7);
+
+    Run run = runUntilSleep(schedule, MONDAY_0600, MONDAY_0600 + 2 * HOUR_MS);
+    TEST_ASSERT_EQUAL(0, run.fired);
+    TEST_ASSERT_EQUAL_UINT64(MONDAY_0600 + 30 * MIN_MS, run.firedAt);
+    TEST_ASSERT_EQUAL_UINT64(run.firedAt + 45 * MIN_MS, run.sleptAt);
+    TEST_ASSERT_GREATER_THAN(10, run.fadeInSteps); // A ramp, not a jump
+    TEST_ASSERT_EQUAL(0, run.lastPercent);
+    // Tuesday 06:30 is 23 h 15 min after Monday 07:15
+    TEST_ASSERT_EQUAL(23 * 3600 + 15 * 60 - SCHEDULE_WAKE_LEAD_S, run.wakeInS);
+}
+
+// The state lives in RTC memory: a fresh Schedule on the same state after
+// a wake must not fire the same alarm again
+static void test_no_refire_after_resume()
+{
+    ScheduleState state;
+    Schedule schedule(state);
+    schedule.reset(alarms, UTC_PLUS_7);
+    Run run = runUntilSleep(schedule, MONDAY_0600, MONDAY_0600 + 2 * HOUR_MS);
+
+    Schedule resumed(state);
+    TEST_ASSERT_TRUE(resumed.isValid());
+    TEST_ASSERT_EQUAL(-1, resumed.update(run.firedAt + 30000, true).fireAlarm);
+    TEST_ASSERT_EQUAL(-1, resumed.update(run.firedAt + 90000, true).fireAlarm);
+}
+
+static void test_late_boot_within_grace_fires_later_skips()
+{
+    uint64_t due = MONDAY_0600 + 30 * MIN_MS;
+
+    ScheduleState onTime;
+    Schedule late(onTime);
+    late.reset(alarms, UTC_PLUS_7);
+    // No wall clock yet: nothing fires
+    TEST_ASSERT_EQUAL(-1, late.update(due + 100000, false).fireAlarm);
+    TEST_ASSERT_EQUAL(0, late.update(due + 100000, true).fireAlarm);
+
+    ScheduleState missed;
+    Schedule tooLate(missed);
+    tooLate.reset(alarms, UTC_PLUS_7);
+    TEST_ASSERT_EQUAL(-1, tooLate.update(due + 10 * MIN_MS, true).fireAlarm);
+}
+
+static void test_one_shot_alarm_disables_itself()
+{
+    alarms[2] = {1, 0, 6, 45, 0, 8, 0, 0};
+    ScheduleState state;
+    Schedule schedule(state);
+    schedule.reset(alarms, UTC_PLUS_7);
+
+    TEST_ASSERT_EQUAL(2, schedule.update(MONDAY_0600 + 45 * MIN_MS, true).fireAlarm);
+    TEST_ASSERT_EQUAL(0, state.alarms[2].enabled);
+}
+
+static void test_sleep_timer_fades_out_without_clock()
+{
+    ScheduleState state;
+    Schedule schedule(state);
+    schedule.reset(alarms, UTC_PLUS_7);
+
+    // Relative timer: runs on time since boot, no wake planned
+    uint64_t t = 5000;
+    schedule.startSleepTimer(t, 10, 30);
+    int8_t last = -1;
+    bool slept = false;
+    for (; t < 5000 + 11 * MIN_MS && !slept; t += 1000)
+    {
+        ScheduleOutput out = schedule.update(t, false);
+        if (out.ampPercent >= 0)
+        {
+            if (last >= 0)
+                TEST_ASSERT_LESS_OR_EQUAL(last, out.ampPercent);
+            last = out.ampPercent;
+        }
+        slept = out.sleep;
+        if (slept)
+            TEST_ASSERT_EQUAL(0, out.wakeInS);
+    }
+    TEST_ASSERT_TRUE(slept);
+    TEST_ASSERT_EQUAL_UINT64(5000 + 10 * MIN_MS + 1000, t);
+    TEST_ASSERT_EQUAL(0, last);
+}
+
+// Weekday 06:30/45 min plus weekend 08:00 (default 60 min): a week of deep
+// sleep between alarms against an always-on unit
+static void test_week_estimate()
+{
+    ScheduleState state;
+    Schedule schedule(state);
+    schedule.reset(alarms, UTC_PLUS_7);
+
+    Schedule::Estimate e = schedule.estimate(3000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, e.wakesPerDay);
+    // 5 x (45 + boot) + 2 x (60 + boot) minutes a week
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, (5 * 45 + 2 * 60) / 7.0f, e.awakeMinPerDay);
+    TEST_ASSERT_TRUE(e.avgMa < SCHEDULE_MA_PLAYING / 20);
+    TEST_ASSERT_TRUE(e.batteryDays > 20.0f);
+
+    char line[128];
+    snprintf(line, sizeof(line), "week: %.2f mA avg, %.1f min awake/day, %.1f days on 3000 mAh (always on: %.1f)",
+             e.avgMa, e.awakeMinPerDay, e.batteryDays, 3000 / SCHEDULE_MA_PLAYING / 24);
+    TEST_MESSAGE(line);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_next_alarm_respects_day_mask_and_timezone);
+    RUN_TEST(test_alarm_fires_fades_and_sleeps_until_next);
+    RUN_TEST(test_no_refire_after_resume);
+    RUN_TEST(test_late_boot_within_grace_fires_later_skips);
+    RUN_TEST(test_one_shot_alarm_disables_itself);
+    RUN_TEST(test_sleep_timer_fades_out_without_clock);
+    RUN_TEST(test_week_estimate);
+    return UNITY_END();
+}
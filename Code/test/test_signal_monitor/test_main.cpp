@@ -0,0 +1,189 @@
+#include <unity.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "SignalMonitor.h"
+
+// The status sampler's rate
+#define SAMPLE_MS 40
+
+// Samples every SAMPLE_MS in [fromMs, toMs); returns when wantMono() last
+// changed (0 if it did not)
+static uint32_t feed(SignalMonitor &mon, uint32_t fromMs, uint32_t toMs, uint8_t rssi)
+{
+    uint32_t changedAt = 0;
+    for (uint32_t t = fromMs; t < toMs; t += SAMPLE_MS)
+    {
+        bool before = mon.wantMono();
+        mon.addSample(rssi, rssi > MONO_BLEND_OFF_RSSI, t);
+        if (mon.wantMono() != before)
+            changedAt = t;
+    }
+    return changedAt;
+}
+
+static void append(const char *data, size_t len, void *ctx)
+{
+    static_cast<std::string *>(ctx)->append(data, len);
+}
+
+// Room for the header line only, so the columns go out in many chunks
+static std::string render(const SignalMonitor &mon, SignalTier tier)
+{
+    std::string page;
+    char buf[128];
+    mon.renderHistory(tier, buf, sizeof(buf), append, &page);
+    return page;
+}
+
+static std::vector<int> column(const std::string &page, const char *name)
+{
+    std::vector<int> values;
+    size_t at = page.find(std::string("\"") + name + "\":[");
+    TEST_ASSERT_TRUE(at != std::string::npos);
+    const char *p = page.c_str() + page.find('[', at) + 1;
+    while (*p != ']')
+    {
+        char *end;
+        values.push_back((int)strtol(p, &end, 10));
+        TEST_ASSERT_TRUE(end != p);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return values;
+}
+
+// Balanced braces/brackets, nothing after the closing brace
+static void assertWellFormed(const std::string &page)
+{
+    int depth = 0;
+    for (size_t i = 0; i < page.size(); i++)
+    {
+        char c = page[i];
+        depth += (c == '{' || c == '[') - (c == '}' || c == ']');
+        TEST_ASSERT_TRUE(depth >= 0);
+        if (depth == 0)
+            TEST_ASSERT_EQUAL(page.size() - 1, i);
+    }
+    TEST_ASSERT_EQUAL(0, depth);
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Mono after MONO_BLEND_HOLD_S weak seconds, held through the hysteresis
+// band, stereo again MONO_BLEND_HOLD_S seconds after the signal recovers
+static void test_blend_hysteresis()
+{
+    SignalMonitor mon;
+    TEST_ASSERT_EQUAL(0, feed(mon, 0, 600000, 60));
+    TEST_ASSERT_FALSE(mon.wantMono());
+
+    uint32_t monoAt = feed(mon, 600000, 660000, MONO_BLEND_ON_RSSI - 8);
+    TEST_ASSERT_EQUAL(600000 + MONO_BLEND_HOLD_S * 1000, monoAt);
+
+    // Inside the band: neither threshold crossed, mode kept
+    TEST_ASSERT_EQUAL(0, feed(mon, 660000, 720000, (MONO_BLEND_ON_RSSI + MONO_BLEND_OFF_RSSI) / 2));
+    TEST_ASSERT_TRUE(mon.wantMono());
+
+    // Recovery: the band seconds before it do not count toward stereo
+    uint32_t stereoAt = feed(mon, 720000, 780000, MONO_BLEND_OFF_RSSI + 16);
+    TEST_ASSERT_EQUAL(720000 + MONO_BLEND_HOLD_S * 1000, stereoAt);
+    TEST_ASSERT_FALSE(mon.wantMono());
+
+    // Short dips shorter than the hold time never switch
+    uint32_t t = 780000;
+    for (int i = 0; i < 20; i++, t += 5000)
+    {
+        TEST_ASSERT_EQUAL(0, feed(mon, t, t + 2000, MONO_BLEND_ON_RSSI - 8));
+        TEST_ASSERT_EQUAL(0, feed(mon, t + 2000, t + 5000, 60));
+    }
+    TEST_ASSERT_FALSE(mon.wantMono());
+}
+
+// Three hours at 25 Hz with the radio off for 10 minutes in between: the
+// gap is 10 empty minute slots, the hour averages come from raw samples
+// and every tier renders as well-formed columns of equal length
+static void test_tiers_over_three_hours()
+{
+    const uint32_t MIN = 60000;
+    SignalMonitor mon;
+    // Hour 0: 20 min at 20, 40 min at 50 (exact average 40)
+    feed(mon, 0, 20 * MIN, 20);
+    feed(mon, 20 * MIN, 60 * MIN, 50);
+    // Hour 1: off 10 min, then 50 min at 30
+    feed(mon, 70 * MIN, 120 * MIN, 30);
+    // Hour 2 (still open): 60
+    feed(mon, 120 * MIN, 180 * MIN, 60);
+
+    std::string hours = render(mon, SIGNAL_TIER_HOUR);
+    assertWellFormed(hours);
+    std::vector<int> avg = column(hours, "avg");
+    TEST_ASSERT_EQUAL(2, avg.size());
+    TEST_ASSERT_EQUAL(40, avg[0]);
+    TEST_ASSERT_EQUAL(30, avg[1]);
+    std::vector<int> min = column(hours, "min");
+    std::vector<int> max = column(hours, "max");
+    TEST_ASSERT_EQUAL(20, min[0]);
+    TEST_ASSERT_EQUAL(50, max[0]);
+    // Stereo only above MONO_BLEND_OFF_RSSI: the 40 of 60 minutes at 50
+    TEST_ASSERT_EQUAL(66, column(hours, "stereo")[0]);
+
+    // The minute ring covers the last 2 h: minutes 59..178 closed
+    std::string minutes = render(mon, SIGNAL_TIER_MIN);
+    assertWellFormed(minutes);
+    avg = column(minutes, "avg");
+    TEST_ASSERT_EQUAL(SIGNAL_MIN_SLOTS, avg.size());
+    TEST_ASSERT_EQUAL(SIGNAL_MIN_SLOTS, column(minutes, "stereo").size());
+    int empty = 0;
+    size_t firstEmpty = 0;
+    for (size_t i = 0; i < avg.size(); i++)
+    {
+        if (avg[i] == -1 && !empty++)
+            firstEmpty = i;
+    }
+    TEST_ASSERT_EQUAL(10, empty);
+    TEST_ASSERT_EQUAL(50, avg[firstEmpty - 1]);
+    TEST_ASSERT_EQUAL(30, avg[firstEmpty + 10]);
+    TEST_ASSERT_EQUAL(60, avg.back());
+
+    std::string seconds = render(mon, SIGNAL_TIER_SEC);
+    assertWellFormed(seconds);
+    TEST_ASSERT_EQUAL(SIGNAL_SEC_SLOTS, column(seconds, "max").size());
+    TEST_ASSERT_TRUE(seconds.find("\"tier\":\"sec\",\"period_ms\":1000") != std::string::npos);
+}
+
+// A gap longer than a whole ring leaves it all empty, still in step with
+// wall time, and sampling resumes in the right slot
+static void test_gap_longer_than_ring()
+{
+    SignalMonitor mon;
+    feed(mon, 0, 10000, 40);
+    feed(mon, 10000 + 1000 * SIGNAL_SEC_SLOTS * 3, 10000 + 1000 * SIGNAL_SEC_SLOTS * 3 + 2000, 45);
+
+    std::string seconds = render(mon, SIGNAL_TIER_SEC);
+    std::vector<int> avg = column(seconds, "avg");
+    TEST_ASSERT_EQUAL(SIGNAL_SEC_SLOTS, avg.size());
+    TEST_ASSERT_EQUAL(45, avg.back());
+    for (size_t i = 0; i < avg.size() - 1; i++)
+        TEST_ASSERT_EQUAL(-1, avg[i]);
+}
+
+static void test_parse_tier()
+{
+    SignalTier tier;
+    TEST_ASSERT_TRUE(SignalMonitor::parseTier("hour", tier));
+    TEST_ASSERT_EQUAL(SIGNAL_TIER_HOUR, tier);
+    TEST_ASSERT_TRUE(SignalMonitor::parseTier("sec", tier));
+    TEST_ASSERT_EQUAL(SIGNAL_TIER_SEC, tier);
+    TEST_ASSERT_FALSE(SignalMonitor::parseTier("day", tier));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_blend_hysteresis);
+    RUN_TEST(test_tiers_over_three_hours);
+    RUN_TEST(test_gap_longer_than_ring);
+    RUN_TEST(test_parse_tier);
+    return UNITY_END();
+}
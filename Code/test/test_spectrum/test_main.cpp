@@ -0,0 +1,173 @@
+#include <unity.h>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include "Spectrum.h"
+
+static const uint32_t RATE = 22050;
+static const int N = SPECTRUM_FFT_SIZE;
+static const int HOP = RATE / 25; // One frame per 40 ms, as the capture task
+
+static Spectrum spectrum;
+static int16_t x[N];
+
+// First bin of a band, from its lower edge in Hz (getBandHz() rounds down)
+static int bandBin(uint8_t band)
+{
+    if (band == SPECTRUM_BANDS)
+        return lround((double)SPECTRUM_MAX_HZ * N / RATE);
+    return (int)ceil((double)spectrum.getBandHz(band) * N / RATE);
+}
+
+// Level byte of one band from a double-precision DFT of the same samples
+static double referenceLevel(const int16_t *s, uint8_t band)
+{
+    double power = 0;
+    for (int k = bandBin(band); k < bandBin(band + 1); k++)
+    {
+        double re = 0, im = 0;
+        for (int n = 0; n < N; n++)
+        {
+            double v = s[n] * (0.5 - 0.5 * cos(2 * M_PI * n / N));
+            re += v * cos(2 * M_PI * k * n / N);
+            im -= v * sin(2 * M_PI * k * n / N);
+        }
+        power += (re * re + im * im) / ((double)N * N);
+    }
+    double fullScale = 32767.0 * 32767.0 * 3 / 32;
+    return 255 + 20 * log10((power + 1) / fullScale);
+}
+
+static double centreHz(uint8_t band)
+{
+    uint32_t upper = band + 1 < SPECTRUM_BANDS ? spectrum.getBandHz(band + 1) : SPECTRUM_MAX_HZ;
+    return sqrt((double)spectrum.getBandHz(band) * upper);
+}
+
+static void sine(double hz, double amplitude)
+{
+    for (int n = 0; n < N; n++)
+        x[n] = (int16_t)lrint(32767 * amplitude * sin(2 * M_PI * hz * n / RATE));
+}
+
+void setUp()
+{
+    spectrum.begin(RATE);
+}
+
+void tearDown() {}
+
+// Two tones plus noise, 50 frames: the fixed-point bands against the
+// double-precision DFT, over the bands above -60 dB
+static void test_bands_match_double_precision_dft()
+{
+    srand(1);
+    double worst = 0;
+    double sumSquares = 0;
+    int compared = 0;
+    SpectrumFrame frame;
+    for (int trial = 0; trial < 50; trial++)
+    {
+        for (int n = 0; n < N; n++)
+        {
+            double v = 0.3 * sin(2 * M_PI * (440 + trial * 37) * n / RATE) + 0.2 * sin(2 * M_PI * 3100 * n / RATE) +
+                       ((rand() % 2001) - 1000) / 5000.0;
+            x[n] = (int16_t)lrint(v * 32767 * 0.9);
+        }
+        spectrum.analyze(x, N, frame);
+        for (uint8_t b = 0; b < SPECTRUM_BANDS; b++)
+        {
+            double ref = referenceLevel(x, b);
+            if (ref < 255 - 120)
+                continue;
+            double err = fabs(frame.bands[b] - ref);
+            worst = fmax(worst, err);
+            sumSquares += err * err;
+            compared++;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(500, compared);
+    // Within 1.5 dB (integer rounding in the FFT shows in the weaker bands)
+    TEST_ASSERT_TRUE(worst <= 3.0);
+
+    char line[96];
+    snprintf(line, sizeof(line), "%d bands vs double DFT: max error %.2f, rms %.2f half-dB", compared, worst,
+             sqrt(sumSquares / compared));
+    TEST_MESSAGE(line);
+}
+
+// A full-scale sine reads 255 in its band (within 3 dB: single-bin low
+// bands lose some of a sine off the bin centre to the neighbours), and
+// -60 dB reads within +/-3 dB of 135
+static void test_sine_levels_in_every_band()
+{
+    SpectrumFrame frame;
+    for (uint8_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        sine(centreHz(b), 1.0);
+        spectrum.analyze(x, N, frame);
+        TEST_ASSERT_INT_WITHIN(6, 255, frame.bands[b]);
+        TEST_ASSERT_EQUAL(255, frame.peak);
+        sine(centreHz(b), 0.001);
+        spectrum.analyze(x, N, frame);
+        TEST_ASSERT_INT_WITHIN(6, 255 - 120, frame.bands[b]);
+    }
+}
+
+// Digital silence bottoms out at -80 dB in the bands (one LSB of band
+// power), not at 0, so the page's meter scale can start there
+static void test_silence_floor()
+{
+    SpectrumFrame frame;
+    memset(x, 0, sizeof(x));
+    spectrum.analyze(x, N, frame);
+    for (uint8_t b = 0; b < SPECTRUM_BANDS; b++)
+        TEST_ASSERT_EQUAL(255 - 160, frame.bands[b]);
+    TEST_ASSERT_LESS_THAN(255 - 160, frame.rms);
+}
+
+static void test_half_db_accuracy()
+{
+    double worst = 0;
+    for (uint64_t v = 1; v < (1ULL << 40); v = v * 1.37 + 1)
+        worst = fmax(worst, fabs(Spectrum::halfDb(v) - 20 * log10((double)v)));
+    // Rounding to whole half-dB steps included
+    TEST_ASSERT_TRUE(worst < 0.6);
+}
+
+// 30 s of mixed program-like signal in capture-sized hops; reported, not
+// asserted (host time says little about the Xtensa, which reports its own
+// figure in cpu.percent)
+static void test_frame_time()
+{
+    static int16_t pcm[RATE * 30];
+    srand(2);
+    for (size_t n = 0; n < sizeof(pcm) / sizeof(pcm[0]); n++)
+    {
+        double v = 0.25 * sin(2 * M_PI * 220 * n / RATE) + 0.15 * sin(2 * M_PI * 1760 * n / RATE) +
+                   ((rand() % 2001) - 1000) / 8000.0;
+        pcm[n] = (int16_t)lrint(v * 32767);
+    }
+
+    SpectrumFrame frame;
+    size_t frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t off = 0; off + HOP <= sizeof(pcm) / sizeof(pcm[0]); off += HOP, frames++)
+        spectrum.analyze(&pcm[off], HOP, frame);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    char line[96];
+    snprintf(line, sizeof(line), "%u frames, %.0f ns/frame on this host", (unsigned)frames, ns / frames);
+    TEST_MESSAGE(line);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bands_match_double_precision_dft);
+    RUN_TEST(test_sine_levels_in_every_band);
+    RUN_TEST(test_silence_floor);
+    RUN_TEST(test_half_db_accuracy);
+    RUN_TEST(test_frame_time);
+    return UNITY_END();
+}
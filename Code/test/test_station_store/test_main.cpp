@@ -0,0 +1,242 @@
+#include <unity.h>
+#include <filesystem>
+#include <random>
+#include "Constants.h"
+#include "FileManager.h"
+#include "StationStore.h"
+
+#define CARD "/tmp/famio-native-stations"
+#define STORE_PATH CARD PROJECT_ROOT_DIR STATION_STORE_FILE
+#define HEADER_SIZE 16
+
+static FileManager *files;
+
+// 87.50 MHz upward on the 50 kHz raster (STATION_MAX of them stay in band)
+static Channel nth(size_t i) { return Channel((uint16_t)(8750 + i * 5)); }
+
+// Every live record is reachable through the index, and nothing else is
+static void assertIndexConsistent(const StationStore &store)
+{
+    size_t live = 0;
+    for (size_t slot = 0; slot < store.capacity(); slot++)
+    {
+        uint16_t code = store.at(slot).code;
+        if (!code)
+            continue;
+        live++;
+        TEST_ASSERT_EQUAL(slot, store.find(Channel(code)));
+    }
+    TEST_ASSERT_EQUAL(live, store.count());
+}
+
+void setUp()
+{
+    HostClock::nowUs = 1000000;
+    HostFs::root = CARD;
+    std::filesystem::remove_all(CARD);
+    std::filesystem::create_directories(CARD PROJECT_ROOT_DIR CONFIG_FILE_PATH);
+    files = new FileManager();
+    TEST_ASSERT_TRUE(files->begin());
+}
+
+void tearDown() { delete files; }
+
+static void test_fresh_store_is_created_full_size()
+{
+    StationStore *store = new StationStore(files);
+    TEST_ASSERT_TRUE(store->begin());
+    TEST_ASSERT_TRUE(store->isFresh());
+    TEST_ASSERT_EQUAL(0, store->count());
+    TEST_ASSERT_EQUAL(-1, store->find(nth(3)));
+    TEST_ASSERT_EQUAL(HEADER_SIZE + STATION_MAX * sizeof(StationRecord), std::filesystem::file_size(STORE_PATH));
+    delete store;
+
+    StationStore *again = new StationStore(files);
+    TEST_ASSERT_TRUE(again->begin());
+    TEST_ASSERT_FALSE(again->isFresh());
+    delete again;
+}
+
+// Metadata goes through upsert, stays in RAM until flush() and comes back
+// from the file at the same slots
+static void test_upsert_flush_and_reload()
+{
+    StationStore *store = new StationStore(files);
+    store->begin();
+    for (size_t i = 0; i < 100; i++)
+    {
+        for (size_t n = 0; n <= i % 5; n++)
+            store->notePlay(nth(i));
+        store->noteRssi(nth(i), (int)(i % 60));
+    }
+    store->setName(nth(7), "VOV GIAO THONG HN");
+    // Upsert of a known channel reuses its record
+    store->notePlay(nth(7));
+    TEST_ASSERT_EQUAL(100, store->count());
+    TEST_ASSERT_TRUE(store->isDirty());
+    // Unknown channels are not created by RSSI or name updates
+    store->noteRssi(nth(200), 30);
+    store->setName(nth(201), "X");
+    TEST_ASSERT_NULL(store->get(nth(200)));
+    TEST_ASSERT_EQUAL(-1, store->find(Channel(0)));
+    assertIndexConsistent(*store);
+
+    store->flush();
+    TEST_ASSERT_FALSE(store->isDirty());
+    int slot7 = store->find(nth(7));
+    delete store;
+
+    StationStore *reloaded = new StationStore(files);
+    TEST_ASSERT_TRUE(reloaded->begin());
+    TEST_ASSERT_FALSE(reloaded->isFresh());
+    TEST_ASSERT_EQUAL(100, reloaded->count());
+    assertIndexConsistent(*reloaded);
+    TEST_ASSERT_EQUAL(slot7, reloaded->find(nth(7)));
+    const StationRecord *rec = reloaded->get(nth(7));
+    TEST_ASSERT_NOT_NULL(rec);
+    TEST_ASSERT_EQUAL_STRING("VOV GIAO THONG HN", rec->name);
+    TEST_ASSERT_EQUAL(4, rec->playCount);
+    TEST_ASSERT_EQUAL(7, rec->lastRssi);
+    TEST_ASSERT_EQUAL(5, reloaded->get(nth(99))->playCount);
+    delete reloaded;
+}
+
+// A record whose CRC does not match is dropped on load, the rest stays
+static void test_corrupt_record_is_dropped()
+{
+    StationStore *store = new StationStore(files);
+    store->begin();
+    for (size_t i = 0; i < 10; i++)
+        store->notePlay(nth(i));
+    store->setName(nth(4), "CORRUPT ME");
+    store->flush();
+    int victim = store->find(nth(4));
+    delete store;
+
+    // Flip one byte of the name on the card
+    FILE *fp = fopen(STORE_PATH, "r+b");
+    long at = HEADER_SIZE + victim * (long)sizeof(StationRecord) + offsetof(StationRecord, name);
+    fseek(fp, at, SEEK_SET);
+    int c = fgetc(fp);
+    fseek(fp, at, SEEK_SET);
+    fputc(c ^ 0x20, fp);
+    fclose(fp);
+
+    StationStore *reloaded = new StationStore(files);
+    TEST_ASSERT_TRUE(reloaded->begin());
+    TEST_ASSERT_FALSE(reloaded->isFresh());
+    TEST_ASSERT_EQUAL(9, reloaded->count());
+    TEST_ASSERT_NULL(reloaded->get(nth(4)));
+    TEST_ASSERT_NOT_NULL(reloaded->get(nth(5)));
+    assertIndexConsistent(*reloaded);
+    delete reloaded;
+}
+
+// A header from another layout is not trusted: the store starts over
+static void test_foreign_header_recreates_store()
+{
+    StationStore *store = new StationStore(files);
+    store->begin();
+    store->notePlay(nth(1));
+    store->flush();
+    delete store;
+
+    FILE *fp = fopen(STORE_PATH, "r+b");
+    fseek(fp, 4, SEEK_SET); // version
+    fputc(0x7F, fp);
+    fclose(fp);
+
+    StationStore *reloaded = new StationStore(files);
+    TEST_ASSERT_TRUE(reloaded->begin());
+    TEST_ASSERT_TRUE(reloaded->isFresh());
+    TEST_ASSERT_EQUAL(0, reloaded->count());
+    delete reloaded;
+}
+
+// Presets are persisted at once and keep the order they were added in
+static void test_preset_add_remove_persist()
+{
+    StationStore *store = new StationStore(files);
+    store->begin();
+    TEST_ASSERT_TRUE(store->addPreset(nth(30)));
+    TEST_ASSERT_TRUE(store->addPreset(nth(2)));
+    TEST_ASSERT_TRUE(store->addPreset(nth(17)));
+    TEST_ASSERT_TRUE(store->addPreset(nth(2))); // Already a preset
+    TEST_ASSERT_EQUAL(3, store->presetCount());
+    TEST_ASSERT_TRUE(store->removePreset(1));
+    TEST_ASSERT_FALSE(store->removePreset(5));
+    TEST_ASSERT_FALSE(store->isDirty());
+    delete store;
+
+    StationStore *reloaded = new StationStore(files);
+    reloaded->begin();
+    TEST_ASSERT_EQUAL(2, reloaded->presetCount());
+    TEST_ASSERT_EQUAL(nth(30).code(), reloaded->presetAt(0)->code);
+    TEST_ASSERT_EQUAL(nth(17).code(), reloaded->presetAt(1)->code);
+    TEST_ASSERT_NULL(reloaded->presetAt(2));
+    // Removing a preset keeps the station
+    TEST_ASSERT_NOT_NULL(reloaded->get(nth(2)));
+    TEST_ASSERT_EQUAL(0, reloaded->get(nth(2))->flags & STATION_FLAG_FAVORITE);
+    // New presets go after the loaded ones
+    TEST_ASSERT_TRUE(reloaded->addPreset(nth(2)));
+    TEST_ASSERT_EQUAL(nth(2).code(), reloaded->presetAt(2)->code);
+    delete reloaded;
+}
+
+// A full store forgets the least played station that is not a preset;
+// many evictions (index tombstones, then a rebuild) keep every lookup right
+static void test_eviction_keeps_index_consistent()
+{
+    StationStore *store = new StationStore(files);
+    store->begin();
+    for (size_t i = 0; i < STATION_MAX; i++)
+    {
+        for (size_t n = 0; n < 1 + i % 7; n++)
+            store->notePlay(nth(i));
+    }
+    TEST_ASSERT_TRUE(store->addPreset(nth(0))); // Played once, but a preset
+    TEST_ASSERT_EQUAL(STATION_MAX, store->count());
+
+    // nth(7) is the first non-preset with the lowest play count
+    store->notePlay(nth(STATION_MAX));
+    TEST_ASSERT_EQUAL(STATION_MAX, store->count());
+    TEST_ASSERT_NULL(store->get(nth(7)));
+    TEST_ASSERT_NOT_NULL(store->get(nth(0)));
+    TEST_ASSERT_NOT_NULL(store->get(nth(STATION_MAX)));
+
+    // Codes anywhere in the band (50 kHz raster) collide in the index, so
+    // removals sit inside probe chains
+    std::mt19937 rng(28);
+    for (size_t i = 0; i < STATION_MAX * 4; i++)
+    {
+        Channel channel((uint16_t)(7600 + rng() % 641 * 5));
+        store->notePlay(channel);
+        TEST_ASSERT_NOT_NULL(store->get(channel));
+        if (i % 64 == 0)
+            assertIndexConsistent(*store);
+    }
+    TEST_ASSERT_EQUAL(STATION_MAX, store->count());
+    TEST_ASSERT_NOT_NULL(store->get(nth(0)));
+    assertIndexConsistent(*store);
+
+    store->flush();
+    delete store;
+    StationStore *reloaded = new StationStore(files);
+    reloaded->begin();
+    TEST_ASSERT_EQUAL(STATION_MAX, reloaded->count());
+    TEST_ASSERT_EQUAL(1, reloaded->presetCount());
+    assertIndexConsistent(*reloaded);
+    delete reloaded;
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fresh_store_is_created_full_size);
+    RUN_TEST(test_upsert_flush_and_reload);
+    RUN_TEST(test_corrupt_record_is_dropped);
+    RUN_TEST(test_foreign_header_recreates_store);
+    RUN_TEST(test_preset_add_remove_persist);
+    RUN_TEST(test_eviction_keeps_index_consistent);
+    return UNITY_END();
+}
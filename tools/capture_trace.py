@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""Read, compare and replay Famio capture traces (/api/system/capture).
+
+Trace (little endian, see Code/include/Capture.h):
+    header (48 bytes): 4s magic "FMCP" | u16 version | u16 header_size
+        | u32 start_us | u32 start_ms | u32 free_heap | u32 reserved | 24s build
+    events: u8 type | u8 len | u32 time_us (from start) | payload[len]
+        1 http   u8 method | u8 0 | u32 dur_us | u32 heap_before | u32 heap_after
+                 | u32 max_alloc | request line ("uri?name=value&...")
+        2 block  u8 ok | u8 0 | u16 regs[6] (0x0A-0x0F)
+        3 reg    u8 reg | u8 ok | u16 value
+        4 stc    u8 ok | u8 0 | u16 0x0A | u16 0x0B
+        5 file   u8 op | u8 ok | u32 dur_us | u32 bytes | u32 free_heap | path
+        6 lost   u32 bytes dropped before this point
+
+Usage:
+    capture_trace.py report field.bin
+    capture_trace.py diff field.bin bench.bin --threshold 0.2
+    capture_trace.py fetch famio.local field --out field.bin
+    capture_trace.py drive famio.local field.bin --name field --out bench.bin
+"""
+import argparse
+import struct
+import sys
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+
+MAGIC = b"FMCP"
+VERSION = 1
+HEADER = struct.Struct("<4sHHIIII24s")
+EVENT = struct.Struct("<BBI")
+HTTP = struct.Struct("<BBIIII")
+BLOCK = struct.Struct("<BB6H")
+REG = struct.Struct("<BBH")
+STC = struct.Struct("<BBHH")
+FILE = struct.Struct("<BBIII")
+
+METHODS = {0: "DELETE", 1: "GET", 2: "HEAD", 3: "POST", 4: "PUT", 6: "OPTIONS"}
+FILE_OPS = {1: "open_read", 2: "open_write", 3: "open_append", 4: "load_json",
+            5: "save_json", 6: "remove", 7: "mkdir", 8: "rename", 9: "exists"}
+# A pause this long between STC polls starts a new tune
+TUNE_GAP_US = 200000
+# Latency changes below this are noise, whatever the ratio
+MIN_LATENCY_DELTA_US = 2000
+
+
+class Trace:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if len(data) < HEADER.size:
+            raise ValueError(f"{path}: too short")
+        magic, version, header_size, _, _, self.free_heap, _, build = HEADER.unpack_from(data)
+        if magic != MAGIC or version != VERSION:
+            raise ValueError(f"{path}: not a version {VERSION} capture")
+        self.build = build.split(b"\0", 1)[0].decode(errors="replace")
+        self.requests, self.blocks, self.regs, self.stc, self.files = [], [], [], [], []
+        self.lost = 0
+        self.truncated = False
+
+        pos = header_size
+        while pos + EVENT.size <= len(data):
+            kind, length, t = EVENT.unpack_from(data, pos)
+            pos += EVENT.size
+            if pos + length > len(data):
+                self.truncated = True  # Power lost mid-write
+                break
+            payload = data[pos:pos + length]
+            pos += length
+            if kind == 1:
+                method, _, dur, before, after, max_alloc = HTTP.unpack_from(payload)
+                line = payload[HTTP.size:].decode(errors="replace")
+                self.requests.append({"t": t, "method": METHODS.get(method, str(method)), "line": line,
+                                      "route": line.split("?", 1)[0], "dur": dur, "heap_before": before,
+                                      "heap_after": after, "max_alloc": max_alloc})
+            elif kind == 2:
+                ok, _, *regs = BLOCK.unpack_from(payload)
+                self.blocks.append((t, ok, regs))
+            elif kind == 3:
+                self.regs.append((t,) + REG.unpack_from(payload))
+            elif kind == 4:
+                ok, _, r0a, r0b = STC.unpack_from(payload)
+                self.stc.append((t, ok, r0a, r0b))
+            elif kind == 5:
+                op, ok, dur, size, heap = FILE.unpack_from(payload)
+                self.files.append({"t": t, "op": FILE_OPS.get(op, str(op)), "ok": ok, "dur": dur, "bytes": size,
+                                   "heap": heap, "path": payload[FILE.size:].decode(errors="replace")})
+            elif kind == 6:
+                self.lost += struct.unpack_from("<I", payload)[0]
+            # Unknown types are skipped by their length
+        if pos < len(data):
+            self.truncated = True
+
+        # SD operations that ran inside a request count against its route
+        for req in self.requests:
+            req["sd_ops"] = 0
+            req["sd_us"] = 0
+        spans = sorted(self.requests, key=lambda r: r["t"])
+        for op in self.files:
+            for req in spans:
+                if req["t"] <= op["t"] < req["t"] + req["dur"]:
+                    req["sd_ops"] += 1
+                    req["sd_us"] += op["dur"]
+                    op["route"] = req["route"]
+                    break
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p * len(values)))]
+
+
+def route_stats(trace):
+    routes = {}
+    for req in trace.requests:
+        routes.setdefault((req["method"], req["route"]), []).append(req)
+    stats = {}
+    for key, reqs in routes.items():
+        durs = [r["dur"] for r in reqs]
+        stats[key] = {
+            "count": len(reqs),
+            "p50": percentile(durs, 0.50),
+            "p95": percentile(durs, 0.95),
+            "max": max(durs),
+            "heap_drop": max(r["heap_before"] - r["heap_after"] for r in reqs),
+            "min_block": min(r["max_alloc"] for r in reqs),
+            "sd_ops": sum(r["sd_ops"] for r in reqs) / len(reqs),
+            "sd_us": percentile([r["sd_us"] for r in reqs], 0.95),
+        }
+    return stats
+
+
+def tuner_stats(trace):
+    reads = len(trace.blocks) + len(trace.regs) + len(trace.stc)
+    failed = sum(1 for b in trace.blocks if not b[1]) + sum(1 for r in trace.regs if not r[2]) \
+        + sum(1 for s in trace.stc if not s[1])
+    tunes = []
+    last = None
+    for t, _, _, _ in trace.stc:
+        if last is None or t - last > TUNE_GAP_US:
+            tunes.append(0)
+        tunes[-1] += 1
+        last = t
+    return {"reads": reads, "failed": failed, "tunes": len(tunes),
+            "polls_p50": percentile(tunes, 0.50), "polls_max": max(tunes, default=0)}
+
+
+def cmd_report(args):
+    trace = Trace(args.trace)
+    print(f"{args.trace}: firmware {trace.build}, {len(trace.requests)} requests, "
+          f"{len(trace.files)} SD ops, {trace.lost} bytes lost{', truncated' if trace.truncated else ''}")
+    print(f"\n{'route':<34}{'n':>5}{'p50 ms':>9}{'p95 ms':>9}{'max ms':>9}{'heap-':>8}{'blk min':>9}{'sd/req':>8}")
+    for (method, route), s in sorted(route_stats(trace).items(), key=lambda kv: -kv[1]["p95"]):
+        print(f"{method + ' ' + route:<34}{s['count']:>5}{s['p50'] / 1000:>9.1f}{s['p95'] / 1000:>9.1f}"
+              f"{s['max'] / 1000:>9.1f}{s['heap_drop']:>8}{s['min_block']:>9}{s['sd_ops']:>8.1f}")
+
+    ops = {}
+    for op in trace.files:
+        ops.setdefault(op["op"], []).append(op)
+    if ops:
+        print(f"\n{'sd op':<14}{'n':>6}{'failed':>8}{'p95 ms':>9}{'max ms':>9}{'outside http':>14}")
+        for name, items in sorted(ops.items()):
+            durs = [o["dur"] for o in items]
+            print(f"{name:<14}{len(items):>6}{sum(1 for o in items if not o['ok']):>8}"
+                  f"{percentile(durs, 0.95) / 1000:>9.1f}{max(durs) / 1000:>9.1f}"
+                  f"{sum(1 for o in items if 'route' not in o):>14}")
+
+    t = tuner_stats(trace)
+    print(f"\ntuner: {t['reads']} reads, {t['failed']} failed, {t['tunes']} tunes, "
+          f"STC polls per tune p50 {t['polls_p50']} max {t['polls_max']}")
+    return 0
+
+
+def cmd_diff(args):
+    base, cand = Trace(args.base), Trace(args.candidate)
+    b, c = route_stats(base), route_stats(cand)
+    regressions = 0
+    print(f"{'route':<34}{'p95 base':>10}{'p95 new':>10}{'blk base':>10}{'blk new':>10}")
+    for key in sorted(set(b) | set(c)):
+        name = f"{key[0]} {key[1]}"
+        if key not in b or key not in c:
+            print(f"{name:<34}  only in {'candidate' if key in c else 'base'}")
+            continue
+        sb, sc = b[key], c[key]
+        flags = []
+        delta = sc["p95"] - sb["p95"]
+        if delta > MIN_LATENCY_DELTA_US and sc["p95"] > sb["p95"] * (1 + args.threshold):
+            flags.append("latency")
+        if sc["min_block"] < sb["min_block"] * (1 - args.threshold):
+            flags.append("heap")
+        if sc["sd_ops"] > sb["sd_ops"]:
+            flags.append("sd ops")
+        regressions += len(flags)
+        print(f"{name:<34}{sb['p95'] / 1000:>10.1f}{sc['p95'] / 1000:>10.1f}{sb['min_block']:>10}"
+              f"{sc['min_block']:>10}  {', '.join(flags)}")
+
+    tb, tc = tuner_stats(base), tuner_stats(cand)
+    print(f"\ntuner failed reads {tb['failed']} -> {tc['failed']}, "
+          f"STC polls per tune max {tb['polls_max']} -> {tc['polls_max']}")
+    if tc["polls_max"] > tb["polls_max"]:
+        regressions += 1
+    if cand.lost:
+        print(f"warning: candidate lost {cand.lost} bytes of events")
+    print(f"\n{regressions} regression(s)")
+    return 1 if regressions else 0
+
+
+def api(host, path, method="GET", params=None, timeout=10):
+    url = f"http://{host}{path}"
+    if params:
+        url += "?" + urllib.parse.urlencode(params)
+    req = urllib.request.Request(url, method=method, data=b"" if method in ("POST", "PUT") else None)
+    with urllib.request.urlopen(req, timeout=timeout) as resp:
+        return resp.read()
+
+
+def cmd_fetch(args):
+    data = api(args.host, "/api/system/capture/file", params={"name": args.name}, timeout=60)
+    with open(args.out, "wb") as f:
+        f.write(data)
+    print(f"{args.out}: {len(data)} bytes")
+    return 0
+
+
+def cmd_drive(args):
+    trace = Trace(args.trace)
+    # The device replays the tuner results of the trace it already holds
+    # (`--name`) and records what the current firmware does with them
+    api(args.host, "/api/system/capture", "POST", {"action": "stop"})
+    api(args.host, "/api/system/capture", "POST", {"action": "replay", "name": args.name})
+    api(args.host, "/api/system/capture", "POST", {"action": "record", "name": args.record})
+
+    failures = 0
+    start = time.monotonic()
+    first = trace.requests[0]["t"] if trace.requests else 0
+    for req in trace.requests:
+        if req["route"].startswith("/api/system/capture") or req["method"] == "OPTIONS":
+            continue
+        delay = (req["t"] - first) / 1e6 / args.speed - (time.monotonic() - start)
+        if delay > 0:
+            time.sleep(delay)
+        path, _, query = req["line"].partition("?")
+        try:
+            api(args.host, path, req["method"], urllib.parse.parse_qsl(query, keep_blank_values=True))
+        except (urllib.error.URLError, OSError) as e:
+            failures += 1
+            print(f"{req['method']} {req['line']}: {e}", file=sys.stderr)
+
+    api(args.host, "/api/system/capture", "POST", {"action": "stop"})
+    data = api(args.host, "/api/system/capture/file", params={"name": args.record}, timeout=60)
+    with open(args.out, "wb") as f:
+        f.write(data)
+    print(f"sent {len(trace.requests)} requests ({failures} failed), {args.out}: {len(data)} bytes\n")
+    return cmd_diff(argparse.Namespace(base=args.trace, candidate=args.out, threshold=args.threshold))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("report", help="latency, heap, SD and tuner summary of one trace")
+    p.add_argument("trace")
+    p.set_defaults(func=cmd_report)
+
+    p = sub.add_parser("diff", help="compare two traces; exit 1 on regression")
+    p.add_argument("base")
+    p.add_argument("candidate")
+    p.add_argument("--threshold", type=float, default=0.2, help="allowed relative change (default 0.2)")
+    p.set_defaults(func=cmd_diff)
+
+    p = sub.add_parser("fetch", help="download a trace from the device")
+    p.add_argument("host")
+    p.add_argument("name")
+    p.add_argument("--out", required=True)
+    p.set_defaults(func=cmd_fetch)
+
+    p = sub.add_parser("drive", help="replay a trace on a bench unit and diff the result")
+    p.add_argument("host")
+    p.add_argument("trace", help="local copy of the trace")
+    p.add_argument("--name", required=True, help="the same trace's name on the device's SD")
+    p.add_argument("--record", default="replay", help="name for the new recording")
+    p.add_argument("--out", required=True)
+    p.add_argument("--speed", type=float, default=1.0, help="time scale of the request schedule")
+    p.add_argument("--threshold", type=float, default=0.2)
+    p.set_defaults(func=cmd_drive)
+
+    args = ap.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
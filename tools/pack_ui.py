@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Pack a UI directory into the read-only "uifs" flash partition image (UiFlash).
+
+Image layout (little endian, offsets from the partition start):
+    header  "FUF1" | u32 count | u32 image_size | u32 reserved
+    index   count x { u32 hash | u32 offset | u32 size | u8 flags | 3 pad }, sorted by hash
+    data    file contents, each 4-byte aligned
+
+hash is FNV-1a over the path relative to the UI root ("/index.html"), the same
+hash UiManifest uses on the device. Text assets are stored gzip-compressed
+(flags bit 0) when that saves at least 10%.
+
+Usage:
+    pack_ui.py <ui_dir> <out.bin>
+    pack_ui.py <ui_dir> <out.bin> --flash /dev/ttyUSB0
+"""
+import argparse
+import gzip
+import os
+import struct
+import subprocess
+import sys
+
+MAGIC = b"FUF1"
+PARTITION_OFFSET = 0x310000   # uifs in partitions.csv
+PARTITION_SIZE = 0xE0000
+FLAG_GZIP = 0x01
+COMPRESSIBLE = (".html", ".htm", ".css", ".js", ".json", ".svg", ".txt", ".ico")
+HEADER = struct.Struct("<4sIII")
+ENTRY = struct.Struct("<IIIB3x")
+
+
+def fnv1a(path):
+    h = 2166136261
+    for b in path.encode("utf-8"):
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h or 1
+
+
+def collect(ui_dir):
+    files = []
+    for root, _, names in os.walk(ui_dir):
+        for name in names:
+            full = os.path.join(root, name)
+            rel = "/" + os.path.relpath(full, ui_dir).replace(os.sep, "/")
+            # Pre-compressed siblings from the SD layout are redundant here
+            if rel.endswith(".gz") and os.path.exists(full[:-3]):
+                continue
+            files.append((rel, full))
+    return files
+
+
+def pack(ui_dir):
+    entries = {}
+    for rel, full in collect(ui_dir):
+        with open(full, "rb") as f:
+            data = f.read()
+        flags = 0
+        if rel.lower().endswith(COMPRESSIBLE):
+            packed = gzip.compress(data, compresslevel=9, mtime=0)
+            if len(packed) * 10 <= len(data) * 9:
+                data, flags = packed, FLAG_GZIP
+        h = fnv1a(rel)
+        if h in entries:
+            sys.exit("hash collision: %s and %s" % (rel, entries[h][0]))
+        entries[h] = (rel, data, flags)
+
+    order = sorted(entries)
+    offset = HEADER.size + ENTRY.size * len(order)
+    index = bytearray()
+    blob = bytearray()
+    for h in order:
+        rel, data, flags = entries[h]
+        pad = (-(offset + len(blob))) % 4
+        blob += b"\0" * pad
+        index += ENTRY.pack(h, offset + len(blob), len(data), flags)
+        blob += data
+
+    size = offset + len(blob)
+    image = HEADER.pack(MAGIC, len(order), size, 0) + bytes(index) + bytes(blob)
+    return image, entries
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("ui_dir")
+    parser.add_argument("output")
+    parser.add_argument("--flash", metavar="PORT", help="write the image to the uifs partition with esptool")
+    args = parser.parse_args()
+
+    image, entries = pack(args.ui_dir)
+    if len(image) > PARTITION_SIZE:
+        sys.exit("image is %d bytes, uifs partition holds %d" % (len(image), PARTITION_SIZE))
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    raw = sum(os.path.getsize(full) for _, full in collect(args.ui_dir))
+    gz = sum(1 for _, _, flags in entries.values() if flags & FLAG_GZIP)
+    print("%s: %d files (%d gzip), %d bytes from %d (%d%% of uifs)"
+          % (args.output, len(entries), gz, len(image), raw, len(image) * 100 // PARTITION_SIZE))
+
+    cmd = ["esptool.py", "--chip", "esp32", "write_flash", hex(PARTITION_OFFSET), args.output]
+    if args.flash:
+        subprocess.check_call(cmd[:1] + ["--port", args.flash] + cmd[1:])
+    else:
+        print("flash with: " + " ".join(cmd))
+
+
+if __name__ == "__main__":
+    main()
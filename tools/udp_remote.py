@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Send one command to the Famio UDP control port (UdpControl) and print the reply.
+
+Request (16 bytes, little endian):
+    u16 magic 0x4346 | u8 version 1 | u8 op | u32 seq | i32 value | u32 token
+Response (16 bytes):
+    u16 magic | u8 version | u8 op | u32 seq | u8 status | u8 flags
+    | u16 channel_code | u8 volume | u8 rssi | u16 reserved
+
+Usage:
+    udp_remote.py famio.local status
+    udp_remote.py famio.local tune 99.5
+    udp_remote.py famio.local volume 8 --token 1234
+    udp_remote.py famio.local bench --count 500
+
+bench re-tunes the current channel alternately over UDP and over
+POST /api/fm/setfreq (the route the web UI uses), so both paths do the
+same RadioController work, and prints the round-trip percentiles of each.
+Requests are paced under the per-client control rate so HTTP is not
+answered 429.
+"""
+import argparse
+import http.client
+import random
+import socket
+import struct
+import sys
+import time
+
+PORT = 5011
+MAGIC = 0x4346
+VERSION = 1
+OPS = {"tune": 1, "volume": 2, "preset": 3, "up": 4, "down": 5,
+       "power": 6, "next": 7, "status": 0x10}
+STATUS = {0: "ok", 1: "invalid", 2: "auth", 3: "stale"}
+REQ = struct.Struct("<HBBIiI")
+RESP = struct.Struct("<HBBIBBHBBH")
+
+
+def request(sock, addr, op, seq, value, token, retries=3, timeout=0.2):
+    pkt = REQ.pack(MAGIC, VERSION, op, seq, value, token)
+    sock.settimeout(timeout)
+    for _ in range(retries):
+        # Resending the same seq is safe: the device answers from its cache
+        sock.sendto(pkt, addr)
+        try:
+            while True:
+                data, _ = sock.recvfrom(64)
+                if len(data) == RESP.size:
+                    resp = RESP.unpack(data)
+                    if resp[0] == MAGIC and resp[3] == seq:
+                        return resp
+        except socket.timeout:
+            continue
+    return None
+
+
+def percentiles(name, rtts, count):
+    rtts.sort()
+    if not rtts:
+        return "%-5s no replies" % name
+    return "%-5s replies %d/%d  p50 %.0f us  p99 %.0f us" % (
+        name, len(rtts), count, rtts[len(rtts) // 2], rtts[len(rtts) * 99 // 100])
+
+
+def http_setfreq(host, code, timeout=1.0):
+    # A new connection per request, as the browser's fetch() gets from WebServer
+    conn = http.client.HTTPConnection(host, 80, timeout=timeout)
+    try:
+        conn.request("POST", "/api/fm/setfreq", "freq=%.2f" % (code / 100.0),
+                     {"Content-Type": "application/x-www-form-urlencoded"})
+        resp = conn.getresponse()
+        resp.read()
+        return resp.status == 200
+    except (OSError, http.client.HTTPException):
+        return False
+    finally:
+        conn.close()
+
+
+def bench(sock, addr, host, seq, args):
+    state = request(sock, addr, OPS["status"], seq, 0, args.token)
+    if not state:
+        sys.exit("no reply")
+    code = state[6]
+    udp, web = [], []
+    for _ in range(args.count):
+        seq += 1
+        t = time.perf_counter()
+        if request(sock, addr, OPS["tune"], seq, code, args.token):
+            udp.append((time.perf_counter() - t) * 1e6)
+        time.sleep(args.pace)
+        t = time.perf_counter()
+        if http_setfreq(host, code):
+            web.append((time.perf_counter() - t) * 1e6)
+        time.sleep(args.pace)
+    print("tune %.2f MHz, %d rounds" % (code / 100.0, args.count))
+    print(percentiles("udp", udp, args.count))
+    print(percentiles("http", web, args.count))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("host")
+    ap.add_argument("op", choices=sorted(OPS) + ["bench"])
+    ap.add_argument("value", nargs="?", default="0")
+    ap.add_argument("--port", type=int, default=PORT)
+    ap.add_argument("--token", type=int, default=0)
+    ap.add_argument("--count", type=int, default=200)
+    ap.add_argument("--pace", type=float, default=0.06, help="seconds between bench requests")
+    args = ap.parse_args()
+
+    addr = (socket.gethostbyname(args.host), args.port)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    seq = random.randint(1, 1 << 30)
+
+    if args.op == "bench":
+        bench(sock, addr, addr[0], seq, args)
+        return
+
+    value = args.value
+    if args.op == "tune":
+        value = round(float(value) * 100)  # MHz -> 10 kHz units
+    resp = request(sock, addr, OPS[args.op], seq + 1, int(value), args.token)
+    if not resp:
+        sys.exit("no reply")
+    _, _, _, _, status, flags, code, volume, rssi, _ = resp
+    print("%s  power=%s  freq=%.2f MHz  volume=%d  rssi=%d" % (
+        STATUS.get(status, status), "on" if flags & 1 else "off", code / 100.0, volume, rssi))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""Pack a UI directory into a Famio UI bundle and optionally upload it.
+
+Bundle layout (little endian), unpacked by OtaManager on the device:
+    "FUI1" | u32 file_count | { u16 path_len | u32 size | path | data } ...
+
+Usage:
+    ui_bundle.py <ui_dir> <out.bin>
+    ui_bundle.py <ui_dir> <out.bin> --upload famio.local --token 1234
+Uploads need the device's udp_token. Firmware uses the same endpoint style:
+    curl -H "X-Famio-Token: 1234" --data-binary @firmware.bin \
+        "http://famio.local:8080/firmware?md5=$(md5sum firmware.bin | cut -c1-32)"
+"""
+import argparse
+import hashlib
+import os
+import struct
+import sys
+import urllib.request
+
+MAGIC = b"FUI1"
+OTA_PORT = 8080
+
+
+def pack(ui_dir):
+    files = []
+    for root, _, names in os.walk(ui_dir):
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            rel = os.path.relpath(full, ui_dir).replace(os.sep, "/")
+            files.append((rel, full))
+    files.sort()
+
+    out = bytearray(MAGIC + struct.pack("<I", len(files)))
+    for rel, full in files:
+        path = rel.encode("utf-8")
+        if len(path) >= 96:
+            sys.exit("path too long for the device: " + rel)
+        with open(full, "rb") as f:
+            data = f.read()
+        out += struct.pack("<HI", len(path), len(data)) + path + data
+    return bytes(out), len(files)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("ui_dir")
+    parser.add_argument("output")
+    parser.add_argument("--upload", metavar="HOST", help="POST the bundle to http://HOST:%d/ui" % OTA_PORT)
+    parser.add_argument("--token", type=int, default=0, help="control token (udp_token in common.json)")
+    args = parser.parse_args()
+
+    bundle, count = pack(args.ui_dir)
+    with open(args.output, "wb") as f:
+        f.write(bundle)
+    md5 = hashlib.md5(bundle).hexdigest()
+    print("%s: %d files, %d bytes, md5 %s" % (args.output, count, len(bundle), md5))
+
+    if args.upload:
+        url = "http://%s:%d/ui?md5=%s" % (args.upload, OTA_PORT, md5)
+        req = urllib.request.Request(url, data=bundle, method="POST",
+                                     headers={"Content-Type": "application/octet-stream",
+                                              "X-Famio-Token": str(args.token)})
+        with urllib.request.urlopen(req, timeout=120) as resp:
+            print(resp.read().decode("utf-8"))
+
+
+if __name__ == "__main__":
+    main()